@@ -0,0 +1,2 @@
+D:\VulkanSDK\Bin\glslangValidator.exe -V ./shader.comp
+pause
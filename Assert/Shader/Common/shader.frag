@@ -3,73 +3,200 @@
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inNormal;
 layout (location = 2) in vec3 inColor;
-layout (location = 3) in vec4 inShadowCoord;
+layout (location = 3) in vec4 inWorldPosition;
 layout (location = 4) in vec3 inLightPos;
 
 layout (location = 0) out vec4 outColor;
 
-layout (binding = 1) uniform sampler2D shadowMapSampler;
+#define SHADOW_CASCADE_MAX 4
 
-float PCF(vec4 shadowCoord, float filterSize)
+layout (binding = 0) uniform MVPUniformBufferObject
 {
-	filterSize = (filterSize > 0.0) ? filterSize : -1.f * filterSize; //非负数
-	filterSize = round(filterSize); //非小数
-	filterSize = (mod(filterSize, 2.0) == 0.0) ? filterSize + 1.0 : filterSize; //非偶数
-	filterSize = (filterSize < 3.0) ? 3.0 : filterSize; //最小3.0
-	//filterSize = (filterSize > 21.0) ? 21.0 : filterSize; //最大9.0
+	mat4 model;
+	mat4 view;
+	mat4 proj;
+	mat4 mv_normal;
+	mat4 lightPovMVP[SHADOW_CASCADE_MAX];
+	vec4 cascadeSplits; //每个cascade在视图空间的远端距离
+	vec3 lightPos;
+	int cascadeCount;
+	int shadowLightType; //0: Directional (CSM), 1: Point (Cube)
+	float omniShadowFarPlane;
+} mvpUBO;
+
+layout (binding = 1) uniform sampler2DArray shadowMapSampler; //每层一个cascade
+layout (binding = 2) uniform samplerCube omniShadowSampler; //存储到点光源的归一化线性距离
+
+//Specialization constants, the loops below have compile-time bounds and can be fully unrolled
+layout (constant_id = 0) const int SHADOW_MODE = 2; //0: Hard, 1: PCF, 2: PCSS
+layout (constant_id = 1) const int PCF_RADIUS = 3; //PCF kernel = (2 * PCF_RADIUS + 1)^2
+layout (constant_id = 2) const int BLOCKER_SEARCH_RADIUS = 2; //Blocker search = (2 * BLOCKER_SEARCH_RADIUS + 1)^2
+
+const mat4 biasMat = mat4( 
+	0.5, 0.0, 0.0, 0.0,
+	0.0, 0.5, 0.0, 0.0,
+	0.0, 0.0, 1.0, 0.0, //不改变z值
+	0.5, 0.5, 0.0, 1.0 );
+
+float HardShadow(vec4 shadowCoord, int cascade)
+{
+	vec2 shadowMapUV = shadowCoord.xy / shadowCoord.w;
+	float currentDepth = shadowCoord.z / shadowCoord.w;
+	float closetDepth = texture(shadowMapSampler, vec3(shadowMapUV, cascade)).r;
+	return (currentDepth > closetDepth) ? 1.0 : 0.0;
+}
 
+//filterScale: 采样间隔（以texel为单位），PCSS用它放大固定大小的kernel
+float PCF(vec4 shadowCoord, int cascade, float filterScale)
+{
 	vec2 shadowMapUV = shadowCoord.xy / shadowCoord.w;
-	vec2 texelSize = 1.0 / textureSize(shadowMapSampler, 0);
+	vec2 texelStep = filterScale / vec2(textureSize(shadowMapSampler, 0).xy);
 	float currentDepth = shadowCoord.z / shadowCoord.w;
-	float closetDepth = 0.0;
 
-	float filterHalf = floor(filterSize / 2.0);
-	float shadowCount = 0.0;
+	//样本数在循环中累加，float(PCF_RADIUS)会生成Shader capability下不合法的OpSpecConstantOp ConvertSToF
 	float shadowTotal = 0.0;
-	for (float i = -filterHalf; i <= filterHalf; ++i)
+	float shadowCount = 0.0;
+	for (int i = -PCF_RADIUS; i <= PCF_RADIUS; ++i)
 	{
-		for (float j = -filterHalf; j <= filterHalf; ++j)
+		for (int j = -PCF_RADIUS; j <= PCF_RADIUS; ++j)
 		{
-			closetDepth = texture(shadowMapSampler, shadowMapUV + vec2(i, j) * texelSize).r;
+			float closetDepth = texture(shadowMapSampler, vec3(shadowMapUV + vec2(i, j) * texelStep, cascade)).r;
 			shadowTotal += (currentDepth > closetDepth) ? 1.0 : 0.0;
-			shadowCount++;
+			shadowCount += 1.0;
 		}
 	}
 
 	return shadowTotal / shadowCount;
 }
 
-float PCSS(vec4 shadowCoord)
+float PCSS(vec4 shadowCoord, int cascade)
 {
 	vec2 shadowMapUV = shadowCoord.xy / shadowCoord.w;
-	vec2 texelSize = 1.0 / textureSize(shadowMapSampler, 0);
+	vec2 texelSize = 1.0 / vec2(textureSize(shadowMapSampler, 0).xy);
 	float receiveDepth = shadowCoord.z / shadowCoord.w;
 
 	//Blocker Search
-	float searchSize = 5.0;
-	float searchHalf = floor(searchSize / 2.0);
-	float searchArea = searchSize * searchSize;
-	float blockerDepth = 0.0;
+	float searchArea = 0.0;
 	float blockerDepthTotal = 0.0;
-	float blockerAverage = 0.0;
-	for (float i = -searchHalf; i <= searchHalf; ++i)
+	for (int i = -BLOCKER_SEARCH_RADIUS; i <= BLOCKER_SEARCH_RADIUS; ++i)
 	{
-		for (float j = -searchHalf; j <= searchHalf; ++j)
+		for (int j = -BLOCKER_SEARCH_RADIUS; j <= BLOCKER_SEARCH_RADIUS; ++j)
 		{
-			blockerDepth = texture(shadowMapSampler, shadowMapUV + vec2(i, j) * texelSize).r;
+			float blockerDepth = texture(shadowMapSampler, vec3(shadowMapUV + vec2(i, j) * texelSize, cascade)).r;
 			blockerDepthTotal += (blockerDepth < receiveDepth) ? blockerDepth : 0.0;
+			searchArea += 1.0;
 		}
 	}
-	blockerAverage = blockerDepthTotal / searchArea;
+	float blockerAverage = blockerDepthTotal / searchArea;
 
 	if (blockerAverage == 0.0)
 		return 0.0;
 
 	//Penumbra Estimation
 	//假设点光源的大小为1
-	float PenumbraWidth = (receiveDepth - blockerAverage) / blockerAverage;
+	float penumbraWidth = (receiveDepth - blockerAverage) / blockerAverage;
+	if (penumbraWidth < 0.0)
+		return 0.0;
 
-	return (PenumbraWidth < 0.0) ? 0.0 : PCF(shadowCoord, PenumbraWidth / 3.0);
+	//原先的filterSize = penumbraWidth / 3，这里固定kernel大小，改为缩放采样间隔
+	float filterHalf = max(floor(penumbraWidth / 6.0), 1.0);
+	return PCF(shadowCoord, cascade, filterHalf / float(max(PCF_RADIUS, 1)));
+}
+
+//按视图空间深度选择第一个覆盖当前片元的cascade
+int SelectCascade(float viewDepth)
+{
+	int cascade = 0;
+	for (int i = 0; i < mvpUBO.cascadeCount - 1; ++i)
+	{
+		if (viewDepth > mvpUBO.cascadeSplits[i])
+			cascade = i + 1;
+	}
+	return cascade;
+}
+
+//Cube map没有规整的texel网格，PCF在采样方向周围取固定的一组偏移
+const vec3 omniSampleOffsets[20] = vec3[]
+(
+	vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),
+	vec3( 1,  1, -1), vec3( 1, -1, -1), vec3(-1, -1, -1), vec3(-1,  1, -1),
+	vec3( 1,  1,  0), vec3( 1, -1,  0), vec3(-1, -1,  0), vec3(-1,  1,  0),
+	vec3( 1,  0,  1), vec3(-1,  0,  1), vec3( 1,  0, -1), vec3(-1,  0, -1),
+	vec3( 0,  1,  1), vec3( 0, -1,  1), vec3( 0, -1, -1), vec3( 0,  1, -1)
+);
+
+//diskScale: 偏移方向的缩放（相对于到光源的方向向量）
+float OmniPCF(vec3 lightToFrag, float currentDepth, float diskScale)
+{
+	float shadowTotal = 0.0;
+	for (int i = 0; i < 20; ++i)
+	{
+		float closetDepth = texture(omniShadowSampler, lightToFrag + omniSampleOffsets[i] * diskScale).r;
+		shadowTotal += (currentDepth > closetDepth) ? 1.0 : 0.0;
+	}
+	return shadowTotal / 20.0;
+}
+
+float OmniShadowFactor(vec4 worldPosition)
+{
+	vec3 lightToFrag = worldPosition.xyz - mvpUBO.lightPos;
+	float currentDepth = length(lightToFrag) / mvpUBO.omniShadowFarPlane;
+	if (currentDepth >= 1.0)
+		return 0.0;
+
+	//线性距离的bias按距离比例计算
+	currentDepth -= 0.005 * currentDepth;
+
+	//一个面的分辨率对应90度，PCF_RADIUS个texel对应的方向偏移
+	float texelScale = 2.0 / float(textureSize(omniShadowSampler, 0).x);
+	float diskScale = length(lightToFrag) * texelScale * float(max(PCF_RADIUS, 1));
+
+	if (SHADOW_MODE == 0)
+	{
+		float closetDepth = texture(omniShadowSampler, lightToFrag).r;
+		return (currentDepth > closetDepth) ? 1.0 : 0.0;
+	}
+	else if (SHADOW_MODE == 1)
+	{
+		return OmniPCF(lightToFrag, currentDepth, diskScale);
+	}
+
+	//Blocker Search
+	float blockerDepthTotal = 0.0;
+	float blockerCount = 0.0;
+	for (int i = 0; i < 20; ++i)
+	{
+		float blockerDepth = texture(omniShadowSampler, lightToFrag + omniSampleOffsets[i] * diskScale).r;
+		if (blockerDepth < currentDepth)
+		{
+			blockerDepthTotal += blockerDepth;
+			blockerCount += 1.0;
+		}
+	}
+
+	if (blockerCount == 0.0)
+		return 0.0;
+
+	//Penumbra Estimation，与平行光相同假设光源的大小为1
+	float blockerAverage = blockerDepthTotal / blockerCount;
+	float penumbraWidth = (currentDepth - blockerAverage) / blockerAverage;
+	return OmniPCF(lightToFrag, currentDepth, diskScale * clamp(penumbraWidth, 0.25, 4.0));
+}
+
+float ShadowFactor(vec4 worldPosition, float viewDepth)
+{
+	if (mvpUBO.shadowLightType == 1)
+		return OmniShadowFactor(worldPosition);
+
+	int cascade = SelectCascade(viewDepth);
+	vec4 shadowCoord = (biasMat * mvpUBO.lightPovMVP[cascade]) * worldPosition;
+
+	if (SHADOW_MODE == 0)
+		return HardShadow(shadowCoord, cascade);
+	else if (SHADOW_MODE == 1)
+		return PCF(shadowCoord, cascade, 1.0);
+	else
+		return PCSS(shadowCoord, cascade);
 }
 
 void main() 
@@ -97,13 +224,7 @@ void main()
 	vec3 diffuse = lightColor * materialDiffuse * max(0.0, dot(inNormal, Light));
 	vec3 specular = lightColor * materialSpecular * pow(max(0.0, dot(inNormal, Half)), 1.0);
 
-    // float closetDepth = texture(shadowMapSampler, inShadowCoord.xy / inShadowCoord.w).r;
-    // float IsInShadow = closetDepth < (inShadowCoord.z / inShadowCoord.w) ? 1.0 : 0.0;
-    // float IsNotInShadow = 1.0 - IsInShadow;
-
-	//float IsNotInShadow = 1.0 - PCF(inShadowCoord, 7.0);
-
-	float IsNotInShadow = 1.0 - PCSS(inShadowCoord);
+	float IsNotInShadow = 1.0 - ShadowFactor(inWorldPosition, -inPosition.z); //视图空间中摄像机朝向-z
 
 	outColor = vec4(ambient + diffuse * IsNotInShadow + specular * IsNotInShadow, 1.0);
 }
\ No newline at end of file
@@ -8,25 +8,23 @@ layout (location = 3) in vec3 inNormal;
 layout (location = 0) out vec3 outPosition;
 layout (location = 1) out vec3 outNormal;
 layout (location = 2) out vec3 outColor;
-layout (location = 3) out vec4 outShadowCoord;
+layout (location = 3) out vec4 outWorldPosition;
 layout (location = 4) out vec3 outLightPos;
 
+#define SHADOW_CASCADE_MAX 4
+
 layout (binding = 0) uniform MVPUniformBufferObject
 {
 	mat4 model;
 	mat4 view;
 	mat4 proj;
 	mat4 mv_normal; //用于将normal转到视图空间
-	mat4 lightPovMVP;
+	mat4 lightPovMVP[SHADOW_CASCADE_MAX];
+	vec4 cascadeSplits;
 	vec3 lightPos;
+	int cascadeCount;
 } mvpUBO;
 
-const mat4 biasMat = mat4( 
-	0.5, 0.0, 0.0, 0.0,
-	0.0, 0.5, 0.0, 0.0,
-	0.0, 0.0, 1.0, 0.0, //不改变z值
-	0.5, 0.5, 0.0, 1.0 );
-
 void main()
 {
     outPosition = (mvpUBO.view * mvpUBO.model * vec4(inPosition, 1.0)).xyz; //转为视图空间进行运算
@@ -34,7 +32,7 @@ void main()
 	outColor = inColor;
 	outLightPos = (mvpUBO.view * mvpUBO.model * vec4(mvpUBO.lightPos, 1.0)).xyz;
 
-	outShadowCoord = (biasMat * mvpUBO.lightPovMVP) * vec4(inPosition, 1.0);
+	outWorldPosition = mvpUBO.model * vec4(inPosition, 1.0); //cascade在fragment shader中按视图空间深度选择
 
     gl_Position = mvpUBO.proj * mvpUBO.view * mvpUBO.model * vec4(inPosition, 1.0);
 }
@@ -0,0 +1,41 @@
+@echo off
+rem -mfmt=num: save binary output as comma separated 32-bit numbers, included by Source/EmbeddedShader.cpp
+rem any failed shader fails the prebuild, a stale .u32 must never be embedded
+cd /d %~dp0
+set GLSLC="%VULKAN_SDK%\Bin\glslc.exe"
+if not exist %GLSLC% (
+	echo error: glslc not found, set VULKAN_SDK to the Vulkan SDK install directory
+	exit /b 1
+)
+%GLSLC% -mfmt=num -o ./Common/vert.u32 ./Common/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./Common/frag.u32 ./Common/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./glTF/vert.u32 ./glTF/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./glTF/frag.u32 ./glTF/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./Skybox/vert.u32 ./Skybox/skybox.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./Skybox/frag.u32 ./Skybox/skybox.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./ShadowMap/vert.u32 ./ShadowMap/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./OmniShadow/vert.u32 ./OmniShadow/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./OmniShadow/geom.u32 ./OmniShadow/shader.geom || exit /b 1
+%GLSLC% -mfmt=num -o ./OmniShadow/frag.u32 ./OmniShadow/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./PointLight/vert.u32 ./PointLight/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./PointLight/frag.u32 ./PointLight/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./Instanced/vert.u32 ./Instanced/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./Instanced/frag.u32 ./Instanced/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./AsteroidCompute/comp.u32 ./AsteroidCompute/shader.comp || exit /b 1
+%GLSLC% -mfmt=num -o ./MeshGrid/vert.u32 ./MeshGrid/meshgrid.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./MeshGrid/frag.u32 ./MeshGrid/meshgrid.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./BlinnPhong/vert.u32 ./BlinnPhong/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./BlinnPhong/frag.u32 ./BlinnPhong/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./PBR/vert.u32 ./PBR/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./PBR/frag.u32 ./PBR/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./vert.u32 ./shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./frag.u32 ./shader.frag || exit /b 1
+%GLSLC% -mfmt=num -DNO_VIRTUAL_FEEDBACK -o ./frag_nofeedback.u32 ./shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./PlanetImpostor/vert.u32 ./PlanetImpostor/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./PlanetImpostor/frag.u32 ./PlanetImpostor/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./PlanetTerrain/vert.u32 ./PlanetTerrain/shader.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./PlanetTerrain/frag.u32 ./PlanetTerrain/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -DNO_VIRTUAL_FEEDBACK -o ./PlanetTerrain/frag_nofeedback.u32 ./PlanetTerrain/shader.frag || exit /b 1
+%GLSLC% -mfmt=num -o ./ImGui/imgui_vert.u32 ./ImGui/imgui.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./ImGui/imgui_vert_srgb.u32 ./ImGui/imgui_srgb.vert || exit /b 1
+%GLSLC% -mfmt=num -o ./ImGui/imgui_frag.u32 ./ImGui/imgui.frag || exit /b 1
@@ -0,0 +1,17 @@
+#version 450
+
+layout (location = 0) in vec3 inWorldPos;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec3 inColor;
+
+layout (location = 0) out vec4 outColor;
+
+void main() 
+{
+    //Lit by the sun at the origin
+    vec3 N = normalize(inNormal);
+    vec3 L = normalize(-inWorldPos);
+    float diffuse = max(dot(N, L), 0.0);
+
+    outColor = vec4(inColor * (0.05 + 0.95 * diffuse), 1.0);
+}
@@ -0,0 +1,36 @@
+#version 450
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inColor;
+layout (location = 2) in vec2 inTexCoord;
+layout (location = 3) in vec3 inNormal;
+
+//Per instance rows of the model matrix (binding 1, VK_VERTEX_INPUT_RATE_INSTANCE), the fourth row is (0, 0, 0, 1)
+//InstanceData.params (location 7) carries the planet texture layer and is not read here
+layout (location = 4) in vec4 inModelRow0;
+layout (location = 5) in vec4 inModelRow1;
+layout (location = 6) in vec4 inModelRow2;
+
+layout (push_constant) uniform PushConstant
+{
+    mat4 viewProj;  //camera relative, no translation
+    vec4 color;
+    vec4 origin;    //camera world position
+} pc;
+
+layout (location = 0) out vec3 outWorldPos;
+layout (location = 1) out vec3 outNormal;
+layout (location = 2) out vec3 outColor;
+
+void main() 
+{
+    vec4 localPos = vec4(inPosition, 1.0);
+    outWorldPos = vec3(dot(inModelRow0, localPos), dot(inModelRow1, localPos), dot(inModelRow2, localPos));
+
+    //Uniform scale only, the upper 3x3 transforms normals as well
+    outNormal = vec3(dot(inModelRow0.xyz, inNormal), dot(inModelRow1.xyz, inNormal), dot(inModelRow2.xyz, inNormal));
+    outColor = inColor * pc.color.rgb;
+
+    //Floating origin: the subtraction is exact for instances close to the camera, so they do not jitter far from the sun
+    gl_Position = pc.viewProj * vec4(outWorldPos - pc.origin.xyz, 1.0);
+}
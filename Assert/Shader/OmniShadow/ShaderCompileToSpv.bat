@@ -0,0 +1,4 @@
+D:\VulkanSDK\Bin\glslangValidator.exe -V ./shader.vert
+D:\VulkanSDK\Bin\glslangValidator.exe -V ./shader.geom
+D:\VulkanSDK\Bin\glslangValidator.exe -V ./shader.frag
+pause
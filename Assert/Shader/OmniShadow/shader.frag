@@ -0,0 +1,15 @@
+#version 450
+
+layout (location = 0) in vec3 inWorldPosition;
+
+layout (binding = 0) uniform OmniShadowUniformBufferObject
+{
+    mat4 faceViewProj[6];
+    vec4 lightPos; //w: far plane
+} omniUBO;
+
+void main() 
+{
+    //Linear distance to the light normalized by the far plane, the same value for every face
+    gl_FragDepth = length(inWorldPosition - omniUBO.lightPos.xyz) / omniUBO.lightPos.w;
+}
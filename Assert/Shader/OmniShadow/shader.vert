@@ -0,0 +1,9 @@
+#version 450
+
+layout (location = 0) in vec3 inPosition;
+
+void main() 
+{
+    //World space, projected per cube face in the geometry shader
+    gl_Position = vec4(inPosition, 1.0);
+}
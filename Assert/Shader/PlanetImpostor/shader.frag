@@ -0,0 +1,46 @@
+#version 450
+
+layout (location = 0) in vec3 inQuadPos;
+layout (location = 1) flat in vec4 inSphere;
+layout (location = 2) flat in float inTextureLayer;
+layout (location = 3) flat in mat3 inRotation;
+
+layout (location = 0) out vec4 outColor;
+
+layout (binding = 0) uniform UniformBufferObject
+{
+	mat4 view;
+	mat4 proj;
+	float lod;
+} ubo;
+
+layout (binding = 1) uniform sampler2DArray texSampler;
+
+const float PI = 3.14159265359;
+
+void main()
+{
+	//Ray from the camera (origin) through this fragment against the sphere
+	vec3 dir = normalize(inQuadPos);
+	vec3 center = inSphere.xyz;
+	float b = dot(dir, center);
+	float c = dot(center, center) - inSphere.w * inSphere.w;
+	float h = b * b - c;
+	if (h < 0.0)
+		discard;
+
+	vec3 hit = dir * (b - sqrt(h));
+	vec3 normal = (hit - center) / inSphere.w;
+
+	//Depth of the real surface point, so impostors and meshes intersect correctly
+	vec4 clip = ubo.proj * ubo.view * vec4(hit, 1.0);
+	gl_FragDepth = clip.z / clip.w;
+
+	//Back to model space, then the same equirectangular mapping as the mesh path (../shader.frag)
+	vec3 localNormal = transpose(inRotation) * normal;
+	vec2 uv = vec2(atan(localNormal.x, localNormal.z) / (2.0 * PI) + 0.5,
+		acos(clamp(localNormal.y, -1.0, 1.0)) / PI);
+
+	//Unlit like the mesh path (shader.frag), the switch between both must not change the color
+	outColor = texture(texSampler, vec3(uv, inTextureLayer), ubo.lod);
+}
@@ -0,0 +1,51 @@
+#version 450
+
+//Same InstanceData records as the mesh path, bound at binding 1 without any per vertex buffer
+//Rows of the model matrix, the fourth row is (0, 0, 0, 1), and the texture array layer from params.x
+layout (location = 4) in vec4 inModelRow0;
+layout (location = 5) in vec4 inModelRow1;
+layout (location = 6) in vec4 inModelRow2;
+layout (location = 7) in float inTextureLayer;
+
+layout (location = 0) out vec3 outQuadPos;
+layout (location = 1) flat out vec4 outSphere;
+layout (location = 2) flat out float outTextureLayer;
+layout (location = 3) flat out mat3 outRotation;
+
+layout (binding = 0) uniform UniformBufferObject
+{
+	mat4 view;
+	mat4 proj;
+	float lod;
+} ubo;
+
+const vec2 corners[6] = vec2[](
+	vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+	vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+	//Model matrices are camera relative, so the camera sits at the origin
+	mat3 model = transpose(mat3(inModelRow0.xyz, inModelRow1.xyz, inModelRow2.xyz));
+	vec3 center = vec3(inModelRow0.w, inModelRow1.w, inModelRow2.w);
+	float scale = length(model[0]);
+	float radius = scale; //the procedural icosphere has unit radius
+
+	//Quad through the center, perpendicular to the view ray
+	//The silhouette cone cuts that plane in a circle of radius r * d / sqrt(d^2 - r^2)
+	float dist = length(center);
+	vec3 forward = center / dist;
+	vec3 up = abs(forward.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+	vec3 right = normalize(cross(up, forward));
+	up = cross(forward, right);
+	float extent = radius * dist / sqrt(max(dist * dist - radius * radius, 1e-6));
+
+	vec2 corner = corners[gl_VertexIndex];
+	vec3 position = center + (right * corner.x + up * corner.y) * extent;
+
+	outQuadPos = position;
+	outSphere = vec4(center, radius);
+	outTextureLayer = inTextureLayer;
+	outRotation = model / scale;
+	gl_Position = ubo.proj * ubo.view * vec4(position, 1.0);
+}
@@ -0,0 +1,3 @@
+D:\VulkanSDK\Bin\glslangValidator.exe -V ./shader.vert
+D:\VulkanSDK\Bin\glslangValidator.exe -V ./shader.frag
+pause
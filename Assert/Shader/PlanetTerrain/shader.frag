@@ -0,0 +1,110 @@
+#version 450
+
+layout (location = 0) in vec3 inLocalPos;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) flat in float inTextureLayer;
+layout (location = 3) in float textureLod;
+
+layout (location = 0) out vec4 outColor;
+
+layout (binding = 0) uniform UniformBufferObject
+{
+	mat4 view;
+	mat4 proj;
+	float lod;
+	uint virtualTextureEnable;
+	uint virtualPageCountX;		//pages along u at mip 0, half as many along v
+	uint virtualMipCount;
+	uint virtualLayerCount;
+} ubo;
+
+layout (binding = 1) uniform sampler2DArray texSampler;
+layout (binding = 2) uniform usampler2DArray virtualPageTable;
+layout (binding = 3) uniform sampler2D virtualAtlas;
+//Built a second time with -DNO_VIRTUAL_FEEDBACK for devices without fragmentStoresAndAtomics,
+//that variant declares no storage buffer and the descriptor set layout has no binding 4
+#ifndef NO_VIRTUAL_FEEDBACK
+layout (std430, binding = 4) buffer VirtualFeedback
+{
+	uint requestBits[];
+};
+#endif
+
+const float PI = 3.14159265359;
+
+const float PAGE_SIZE = 128.0;
+const float PAGE_BORDER = 4.0;
+const float PAGE_STRIDE = PAGE_SIZE + 2.0 * PAGE_BORDER;
+
+//Same virtual texture lookup as ../shader.frag (no #include in the runtime compiler)
+//Returns false while no page of the layer is resident, the texture array is used then
+bool SampleVirtualTexture(vec2 uv, uint layer, float lodBias, out vec4 color)
+{
+	color = vec4(0.0);
+
+	//u jumps from 1 to 0 at the atan seam, fold that out of the derivatives
+	vec2 dx = dFdx(uv);
+	vec2 dy = dFdy(uv);
+	dx.x -= round(dx.x);
+	dy.x -= round(dy.x);
+
+	if (layer >= ubo.virtualLayerCount)
+		return false;
+
+	vec2 virtualSize = vec2(float(ubo.virtualPageCountX), float(ubo.virtualPageCountX / 2u)) * PAGE_SIZE;
+	vec2 texelDx = dx * virtualSize;
+	vec2 texelDy = dy * virtualSize;
+	float lod = 0.5 * log2(max(max(dot(texelDx, texelDx), dot(texelDy, texelDy)), 1e-8)) + lodBias;
+	uint mip = uint(clamp(floor(lod + 0.5), 0.0, float(ubo.virtualMipCount - 1u)));
+
+	uint pagesX = ubo.virtualPageCountX >> mip;
+	uint pagesY = (ubo.virtualPageCountX / 2u) >> mip;
+	vec2 wrappedUV = vec2(fract(uv.x), clamp(uv.y, 0.0, 1.0));
+	uvec2 page = min(uvec2(wrappedUV * vec2(pagesX, pagesY)), uvec2(pagesX - 1u, pagesY - 1u));
+
+#ifndef NO_VIRTUAL_FEEDBACK
+	//Request the page from a quarter of the pixels, pages in all finer mips come first (a 1/4 geometric series)
+	uvec2 pixel = uvec2(gl_FragCoord.xy);
+	if (((pixel.x ^ pixel.y) & 3u) == 0u)
+	{
+		uint pagesAll = ubo.virtualPageCountX * (ubo.virtualPageCountX / 2u);
+		uint mipBase = (pagesAll - pagesX * pagesY) / 3u * 4u;
+		uint index = mipBase * ubo.virtualLayerCount + layer * pagesX * pagesY + page.y * pagesX + page.x;
+		uint bit = 1u << (index & 31u);
+		if ((requestBits[index >> 5] & bit) == 0u)
+			atomicOr(requestBits[index >> 5], bit);
+	}
+#endif
+
+	//R, G = atlas page, B = mip actually resident (the page or its nearest resident ancestor), A = valid
+	uvec4 entry = texelFetch(virtualPageTable, ivec3(page, layer), int(mip));
+	if (entry.a == 0u)
+		return false;
+
+	vec2 residentPages = vec2(float(ubo.virtualPageCountX >> entry.b), float((ubo.virtualPageCountX / 2u) >> entry.b));
+	vec2 pagePos = wrappedUV * residentPages;
+	vec2 inPage = clamp(pagePos - min(floor(pagePos), residentPages - 1.0), 0.0, 1.0);
+
+	vec2 atlasSize = vec2(textureSize(virtualAtlas, 0));
+	vec2 atlasUV = (vec2(entry.rg) * PAGE_STRIDE + PAGE_BORDER + inPage * PAGE_SIZE) / atlasSize;
+	float scale = exp2(-float(entry.b));
+	color = textureGrad(virtualAtlas, atlasUV, texelDx * scale / atlasSize, texelDy * scale / atlasSize);
+	return true;
+}
+
+void main()
+{
+	//Same equirectangular mapping as the sphere mesh (../shader.frag)
+	vec3 sphereNormal = normalize(inLocalPos);
+	vec2 uv = vec2(atan(sphereNormal.x, sphereNormal.z) / (2.0 * PI) + 0.5,
+		acos(clamp(sphereNormal.y, -1.0, 1.0)) / PI);
+
+	//The planets are unlit, only slopes are darkened so the relief reads while flat ground keeps the sphere color
+	float slope = clamp(dot(normalize(inNormal), sphereNormal), 0.0, 1.0);
+	vec4 baseColor = texture(texSampler, vec3(uv, inTextureLayer), textureLod);
+	vec4 virtualColor;
+	if (ubo.virtualTextureEnable != 0u && SampleVirtualTexture(uv, uint(inTextureLayer + 0.5), textureLod, virtualColor))
+		baseColor = virtualColor;
+
+	outColor = baseColor * vec4(vec3(mix(0.4, 1.0, slope)), 1.0);
+}
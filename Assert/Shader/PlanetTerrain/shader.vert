@@ -0,0 +1,32 @@
+#version 450
+
+//TerrainVertex in planet local space, the undisplaced sphere has radius 1
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec3 inNormal;
+
+layout (location = 0) out vec3 outLocalPos;
+layout (location = 1) out vec3 outNormal;
+layout (location = 2) flat out float outTextureLayer;
+layout (location = 3) out float textureLod;
+
+layout (binding = 0) uniform UniformBufferObject
+{
+	mat4 view;
+	mat4 proj;
+	float lod;
+} ubo;
+
+layout (push_constant) uniform PushConstant
+{
+	mat4 model;			//camera relative, same matrix as the planet instance
+	float textureLayer;
+} pc;
+
+void main()
+{
+	gl_Position = ubo.proj * ubo.view * pc.model * vec4(inPosition, 1.0);
+	outLocalPos = inPosition;
+	outNormal = inNormal;
+	outTextureLayer = pc.textureLayer;
+	textureLod = ubo.lod;
+}
@@ -2,12 +2,19 @@
 
 layout (location = 0) in vec3 inPosition;
 
-layout (binding = 0) uniform MVPUniformBufferObject
+#define SHADOW_CASCADE_MAX 4
+
+layout (binding = 0) uniform ShadowCascadeUniformBufferObject
+{
+    mat4 viewProj[SHADOW_CASCADE_MAX];
+} cascadeUBO;
+
+layout (push_constant) uniform CascadePushConstant
 {
-    mat4 mvp;
-} mvpUBO;
+    uint cascadeIndex;
+} cascadePC;
 
 void main() 
 {
-    gl_Position = mvpUBO.mvp * vec4(inPosition, 1.0);
+    gl_Position = cascadeUBO.viewProj[cascadePC.cascadeIndex] * vec4(inPosition, 1.0);
 }
\ No newline at end of file
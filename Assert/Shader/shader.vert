@@ -1,14 +1,16 @@
 #version 450
 
-layout (location = 0) in vec3 inPosition;
-layout (location = 1) in vec3 inColor;
-layout (location = 2) in vec2 inTexCoord;
-layout (location = 3) in vec2 inNormal;
+//Per instance InstanceData (binding 1, VK_VERTEX_INPUT_RATE_INSTANCE), the same layout as the Instanced pipeline
+//Rows of the model matrix, the fourth row is (0, 0, 0, 1), and the texture array layer from params.x
+//There is no per vertex buffer, the icosphere is generated from gl_VertexIndex
+layout (location = 4) in vec4 inModelRow0;
+layout (location = 5) in vec4 inModelRow1;
+layout (location = 6) in vec4 inModelRow2;
+layout (location = 7) in float inTextureLayer;
 
-layout (location = 0) out vec3 fragColor;
-layout (location = 1) out vec2 fragTexCoord;
+layout (location = 0) out vec3 outLocalPos;
+layout (location = 1) flat out float outTextureLayer;
 layout (location = 2) out float textureLod;
-layout (location = 3) out vec3 outUV;
 
 layout (binding = 0) uniform UniformBufferObject
 {
@@ -17,18 +19,61 @@ layout (binding = 0) uniform UniformBufferObject
 	float lod;
 } ubo;
 
-layout (binding = 1) uniform DynamicUniformBufferObject
+layout (push_constant) uniform PushConstant
 {
-	mat4 model;
-	float textureIndex;
-} dynamicUbo;
+	uint subdivision;	//segments per icosahedron edge, a power of two so the grid weights are exact
+} pc;
 
-layout (binding = 2) uniform sampler2DArray texSampler;
+//Unit icosahedron, faces wound counter clockwise seen from outside
+const float X = 0.525731112119133606;
+const float Z = 0.850650808352039932;
 
-void main() {
-    gl_Position = ubo.proj * ubo.view * dynamicUbo.model * vec4(inPosition, 1.0);
-    fragColor = inColor;
-	fragTexCoord = inTexCoord;
+const vec3 icoVertices[12] = vec3[](
+	vec3(-X, 0.0, Z), vec3(X, 0.0, Z), vec3(-X, 0.0, -Z), vec3(X, 0.0, -Z),
+	vec3(0.0, Z, X), vec3(0.0, Z, -X), vec3(0.0, -Z, X), vec3(0.0, -Z, -X),
+	vec3(Z, X, 0.0), vec3(-Z, X, 0.0), vec3(Z, -X, 0.0), vec3(-Z, -X, 0.0));
+
+const uvec3 icoFaces[20] = uvec3[](
+	uvec3(0, 1, 4), uvec3(0, 4, 9), uvec3(9, 4, 5), uvec3(4, 8, 5), uvec3(4, 1, 8),
+	uvec3(8, 1, 10), uvec3(8, 10, 3), uvec3(5, 8, 3), uvec3(5, 3, 2), uvec3(2, 3, 7),
+	uvec3(7, 3, 10), uvec3(7, 10, 6), uvec3(7, 6, 11), uvec3(11, 6, 0), uvec3(0, 6, 1),
+	uvec3(6, 10, 1), uvec3(9, 11, 0), uvec3(9, 2, 11), uvec3(9, 5, 2), uvec3(7, 11, 2));
+
+void main()
+{
+	uint n = pc.subdivision;
+	uint triangle = uint(gl_VertexIndex) / 3u;
+	uint corner = uint(gl_VertexIndex) % 3u;
+	uint face = triangle / (n * n);
+	uint local = triangle % (n * n);
+
+	//Row i of the triangular grid holds 2i + 1 triangles, so row i starts at triangle i^2
+	uint row = uint(sqrt(float(local)));
+	if (row * row > local)
+		--row;
+	else if ((row + 1u) * (row + 1u) <= local)
+		++row;
+	uint k = local - row * row;
+	uint column = k / 2u;
+
+	//Grid points are (row, column) with column <= row, even k is an upright triangle, odd k an inverted one
+	uvec2 upward[3] = uvec2[](uvec2(row, column), uvec2(row + 1u, column), uvec2(row + 1u, column + 1u));
+	uvec2 downward[3] = uvec2[](uvec2(row, column), uvec2(row + 1u, column + 1u), uvec2(row, column + 1u));
+	uvec2 grid = (k & 1u) == 0u ? upward[corner] : downward[corner];
+
+	//On a shared edge one weight is 0, precise keeps both faces from fusing or reordering the remaining
+	//two products differently, so the edge vertices are bit identical and the mesh stays watertight
+	uvec3 faceVertices = icoFaces[face];
+	float invN = 1.0 / float(n);
+	precise vec3 position = icoVertices[faceVertices.x] * (float(n - grid.x) * invN)
+		+ icoVertices[faceVertices.y] * (float(grid.x - grid.y) * invN)
+		+ icoVertices[faceVertices.z] * (float(grid.y) * invN);
+	position = normalize(position);
+
+	vec4 localPos = vec4(position, 1.0);
+	precise vec3 worldPos = vec3(dot(inModelRow0, localPos), dot(inModelRow1, localPos), dot(inModelRow2, localPos));
+	gl_Position = ubo.proj * ubo.view * vec4(worldPos, 1.0);
+	outLocalPos = position;
+	outTextureLayer = inTextureLayer;
 	textureLod = ubo.lod;
-	outUV = vec3(inTexCoord, dynamicUbo.textureIndex);
-}
\ No newline at end of file
+}
@@ -0,0 +1,281 @@
+#include "AsteroidBelt.h"
+
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	constexpr double PI = 3.14159265358979323846;
+	constexpr double TWO_PI = 2.0 * PI;
+
+	inline float WrapAngle(double dAngle)
+	{
+		return static_cast<float>(dAngle - TWO_PI * std::floor((dAngle + PI) / TWO_PI));
+	}
+
+	//Over-allocated so the instance pointer can be realigned to 16 bytes
+	struct AlignedInstanceBuffer
+	{
+		std::vector<char> vecStorage;
+		InstanceData* pData = nullptr;
+
+		explicit AlignedInstanceBuffer(UINT uiCount)
+		{
+			vecStorage.resize(uiCount * sizeof(InstanceData) + 16);
+			size_t uiAddress = reinterpret_cast<size_t>(vecStorage.data());
+			pData = reinterpret_cast<InstanceData*>((uiAddress + 15) & ~size_t(15));
+		}
+	};
+}
+
+void DZW_AsteroidKernel::UpdateScalar(const AsteroidBeltView& view, UINT uiBegin, UINT uiEnd, double dDays, InstanceData* pDst)
+{
+	for (UINT i = uiBegin; i < uiEnd; ++i)
+	{
+		float M = WrapAngle(view.pMeanAnomalyAtEpoch[i] + view.pMeanMotion[i] * dDays);
+		float e = view.pEccentricity[i];
+
+		//Same starter and iteration count as the SIMD kernels
+		float E = M + 0.85f * e * ((M < 0.f) ? -1.f : 1.f);
+		for (UINT uiIter = 0; uiIter < HALLEY_ITERATION; ++uiIter)
+		{
+			float fSin = std::sin(E), fCos = std::cos(E);
+			float f = E - e * fSin - M;
+			float f1 = 1.f - e * fCos;
+			E -= (2.f * f * f1) / (2.f * f1 * f1 - f * e * fSin);
+		}
+
+		float fP = std::cos(E) - e;
+		float fQ = std::sin(E);
+		float x = view.pPx[i] * fP + view.pQx[i] * fQ;
+		float y = view.pPy[i] * fP + view.pQy[i] * fQ;
+		float z = view.pPz[i] * fP + view.pQz[i] * fQ;
+
+		float fSpin = WrapAngle(view.pSpinAtEpoch[i] + view.pSpinRate[i] * dDays);
+		float fScaleCos = view.pScale[i] * std::cos(fSpin);
+		float fScaleSin = view.pScale[i] * std::sin(fSpin);
+		float fTiltCos = view.pTiltCos[i], fTiltSin = view.pTiltSin[i];
+
+		//Rows of T * Rz(-tilt) * Ry(spin) * S, the same transform OrbitSystem builds for planets
+		float* pRow = reinterpret_cast<float*>(pDst + i);
+		pRow[0] = fScaleCos * fTiltCos;
+		pRow[1] = view.pScale[i] * fTiltSin;
+		pRow[2] = fScaleSin * fTiltCos;
+		pRow[3] = x;
+		pRow[4] = -fScaleCos * fTiltSin;
+		pRow[5] = view.pScale[i] * fTiltCos;
+		pRow[6] = -fScaleSin * fTiltSin;
+		pRow[7] = y;
+		pRow[8] = -fScaleSin;
+		pRow[9] = 0.f;
+		pRow[10] = fScaleCos;
+		pRow[11] = z;
+		pDst[i].params = glm::vec4(0.f);
+	}
+}
+
+void AsteroidBelt::Generate(UINT uiCount, UINT uiSeed, float fInnerAU, float fOuterAU, float fDistanceScale)
+{
+	std::mt19937 randomEngine(uiSeed);
+	std::uniform_real_distribution<float> semiMajorAxis(fInnerAU, fOuterAU);
+	std::uniform_real_distribution<float> eccentricity(0.f, 0.35f);
+	std::uniform_real_distribution<float> inclination(0.f, 20.f);
+	std::uniform_real_distribution<float> angle(0.f, 360.f);
+	std::uniform_real_distribution<float> rotationPeriod(0.1f, 2.f);
+	std::uniform_real_distribution<float> scale(0.005f, 0.05f);
+
+	std::vector<std::vector<float>*> vecArrays = {
+		&m_vecMeanAnomalyAtEpoch, &m_vecMeanMotion, &m_vecEccentricity,
+		&m_vecPx, &m_vecPy, &m_vecPz, &m_vecQx, &m_vecQy, &m_vecQz,
+		&m_vecSpinAtEpoch, &m_vecSpinRate, &m_vecTiltCos, &m_vecTiltSin, &m_vecScale,
+	};
+	for (auto pArray : vecArrays)
+	{
+		pArray->clear();
+		pArray->reserve(uiCount);
+	}
+
+	for (UINT i = 0; i < uiCount; ++i)
+	{
+		float fA = semiMajorAxis(randomEngine);
+		float fE = eccentricity(randomEngine);
+		float fInclination = glm::radians(inclination(randomEngine));
+		float fNode = glm::radians(angle(randomEngine));
+		float fPeriapsis = glm::radians(angle(randomEngine));
+
+		float fCosI = std::cos(fInclination), fSinI = std::sin(fInclination);
+		float fCosO = std::cos(fNode), fSinO = std::sin(fNode);
+		float fCosW = std::cos(fPeriapsis), fSinW = std::sin(fPeriapsis);
+
+		//Perifocal basis in ecliptic coordinates, mapped to the scene like OrbitSystem (ecliptic = xz, north = +y)
+		glm::vec3 P = { fCosW * fCosO - fSinW * fSinO * fCosI, fCosW * fSinO + fSinW * fCosO * fCosI, fSinW * fSinI };
+		glm::vec3 Q = { -fSinW * fCosO - fCosW * fSinO * fCosI, -fSinW * fSinO + fCosW * fCosO * fCosI, fCosW * fSinI };
+		float fScaledA = fA * fDistanceScale;
+		float fScaledB = fScaledA * std::sqrt(1.f - fE * fE);
+
+		m_vecMeanAnomalyAtEpoch.push_back(glm::radians(angle(randomEngine)));
+		m_vecMeanMotion.push_back(static_cast<float>(TWO_PI / (365.25 * std::pow(fA, 1.5))));
+		m_vecEccentricity.push_back(fE);
+		m_vecPx.push_back(fScaledA * P.x);
+		m_vecPy.push_back(fScaledA * P.z);
+		m_vecPz.push_back(-fScaledA * P.y);
+		m_vecQx.push_back(fScaledB * Q.x);
+		m_vecQy.push_back(fScaledB * Q.z);
+		m_vecQz.push_back(-fScaledB * Q.y);
+
+		float fTilt = glm::radians(angle(randomEngine));
+		m_vecSpinAtEpoch.push_back(glm::radians(angle(randomEngine)));
+		m_vecSpinRate.push_back(static_cast<float>(TWO_PI / rotationPeriod(randomEngine)));
+		m_vecTiltCos.push_back(std::cos(fTilt));
+		m_vecTiltSin.push_back(std::sin(fTilt));
+		m_vecScale.push_back(scale(randomEngine));
+	}
+}
+
+AsteroidBeltView AsteroidBelt::GetView() const
+{
+	AsteroidBeltView view;
+	view.pMeanAnomalyAtEpoch = m_vecMeanAnomalyAtEpoch.data();
+	view.pMeanMotion = m_vecMeanMotion.data();
+	view.pEccentricity = m_vecEccentricity.data();
+	view.pPx = m_vecPx.data();
+	view.pPy = m_vecPy.data();
+	view.pPz = m_vecPz.data();
+	view.pQx = m_vecQx.data();
+	view.pQy = m_vecQy.data();
+	view.pQz = m_vecQz.data();
+	view.pSpinAtEpoch = m_vecSpinAtEpoch.data();
+	view.pSpinRate = m_vecSpinRate.data();
+	view.pTiltCos = m_vecTiltCos.data();
+	view.pTiltSin = m_vecTiltSin.data();
+	view.pScale = m_vecScale.data();
+	return view;
+}
+
+void AsteroidBelt::Update(double dSimulationDays, InstanceData* pDst, UINT uiCount)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	//Never run a level the CPU cannot execute, the UI may still hold a stale selection
+	auto level = static_cast<OrbitSimdLevel>(std::min(m_nSimdLevel, static_cast<int>(GetMaxSupportedSimdLevel())));
+	Update(dSimulationDays, pDst, uiCount, level);
+
+	m_fLastUpdateMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void AsteroidBelt::Update(double dSimulationDays, InstanceData* pDst, UINT uiCount, OrbitSimdLevel level) const
+{
+	ASSERT(uiCount <= GetCount(), "Asteroid count out of range");
+	ASSERT((reinterpret_cast<size_t>(pDst) & 15) == 0, "Asteroid instance data must be 16 byte aligned");
+
+	auto view = GetView();
+	switch (level)
+	{
+	case ORBIT_SIMD_AVX2:	DZW_AsteroidKernel::UpdateAVX2(view, 0, uiCount, dSimulationDays, pDst); break;
+	case ORBIT_SIMD_SSE41:	DZW_AsteroidKernel::UpdateSSE41(view, 0, uiCount, dSimulationDays, pDst); break;
+	default:				DZW_AsteroidKernel::UpdateScalar(view, 0, uiCount, dSimulationDays, pDst); break;
+	}
+}
+
+OrbitSimdLevel AsteroidBelt::GetMaxSupportedSimdLevel()
+{
+	static OrbitSimdLevel s_MaxLevel = []()
+		{
+#if defined(_MSC_VER)
+			int aryInfo[4];
+			__cpuid(aryInfo, 1);
+			bool bSSE41 = (aryInfo[2] & (1 << 19)) != 0;
+			bool bFMA = (aryInfo[2] & (1 << 12)) != 0;
+			bool bOSXSave = (aryInfo[2] & (1 << 27)) != 0;
+			bool bAVX = (aryInfo[2] & (1 << 28)) != 0;
+
+			//The OS must save the YMM registers on context switch
+			bool bYMMEnabled = bOSXSave && bAVX && ((_xgetbv(0) & 0x6) == 0x6);
+
+			__cpuidex(aryInfo, 7, 0);
+			bool bAVX2 = (aryInfo[1] & (1 << 5)) != 0;
+#else
+			bool bSSE41 = __builtin_cpu_supports("sse4.1");
+			bool bFMA = __builtin_cpu_supports("fma");
+			bool bYMMEnabled = __builtin_cpu_supports("avx");
+			bool bAVX2 = __builtin_cpu_supports("avx2");
+#endif
+			if (bYMMEnabled && bAVX2 && bFMA)
+				return ORBIT_SIMD_AVX2;
+			if (bSSE41)
+				return ORBIT_SIMD_SSE41;
+			return ORBIT_SIMD_SCALAR;
+		}();
+
+	return s_MaxLevel;
+}
+
+const char* AsteroidBelt::GetSimdLevelName(OrbitSimdLevel level)
+{
+	switch (level)
+	{
+	case ORBIT_SIMD_SCALAR:	return "Scalar";
+	case ORBIT_SIMD_SSE41:	return "SSE4.1";
+	case ORBIT_SIMD_AVX2:	return "AVX2";
+	default:				return "Unknown";
+	}
+}
+
+std::vector<AsteroidBelt::BenchmarkResult> AsteroidBelt::RunBenchmark(const std::vector<UINT>& vecBodyCount, UINT uiUpdateCount)
+{
+	std::vector<BenchmarkResult> vecResult;
+
+	for (auto uiBodyCount : vecBodyCount)
+	{
+		AsteroidBelt belt;
+		belt.Generate(uiBodyCount);
+
+		//A day offset far from the epoch exercises the double precision phase reduction
+		constexpr double dDays = 36525.0 + 0.37;
+
+		AlignedInstanceBuffer reference(uiBodyCount);
+		belt.Update(dDays, reference.pData, uiBodyCount, ORBIT_SIMD_SCALAR);
+
+		AlignedInstanceBuffer output(uiBodyCount);
+		for (int nLevel = ORBIT_SIMD_SCALAR; nLevel <= GetMaxSupportedSimdLevel(); ++nLevel)
+		{
+			auto level = static_cast<OrbitSimdLevel>(nLevel);
+
+			belt.Update(dDays, output.pData, uiBodyCount, level);
+
+			auto startTime = std::chrono::high_resolution_clock::now();
+			for (UINT i = 0; i < uiUpdateCount; ++i)
+			{
+				belt.Update(dDays + i / 60.0, output.pData, uiBodyCount, level);
+			}
+			float fTotalMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			belt.Update(dDays, output.pData, uiBodyCount, level);
+			float fMaxError = 0.f;
+			for (UINT i = 0; i < uiBodyCount; ++i)
+			{
+				fMaxError = std::max(fMaxError, std::abs(output.pData[i].row0.w - reference.pData[i].row0.w));
+				fMaxError = std::max(fMaxError, std::abs(output.pData[i].row1.w - reference.pData[i].row1.w));
+				fMaxError = std::max(fMaxError, std::abs(output.pData[i].row2.w - reference.pData[i].row2.w));
+			}
+
+			BenchmarkResult result;
+			result.level = level;
+			result.uiBodyCount = uiBodyCount;
+			result.fMsPerUpdate = fTotalMs / uiUpdateCount;
+			result.fBodiesPerMs = (result.fMsPerUpdate > 0.f) ? uiBodyCount / result.fMsPerUpdate : 0.f;
+			result.fMaxError = fMaxError;
+			vecResult.push_back(result);
+
+			Log::Info("Asteroid benchmark {} bodies, {}: {:.3f} ms/update, {:.0f} bodies/ms, max error {:.2e}",
+				uiBodyCount, GetSimdLevelName(level), result.fMsPerUpdate, result.fBodiesPerMs, result.fMaxError);
+		}
+	}
+
+	return vecResult;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "Core.h"
+
+#include "glm/glm.hpp"
+
+enum OrbitSimdLevel
+{
+	ORBIT_SIMD_SCALAR = 0,
+	ORBIT_SIMD_SSE41,
+	ORBIT_SIMD_AVX2,				//AVX2 + FMA
+	ORBIT_SIMD_LEVEL_COUNT,
+};
+
+//Per instance data shared by every instanced draw (asteroids and planets)
+//First three rows of the model matrix (the fourth is 0,0,0,1) plus a params vec4, one 64 byte cache line
+struct alignas(16) InstanceData
+{
+	glm::vec4 row0;
+	glm::vec4 row1;
+	glm::vec4 row2;
+	glm::vec4 params; //x: texture array layer, asteroids leave it 0
+};
+
+//SoA arrays consumed by the batch kernels, every pointer covers the whole belt
+struct AsteroidBeltView
+{
+	const float* pMeanAnomalyAtEpoch;	//radians
+	const float* pMeanMotion;			//radians per day
+	const float* pEccentricity;
+	const float* pPx, * pPy, * pPz;		//perifocal basis in scene space premultiplied by a
+	const float* pQx, * pQy, * pQz;		//premultiplied by b
+	const float* pSpinAtEpoch;			//radians
+	const float* pSpinRate;				//radians per day
+	const float* pTiltCos, * pTiltSin;
+	const float* pScale;
+};
+
+//One kernel per ISA, each TU is compiled with the matching instruction set (see premake5.lua)
+//pDst is indexed with the body index and must be 16 byte aligned, the SIMD kernels use streaming stores
+namespace DZW_AsteroidKernel
+{
+	constexpr UINT HALLEY_ITERATION = 4;
+
+	void UpdateScalar(const AsteroidBeltView& view, UINT uiBegin, UINT uiEnd, double dDays, InstanceData* pDst);
+	void UpdateSSE41(const AsteroidBeltView& view, UINT uiBegin, UINT uiEnd, double dDays, InstanceData* pDst);
+	void UpdateAVX2(const AsteroidBeltView& view, UINT uiBegin, UINT uiEnd, double dDays, InstanceData* pDst);
+}
+
+//Minor bodies around the sun, the only minor body propagator: kept apart from OrbitSystem so that the
+//hot loop is a float batch kernel (or AsteroidBeltCompute) without parents or per body bookkeeping
+class AsteroidBelt
+{
+public:
+	struct BenchmarkResult
+	{
+		OrbitSimdLevel level;
+		UINT uiBodyCount;
+		float fMsPerUpdate;
+		float fBodiesPerMs;
+		float fMaxError;				//max position difference to the scalar kernel, scene units
+	};
+
+public:
+	void Generate(UINT uiCount, UINT uiSeed = 20240501, float fInnerAU = 2.1f, float fOuterAU = 3.3f, float fDistanceScale = 100.f);
+
+	//Writes the first uiCount bodies to pDst with the selected SIMD level
+	void Update(double dSimulationDays, InstanceData* pDst, UINT uiCount);
+	void Update(double dSimulationDays, InstanceData* pDst, UINT uiCount, OrbitSimdLevel level) const;
+
+	UINT GetCount() const { return static_cast<UINT>(m_vecEccentricity.size()); }
+	int* GetSimdLevel() { return &m_nSimdLevel; }
+	float GetLastUpdateMs() const { return m_fLastUpdateMs; }
+
+	static OrbitSimdLevel GetMaxSupportedSimdLevel();
+	static const char* GetSimdLevelName(OrbitSimdLevel level);
+
+	//Runs every supported ISA level on belts of each size, logs bodies/ms and the error to the scalar kernel
+	static std::vector<BenchmarkResult> RunBenchmark(const std::vector<UINT>& vecBodyCount, UINT uiUpdateCount = 16);
+
+	//Also read by AsteroidBeltCompute to pack the element SSBO
+	AsteroidBeltView GetView() const;
+
+private:
+	int m_nSimdLevel = GetMaxSupportedSimdLevel();
+	float m_fLastUpdateMs = 0.f;
+
+	std::vector<float> m_vecMeanAnomalyAtEpoch;
+	std::vector<float> m_vecMeanMotion;
+	std::vector<float> m_vecEccentricity;
+	std::vector<float> m_vecPx, m_vecPy, m_vecPz;
+	std::vector<float> m_vecQx, m_vecQy, m_vecQz;
+	std::vector<float> m_vecSpinAtEpoch;
+	std::vector<float> m_vecSpinRate;
+	std::vector<float> m_vecTiltCos, m_vecTiltSin;
+	std::vector<float> m_vecScale;
+};
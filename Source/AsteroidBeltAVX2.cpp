@@ -0,0 +1,87 @@
+#include "AsteroidBeltKernel.h"
+
+#include <immintrin.h>
+
+//Built with /arch:AVX2 (premake5.lua), only called after AsteroidBelt::GetMaxSupportedSimdLevel() reports AVX2 + FMA
+namespace
+{
+	struct SimdAVX2
+	{
+		static constexpr UINT WIDTH = 8;
+		using F = __m256;
+		using I = __m256i;
+
+		static F Load(const float* p) { return _mm256_loadu_ps(p); }
+		static F Set1(float f) { return _mm256_set1_ps(f); }
+		static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm256_div_ps(a, b); }
+		static F MulAdd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+		static F And(F a, F b) { return _mm256_and_ps(a, b); }
+		static F Or(F a, F b) { return _mm256_or_ps(a, b); }
+		static F Xor(F a, F b) { return _mm256_xor_ps(a, b); }
+		static F Select(F mask, F a, F b) { return _mm256_blendv_ps(b, a, mask); }
+		static F Round(F a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static I ToInt(F a) { return _mm256_cvtps_epi32(a); }
+		static F IntBitMask(I a, int nBit)
+		{
+			I bit = _mm256_set1_epi32(nBit);
+			return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(a, bit), bit));
+		}
+
+		//base + rate * days reduced to [-pi, pi] in double, four lanes at a time
+		static F WrapPhase(const float* pBase, const float* pRate, double dDays)
+		{
+			const __m256d days = _mm256_set1_pd(dDays);
+			const __m256d pi = _mm256_set1_pd(3.14159265358979323846);
+			const __m256d twoPi = _mm256_set1_pd(6.28318530717958647692);
+			const __m256d invTwoPi = _mm256_set1_pd(0.15915494309189533577);
+
+			__m256d lo = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(pRate)), days, _mm256_cvtps_pd(_mm_loadu_ps(pBase)));
+			__m256d hi = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(pRate + 4)), days, _mm256_cvtps_pd(_mm_loadu_ps(pBase + 4)));
+			lo = _mm256_fnmadd_pd(twoPi, _mm256_floor_pd(_mm256_mul_pd(_mm256_add_pd(lo, pi), invTwoPi)), lo);
+			hi = _mm256_fnmadd_pd(twoPi, _mm256_floor_pd(_mm256_mul_pd(_mm256_add_pd(hi, pi), invTwoPi)), hi);
+
+			return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+		}
+
+		//SoA -> AoS, each 128 bit half is a 4x4 transpose per matrix row, streamed into the mapped buffer
+		static void StoreInstances(const F* pElement, InstanceData* pDst)
+		{
+			float* pFloat = reinterpret_cast<float*>(pDst);
+			for (UINT uiRow = 0; uiRow < 3; ++uiRow)
+			{
+				const F* pRow = pElement + uiRow * 4;
+
+				__m128 a = _mm256_castps256_ps128(pRow[0]), b = _mm256_castps256_ps128(pRow[1]);
+				__m128 c = _mm256_castps256_ps128(pRow[2]), d = _mm256_castps256_ps128(pRow[3]);
+				_MM_TRANSPOSE4_PS(a, b, c, d);
+				_mm_stream_ps(pFloat + 0 * 16 + uiRow * 4, a);
+				_mm_stream_ps(pFloat + 1 * 16 + uiRow * 4, b);
+				_mm_stream_ps(pFloat + 2 * 16 + uiRow * 4, c);
+				_mm_stream_ps(pFloat + 3 * 16 + uiRow * 4, d);
+
+				a = _mm256_extractf128_ps(pRow[0], 1), b = _mm256_extractf128_ps(pRow[1], 1);
+				c = _mm256_extractf128_ps(pRow[2], 1), d = _mm256_extractf128_ps(pRow[3], 1);
+				_MM_TRANSPOSE4_PS(a, b, c, d);
+				_mm_stream_ps(pFloat + 4 * 16 + uiRow * 4, a);
+				_mm_stream_ps(pFloat + 5 * 16 + uiRow * 4, b);
+				_mm_stream_ps(pFloat + 6 * 16 + uiRow * 4, c);
+				_mm_stream_ps(pFloat + 7 * 16 + uiRow * 4, d);
+			}
+
+			//params is streamed as well, a partially written line would defeat the non temporal stores
+			__m128 zero = _mm_setzero_ps();
+			for (UINT k = 0; k < 8; ++k)
+				_mm_stream_ps(pFloat + k * 16 + 12, zero);
+		}
+
+		static void Fence() { _mm_sfence(); }
+	};
+}
+
+void DZW_AsteroidKernel::UpdateAVX2(const AsteroidBeltView& view, UINT uiBegin, UINT uiEnd, double dDays, InstanceData* pDst)
+{
+	UpdateBatch<SimdAVX2>(view, uiBegin, uiEnd, dDays, pDst);
+}
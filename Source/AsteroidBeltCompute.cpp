@@ -0,0 +1,552 @@
+#include "AsteroidBeltCompute.h"
+#include "EmbeddedShader.h"
+#include "Frustum.h"
+#include "VulkanUtils.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+	UINT FindMemoryTypeIndex(VkPhysicalDevice physicalDevice, UINT typeFilter, VkMemoryPropertyFlags properties)
+	{
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+		for (UINT i = 0; i < memoryProperties.memoryTypeCount; ++i)
+		{
+			if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+				return i;
+		}
+
+		ASSERT(false, "Find no suitable memory type for asteroid compute buffer");
+		return 0;
+	}
+}
+
+void AsteroidBeltCompute::Init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, UINT uiQueueFamilyIdx,
+	const AsteroidBelt& belt, UINT uiIndexCount, float fBoundingRadius)
+{
+	ASSERT(belt.GetCount() > 0, "Asteroid belt must be generated before the compute path is initialized");
+
+	m_PhysicalDevice = physicalDevice;
+	m_Device = device;
+	m_Queue = queue;
+	m_uiCapacity = belt.GetCount();
+	m_uiIndexCount = uiIndexCount;
+	m_fBoundingRadius = fBoundingRadius;
+	m_dEpochDays = 0.0;
+
+	VkCommandPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolCreateInfo.queueFamilyIndex = uiQueueFamilyIdx;
+	VULKAN_ASSERT(vkCreateCommandPool(m_Device, &poolCreateInfo, nullptr, &m_CommandPool), "Create asteroid compute command pool failed");
+
+	//Everything stays device local, only the initial element upload goes through a staging buffer
+	CreateBuffer(sizeof(GPUElement) * m_uiCapacity,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_ElementBuffer, m_ElementBufferMemory);
+	CreateBuffer(sizeof(InstanceData) * m_uiCapacity,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_InstanceBuffer, m_InstanceBufferMemory);
+	CreateBuffer(sizeof(VkDrawIndexedIndirectCommand),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndirectBuffer, m_IndirectBufferMemory);
+
+	UploadElements(belt);
+
+	CreateDescriptorSetLayout();
+	CreateDescriptorPool();
+	CreateDescriptorSet();
+	CreatePipelineLayout();
+}
+
+void AsteroidBeltCompute::Destroy()
+{
+	if (m_Device == VK_NULL_HANDLE)
+		return;
+
+	vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
+	vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+	vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_Device, m_DescriptorSetLayout, nullptr);
+	for (const auto& shaderModule : m_mapShaderModule)
+	{
+		vkDestroyShaderModule(m_Device, shaderModule.second, nullptr);
+	}
+	m_mapShaderModule.clear();
+
+	DestroyBuffer(m_ElementBuffer, m_ElementBufferMemory);
+	DestroyBuffer(m_InstanceBuffer, m_InstanceBufferMemory);
+	DestroyBuffer(m_IndirectBuffer, m_IndirectBufferMemory);
+
+	vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
+
+	m_Pipeline = VK_NULL_HANDLE;
+	m_PipelineLayout = VK_NULL_HANDLE;
+	m_DescriptorPool = VK_NULL_HANDLE;
+	m_DescriptorSetLayout = VK_NULL_HANDLE;
+	m_DescriptorSet = VK_NULL_HANDLE;
+	m_CommandPool = VK_NULL_HANDLE;
+	m_Device = VK_NULL_HANDLE;
+}
+
+void AsteroidBeltCompute::CreateBuffer(VkDeviceSize deviceSize, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+{
+	VkBufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size = deviceSize;
+	bufferCreateInfo.usage = usageFlags;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	VULKAN_ASSERT(vkCreateBuffer(m_Device, &bufferCreateInfo, nullptr, &buffer), "Create asteroid compute buffer failed");
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(m_Device, buffer, &memoryRequirements);
+
+	VkMemoryAllocateInfo memoryAllocInfo{};
+	memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocInfo.allocationSize = memoryRequirements.size;
+	memoryAllocInfo.memoryTypeIndex = FindMemoryTypeIndex(m_PhysicalDevice, memoryRequirements.memoryTypeBits, propertyFlags);
+	VULKAN_ASSERT(vkAllocateMemory(m_Device, &memoryAllocInfo, nullptr, &bufferMemory), "Allocate asteroid compute buffer memory failed");
+
+	vkBindBufferMemory(m_Device, buffer, bufferMemory, 0);
+}
+
+void AsteroidBeltCompute::DestroyBuffer(VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+{
+	vkDestroyBuffer(m_Device, buffer, nullptr);
+	vkFreeMemory(m_Device, bufferMemory, nullptr);
+	buffer = VK_NULL_HANDLE;
+	bufferMemory = VK_NULL_HANDLE;
+}
+
+VkCommandBuffer AsteroidBeltCompute::BeginSingleTimeCommand()
+{
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = m_CommandPool;
+	allocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer;
+	VULKAN_ASSERT(vkAllocateCommandBuffers(m_Device, &allocInfo, &commandBuffer), "Allocate asteroid compute command buffer failed");
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	return commandBuffer;
+}
+
+void AsteroidBeltCompute::EndSingleTimeCommand(VkCommandBuffer commandBuffer)
+{
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	vkQueueSubmit(m_Queue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(m_Queue);
+
+	vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &commandBuffer);
+}
+
+void AsteroidBeltCompute::UploadElements(const AsteroidBelt& belt)
+{
+	VkDeviceSize bufferSize = sizeof(GPUElement) * m_uiCapacity;
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		stagingBuffer, stagingBufferMemory);
+
+	void* pMapped = nullptr;
+	VULKAN_ASSERT(vkMapMemory(m_Device, stagingBufferMemory, 0, bufferSize, 0, &pMapped), "Map asteroid element staging buffer failed");
+
+	//SoA on the CPU, one 64 byte record per body on the GPU so each invocation reads four vec4
+	auto view = belt.GetView();
+	auto pElement = static_cast<GPUElement*>(pMapped);
+	for (UINT i = 0; i < m_uiCapacity; ++i)
+	{
+		pElement[i].orbit = { view.pMeanAnomalyAtEpoch[i], view.pMeanMotion[i], view.pEccentricity[i], view.pScale[i] };
+		pElement[i].P = { view.pPx[i], view.pPy[i], view.pPz[i], view.pSpinAtEpoch[i] };
+		pElement[i].Q = { view.pQx[i], view.pQy[i], view.pQz[i], view.pSpinRate[i] };
+		pElement[i].tilt = { view.pTiltCos[i], view.pTiltSin[i], 0.f, 0.f };
+	}
+	vkUnmapMemory(m_Device, stagingBufferMemory);
+
+	VkCommandBuffer commandBuffer = BeginSingleTimeCommand();
+	VkBufferCopy copyRegion{};
+	copyRegion.size = bufferSize;
+	vkCmdCopyBuffer(commandBuffer, stagingBuffer, m_ElementBuffer, 1, &copyRegion);
+	EndSingleTimeCommand(commandBuffer);
+
+	DestroyBuffer(stagingBuffer, stagingBufferMemory);
+}
+
+void AsteroidBeltCompute::CreateDescriptorSetLayout()
+{
+	//0: elements (read, written back on rebase)  1: instances  2: indirect draw args
+	std::array<VkDescriptorSetLayoutBinding, 3> aryBinding{};
+	for (UINT i = 0; i < static_cast<UINT>(aryBinding.size()); ++i)
+	{
+		aryBinding[i].binding = i;
+		aryBinding[i].descriptorCount = 1;
+		aryBinding[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		aryBinding[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = static_cast<UINT>(aryBinding.size());
+	createInfo.pBindings = aryBinding.data();
+
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_Device, &createInfo, nullptr, &m_DescriptorSetLayout), "Create asteroid compute descriptor set layout failed");
+}
+
+void AsteroidBeltCompute::CreateDescriptorPool()
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 3;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.poolSizeCount = 1;
+	poolCreateInfo.pPoolSizes = &poolSize;
+	poolCreateInfo.maxSets = 1;
+
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_Device, &poolCreateInfo, nullptr, &m_DescriptorPool), "Create asteroid compute descriptor pool failed");
+}
+
+void AsteroidBeltCompute::CreateDescriptorSet()
+{
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_DescriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_DescriptorSetLayout;
+
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_Device, &allocInfo, &m_DescriptorSet), "Allocate asteroid compute descriptor set failed");
+
+	std::array<VkDescriptorBufferInfo, 3> aryBufferInfo{};
+	aryBufferInfo[0].buffer = m_ElementBuffer;
+	aryBufferInfo[1].buffer = m_InstanceBuffer;
+	aryBufferInfo[2].buffer = m_IndirectBuffer;
+
+	std::array<VkWriteDescriptorSet, 3> aryWrite{};
+	for (UINT i = 0; i < static_cast<UINT>(aryWrite.size()); ++i)
+	{
+		aryBufferInfo[i].offset = 0;
+		aryBufferInfo[i].range = VK_WHOLE_SIZE;
+
+		aryWrite[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		aryWrite[i].dstSet = m_DescriptorSet;
+		aryWrite[i].dstBinding = i;
+		aryWrite[i].dstArrayElement = 0;
+		aryWrite[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		aryWrite[i].descriptorCount = 1;
+		aryWrite[i].pBufferInfo = &aryBufferInfo[i];
+	}
+
+	vkUpdateDescriptorSets(m_Device, static_cast<UINT>(aryWrite.size()), aryWrite.data(), 0, nullptr);
+}
+
+void AsteroidBeltCompute::CreatePipelineLayout()
+{
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PushConstant);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_DescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, nullptr, &m_PipelineLayout), "Create asteroid compute pipeline layout failed");
+}
+
+void AsteroidBeltCompute::CreatePipeline()
+{
+	VkPipelineShaderStageCreateInfo stageCreateInfo{};
+	stageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stageCreateInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	stageCreateInfo.module = m_mapShaderModule.at(VK_SHADER_STAGE_COMPUTE_BIT);
+	stageCreateInfo.pName = "main";
+
+	VkComputePipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stage = stageCreateInfo;
+	pipelineCreateInfo.layout = m_PipelineLayout;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
+
+	VULKAN_ASSERT(vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_Pipeline), "Create asteroid compute pipeline failed");
+}
+
+void AsteroidBeltCompute::RecordDispatch(VkCommandBuffer commandBuffer, double dSimulationDays, UINT uiDrawCount, const glm::mat4* pViewProj)
+{
+	ASSERT(uiDrawCount <= m_uiCapacity, "Asteroid draw count out of range");
+
+	PushConstant pushConstant{};
+	double dDays = dSimulationDays - m_dEpochDays;
+	if (std::abs(dDays) > REBASE_DAYS)
+	{
+		//Every body has to be rebased together, so this dispatch covers the whole capacity
+		pushConstant.uiFlags |= DISPATCH_FLAG_REBASE;
+		m_dEpochDays = dSimulationDays;
+	}
+	pushConstant.fDays = static_cast<float>(dDays);
+	pushConstant.uiDrawCount = uiDrawCount;
+	pushConstant.fBoundingRadius = m_fBoundingRadius;
+	if (pViewProj)
+	{
+		pushConstant.uiFlags |= DISPATCH_FLAG_CULL;
+		DZW_Frustum::ExtractFrustumPlanes(*pViewProj, pushConstant.aryFrustumPlane);
+	}
+
+	//WAR against the previous draw reading the args / instances, RAW against the previous rebase
+	VkMemoryBarrier beginBarrier{};
+	beginBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	beginBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	beginBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &beginBarrier, 0, nullptr, 0, nullptr);
+
+	//Culling appends with atomicAdd, without culling every body keeps its slot and the count is known
+	VkDrawIndexedIndirectCommand drawCommand{};
+	drawCommand.indexCount = m_uiIndexCount;
+	drawCommand.instanceCount = (pushConstant.uiFlags & DISPATCH_FLAG_CULL) ? 0 : uiDrawCount;
+	vkCmdUpdateBuffer(commandBuffer, m_IndirectBuffer, 0, sizeof(drawCommand), &drawCommand);
+
+	VkMemoryBarrier resetBarrier{};
+	resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+	UINT uiDispatchCount = (pushConstant.uiFlags & DISPATCH_FLAG_REBASE) ? m_uiCapacity : uiDrawCount;
+	if (uiDispatchCount > 0)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstant), &pushConstant);
+		vkCmdDispatch(commandBuffer, (uiDispatchCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+	}
+
+	VkMemoryBarrier endBarrier{};
+	endBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	endBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	endBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 1, &endBarrier, 0, nullptr, 0, nullptr);
+}
+
+std::vector<AsteroidBeltCompute::BenchmarkResult> AsteroidBeltCompute::RunHeadlessBenchmark(const std::vector<UINT>& vecBodyCount, UINT uiUpdateCount)
+{
+	std::vector<BenchmarkResult> vecResult;
+
+	auto pEmbedded = DZW_EmbeddedShader::FindEmbeddedSpirv("AsteroidCompute", VK_SHADER_STAGE_COMPUTE_BIT);
+	ASSERT(pEmbedded, "No embedded spirv for shader AsteroidCompute");
+
+	VkApplicationInfo appInfo{};
+	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	appInfo.pApplicationName = "Asteroid Compute Benchmark";
+	appInfo.apiVersion = VK_API_VERSION_1_0;
+
+	//No surface or swap chain extension, the benchmark never presents
+	VkInstanceCreateInfo instanceCreateInfo{};
+	instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceCreateInfo.pApplicationInfo = &appInfo;
+
+	VkInstance instance;
+	if (vkCreateInstance(&instanceCreateInfo, nullptr, &instance) != VK_SUCCESS)
+	{
+		Log::Error("Asteroid compute benchmark: create instance failed");
+		return vecResult;
+	}
+
+	UINT uiPhysicalDeviceCount = 0;
+	vkEnumeratePhysicalDevices(instance, &uiPhysicalDeviceCount, nullptr);
+	std::vector<VkPhysicalDevice> vecPhysicalDevice(uiPhysicalDeviceCount);
+	vkEnumeratePhysicalDevices(instance, &uiPhysicalDeviceCount, vecPhysicalDevice.data());
+
+	for (auto physicalDevice : vecPhysicalDevice)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		UINT uiQueueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &uiQueueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> vecQueueFamily(uiQueueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &uiQueueFamilyCount, vecQueueFamily.data());
+
+		std::optional<UINT> computeFamilyIdx;
+		for (UINT i = 0; i < uiQueueFamilyCount; ++i)
+		{
+			if (vecQueueFamily[i].queueFlags & VK_QUEUE_COMPUTE_BIT)
+			{
+				computeFamilyIdx = i;
+				break;
+			}
+		}
+		if (!computeFamilyIdx.has_value())
+		{
+			Log::Warn("Asteroid compute benchmark: {} has no compute queue", properties.deviceName);
+			continue;
+		}
+
+		float fQueuePriority = 1.f;
+		VkDeviceQueueCreateInfo queueCreateInfo{};
+		queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queueCreateInfo.queueFamilyIndex = computeFamilyIdx.value();
+		queueCreateInfo.queueCount = 1;
+		queueCreateInfo.pQueuePriorities = &fQueuePriority;
+
+		VkDeviceCreateInfo deviceCreateInfo{};
+		deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		deviceCreateInfo.queueCreateInfoCount = 1;
+		deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+
+		VkDevice device;
+		if (vkCreateDevice(physicalDevice, &deviceCreateInfo, nullptr, &device) != VK_SUCCESS)
+		{
+			Log::Warn("Asteroid compute benchmark: create device on {} failed", properties.deviceName);
+			continue;
+		}
+
+		VkQueue queue;
+		vkGetDeviceQueue(device, computeFamilyIdx.value(), 0, &queue);
+
+		//Timestamps measure the dispatches only, otherwise fall back to the wall clock around submit + wait
+		VkQueryPool queryPool = VK_NULL_HANDLE;
+		if (vecQueueFamily[computeFamilyIdx.value()].timestampValidBits > 0)
+		{
+			VkQueryPoolCreateInfo queryPoolCreateInfo{};
+			queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolCreateInfo.queryCount = 2;
+			VULKAN_ASSERT(vkCreateQueryPool(device, &queryPoolCreateInfo, nullptr, &queryPool), "Create asteroid benchmark query pool failed");
+		}
+
+		for (auto uiBodyCount : vecBodyCount)
+		{
+			AsteroidBelt belt;
+			belt.Generate(uiBodyCount);
+
+			AsteroidBeltCompute compute;
+			compute.Init(physicalDevice, device, queue, computeFamilyIdx.value(), belt, 0, 1.f);
+			compute.SetShaderModule(DZW_VulkanUtils::CreateShaderModule(device, pEmbedded->spirv));
+			compute.CreatePipeline();
+
+			//Stays inside REBASE_DAYS, like a running frame loop the kernel sees small float offsets
+			constexpr double dDays = 10.37;
+
+			//Warm up, the first dispatch pays for pipeline and memory first touch costs
+			VkCommandBuffer commandBuffer = compute.BeginSingleTimeCommand();
+			compute.RecordDispatch(commandBuffer, dDays, uiBodyCount, nullptr);
+			compute.EndSingleTimeCommand(commandBuffer);
+
+			auto startTime = std::chrono::high_resolution_clock::now();
+			commandBuffer = compute.BeginSingleTimeCommand();
+			if (queryPool != VK_NULL_HANDLE)
+			{
+				vkCmdResetQueryPool(commandBuffer, queryPool, 0, 2);
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+			}
+			for (UINT i = 0; i < uiUpdateCount; ++i)
+			{
+				compute.RecordDispatch(commandBuffer, dDays + i / 60.0, uiBodyCount, nullptr);
+			}
+			if (queryPool != VK_NULL_HANDLE)
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+			compute.EndSingleTimeCommand(commandBuffer);
+			float fTotalMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			bool bGPUTimestamp = false;
+			if (queryPool != VK_NULL_HANDLE)
+			{
+				std::array<UINT64, 2> aryTimestamp{};
+				if (vkGetQueryPoolResults(device, queryPool, 0, 2, sizeof(aryTimestamp), aryTimestamp.data(), sizeof(UINT64),
+					VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS)
+				{
+					fTotalMs = static_cast<float>(aryTimestamp[1] - aryTimestamp[0]) * properties.limits.timestampPeriod / 1000000.f;
+					bGPUTimestamp = true;
+				}
+			}
+
+			//Read the last state back and compare the translations with the scalar CPU kernel
+			double dFinalDays = dDays + (uiUpdateCount - 1) / 60.0;
+			VkDeviceSize instanceSize = sizeof(InstanceData) * uiBodyCount;
+			VkBuffer readbackBuffer;
+			VkDeviceMemory readbackBufferMemory;
+			compute.CreateBuffer(instanceSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				readbackBuffer, readbackBufferMemory);
+
+			commandBuffer = compute.BeginSingleTimeCommand();
+			compute.RecordDispatch(commandBuffer, dFinalDays, uiBodyCount, nullptr);
+			VkBufferCopy copyRegion{};
+			copyRegion.size = instanceSize;
+			vkCmdCopyBuffer(commandBuffer, compute.m_InstanceBuffer, readbackBuffer, 1, &copyRegion);
+			VkMemoryBarrier hostBarrier{};
+			hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+				0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+			compute.EndSingleTimeCommand(commandBuffer);
+
+			std::vector<InstanceData> vecReference(uiBodyCount);
+			belt.Update(dFinalDays, vecReference.data(), uiBodyCount, ORBIT_SIMD_SCALAR);
+
+			void* pMapped = nullptr;
+			VULKAN_ASSERT(vkMapMemory(device, readbackBufferMemory, 0, instanceSize, 0, &pMapped), "Map asteroid readback buffer failed");
+			auto pInstance = static_cast<const InstanceData*>(pMapped);
+			float fMaxError = 0.f;
+			for (UINT i = 0; i < uiBodyCount; ++i)
+			{
+				fMaxError = std::max(fMaxError, std::abs(pInstance[i].row0.w - vecReference[i].row0.w));
+				fMaxError = std::max(fMaxError, std::abs(pInstance[i].row1.w - vecReference[i].row1.w));
+				fMaxError = std::max(fMaxError, std::abs(pInstance[i].row2.w - vecReference[i].row2.w));
+			}
+			vkUnmapMemory(device, readbackBufferMemory);
+			compute.DestroyBuffer(readbackBuffer, readbackBufferMemory);
+
+			compute.Destroy();
+
+			BenchmarkResult result;
+			result.strDeviceName = properties.deviceName;
+			result.uiBodyCount = uiBodyCount;
+			result.fMsPerUpdate = fTotalMs / uiUpdateCount;
+			result.fBodiesPerMs = (result.fMsPerUpdate > 0.f) ? uiBodyCount / result.fMsPerUpdate : 0.f;
+			result.fMaxError = fMaxError;
+			result.bGPUTimestamp = bGPUTimestamp;
+			vecResult.push_back(result);
+
+			Log::Info("Asteroid GPU benchmark {} bodies on {}: {:.3f} ms/update ({}), {:.0f} bodies/ms, max error {:.2e}",
+				uiBodyCount, result.strDeviceName, result.fMsPerUpdate, bGPUTimestamp ? "timestamp" : "wall clock",
+				result.fBodiesPerMs, result.fMaxError);
+		}
+
+		if (queryPool != VK_NULL_HANDLE)
+			vkDestroyQueryPool(device, queryPool, nullptr);
+		vkDestroyDevice(device, nullptr);
+	}
+
+	vkDestroyInstance(instance, nullptr);
+
+	return vecResult;
+}
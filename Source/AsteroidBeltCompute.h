@@ -0,0 +1,122 @@
+#pragma once
+#include "vulkan/vulkan.h"
+
+#include "Core.h"
+#include "AsteroidBelt.h"
+
+//GPU path beside the CPU kernels: the orbital elements live in an SSBO, a compute shader solves
+//Kepler's equation for every body, culls it against the view frustum and appends the visible
+//transforms to the instance buffer together with the indirect draw args, so the CPU never
+//touches per asteroid data after Init
+//Only needs a device and a compute capable queue, the headless benchmark runs it without a surface
+class AsteroidBeltCompute
+{
+public:
+	//std430 record per body, mirrors Element in Assert/Shader/AsteroidCompute/shader.comp
+	struct GPUElement
+	{
+		glm::vec4 orbit;				//mean anomaly at epoch, mean motion (rad/day), eccentricity, scale
+		glm::vec4 P;					//perifocal P premultiplied by a, spin at epoch
+		glm::vec4 Q;					//perifocal Q premultiplied by b, spin rate (rad/day)
+		glm::vec4 tilt;					//cos, sin, unused, unused
+	};
+
+	enum DispatchFlag : UINT
+	{
+		DISPATCH_FLAG_REBASE = 1 << 0,
+		DISPATCH_FLAG_CULL = 1 << 1,
+	};
+
+	struct PushConstant
+	{
+		float fDays;					//simulation days since the element epoch
+		UINT uiDrawCount;
+		UINT uiFlags;
+		float fBoundingRadius;			//model space radius of the mesh, scaled per body
+		glm::vec4 aryFrustumPlane[6];
+	};
+
+	struct BenchmarkResult
+	{
+		std::string strDeviceName;
+		UINT uiBodyCount;
+		float fMsPerUpdate;
+		float fBodiesPerMs;
+		float fMaxError;				//max position difference to the scalar CPU kernel, scene units
+		bool bGPUTimestamp;				//false: wall clock around submit + wait
+	};
+
+	static constexpr UINT WORKGROUP_SIZE = 256;
+
+	//The shader only sees float days relative to the element epoch, once the offset grows past this
+	//the elapsed phase is folded into the elements in place and the epoch moves to the current day
+	static constexpr double REBASE_DAYS = 16.0;
+
+public:
+	AsteroidBeltCompute() = default;
+	~AsteroidBeltCompute() = default;
+
+	AsteroidBeltCompute(const AsteroidBeltCompute&) = delete;
+	AsteroidBeltCompute& operator=(const AsteroidBeltCompute&) = delete;
+
+	//Uploads the whole belt once, uiIndexCount is written into the indirect args every dispatch
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, UINT uiQueueFamilyIdx,
+		const AsteroidBelt& belt, UINT uiIndexCount, float fBoundingRadius);
+	void Destroy();
+
+	//The shader module is owned by the map so ShaderHotReload can retire it with the pipeline
+	void SetShaderModule(VkShaderModule shaderModule) { m_mapShaderModule[VK_SHADER_STAGE_COMPUTE_BIT] = shaderModule; }
+	void CreatePipeline();
+	std::unordered_map<VkShaderStageFlagBits, VkShaderModule>* GetShaderModuleMap() { return &m_mapShaderModule; }
+	VkPipeline* GetPipeline() { return &m_Pipeline; }
+
+	//Record outside of a render pass, before the draw that reads GetInstanceBuffer() / GetIndirectBuffer()
+	//pViewProj == nullptr disables culling, the instances are then written in body order
+	void RecordDispatch(VkCommandBuffer commandBuffer, double dSimulationDays, UINT uiDrawCount, const glm::mat4* pViewProj);
+
+	VkBuffer GetInstanceBuffer() const { return m_InstanceBuffer; }
+	VkBuffer GetIndirectBuffer() const { return m_IndirectBuffer; }
+	UINT GetCapacity() const { return m_uiCapacity; }
+	bool IsInitialized() const { return m_Device != VK_NULL_HANDLE; }
+
+	//Creates its own instance and a compute only device on every physical device, so it also runs on
+	//software implementations (lavapipe, SwiftShader) without a window
+	static std::vector<BenchmarkResult> RunHeadlessBenchmark(const std::vector<UINT>& vecBodyCount, UINT uiUpdateCount = 16);
+
+private:
+	void CreateBuffer(VkDeviceSize deviceSize, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags propertyFlags, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+	void DestroyBuffer(VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+	VkCommandBuffer BeginSingleTimeCommand();
+	void EndSingleTimeCommand(VkCommandBuffer commandBuffer);
+
+	void UploadElements(const AsteroidBelt& belt);
+	void CreateDescriptorSetLayout();
+	void CreateDescriptorPool();
+	void CreateDescriptorSet();
+	void CreatePipelineLayout();
+
+private:
+	VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VkQueue m_Queue = VK_NULL_HANDLE;
+	VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+
+	UINT m_uiCapacity = 0;
+	UINT m_uiIndexCount = 0;
+	float m_fBoundingRadius = 1.f;
+	double m_dEpochDays = 0.0;
+
+	VkBuffer m_ElementBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory m_ElementBufferMemory = VK_NULL_HANDLE;
+	VkBuffer m_InstanceBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory m_InstanceBufferMemory = VK_NULL_HANDLE;
+	VkBuffer m_IndirectBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory m_IndirectBufferMemory = VK_NULL_HANDLE;
+
+	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapShaderModule;
+	VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+	VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+	VkPipeline m_Pipeline = VK_NULL_HANDLE;
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include "AsteroidBelt.h"
+
+//Batch kernel shared by the SSE4.1 and AVX2 TUs, S is the ISA traits struct of the including TU
+//Only include this from AsteroidBeltSSE41.cpp / AsteroidBeltAVX2.cpp, the traits need the matching compiler flags
+namespace DZW_AsteroidKernel
+{
+	//Cephes style sin/cos, pi/2 range reduction in three parts, error ~1e-7 for |x| < 8192
+	template<typename S>
+	inline void SinCos(typename S::F x, typename S::F& outSin, typename S::F& outCos)
+	{
+		using F = typename S::F;
+
+		F j = S::Round(S::Mul(x, S::Set1(0.63661977236758134f)));
+		F r = S::MulAdd(j, S::Set1(-1.5703125f), x);
+		r = S::MulAdd(j, S::Set1(-4.837512969970703125e-4f), r);
+		r = S::MulAdd(j, S::Set1(-7.54978995489188216e-8f), r);
+		F z = S::Mul(r, r);
+
+		F s = S::MulAdd(S::Set1(-1.9515295891e-4f), z, S::Set1(8.3321608736e-3f));
+		s = S::MulAdd(s, z, S::Set1(-1.6666654611e-1f));
+		s = S::MulAdd(S::Mul(s, z), r, r);
+
+		F c = S::MulAdd(S::Set1(2.443315711809948e-5f), z, S::Set1(-1.388731625493765e-3f));
+		c = S::MulAdd(c, z, S::Set1(4.166664568298827e-2f));
+		c = S::MulAdd(S::Mul(c, z), z, S::MulAdd(S::Set1(-0.5f), z, S::Set1(1.f)));
+
+		//Quadrant q: odd quadrants swap sin/cos, sin flips in q = 2,3, cos flips in q = 1,2
+		auto q = S::ToInt(j);
+		F bit0 = S::IntBitMask(q, 1);
+		F bit1 = S::IntBitMask(q, 2);
+		F signMask = S::Set1(-0.f);
+
+		outSin = S::Xor(S::Select(bit0, c, s), S::And(bit1, signMask));
+		outCos = S::Xor(S::Select(bit0, s, c), S::And(S::Xor(bit0, bit1), signMask));
+	}
+
+	template<typename S>
+	void UpdateBatch(const AsteroidBeltView& view, UINT uiBegin, UINT uiEnd, double dDays, InstanceData* pDst)
+	{
+		using F = typename S::F;
+
+		const F one = S::Set1(1.f);
+		const F two = S::Set1(2.f);
+		const F zero = S::Set1(0.f);
+		const F signMask = S::Set1(-0.f);
+		const F danby = S::Set1(0.85f);
+
+		UINT uiSimdEnd = uiBegin + (uiEnd - uiBegin) / S::WIDTH * S::WIDTH;
+		for (UINT i = uiBegin; i < uiSimdEnd; i += S::WIDTH)
+		{
+			//Kepler's equation, Halley iterations from the Danby starter like the scalar kernel
+			F M = S::WrapPhase(view.pMeanAnomalyAtEpoch + i, view.pMeanMotion + i, dDays);
+			F e = S::Load(view.pEccentricity + i);
+			F E = S::MulAdd(S::Mul(danby, e), S::Or(S::And(M, signMask), one), M);
+			for (UINT uiIter = 0; uiIter < HALLEY_ITERATION; ++uiIter)
+			{
+				F fSin, fCos;
+				SinCos<S>(E, fSin, fCos);
+				F eSin = S::Mul(e, fSin);
+				F f = S::Sub(S::Sub(E, eSin), M);
+				F f1 = S::Sub(one, S::Mul(e, fCos));
+				F numerator = S::Mul(two, S::Mul(f, f1));
+				F denominator = S::Sub(S::Mul(two, S::Mul(f1, f1)), S::Mul(f, eSin));
+				E = S::Sub(E, S::Div(numerator, denominator));
+			}
+
+			F sinE, cosE;
+			SinCos<S>(E, sinE, cosE);
+			F fP = S::Sub(cosE, e);
+			F x = S::MulAdd(S::Load(view.pPx + i), fP, S::Mul(S::Load(view.pQx + i), sinE));
+			F y = S::MulAdd(S::Load(view.pPy + i), fP, S::Mul(S::Load(view.pQy + i), sinE));
+			F z = S::MulAdd(S::Load(view.pPz + i), fP, S::Mul(S::Load(view.pQz + i), sinE));
+
+			F spin = S::WrapPhase(view.pSpinAtEpoch + i, view.pSpinRate + i, dDays);
+			F sinSpin, cosSpin;
+			SinCos<S>(spin, sinSpin, cosSpin);
+
+			F scale = S::Load(view.pScale + i);
+			F tiltCos = S::Load(view.pTiltCos + i);
+			F tiltSin = S::Load(view.pTiltSin + i);
+			F scaleCos = S::Mul(scale, cosSpin);
+			F scaleSin = S::Mul(scale, sinSpin);
+
+			//Rows of T * Rz(-tilt) * Ry(spin) * S, one register per matrix element
+			F aryElement[12] = {
+				S::Mul(scaleCos, tiltCos), S::Mul(scale, tiltSin), S::Mul(scaleSin, tiltCos), x,
+				S::Xor(S::Mul(scaleCos, tiltSin), signMask), S::Mul(scale, tiltCos), S::Xor(S::Mul(scaleSin, tiltSin), signMask), y,
+				S::Xor(scaleSin, signMask), zero, scaleCos, z,
+			};
+			S::StoreInstances(aryElement, pDst + i);
+		}
+
+		UpdateScalar(view, uiSimdEnd, uiEnd, dDays, pDst);
+
+		S::Fence();
+	}
+}
@@ -0,0 +1,78 @@
+#include "AsteroidBeltKernel.h"
+
+#include <smmintrin.h>
+
+namespace
+{
+	struct SimdSSE41
+	{
+		static constexpr UINT WIDTH = 4;
+		using F = __m128;
+		using I = __m128i;
+
+		static F Load(const float* p) { return _mm_loadu_ps(p); }
+		static F Set1(float f) { return _mm_set1_ps(f); }
+		static F Add(F a, F b) { return _mm_add_ps(a, b); }
+		static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+		static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+		static F Div(F a, F b) { return _mm_div_ps(a, b); }
+		static F MulAdd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+		static F And(F a, F b) { return _mm_and_ps(a, b); }
+		static F Or(F a, F b) { return _mm_or_ps(a, b); }
+		static F Xor(F a, F b) { return _mm_xor_ps(a, b); }
+		static F Select(F mask, F a, F b) { return _mm_blendv_ps(b, a, mask); }
+		static F Round(F a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static I ToInt(F a) { return _mm_cvtps_epi32(a); }
+		static F IntBitMask(I a, int nBit)
+		{
+			I bit = _mm_set1_epi32(nBit);
+			return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, bit), bit));
+		}
+
+		//base + rate * days reduced to [-pi, pi] in double, two lanes at a time
+		static F WrapPhase(const float* pBase, const float* pRate, double dDays)
+		{
+			const __m128d days = _mm_set1_pd(dDays);
+			const __m128d pi = _mm_set1_pd(3.14159265358979323846);
+			const __m128d twoPi = _mm_set1_pd(6.28318530717958647692);
+			const __m128d invTwoPi = _mm_set1_pd(0.15915494309189533577);
+
+			F base = _mm_loadu_ps(pBase);
+			F rate = _mm_loadu_ps(pRate);
+
+			__m128d lo = _mm_add_pd(_mm_cvtps_pd(base), _mm_mul_pd(_mm_cvtps_pd(rate), days));
+			__m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(base, base)), _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(rate, rate)), days));
+			lo = _mm_sub_pd(lo, _mm_mul_pd(twoPi, _mm_floor_pd(_mm_mul_pd(_mm_add_pd(lo, pi), invTwoPi))));
+			hi = _mm_sub_pd(hi, _mm_mul_pd(twoPi, _mm_floor_pd(_mm_mul_pd(_mm_add_pd(hi, pi), invTwoPi))));
+
+			return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+		}
+
+		//SoA -> AoS, one 4x4 transpose per matrix row, streamed past the cache into the mapped buffer
+		static void StoreInstances(const F* pElement, InstanceData* pDst)
+		{
+			float* pFloat = reinterpret_cast<float*>(pDst);
+			for (UINT uiRow = 0; uiRow < 3; ++uiRow)
+			{
+				F a = pElement[uiRow * 4 + 0], b = pElement[uiRow * 4 + 1], c = pElement[uiRow * 4 + 2], d = pElement[uiRow * 4 + 3];
+				_MM_TRANSPOSE4_PS(a, b, c, d);
+				_mm_stream_ps(pFloat + 0 * 16 + uiRow * 4, a);
+				_mm_stream_ps(pFloat + 1 * 16 + uiRow * 4, b);
+				_mm_stream_ps(pFloat + 2 * 16 + uiRow * 4, c);
+				_mm_stream_ps(pFloat + 3 * 16 + uiRow * 4, d);
+			}
+
+			//params is streamed as well, a partially written line would defeat the non temporal stores
+			__m128 zero = _mm_setzero_ps();
+			for (UINT k = 0; k < 4; ++k)
+				_mm_stream_ps(pFloat + k * 16 + 12, zero);
+		}
+
+		static void Fence() { _mm_sfence(); }
+	};
+}
+
+void DZW_AsteroidKernel::UpdateSSE41(const AsteroidBeltView& view, UINT uiBegin, UINT uiEnd, double dDays, InstanceData* pDst)
+{
+	UpdateBatch<SimdSSE41>(view, uiBegin, uiEnd, dDays, pDst);
+}
@@ -18,8 +18,8 @@ void Camera::Init(float fFov, float fWidth, float fHeight, float fNearClip, floa
 	m_fNearClip = fNearClip;
 	m_fFarClip = fFarClip;
 	m_pWindow = pWindow;
-	m_Position = position;
-	m_FocalPoint = focalPoint;
+	m_Position = glm::dvec3(position);
+	m_FocalPoint = glm::dvec3(focalPoint);
 	m_bFlipY = bFlipY;
 
 
@@ -62,40 +62,26 @@ void Camera::Tick()
 
 	float fSpeed = 10.f;
 
+	//λdoubleۼӣԶԭʱÿ֡Сᱻ
+	glm::dvec3 move = { 0.0, 0.0, 0.0 };
 	if (IsKeyPressed(GLFW_KEY_W))
-	{
-		m_Position += fSpeed * fDeltaTime * GetForwardDirection();
-		m_FocalPoint += fSpeed * fDeltaTime * GetForwardDirection();
-		bPositionChange = true;
-	}
+		move = glm::dvec3(GetForwardDirection());
 	else if (IsKeyPressed(GLFW_KEY_S))
-	{
-		m_Position -= fSpeed * fDeltaTime * GetForwardDirection();
-		m_FocalPoint -= fSpeed * fDeltaTime * GetForwardDirection();
-		bPositionChange = true;
-	}
+		move = -glm::dvec3(GetForwardDirection());
 	else if (IsKeyPressed(GLFW_KEY_A))
-	{
-		m_Position -= fSpeed * fDeltaTime * GetRightDirection();
-		m_FocalPoint -= fSpeed * fDeltaTime * GetRightDirection();
-		bPositionChange = true;
-	}
+		move = -glm::dvec3(GetRightDirection());
 	else if (IsKeyPressed(GLFW_KEY_D))
-	{
-		m_Position += fSpeed * fDeltaTime * GetRightDirection();
-		m_FocalPoint += fSpeed * fDeltaTime * GetRightDirection();
-		bPositionChange = true;
-	}
+		move = glm::dvec3(GetRightDirection());
 	else if (IsKeyPressed(GLFW_KEY_Q))
-	{
-		m_Position += fSpeed * fDeltaTime * GetUpDirection();
-		m_FocalPoint += fSpeed * fDeltaTime * GetUpDirection();
-		bPositionChange = true;
-	}
+		move = glm::dvec3(GetUpDirection());
 	else if (IsKeyPressed(GLFW_KEY_E))
+		move = -glm::dvec3(GetUpDirection());
+
+	if (move != glm::dvec3(0.0))
 	{
-		m_Position -= fSpeed * fDeltaTime * GetUpDirection();
-		m_FocalPoint -= fSpeed * fDeltaTime * GetUpDirection();
+		move *= static_cast<double>(fSpeed * fDeltaTime);
+		m_Position += move;
+		m_FocalPoint += move;
 		bPositionChange = true;
 	}
 
@@ -142,12 +128,12 @@ glm::vec3 Camera::GetRightDirection() const
 }
 glm::vec3 Camera::GetForwardDirection() const
 {
-	return glm::normalize(m_FocalPoint - m_Position);
+	return glm::vec3(glm::normalize(m_FocalPoint - m_Position));
 }
 
 void Camera::CalcYawPitch()
 {
-	glm::vec3 forward = glm::normalize(m_Position - m_FocalPoint);
+	glm::vec3 forward = glm::vec3(glm::normalize(m_Position - m_FocalPoint));
 
 	// yawpitch, rollͨΪ0
 	float yaw = atan2(forward.x, forward.z);
@@ -160,15 +146,31 @@ void Camera::CalcYawPitch()
 
 void Camera::UpdateView()
 {
-	m_ViewMatrix = glm::lookAt(m_Position, m_FocalPoint, GetUpDirection());
+	glm::dvec3 up = glm::dvec3(GetUpDirection());
+	m_ViewMatrix = glm::mat4(glm::lookAt(m_Position, m_FocalPoint, up));
+	m_RelativeViewMatrix = glm::mat4(glm::lookAt(glm::dvec3(0.0), m_FocalPoint - m_Position, up));
 }
 void Camera::UpdateProjection()
 {
 	ASSERT(m_fViewportHeight != 0.f, "Viewport Height cant be 0!");
 	m_fAspectRatio = m_fViewportWidth / m_fViewportHeight;
-	m_ProjMatrix = glm::perspective(glm::radians(m_fVerticalFOV), m_fAspectRatio, m_fNearClip, m_fFarClip);
+	m_FiniteProjMatrix = glm::perspective(glm::radians(m_fVerticalFOV), m_fAspectRatio, m_fNearClip, m_fFarClip);
 	if (m_bFlipY)
-		m_ProjMatrix[1][1] *= -1.f;
+		m_FiniteProjMatrix[1][1] *= -1.f;
+
+	if (!m_bReversedZ)
+	{
+		m_ProjMatrix = m_FiniteProjMatrix;
+		return;
+	}
+
+	//Զreversed-Zz_ndc = near / -z_viewȵľȼԶfloatֲָ໥
+	float fFocal = 1.f / std::tan(glm::radians(m_fVerticalFOV) * 0.5f);
+	m_ProjMatrix = glm::mat4(0.f);
+	m_ProjMatrix[0][0] = fFocal / m_fAspectRatio;
+	m_ProjMatrix[1][1] = m_bFlipY ? -fFocal : fFocal;
+	m_ProjMatrix[2][3] = -1.f;
+	m_ProjMatrix[3][2] = m_fNearClip;
 }
 
 void Camera::CameraRotate(const glm::vec2& delta)
@@ -178,9 +180,9 @@ void Camera::CameraRotate(const glm::vec2& delta)
 
 	m_fPitch = std::clamp(m_fPitch, -89.f, 89.f);
 
-	float fCameraDistance = glm::distance(m_Position, m_FocalPoint);
+	double dCameraDistance = glm::distance(m_Position, m_FocalPoint);
 
-	m_Position = m_FocalPoint + GetRotationQuat() * glm::vec3(0.f, 0.f, fCameraDistance);
+	m_Position = m_FocalPoint + glm::dquat(GetRotationQuat()) * glm::dvec3(0.0, 0.0, dCameraDistance);
 
 	UpdateView();
 }
@@ -25,9 +25,15 @@ public:
 	void SetViewportSize(float fWidth, float fHeight);
 
 	const glm::mat4& GetProjMatrix() const { return m_ProjMatrix; }
+	//׼[0,1]ȡԶƽΪm_fFarClipͶӰCPUҪ׶ʱʹãCSMз֣reversed-Z仯
+	const glm::mat4& GetFiniteProjMatrix() const { return m_FiniteProjMatrix; }
 	const glm::mat4& GetViewMatrix() const { return m_ViewMatrix; }
 	glm::mat4 GetViewProjMatrix() const { return m_ProjMatrix * m_ViewMatrix; }
 
+	//λԭviewֻתmodelʹãfloating origin
+	const glm::mat4& GetRelativeViewMatrix() const { return m_RelativeViewMatrix; }
+	glm::mat4 GetRelativeViewProjMatrix() const { return m_ProjMatrix * m_RelativeViewMatrix; }
+
 	glm::quat GetRotationQuat() const;
 	glm::mat4 GetRotationMatrix() const;
 
@@ -35,16 +41,28 @@ public:
 	glm::vec3 GetRightDirection() const;
 	glm::vec3 GetForwardDirection() const;
 
-	const glm::vec3& GetPosition() { return m_Position; }
-	void SetPosition(const glm::vec3& pos) { m_Position = pos; }
+	glm::vec3 GetPosition() const { return glm::vec3(m_Position); }
+	void SetPosition(const glm::vec3& pos) { m_Position = glm::dvec3(pos); }
+
+	glm::vec3 GetFocalPoint() const { return glm::vec3(m_FocalPoint); }
+	void SetFocalPoint(const glm::vec3& pos) { m_FocalPoint = glm::dvec3(pos); }
 
-	const glm::vec3& GetFocalPoint() { return m_FocalPoint; }
-	void SetFocalPoint(const glm::vec3& pos) { m_FocalPoint = pos; }
+	//doubleȵ꣬Զԭʱڼı任
+	const glm::dvec3& GetWorldPosition() const { return m_Position; }
+	void SetWorldPosition(const glm::dvec3& pos) { m_Position = pos; }
+	const glm::dvec3& GetWorldFocalPoint() const { return m_FocalPoint; }
+	void SetWorldFocalPoint(const glm::dvec3& pos) { m_FocalPoint = pos; }
 
 	void SetFlipY(bool bFlipY) { m_bFlipY = bFlipY; }
 
+	//reversed-ZƽΪ1ԶƽԶΪ0ȲGREATER_OR_EQUALΪ0
+	void SetReversedZ(bool bReversedZ) { m_bReversedZ = bReversedZ; UpdateProjection(); }
+	bool IsReversedZ() const { return m_bReversedZ; }
+
 	float GetVerticalFOV() { return m_fVerticalFOV; }
 	float GetAspectRatio() { return m_fAspectRatio; }
+	float GetNearClip() const { return m_fNearClip; }
+	float GetFarClip() const { return m_fFarClip; }
 
 	float GetPitch() const { return m_fPitch; }
 	float GetYaw() const { return m_fYaw; }
@@ -70,10 +88,12 @@ private:
 	float m_fFarClip = 1000.f;
 
 	glm::mat4 m_ViewMatrix;
+	glm::mat4 m_RelativeViewMatrix;
 	glm::mat4 m_ProjMatrix;
+	glm::mat4 m_FiniteProjMatrix;
 
-	glm::vec3 m_Position = { 0.f, 0.f, 5.f };
-	glm::vec3 m_FocalPoint = { 0.f, 0.f, 0.f };
+	glm::dvec3 m_Position = { 0.0, 0.0, 5.0 };
+	glm::dvec3 m_FocalPoint = { 0.0, 0.0, 0.0 };
 
 	//degrees
 	float m_fYaw = 0.f;		//ƫǣyת
@@ -86,6 +106,7 @@ private:
 	glm::vec2 m_InititalMousePosition;
 
 	bool m_bFlipY = false;
+	bool m_bReversedZ = false;
 
 	GLFWwindow* m_pWindow = nullptr;
 };
@@ -0,0 +1,41 @@
+#pragma once
+#include "Core.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+//sRGB transfer function tables for the CPU mip filters, which average in linear space and store sRGB encoded
+namespace DZW_ColorSpace
+{
+	inline const std::array<float, 256>& GetSrgbToLinearTable()
+	{
+		static const std::array<float, 256> aryTable = []()
+		{
+			std::array<float, 256> ary{};
+			for (UINT i = 0; i < 256; ++i)
+			{
+				float f = static_cast<float>(i) / 255.f;
+				ary[i] = (f <= 0.04045f) ? f / 12.92f : std::pow((f + 0.055f) / 1.055f, 2.4f);
+			}
+			return ary;
+		}();
+		return aryTable;
+	}
+
+	inline UCHAR LinearToSrgb(float fLinear)
+	{
+		static const std::array<UCHAR, 4096> aryTable = []()
+		{
+			std::array<UCHAR, 4096> ary{};
+			for (UINT i = 0; i < 4096; ++i)
+			{
+				float f = static_cast<float>(i) / 4095.f;
+				float fSrgb = (f <= 0.0031308f) ? f * 12.92f : 1.055f * std::pow(f, 1.f / 2.4f) - 0.055f;
+				ary[i] = static_cast<UCHAR>(std::clamp(fSrgb * 255.f + 0.5f, 0.f, 255.f));
+			}
+			return ary;
+		}();
+		return aryTable[static_cast<UINT>(std::clamp(fLinear, 0.f, 1.f) * 4095.f + 0.5f)];
+	}
+}
@@ -0,0 +1,184 @@
+#include "EmbeddedShader.h"
+
+namespace DZW_EmbeddedShader
+{
+	namespace
+	{
+		constexpr UINT g_Common_vert[] = {
+#include "../Assert/Shader/Common/vert.u32"
+		};
+
+		constexpr UINT g_Common_frag[] = {
+#include "../Assert/Shader/Common/frag.u32"
+		};
+
+		constexpr UINT g_glTF_vert[] = {
+#include "../Assert/Shader/glTF/vert.u32"
+		};
+
+		constexpr UINT g_glTF_frag[] = {
+#include "../Assert/Shader/glTF/frag.u32"
+		};
+
+		constexpr UINT g_Skybox_vert[] = {
+#include "../Assert/Shader/Skybox/vert.u32"
+		};
+
+		constexpr UINT g_Skybox_frag[] = {
+#include "../Assert/Shader/Skybox/frag.u32"
+		};
+
+		constexpr UINT g_ShadowMap_vert[] = {
+#include "../Assert/Shader/ShadowMap/vert.u32"
+		};
+
+		constexpr UINT g_OmniShadow_vert[] = {
+#include "../Assert/Shader/OmniShadow/vert.u32"
+		};
+
+		constexpr UINT g_OmniShadow_geom[] = {
+#include "../Assert/Shader/OmniShadow/geom.u32"
+		};
+
+		constexpr UINT g_OmniShadow_frag[] = {
+#include "../Assert/Shader/OmniShadow/frag.u32"
+		};
+
+		constexpr UINT g_PointLight_vert[] = {
+#include "../Assert/Shader/PointLight/vert.u32"
+		};
+
+		constexpr UINT g_PointLight_frag[] = {
+#include "../Assert/Shader/PointLight/frag.u32"
+		};
+
+		constexpr UINT g_Instanced_vert[] = {
+#include "../Assert/Shader/Instanced/vert.u32"
+		};
+
+		constexpr UINT g_Instanced_frag[] = {
+#include "../Assert/Shader/Instanced/frag.u32"
+		};
+
+		constexpr UINT g_AsteroidCompute_comp[] = {
+#include "../Assert/Shader/AsteroidCompute/comp.u32"
+		};
+
+		constexpr UINT g_MeshGrid_vert[] = {
+#include "../Assert/Shader/MeshGrid/vert.u32"
+		};
+
+		constexpr UINT g_MeshGrid_frag[] = {
+#include "../Assert/Shader/MeshGrid/frag.u32"
+		};
+
+		constexpr UINT g_BlinnPhong_vert[] = {
+#include "../Assert/Shader/BlinnPhong/vert.u32"
+		};
+
+		constexpr UINT g_BlinnPhong_frag[] = {
+#include "../Assert/Shader/BlinnPhong/frag.u32"
+		};
+
+		constexpr UINT g_PBR_vert[] = {
+#include "../Assert/Shader/PBR/vert.u32"
+		};
+
+		constexpr UINT g_PBR_frag[] = {
+#include "../Assert/Shader/PBR/frag.u32"
+		};
+
+		constexpr UINT g_Planet_vert[] = {
+#include "../Assert/Shader/vert.u32"
+		};
+
+		constexpr UINT g_Planet_frag[] = {
+#include "../Assert/Shader/frag.u32"
+		};
+
+		constexpr UINT g_PlanetNoFeedback_frag[] = {
+#include "../Assert/Shader/frag_nofeedback.u32"
+		};
+
+		constexpr UINT g_PlanetImpostor_vert[] = {
+#include "../Assert/Shader/PlanetImpostor/vert.u32"
+		};
+
+		constexpr UINT g_PlanetImpostor_frag[] = {
+#include "../Assert/Shader/PlanetImpostor/frag.u32"
+		};
+
+		constexpr UINT g_PlanetTerrain_vert[] = {
+#include "../Assert/Shader/PlanetTerrain/vert.u32"
+		};
+
+		constexpr UINT g_PlanetTerrain_frag[] = {
+#include "../Assert/Shader/PlanetTerrain/frag.u32"
+		};
+
+		constexpr UINT g_PlanetTerrainNoFeedback_frag[] = {
+#include "../Assert/Shader/PlanetTerrain/frag_nofeedback.u32"
+		};
+
+		constexpr UINT g_ImGui_imgui_vert[] = {
+#include "../Assert/Shader/ImGui/imgui_vert.u32"
+		};
+
+		constexpr UINT g_ImGui_imgui_vert_srgb[] = {
+#include "../Assert/Shader/ImGui/imgui_vert_srgb.u32"
+		};
+
+		constexpr UINT g_ImGui_imgui_frag[] = {
+#include "../Assert/Shader/ImGui/imgui_frag.u32"
+		};
+	}
+
+	const std::vector<EmbeddedSpirv>& GetEmbeddedSpirvTable()
+	{
+		static const std::vector<EmbeddedSpirv> vecTable = {
+			{ "Common",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/Common/shader.vert",	"./Assert/Shader/Common/vert.spv",	g_Common_vert },
+			{ "Common",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/Common/shader.frag",	"./Assert/Shader/Common/frag.spv",	g_Common_frag },
+			{ "glTF",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/glTF/shader.vert",	"./Assert/Shader/glTF/vert.spv",	g_glTF_vert },
+			{ "glTF",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/glTF/shader.frag",	"./Assert/Shader/glTF/frag.spv",	g_glTF_frag },
+			{ "Skybox",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/Skybox/skybox.vert",	"./Assert/Shader/Skybox/vert.spv",	g_Skybox_vert },
+			{ "Skybox",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/Skybox/skybox.frag",	"./Assert/Shader/Skybox/frag.spv",	g_Skybox_frag },
+			{ "ShadowMap",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/ShadowMap/shader.vert",	"./Assert/Shader/ShadowMap/vert.spv",	g_ShadowMap_vert },
+			{ "OmniShadow",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/OmniShadow/shader.vert",	"./Assert/Shader/OmniShadow/vert.spv",	g_OmniShadow_vert },
+			{ "OmniShadow",	VK_SHADER_STAGE_GEOMETRY_BIT,	"./Assert/Shader/OmniShadow/shader.geom",	"./Assert/Shader/OmniShadow/geom.spv",	g_OmniShadow_geom },
+			{ "OmniShadow",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/OmniShadow/shader.frag",	"./Assert/Shader/OmniShadow/frag.spv",	g_OmniShadow_frag },
+			{ "PointLight",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/PointLight/shader.vert",	"./Assert/Shader/PointLight/vert.spv",	g_PointLight_vert },
+			{ "PointLight",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/PointLight/shader.frag",	"./Assert/Shader/PointLight/frag.spv",	g_PointLight_frag },
+			{ "Instanced",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/Instanced/shader.vert",	"./Assert/Shader/Instanced/vert.spv",	g_Instanced_vert },
+			{ "Instanced",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/Instanced/shader.frag",	"./Assert/Shader/Instanced/frag.spv",	g_Instanced_frag },
+			{ "AsteroidCompute",	VK_SHADER_STAGE_COMPUTE_BIT,	"./Assert/Shader/AsteroidCompute/shader.comp",	"./Assert/Shader/AsteroidCompute/comp.spv",	g_AsteroidCompute_comp },
+			{ "MeshGrid",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/MeshGrid/meshgrid.vert",	"./Assert/Shader/MeshGrid/vert.spv",	g_MeshGrid_vert },
+			{ "MeshGrid",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/MeshGrid/meshgrid.frag",	"./Assert/Shader/MeshGrid/frag.spv",	g_MeshGrid_frag },
+			{ "BlinnPhong",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/BlinnPhong/shader.vert",	"./Assert/Shader/BlinnPhong/vert.spv",	g_BlinnPhong_vert },
+			{ "BlinnPhong",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/BlinnPhong/shader.frag",	"./Assert/Shader/BlinnPhong/frag.spv",	g_BlinnPhong_frag },
+			{ "PBR",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/PBR/shader.vert",	"./Assert/Shader/PBR/vert.spv",	g_PBR_vert },
+			{ "PBR",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/PBR/shader.frag",	"./Assert/Shader/PBR/frag.spv",	g_PBR_frag },
+			{ "Planet",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/shader.vert",	"./Assert/Shader/vert.spv",	g_Planet_vert },
+			{ "Planet",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/shader.frag",	"./Assert/Shader/frag.spv",	g_Planet_frag },
+			{ "PlanetNoFeedback",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/shader.frag",	"./Assert/Shader/frag_nofeedback.spv",	g_PlanetNoFeedback_frag,	{ "NO_VIRTUAL_FEEDBACK" } },
+			{ "PlanetImpostor",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/PlanetImpostor/shader.vert",	"./Assert/Shader/PlanetImpostor/vert.spv",	g_PlanetImpostor_vert },
+			{ "PlanetImpostor",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/PlanetImpostor/shader.frag",	"./Assert/Shader/PlanetImpostor/frag.spv",	g_PlanetImpostor_frag },
+			{ "PlanetTerrain",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/PlanetTerrain/shader.vert",	"./Assert/Shader/PlanetTerrain/vert.spv",	g_PlanetTerrain_vert },
+			{ "PlanetTerrain",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/PlanetTerrain/shader.frag",	"./Assert/Shader/PlanetTerrain/frag.spv",	g_PlanetTerrain_frag },
+			{ "PlanetTerrainNoFeedback",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/PlanetTerrain/shader.frag",	"./Assert/Shader/PlanetTerrain/frag_nofeedback.spv",	g_PlanetTerrainNoFeedback_frag,	{ "NO_VIRTUAL_FEEDBACK" } },
+			{ "ImGui",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/ImGui/imgui.vert",	"./Assert/Shader/ImGui/imgui_vert.spv",	g_ImGui_imgui_vert },
+			{ "ImGuiSRGB",	VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/ImGui/imgui_srgb.vert",	"./Assert/Shader/ImGui/imgui_vert_srgb.spv",	g_ImGui_imgui_vert_srgb },
+			{ "ImGui",	VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/ImGui/imgui.frag",	"./Assert/Shader/ImGui/imgui_frag.spv",	g_ImGui_imgui_frag },
+		};
+		return vecTable;
+	}
+
+	const EmbeddedSpirv* FindEmbeddedSpirv(const std::string& strName, VkShaderStageFlagBits stage)
+	{
+		for (const auto& embedded : GetEmbeddedSpirvTable())
+		{
+			if (strName == embedded.szName && stage == embedded.stage)
+				return &embedded;
+		}
+		return nullptr;
+	}
+}
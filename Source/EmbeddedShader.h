@@ -0,0 +1,26 @@
+#pragma once
+#include "vulkan/vulkan.h"
+
+#include "Core.h"
+
+#include <span>
+
+//SPIR-V compiled into the binary by Assert/Shader/GenerateEmbeddedSpv.bat (glslc -mfmt=num)
+//Specialization constants are not part of the key, permutations are built from the same module at pipeline creation
+//Preprocessor variants (e.g. "PlanetNoFeedback") are separate entries sharing a source with their own defines
+namespace DZW_EmbeddedShader
+{
+	struct EmbeddedSpirv
+	{
+		const char* szName;				//Shader directory name or variant name, e.g. "Common", "PlanetNoFeedback"
+		VkShaderStageFlagBits stage;
+		const char* szSourcePath;		//GLSL source, watched by ShaderHotReload
+		const char* szSpvPath;			//On-disk spv produced by ShaderCompileToSpv.bat / hot reload
+		std::span<const UINT> spirv;
+		std::vector<const char*> vecDefines = {};	//Same -D macros GenerateEmbeddedSpv.bat passes to glslc
+	};
+
+	const std::vector<EmbeddedSpirv>& GetEmbeddedSpirvTable();
+
+	const EmbeddedSpirv* FindEmbeddedSpirv(const std::string& strName, VkShaderStageFlagBits stage);
+}
@@ -0,0 +1,21 @@
+#include "Frustum.h"
+
+void DZW_Frustum::ExtractFrustumPlanes(const glm::mat4& viewProj, glm::vec4* pPlane)
+{
+	//glm is column major, row r of the matrix is (m[0][r], m[1][r], m[2][r], m[3][r])
+	auto row = [&](int r) { return glm::vec4(viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]); };
+
+	pPlane[0] = row(3) + row(0);	//left
+	pPlane[1] = row(3) - row(0);	//right
+	pPlane[2] = row(3) + row(1);	//bottom
+	pPlane[3] = row(3) - row(1);	//top
+	pPlane[4] = row(2);				//near, depth range [0, 1] (far with reversed-Z)
+	pPlane[5] = row(3) - row(2);	//far (near with reversed-Z)
+
+	for (UINT i = 0; i < 6; ++i)
+	{
+		//An infinite far plane has no normal, keep it as a plane every point is inside of
+		float fLength = glm::length(glm::vec3(pPlane[i]));
+		pPlane[i] = (fLength > 1e-6f) ? pPlane[i] / fLength : glm::vec4(0.f, 0.f, 0.f, 1.f);
+	}
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "Core.h"
+
+#include "glm/glm.hpp"
+
+namespace DZW_Frustum
+{
+	//Gribb/Hartmann planes for Vulkan clip space (0 <= z <= w), normalized, inside when dot(n, p) + d >= 0
+	//Order: left, right, bottom, top, near, far
+	void ExtractFrustumPlanes(const glm::mat4& viewProj, glm::vec4* pPlane);
+}
@@ -0,0 +1,240 @@
+#include "ImageDecoder.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "stb_image.h"
+#include "stb_image_write.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+void DZW_ImageKernel::ExpandRGBToRGBAScalar(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; ++i)
+	{
+		pDst[0] = pSrc[0];
+		pDst[1] = pSrc[1];
+		pDst[2] = pSrc[2];
+		pDst[3] = 255;
+
+		pDst += 4;
+		pSrc += 3;
+	}
+}
+
+void ImageDecoder::FreePixels(void* pPixels)
+{
+	stbi_image_free(pPixels);
+}
+
+void ImageDecoder::ParallelFor(size_t count, UINT uiThreadCount, const std::function<void(size_t)>& func)
+{
+	if (uiThreadCount == 0)
+		uiThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	uiThreadCount = static_cast<UINT>(std::min<size_t>(uiThreadCount, count));
+
+	//Items are claimed one at a time, images differ a lot in size so static ranges would leave threads idle
+	std::atomic<size_t> nextIdx = 0;
+	auto worker = [&]()
+		{
+			for (size_t i = nextIdx++; i < count; i = nextIdx++)
+				func(i);
+		};
+
+	std::vector<std::thread> vecThread;
+	for (UINT i = 1; i < uiThreadCount; ++i)
+		vecThread.emplace_back(worker);
+	worker();
+	for (auto& thread : vecThread)
+		thread.join();
+}
+
+ImageDecoder::DecodedImage ImageDecoder::Decode(std::span<const UCHAR> encoded)
+{
+	DecodedImage image;
+
+	int nWidth = 0;
+	int nHeight = 0;
+	int nChannel = 0;
+	int nSize = static_cast<int>(encoded.size());
+	if (!stbi_info_from_memory(encoded.data(), nSize, &nWidth, &nHeight, &nChannel))
+		return image;
+
+	//RGB stays packed until it is written out, grey and grey alpha are expanded by stb
+	int nDesiredChannel = (nChannel == 3) ? 3 : 4;
+	stbi_uc* pPixels = stbi_load_from_memory(encoded.data(), nSize, &nWidth, &nHeight, &nChannel, nDesiredChannel);
+	if (!pPixels)
+		return image;
+
+	image.uiWidth = static_cast<UINT>(nWidth);
+	image.uiHeight = static_cast<UINT>(nHeight);
+	image.uiChannel = static_cast<UINT>(nDesiredChannel);
+	image.pPixels.reset(pPixels);
+	return image;
+}
+
+std::vector<ImageDecoder::DecodedImage> ImageDecoder::DecodeBatch(const std::vector<std::span<const UCHAR>>& vecEncoded, UINT uiThreadCount)
+{
+	std::vector<DecodedImage> vecDecoded(vecEncoded.size());
+	ParallelFor(vecEncoded.size(), uiThreadCount, [&](size_t i) { vecDecoded[i] = Decode(vecEncoded[i]); });
+	return vecDecoded;
+}
+
+void ImageDecoder::WriteRGBA(const DecodedImage& image, UCHAR* pDst)
+{
+	ASSERT(image.IsValid(), "Write an image that failed to decode");
+
+	size_t pixelCount = static_cast<size_t>(image.uiWidth) * image.uiHeight;
+	if (image.uiChannel == 4)
+		memcpy(pDst, image.pPixels.get(), pixelCount * 4);
+	else
+		ExpandRGBToRGBA(image.pPixels.get(), pDst, pixelCount, GetMaxSupportedSimdLevel());
+}
+
+void ImageDecoder::ExpandRGBToRGBA(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount, ImageSimdLevel level)
+{
+	switch (level)
+	{
+	case IMAGE_SIMD_AVX2:	DZW_ImageKernel::ExpandRGBToRGBAAVX2(pSrc, pDst, pixelCount); break;
+	case IMAGE_SIMD_SSSE3:	DZW_ImageKernel::ExpandRGBToRGBASSSE3(pSrc, pDst, pixelCount); break;
+	default:				DZW_ImageKernel::ExpandRGBToRGBAScalar(pSrc, pDst, pixelCount); break;
+	}
+}
+
+ImageSimdLevel ImageDecoder::GetMaxSupportedSimdLevel()
+{
+	static ImageSimdLevel s_MaxLevel = []()
+		{
+#if defined(_MSC_VER)
+			int aryInfo[4];
+			__cpuid(aryInfo, 1);
+			bool bSSSE3 = (aryInfo[2] & (1 << 9)) != 0;
+			bool bOSXSave = (aryInfo[2] & (1 << 27)) != 0;
+			bool bAVX = (aryInfo[2] & (1 << 28)) != 0;
+
+			//The OS must save the YMM registers on context switch
+			bool bYMMEnabled = bOSXSave && bAVX && ((_xgetbv(0) & 0x6) == 0x6);
+
+			__cpuidex(aryInfo, 7, 0);
+			bool bAVX2 = (aryInfo[1] & (1 << 5)) != 0;
+#else
+			bool bSSSE3 = __builtin_cpu_supports("ssse3");
+			bool bYMMEnabled = __builtin_cpu_supports("avx");
+			bool bAVX2 = __builtin_cpu_supports("avx2");
+#endif
+			if (bYMMEnabled && bAVX2)
+				return IMAGE_SIMD_AVX2;
+			if (bSSSE3)
+				return IMAGE_SIMD_SSSE3;
+			return IMAGE_SIMD_SCALAR;
+		}();
+
+	return s_MaxLevel;
+}
+
+const char* ImageDecoder::GetSimdLevelName(ImageSimdLevel level)
+{
+	switch (level)
+	{
+	case IMAGE_SIMD_SCALAR:	return "Scalar";
+	case IMAGE_SIMD_SSSE3:	return "SSSE3";
+	case IMAGE_SIMD_AVX2:	return "AVX2";
+	default:				return "Unknown";
+	}
+}
+
+std::vector<ImageDecoder::BenchmarkResult> ImageDecoder::RunBenchmark(const std::vector<UINT>& vecThreadCount, UINT uiImageCount, UINT uiImageSize)
+{
+	std::vector<BenchmarkResult> vecResult;
+
+	//Smooth gradients with a little noise, roughly what albedo textures compress to
+	std::vector<std::vector<UCHAR>> vecEncodedStorage(uiImageCount);
+	ParallelFor(uiImageCount, 0, [&](size_t uiImage)
+		{
+			std::vector<UCHAR> vecPixel(static_cast<size_t>(uiImageSize) * uiImageSize * 3);
+			UINT uiSeed = static_cast<UINT>(uiImage) * 2654435761u + 1;
+			for (UINT y = 0; y < uiImageSize; ++y)
+			{
+				for (UINT x = 0; x < uiImageSize; ++x)
+				{
+					uiSeed = uiSeed * 1664525u + 1013904223u;
+					UCHAR* pPixel = vecPixel.data() + (static_cast<size_t>(y) * uiImageSize + x) * 3;
+					pPixel[0] = static_cast<UCHAR>((x * 255 / uiImageSize + (uiSeed >> 29)) & 0xFF);
+					pPixel[1] = static_cast<UCHAR>((y * 255 / uiImageSize + (uiSeed >> 28)) & 0xFF);
+					pPixel[2] = static_cast<UCHAR>(((x + y) * 127 / uiImageSize + uiImage * 16) & 0xFF);
+				}
+			}
+
+			auto write = [](void* pContext, void* pData, int nSize)
+				{
+					auto* pEncoded = static_cast<std::vector<UCHAR>*>(pContext);
+					pEncoded->insert(pEncoded->end(), static_cast<UCHAR*>(pData), static_cast<UCHAR*>(pData) + nSize);
+				};
+			stbi_write_png_to_func(write, &vecEncodedStorage[uiImage], uiImageSize, uiImageSize, 3, vecPixel.data(), uiImageSize * 3);
+		});
+
+	std::vector<std::span<const UCHAR>> vecEncoded;
+	for (const auto& vecStorage : vecEncodedStorage)
+		vecEncoded.emplace_back(vecStorage.data(), vecStorage.size());
+
+	size_t rgbaSize = static_cast<size_t>(uiImageSize) * uiImageSize * 4;
+	std::vector<std::vector<UCHAR>> vecReference(uiImageCount);
+	std::vector<std::vector<UCHAR>> vecOutput(uiImageCount, std::vector<UCHAR>(rgbaSize));
+
+	for (UINT uiThreadCount : vecThreadCount)
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+		std::vector<DecodedImage> vecDecoded = DecodeBatch(vecEncoded, uiThreadCount);
+		float fDecodeSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		size_t decodedBytes = 0;
+		for (const auto& image : vecDecoded)
+		{
+			ASSERT(image.IsValid(), "Benchmark image failed to decode");
+			decodedBytes += static_cast<size_t>(image.uiWidth) * image.uiHeight * image.uiChannel;
+		}
+
+		if (vecReference[0].empty())
+		{
+			for (UINT i = 0; i < uiImageCount; ++i)
+			{
+				vecReference[i].resize(rgbaSize);
+				ExpandRGBToRGBA(vecDecoded[i].pPixels.get(), vecReference[i].data(), rgbaSize / 4, IMAGE_SIMD_SCALAR);
+			}
+		}
+
+		for (int nLevel = IMAGE_SIMD_SCALAR; nLevel <= GetMaxSupportedSimdLevel(); ++nLevel)
+		{
+			auto level = static_cast<ImageSimdLevel>(nLevel);
+
+			startTime = std::chrono::high_resolution_clock::now();
+			ParallelFor(uiImageCount, uiThreadCount, [&](size_t i)
+				{
+					ExpandRGBToRGBA(vecDecoded[i].pPixels.get(), vecOutput[i].data(), rgbaSize / 4, level);
+				});
+			float fExpandSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			bool bMatch = true;
+			for (UINT i = 0; i < uiImageCount; ++i)
+				bMatch = bMatch && (vecOutput[i] == vecReference[i]);
+
+			BenchmarkResult result;
+			result.uiThreadCount = uiThreadCount;
+			result.level = level;
+			result.fDecodeMBPerSecond = (fDecodeSeconds > 0.f) ? decodedBytes / (1024.f * 1024.f) / fDecodeSeconds : 0.f;
+			result.fExpandMBPerSecond = (fExpandSeconds > 0.f) ? rgbaSize * uiImageCount / (1024.f * 1024.f) / fExpandSeconds : 0.f;
+			result.bMatchScalar = bMatch;
+			vecResult.push_back(result);
+
+			Log::Info("Image decode benchmark {} images {}x{}, {} threads, {}: decode {:.1f} MB/s, expand {:.1f} MB/s, {}",
+				uiImageCount, uiImageSize, uiImageSize, uiThreadCount, GetSimdLevelName(level),
+				result.fDecodeMBPerSecond, result.fExpandMBPerSecond, bMatch ? "match" : "MISMATCH");
+		}
+	}
+
+	return vecResult;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "Core.h"
+
+#include <span>
+#include <functional>
+
+enum ImageSimdLevel
+{
+	IMAGE_SIMD_SCALAR = 0,
+	IMAGE_SIMD_SSSE3,
+	IMAGE_SIMD_AVX2,
+	IMAGE_SIMD_LEVEL_COUNT,
+};
+
+//RGB8 -> RGBA8 with alpha 255, one kernel per ISA, each TU is compiled with the matching instruction set (see premake5.lua)
+//pDst may be write combined staging memory, the kernels only write it sequentially and never read it back
+namespace DZW_ImageKernel
+{
+	void ExpandRGBToRGBAScalar(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount);
+	void ExpandRGBToRGBASSSE3(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount);
+	void ExpandRGBToRGBAAVX2(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount);
+}
+
+//Decodes encoded images (png, jpg, tga, bmp ... anything stb_image reads) on a pool of worker threads
+//RGB images stay 3 channel after decoding and are expanded to RGBA only when written to the destination,
+//which is normally the mapped staging buffer, so no RGBA copy is ever made on the heap
+class ImageDecoder
+{
+public:
+	struct DecodedImage
+	{
+		UINT uiWidth = 0;
+		UINT uiHeight = 0;
+		UINT uiChannel = 0;								//3 or 4, 0 when decoding failed
+		std::unique_ptr<UCHAR, void(*)(void*)> pPixels{ nullptr, &ImageDecoder::FreePixels };
+
+		bool IsValid() const { return pPixels != nullptr; }
+		size_t GetRGBASize() const { return static_cast<size_t>(uiWidth) * uiHeight * 4; }
+	};
+
+	struct BenchmarkResult
+	{
+		UINT uiThreadCount;
+		ImageSimdLevel level;
+		float fDecodeMBPerSecond;						//decoded bytes per second
+		float fExpandMBPerSecond;						//RGBA bytes written per second
+		bool bMatchScalar;
+	};
+
+public:
+	//uiThreadCount 0 uses every hardware thread, the result keeps the order of vecEncoded
+	static std::vector<DecodedImage> DecodeBatch(const std::vector<std::span<const UCHAR>>& vecEncoded, UINT uiThreadCount = 0);
+	static DecodedImage Decode(std::span<const UCHAR> encoded);
+
+	//Writes GetRGBASize() bytes of RGBA8 to pDst with the best SIMD level the CPU supports
+	static void WriteRGBA(const DecodedImage& image, UCHAR* pDst);
+	static void ExpandRGBToRGBA(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount, ImageSimdLevel level);
+
+	static ImageSimdLevel GetMaxSupportedSimdLevel();
+	static const char* GetSimdLevelName(ImageSimdLevel level);
+
+	//Encodes uiImageCount synthetic RGB png images in memory, then for every thread count decodes them all and
+	//expands them with every supported SIMD level; logs MB/s and whether the SIMD output equals the scalar one
+	static std::vector<BenchmarkResult> RunBenchmark(const std::vector<UINT>& vecThreadCount, UINT uiImageCount = 16, UINT uiImageSize = 1024);
+
+private:
+	static void FreePixels(void* pPixels);
+	static void ParallelFor(size_t count, UINT uiThreadCount, const std::function<void(size_t)>& func);
+};
@@ -0,0 +1,26 @@
+#include "ImageDecoder.h"
+
+#include <immintrin.h>
+
+//Built with /arch:AVX2 (premake5.lua), only called after ImageDecoder::GetMaxSupportedSimdLevel() reports AVX2
+void DZW_ImageKernel::ExpandRGBToRGBAAVX2(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount)
+{
+	//vpshufb works per 128 bit lane, so each lane gets its own 12 byte group of four pixels
+	const __m256i shuffle = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+	//Eight pixels per iteration, the upper lane load reads 4 bytes past its group
+	size_t i = 0;
+	for (; i + 10 <= pixelCount; i += 8)
+	{
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 3));
+		__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 3 + 12));
+		__m256i rgb = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		__m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i * 4), rgba);
+	}
+
+	DZW_ImageKernel::ExpandRGBToRGBAScalar(pSrc + i * 3, pDst + i * 4, pixelCount - i);
+}
@@ -0,0 +1,22 @@
+#include "ImageDecoder.h"
+
+#include <tmmintrin.h>
+
+//Only called after ImageDecoder::GetMaxSupportedSimdLevel() reports SSSE3
+void DZW_ImageKernel::ExpandRGBToRGBASSSE3(const UCHAR* pSrc, UCHAR* pDst, size_t pixelCount)
+{
+	//Four pixels per 16 byte load, the last 4 loaded bytes belong to the next group
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+	//Stop while 16 bytes can still be read, the tail is done by the scalar kernel
+	size_t i = 0;
+	for (; i + 6 <= pixelCount; i += 4)
+	{
+		__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 3));
+		__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 4), rgba);
+	}
+
+	DZW_ImageKernel::ExpandRGBToRGBAScalar(pSrc + i * 3, pDst + i * 4, pixelCount - i);
+}
@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::filesystem::path& filepath)
+{
+	Close();
+
+	HANDLE hFile = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (hMapping == nullptr)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (pView == nullptr)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+	m_pData = static_cast<const UCHAR*>(pView);
+	m_Size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	if (m_hFile)
+		CloseHandle(m_hFile);
+
+	m_pData = nullptr;
+	m_Size = 0;
+	m_hMapping = nullptr;
+	m_hFile = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& filepath)
+{
+	Close();
+
+	int nFile = open(filepath.c_str(), O_RDONLY);
+	if (nFile < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(nFile, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(nFile);
+		return false;
+	}
+
+	void* pView = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, nFile, 0);
+	if (pView == MAP_FAILED)
+	{
+		close(nFile);
+		return false;
+	}
+
+	m_nFile = nFile;
+	m_pData = static_cast<const UCHAR*>(pView);
+	m_Size = static_cast<size_t>(fileStat.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+		munmap(const_cast<UCHAR*>(m_pData), m_Size);
+	if (m_nFile >= 0)
+		close(m_nFile);
+
+	m_pData = nullptr;
+	m_Size = 0;
+	m_nFile = -1;
+}
+
+#endif
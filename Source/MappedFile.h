@@ -0,0 +1,33 @@
+#pragma once
+#include "Core.h"
+
+//Read-only memory mapping of a whole file, the mapping lives until Close or destruction
+//Pages are faulted in by the OS on first access, so copying a sub range only reads that range from disk
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::filesystem::path& filepath) { Open(filepath); }
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//Empty files can not be mapped and fail like missing ones
+	bool Open(const std::filesystem::path& filepath);
+	void Close();
+
+	bool IsOpen() const { return m_pData != nullptr; }
+	const UCHAR* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_Size; }
+
+private:
+	const UCHAR* m_pData = nullptr;
+	size_t m_Size = 0;
+#ifdef _WIN32
+	void* m_hFile = nullptr;
+	void* m_hMapping = nullptr;
+#else
+	int m_nFile = -1;
+#endif
+};
@@ -0,0 +1,416 @@
+#include "OrbitSystem.h"
+
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	constexpr double PI = 3.14159265358979323846;
+	constexpr double TWO_PI = 2.0 * PI;
+
+	//Wraps to [-pi, pi], the Kepler solver starter relies on this range
+	inline double WrapAngle(double dAngle)
+	{
+		return dAngle - TWO_PI * std::floor((dAngle + PI) / TWO_PI);
+	}
+
+	//SSE2 is part of x64, so the double kernels below need neither extra compiler flags nor a runtime dispatch
+	inline __m128d SelectSSE2(__m128d mask, __m128d a, __m128d b)
+	{
+		return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+	}
+
+	inline __m128d IntBitMaskSSE2(__m128i q, int nBit)
+	{
+		//q holds two int32 lanes, widen each to a 64 bit mask
+		__m128i bit = _mm_set1_epi32(nBit);
+		__m128i mask = _mm_cmpeq_epi32(_mm_and_si128(_mm_shuffle_epi32(q, _MM_SHUFFLE(1, 1, 0, 0)), bit), bit);
+		return _mm_castsi128_pd(mask);
+	}
+
+	//Cephes sin/cos in double, pi/2 range reduction in three parts, accurate to a few ulp for the |x| < 2pi
+	//the solver feeds it (E stays within M +- e of a wrapped M)
+	inline void SinCosSSE2(__m128d x, __m128d& outSin, __m128d& outCos)
+	{
+		//cvtpd rounds to nearest under the default MXCSR mode
+		__m128i q = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(0.63661977236758134308)));
+		__m128d j = _mm_cvtepi32_pd(q);
+		__m128d r = _mm_sub_pd(x, _mm_mul_pd(j, _mm_set1_pd(1.57079625129699707031)));
+		r = _mm_sub_pd(r, _mm_mul_pd(j, _mm_set1_pd(7.54978941586159635336e-8)));
+		r = _mm_sub_pd(r, _mm_mul_pd(j, _mm_set1_pd(5.39030285815811905290e-15)));
+		__m128d z = _mm_mul_pd(r, r);
+
+		__m128d s = _mm_set1_pd(1.58962301576546568060e-10);
+		s = _mm_add_pd(_mm_mul_pd(s, z), _mm_set1_pd(-2.50507477628578072866e-8));
+		s = _mm_add_pd(_mm_mul_pd(s, z), _mm_set1_pd(2.75573136213857245213e-6));
+		s = _mm_add_pd(_mm_mul_pd(s, z), _mm_set1_pd(-1.98412698295895385996e-4));
+		s = _mm_add_pd(_mm_mul_pd(s, z), _mm_set1_pd(8.33333333332211858878e-3));
+		s = _mm_add_pd(_mm_mul_pd(s, z), _mm_set1_pd(-1.66666666666666307295e-1));
+		s = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), s));
+
+		__m128d c = _mm_set1_pd(-1.13585365213876817300e-11);
+		c = _mm_add_pd(_mm_mul_pd(c, z), _mm_set1_pd(2.08757008419747316778e-9));
+		c = _mm_add_pd(_mm_mul_pd(c, z), _mm_set1_pd(-2.75573141792967388112e-7));
+		c = _mm_add_pd(_mm_mul_pd(c, z), _mm_set1_pd(2.48015872888517045348e-5));
+		c = _mm_add_pd(_mm_mul_pd(c, z), _mm_set1_pd(-1.38888888888730564116e-3));
+		c = _mm_add_pd(_mm_mul_pd(c, z), _mm_set1_pd(4.16666666666665929218e-2));
+		c = _mm_add_pd(_mm_sub_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_set1_pd(0.5), z)), _mm_mul_pd(_mm_mul_pd(z, z), c));
+
+		//Quadrant q: odd quadrants swap sin/cos, sin flips in q = 2,3, cos flips in q = 1,2
+		__m128d bit0 = IntBitMaskSSE2(q, 1);
+		__m128d bit1 = IntBitMaskSSE2(q, 2);
+		__m128d signMask = _mm_set1_pd(-0.0);
+
+		outSin = _mm_xor_pd(SelectSSE2(bit0, c, s), _mm_and_pd(bit1, signMask));
+		outCos = _mm_xor_pd(SelectSSE2(bit0, s, c), _mm_and_pd(_mm_xor_pd(bit0, bit1), signMask));
+	}
+}
+
+UINT OrbitSystem::AddBody(const KeplerElements& elements, const BodyRotation& rotation, int nParent)
+{
+	UINT uiIdx = GetBodyCount();
+	ASSERT(nParent < static_cast<int>(uiIdx), "Orbit parent must be added before its children");
+	ASSERT(elements.fEccentricity >= 0.f && elements.fEccentricity < 1.f, "Only elliptic orbits are supported");
+
+	double dInclination = glm::radians(static_cast<double>(elements.fInclination));
+	double dNode = glm::radians(static_cast<double>(elements.fAscendingNode));
+	double dPeriapsis = glm::radians(static_cast<double>(elements.fArgumentOfPeriapsis));
+
+	double dCosI = std::cos(dInclination), dSinI = std::sin(dInclination);
+	double dCosO = std::cos(dNode), dSinO = std::sin(dNode);
+	double dCosW = std::cos(dPeriapsis), dSinW = std::sin(dPeriapsis);
+
+	//Perifocal basis in ecliptic coordinates (z = north)
+	glm::dvec3 P = { dCosW * dCosO - dSinW * dSinO * dCosI, dCosW * dSinO + dSinW * dCosO * dCosI, dSinW * dSinI };
+	glm::dvec3 Q = { -dSinW * dCosO - dCosW * dSinO * dCosI, -dSinW * dSinO + dCosW * dCosO * dCosI, dCosW * dSinI };
+
+	//Ecliptic -> scene: the ecliptic is the xz plane and north is +y
+	double dEccentricity = elements.fEccentricity;
+	double dA = elements.fSemiMajorAxis * m_dDistanceScale;
+	double dB = dA * std::sqrt(1.0 - dEccentricity * dEccentricity);
+
+	m_vecEccentricity.push_back(dEccentricity);
+	m_vecMeanAnomalyAtEpoch.push_back(glm::radians(static_cast<double>(elements.fMeanAnomalyAtEpoch)));
+	m_vecMeanMotion.push_back(elements.fPeriod > 0.f ? TWO_PI / elements.fPeriod : 0.0);
+	m_vecPx.push_back(dA * P.x);
+	m_vecPy.push_back(dA * P.z);
+	m_vecPz.push_back(-dA * P.y);
+	m_vecQx.push_back(dB * Q.x);
+	m_vecQy.push_back(dB * Q.z);
+	m_vecQz.push_back(-dB * Q.y);
+	m_vecParent.push_back(nParent);
+	if (nParent >= 0)
+		m_vecChildBody.push_back(uiIdx);
+
+	float fTilt = glm::radians(rotation.fAxisTiltDegree);
+	m_vecSpinRate.push_back(rotation.fRotationPeriod > 0.f ? TWO_PI / rotation.fRotationPeriod : 0.0);
+	m_vecTiltCos.push_back(std::cos(fTilt));
+	m_vecTiltSin.push_back(std::sin(fTilt));
+	m_vecScale.push_back(rotation.fScale);
+
+	m_vecMeanAnomaly.push_back(0.0);
+	m_vecEccentricAnomaly.push_back(0.0);
+	m_vecSpinAngle.push_back(0.f);
+	m_vecPositionX.push_back(0.0);
+	m_vecPositionY.push_back(0.0);
+	m_vecPositionZ.push_back(0.0);
+	m_vecModelMatrix.push_back(glm::mat4(1.f));
+
+	UpdateRange(uiIdx, uiIdx + 1);
+	return uiIdx;
+}
+
+void OrbitSystem::Clear()
+{
+	m_vecEccentricity.clear();
+	m_vecMeanAnomalyAtEpoch.clear();
+	m_vecMeanMotion.clear();
+	m_vecPx.clear(); m_vecPy.clear(); m_vecPz.clear();
+	m_vecQx.clear(); m_vecQy.clear(); m_vecQz.clear();
+	m_vecParent.clear();
+	m_vecChildBody.clear();
+
+	m_vecSpinRate.clear();
+	m_vecTiltCos.clear();
+	m_vecTiltSin.clear();
+	m_vecScale.clear();
+
+	m_vecMeanAnomaly.clear();
+	m_vecEccentricAnomaly.clear();
+	m_vecSpinAngle.clear();
+	m_vecPositionX.clear(); m_vecPositionY.clear(); m_vecPositionZ.clear();
+	m_vecModelMatrix.clear();
+}
+
+void OrbitSystem::Update(float fDeltaSeconds)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	if (!m_bPaused)
+		m_dSimulationDays += static_cast<double>(fDeltaSeconds) * m_fTimeWarp;
+
+	UpdateRange(0, GetBodyCount());
+
+	m_fLastUpdateMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void OrbitSystem::UpdateRange(UINT uiBegin, UINT uiEnd)
+{
+	if (uiBegin >= uiEnd)
+		return;
+
+	UINT uiCount = uiEnd - uiBegin;
+	double dDays = m_dSimulationDays;
+
+	//Mean anomaly and spin angle, the spin only feeds the float rotation so it is reduced before the cast
+	{
+		const double* pM0 = m_vecMeanAnomalyAtEpoch.data() + uiBegin;
+		const double* pN = m_vecMeanMotion.data() + uiBegin;
+		const double* pSpinRate = m_vecSpinRate.data() + uiBegin;
+		double* pM = m_vecMeanAnomaly.data() + uiBegin;
+		float* pSpin = m_vecSpinAngle.data() + uiBegin;
+		for (UINT i = 0; i < uiCount; ++i)
+		{
+			pM[i] = WrapAngle(pM0[i] + pN[i] * dDays);
+			pSpin[i] = static_cast<float>(WrapAngle(pSpinRate[i] * dDays));
+		}
+	}
+
+	SolveKepler(static_cast<KeplerSolver>(m_nSolver), m_vecMeanAnomaly.data() + uiBegin, m_vecEccentricity.data() + uiBegin,
+		m_vecEccentricAnomaly.data() + uiBegin, uiCount);
+
+	//r = a(cosE - e)P + b sinE Q
+	{
+		const double* pE = m_vecEccentricAnomaly.data() + uiBegin;
+		const double* pEcc = m_vecEccentricity.data() + uiBegin;
+		const double* pPx = m_vecPx.data() + uiBegin, * pPy = m_vecPy.data() + uiBegin, * pPz = m_vecPz.data() + uiBegin;
+		const double* pQx = m_vecQx.data() + uiBegin, * pQy = m_vecQy.data() + uiBegin, * pQz = m_vecQz.data() + uiBegin;
+		double* pX = m_vecPositionX.data() + uiBegin;
+		double* pY = m_vecPositionY.data() + uiBegin;
+		double* pZ = m_vecPositionZ.data() + uiBegin;
+		for (UINT i = 0; i < uiCount; ++i)
+		{
+			double dP = std::cos(pE[i]) - pEcc[i];
+			double dQ = std::sin(pE[i]);
+			pX[i] = pPx[i] * dP + pQx[i] * dQ;
+			pY[i] = pPy[i] * dP + pQy[i] * dQ;
+			pZ[i] = pPz[i] * dP + pQz[i] * dQ;
+		}
+	}
+
+	//Moons orbit their parent, parents always have a smaller index so they are already in place
+	auto iter = std::lower_bound(m_vecChildBody.begin(), m_vecChildBody.end(), uiBegin);
+	for (; iter != m_vecChildBody.end() && *iter < uiEnd; ++iter)
+	{
+		UINT uiChild = *iter;
+		UINT uiParent = static_cast<UINT>(m_vecParent[uiChild]);
+		m_vecPositionX[uiChild] += m_vecPositionX[uiParent];
+		m_vecPositionY[uiChild] += m_vecPositionY[uiParent];
+		m_vecPositionZ[uiChild] += m_vecPositionZ[uiParent];
+	}
+
+	//Model = Rz(-tilt) * Ry(spin) * S(scale), written column by column
+	//T(position - origin) is added per frame by WriteModelMatrices
+	{
+		const float* pSpin = m_vecSpinAngle.data() + uiBegin;
+		const float* pTiltCos = m_vecTiltCos.data() + uiBegin;
+		const float* pTiltSin = m_vecTiltSin.data() + uiBegin;
+		const float* pScale = m_vecScale.data() + uiBegin;
+		glm::mat4* pModel = m_vecModelMatrix.data() + uiBegin;
+		for (UINT i = 0; i < uiCount; ++i)
+		{
+			float fSpinCos = std::cos(pSpin[i]), fSpinSin = std::sin(pSpin[i]);
+			float fScale = pScale[i];
+			float* pMat = &pModel[i][0][0];
+
+			pMat[0] = fScale * fSpinCos * pTiltCos[i];
+			pMat[1] = -fScale * fSpinCos * pTiltSin[i];
+			pMat[2] = -fScale * fSpinSin;
+			pMat[3] = 0.f;
+
+			pMat[4] = fScale * pTiltSin[i];
+			pMat[5] = fScale * pTiltCos[i];
+			pMat[6] = 0.f;
+			pMat[7] = 0.f;
+
+			pMat[8] = fScale * fSpinSin * pTiltCos[i];
+			pMat[9] = -fScale * fSpinSin * pTiltSin[i];
+			pMat[10] = fScale * fSpinCos;
+			pMat[11] = 0.f;
+
+			pMat[12] = 0.f;
+			pMat[13] = 0.f;
+			pMat[14] = 0.f;
+			pMat[15] = 1.f;
+		}
+	}
+}
+
+void OrbitSystem::SolveKepler(KeplerSolver solver, const double* pMeanAnomaly, const double* pEccentricity, double* pEccentricAnomaly, UINT uiCount)
+{
+	//Kepler's equation f(E) = E - e*sin(E) - M = 0
+	//Fixed iteration count and no early exit keeps the loop branch free
+	//The starter E0 = M + 0.85e*sign(M) (Danby) converges for every e < 1 when M is in [-pi, pi]
+	//Two bodies per SSE2 register, the odd tail goes through the scalar loops below
+	const __m128d one = _mm_set1_pd(1.0);
+	const __m128d two = _mm_set1_pd(2.0);
+	const __m128d signMask = _mm_set1_pd(-0.0);
+	const __m128d danby = _mm_set1_pd(0.85);
+	bool bHalley = (solver == KEPLER_SOLVER_HALLEY);
+	UINT uiIteration = bHalley ? HALLEY_ITERATION : NEWTON_ITERATION;
+
+	UINT uiSimdEnd = uiCount & ~1u;
+	for (UINT i = 0; i < uiSimdEnd; i += 2)
+	{
+		__m128d M = _mm_loadu_pd(pMeanAnomaly + i);
+		__m128d e = _mm_loadu_pd(pEccentricity + i);
+		__m128d E = _mm_add_pd(M, _mm_mul_pd(_mm_mul_pd(danby, e), _mm_or_pd(_mm_and_pd(M, signMask), one)));
+		for (UINT uiIter = 0; uiIter < uiIteration; ++uiIter)
+		{
+			__m128d dSin, dCos;
+			SinCosSSE2(E, dSin, dCos);
+			__m128d eSin = _mm_mul_pd(e, dSin);
+			__m128d f = _mm_sub_pd(_mm_sub_pd(E, eSin), M);
+			__m128d f1 = _mm_sub_pd(one, _mm_mul_pd(e, dCos));
+			if (bHalley)
+				E = _mm_sub_pd(E, _mm_div_pd(_mm_mul_pd(two, _mm_mul_pd(f, f1)), _mm_sub_pd(_mm_mul_pd(two, _mm_mul_pd(f1, f1)), _mm_mul_pd(f, eSin))));
+			else
+				E = _mm_sub_pd(E, _mm_div_pd(f, f1));
+		}
+		_mm_storeu_pd(pEccentricAnomaly + i, E);
+	}
+
+	if (bHalley)
+	{
+		for (UINT i = uiSimdEnd; i < uiCount; ++i)
+		{
+			double M = pMeanAnomaly[i];
+			double e = pEccentricity[i];
+			double E = M + 0.85 * e * ((M < 0.0) ? -1.0 : 1.0);
+			for (UINT uiIter = 0; uiIter < HALLEY_ITERATION; ++uiIter)
+			{
+				double dSin = std::sin(E), dCos = std::cos(E);
+				double f = E - e * dSin - M;
+				double f1 = 1.0 - e * dCos;
+				double f2 = e * dSin;
+				E -= (2.0 * f * f1) / (2.0 * f1 * f1 - f * f2);
+			}
+			pEccentricAnomaly[i] = E;
+		}
+	}
+	else
+	{
+		for (UINT i = uiSimdEnd; i < uiCount; ++i)
+		{
+			double M = pMeanAnomaly[i];
+			double e = pEccentricity[i];
+			double E = M + 0.85 * e * ((M < 0.0) ? -1.0 : 1.0);
+			for (UINT uiIter = 0; uiIter < NEWTON_ITERATION; ++uiIter)
+			{
+				double f = E - e * std::sin(E) - M;
+				double f1 = 1.0 - e * std::cos(E);
+				E -= f / f1;
+			}
+			pEccentricAnomaly[i] = E;
+		}
+	}
+}
+
+float OrbitSystem::ComputeMaxResidual(UINT uiBegin, UINT uiEnd) const
+{
+	float fMaxResidual = 0.f;
+	for (UINT i = uiBegin; i < uiEnd; ++i)
+	{
+		double E = m_vecEccentricAnomaly[i];
+		fMaxResidual = std::max(fMaxResidual, static_cast<float>(std::abs(E - m_vecEccentricity[i] * std::sin(E) - m_vecMeanAnomaly[i])));
+	}
+	return fMaxResidual;
+}
+
+void OrbitSystem::WriteModelMatrices(void* pDst, size_t uiStride, UINT uiFirst, UINT uiCount, const glm::dvec3& origin) const
+{
+	ASSERT(uiFirst + uiCount <= GetBodyCount(), "Orbit body index out of range");
+
+	//One pass over every body: only the difference to the origin is rounded to float, so bodies near the
+	//camera keep full precision no matter how far both are from the sun
+	const double* pX = m_vecPositionX.data() + uiFirst;
+	const double* pY = m_vecPositionY.data() + uiFirst;
+	const double* pZ = m_vecPositionZ.data() + uiFirst;
+	auto pDstByte = static_cast<char*>(pDst);
+	for (UINT i = 0; i < uiCount; ++i)
+	{
+		float* pMat = reinterpret_cast<float*>(pDstByte + i * uiStride);
+		memcpy(pMat, &m_vecModelMatrix[uiFirst + i], sizeof(glm::mat4));
+		pMat[12] = static_cast<float>(pX[i] - origin.x);
+		pMat[13] = static_cast<float>(pY[i] - origin.y);
+		pMat[14] = static_cast<float>(pZ[i] - origin.z);
+	}
+}
+
+std::vector<OrbitSystem::BenchmarkResult> OrbitSystem::RunBenchmark(const std::vector<UINT>& vecBodyCount, UINT uiUpdateCount)
+{
+	std::vector<BenchmarkResult> vecResult;
+
+	for (auto uiBodyCount : vecBodyCount)
+	{
+		for (auto solver : { KEPLER_SOLVER_NEWTON, KEPLER_SOLVER_HALLEY })
+		{
+			//Main belt like population, fixed seed so runs are comparable
+			std::mt19937 randomEngine(20240501);
+			std::uniform_real_distribution<float> semiMajorAxis(2.1f, 3.3f);
+			std::uniform_real_distribution<float> eccentricity(0.f, 0.35f);
+			std::uniform_real_distribution<float> inclination(0.f, 20.f);
+			std::uniform_real_distribution<float> angle(0.f, 360.f);
+			std::uniform_real_distribution<float> rotationPeriod(0.1f, 2.f);
+
+			OrbitSystem system;
+			*system.GetSolver() = solver;
+			*system.GetTimeWarp() = 30.f;
+
+			for (UINT i = 0; i < uiBodyCount; ++i)
+			{
+				KeplerElements elements;
+				elements.fSemiMajorAxis = semiMajorAxis(randomEngine);
+				elements.fEccentricity = eccentricity(randomEngine);
+				elements.fInclination = inclination(randomEngine);
+				elements.fAscendingNode = angle(randomEngine);
+				elements.fArgumentOfPeriapsis = angle(randomEngine);
+				elements.fMeanAnomalyAtEpoch = angle(randomEngine);
+				elements.fPeriod = 365.25f * std::pow(elements.fSemiMajorAxis, 1.5f);
+
+				BodyRotation rotation;
+				rotation.fRotationPeriod = rotationPeriod(randomEngine);
+				rotation.fScale = 0.02f;
+
+				system.AddBody(elements, rotation);
+			}
+
+			//Warm up caches once before timing
+			system.Update(1.f / 60.f);
+
+			auto startTime = std::chrono::high_resolution_clock::now();
+			for (UINT i = 0; i < uiUpdateCount; ++i)
+			{
+				system.Update(1.f / 60.f);
+			}
+			float fTotalMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+			BenchmarkResult result;
+			result.solver = solver;
+			result.uiBodyCount = uiBodyCount;
+			result.fMsPerUpdate = fTotalMs / uiUpdateCount;
+			result.fBodiesPerMs = (result.fMsPerUpdate > 0.f) ? uiBodyCount / result.fMsPerUpdate : 0.f;
+			result.fMaxResidual = system.ComputeMaxResidual(0, uiBodyCount);
+			vecResult.push_back(result);
+
+			Log::Info("Orbit benchmark {} bodies, {}: {:.3f} ms/update, {:.0f} bodies/ms, max residual {:.2e}",
+				uiBodyCount, (solver == KEPLER_SOLVER_HALLEY) ? "Halley" : "Newton",
+				result.fMsPerUpdate, result.fBodiesPerMs, result.fMaxResidual);
+		}
+	}
+
+	return vecResult;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "Core.h"
+
+#include "glm/glm.hpp"
+
+//Classical orbital elements, angles are in degrees to match config.json
+struct KeplerElements
+{
+	float fSemiMajorAxis = 0.f;			//AU, relative to the parent body
+	float fEccentricity = 0.f;			//[0, 1)
+	float fInclination = 0.f;			//relative to the ecliptic
+	float fAscendingNode = 0.f;			//longitude of the ascending node
+	float fArgumentOfPeriapsis = 0.f;
+	float fMeanAnomalyAtEpoch = 0.f;
+	float fPeriod = 0.f;				//days, 0 = fixed in place
+};
+
+struct BodyRotation
+{
+	float fAxisTiltDegree = 0.f;
+	float fRotationPeriod = 0.f;		//days, 0 = not spinning
+	float fScale = 1.f;					//uniform model scale
+};
+
+//Keplerian propagation for planets and moons, every body is updated every frame
+//Bodies are stored as SoA, one Update() runs mean anomaly -> Kepler solve -> position -> model matrix
+//as flat loops over contiguous arrays with a fixed iteration count, so the compiler can vectorize them
+//The asteroid belt is propagated by AsteroidBelt (float SIMD kernels) or AsteroidBeltCompute, not here
+//Orbit state and positions are double so true scale distances stay exact far from the origin, the float
+//model matrices only leave the system camera relative (floating origin), see WriteModelMatrices
+class OrbitSystem
+{
+public:
+	enum KeplerSolver
+	{
+		KEPLER_SOLVER_NEWTON = 0,
+		KEPLER_SOLVER_HALLEY,
+	};
+
+	struct BenchmarkResult
+	{
+		KeplerSolver solver;
+		UINT uiBodyCount;
+		float fMsPerUpdate;
+		float fBodiesPerMs;
+		float fMaxResidual;				//max |E - e*sin(E) - M| of the last update
+	};
+
+	static constexpr UINT NEWTON_ITERATION = 6;
+	static constexpr UINT HALLEY_ITERATION = 4;
+
+public:
+	//Parents must be added before their children
+	UINT AddBody(const KeplerElements& elements, const BodyRotation& rotation, int nParent = -1);
+	void Clear();
+
+	//Advances the simulation clock by fDeltaSeconds * time warp and rebuilds the model matrices
+	void Update(float fDeltaSeconds);
+
+	//Writes model matrices relative to origin (usually the camera position) to a strided destination, e.g. the
+	//per instance vertex buffer of the planets, the subtraction happens in double before the cast to float
+	void WriteModelMatrices(void* pDst, size_t uiStride, UINT uiFirst, UINT uiCount, const glm::dvec3& origin) const;
+
+	glm::dvec3 GetPosition(UINT uiIdx) const { return { m_vecPositionX[uiIdx], m_vecPositionY[uiIdx], m_vecPositionZ[uiIdx] }; }
+
+	UINT GetBodyCount() const { return static_cast<UINT>(m_vecEccentricity.size()); }
+	float GetLastUpdateMs() const { return m_fLastUpdateMs; }
+	double GetSimulationDays() const { return m_dSimulationDays; }
+
+	float* GetTimeWarp() { return &m_fTimeWarp; }
+	bool* GetPaused() { return &m_bPaused; }
+	int* GetSolver() { return &m_nSolver; }
+
+	void SetDistanceScale(double dScale) { m_dDistanceScale = dScale; }
+	double GetDistanceScale() const { return m_dDistanceScale; }
+
+	//pMeanAnomaly must be wrapped to [-pi, pi]
+	//Solves two bodies per SSE2 register with a polynomial sin/cos, an odd last body takes the scalar path
+	static void SolveKepler(KeplerSolver solver, const double* pMeanAnomaly, const double* pEccentricity, double* pEccentricAnomaly, UINT uiCount);
+
+	//Propagates synthetic asteroid belts of each size with both solvers and logs bodies/ms
+	static std::vector<BenchmarkResult> RunBenchmark(const std::vector<UINT>& vecBodyCount, UINT uiUpdateCount = 64);
+
+private:
+	void UpdateRange(UINT uiBegin, UINT uiEnd);
+	float ComputeMaxResidual(UINT uiBegin, UINT uiEnd) const;
+
+private:
+	double m_dDistanceScale = 100.0;	//scene units per AU, applied in AddBody
+	float m_fTimeWarp = 1.f;			//simulated days per real second, negative runs backwards
+	bool m_bPaused = false;
+	int m_nSolver = KEPLER_SOLVER_HALLEY;
+
+	double m_dSimulationDays = 0.0;
+
+	float m_fLastUpdateMs = 0.f;
+
+	//Orbit, P/Q are the perifocal basis in scene space premultiplied by a and b
+	std::vector<double> m_vecEccentricity;
+	std::vector<double> m_vecMeanAnomalyAtEpoch;	//radians
+	std::vector<double> m_vecMeanMotion;			//radians per day
+	std::vector<double> m_vecPx, m_vecPy, m_vecPz;
+	std::vector<double> m_vecQx, m_vecQy, m_vecQz;
+	std::vector<int> m_vecParent;
+	std::vector<UINT> m_vecChildBody;			//bodies with a parent, in ascending order
+
+	//Rotation
+	std::vector<double> m_vecSpinRate;			//radians per day
+	std::vector<float> m_vecTiltCos, m_vecTiltSin;
+	std::vector<float> m_vecScale;
+
+	//Per frame
+	std::vector<double> m_vecMeanAnomaly;
+	std::vector<double> m_vecEccentricAnomaly;
+	std::vector<float> m_vecSpinAngle;
+	std::vector<double> m_vecPositionX, m_vecPositionY, m_vecPositionZ;
+	std::vector<glm::mat4> m_vecModelMatrix;	//rotation and scale only, the translation is filled in by WriteModelMatrices
+};
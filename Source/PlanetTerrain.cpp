@@ -0,0 +1,564 @@
+#include "PlanetTerrain.h"
+#include "Frustum.h"
+
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	constexpr float HALF_PI = 1.57079632679f;
+
+	UINT HashLattice(int nX, int nY, int nZ, UINT uiSeed)
+	{
+		UINT uiHash = static_cast<UINT>(nX) * 0x8da6b343u ^ static_cast<UINT>(nY) * 0xd8163841u ^ static_cast<UINT>(nZ) * 0xcb1ab31fu ^ uiSeed * 0x9e3779b9u;
+		uiHash ^= uiHash >> 16;
+		uiHash *= 0x7feb352du;
+		uiHash ^= uiHash >> 15;
+		uiHash *= 0x846ca68bu;
+		uiHash ^= uiHash >> 16;
+		return uiHash;
+	}
+
+	float ValueNoise(const glm::vec3& p, UINT uiSeed)
+	{
+		glm::vec3 cell = glm::floor(p);
+		glm::vec3 t = p - cell;
+		t = t * t * (3.f - 2.f * t);
+
+		int nX = static_cast<int>(cell.x), nY = static_cast<int>(cell.y), nZ = static_cast<int>(cell.z);
+		auto corner = [&](int dx, int dy, int dz)
+		{
+			return static_cast<float>(HashLattice(nX + dx, nY + dy, nZ + dz, uiSeed) & 0xffffff) / 16777215.f;
+		};
+
+		float x00 = glm::mix(corner(0, 0, 0), corner(1, 0, 0), t.x);
+		float x10 = glm::mix(corner(0, 1, 0), corner(1, 1, 0), t.x);
+		float x01 = glm::mix(corner(0, 0, 1), corner(1, 0, 1), t.x);
+		float x11 = glm::mix(corner(0, 1, 1), corner(1, 1, 1), t.x);
+		return glm::mix(glm::mix(x00, x10, t.y), glm::mix(x01, x11, t.y), t.z);
+	}
+}
+
+PlanetTerrain::~PlanetTerrain()
+{
+	Stop();
+}
+
+void PlanetTerrain::Start(UINT64 uiBudgetBytes, UINT uiFramesInFlight, UINT uiWorkerCount)
+{
+	Stop();
+
+	m_uiSlotCount = static_cast<UINT>(std::max<UINT64>(uiBudgetBytes / CHUNK_BYTES, 6 * MAX_BODY));
+	m_uiFramesInFlight = std::max(uiFramesInFlight, 1u);
+	m_uiFrame = 0;
+
+	m_mapResident.clear();
+	m_listLRU.clear();
+	m_vecDrawSlot.clear();
+	m_vecFreeSlot.resize(m_uiSlotCount);
+	for (UINT i = 0; i < m_uiSlotCount; ++i)
+	{
+		m_vecFreeSlot[i] = m_uiSlotCount - 1 - i;
+	}
+
+	if (uiWorkerCount == 0)
+		uiWorkerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+
+	m_bRunning = true;
+	for (UINT i = 0; i < uiWorkerCount; ++i)
+	{
+		m_vecWorker.emplace_back(&PlanetTerrain::WorkerThreadFunc, this);
+	}
+
+	Log::Info("Planet terrain: {} chunk slots ({:.1f} MB), {} worker threads", m_uiSlotCount,
+		static_cast<double>(m_uiSlotCount) * CHUNK_BYTES / (1024.0 * 1024.0), uiWorkerCount);
+}
+
+void PlanetTerrain::Stop()
+{
+	if (!m_bRunning)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_bRunning = false;
+		m_queueRequest = {};
+	}
+	m_RequestCondition.notify_all();
+
+	for (auto& worker : m_vecWorker)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+	m_vecWorker.clear();
+
+	m_setPending.clear();
+	m_vecFinished.clear();
+}
+
+UINT PlanetTerrain::AddBody(const BodyDesc& desc)
+{
+	ASSERT(m_vecBody.size() < MAX_BODY, "Too many terrain bodies");
+	ASSERT(m_vecWorker.empty(), "Terrain bodies must be added before Start");
+	m_vecBody.push_back(desc);
+	return static_cast<UINT>(m_vecBody.size() - 1);
+}
+
+std::vector<UINT> PlanetTerrain::BuildIndices()
+{
+	std::vector<UINT> vecIndex;
+	vecIndex.reserve((GRID_SIZE - 1) * (GRID_SIZE - 1) * 6 + 4 * (GRID_SIZE - 1) * 6);
+
+	//Counter clockwise seen from outside, see FaceToCube
+	for (UINT j = 0; j + 1 < GRID_SIZE; ++j)
+	{
+		for (UINT i = 0; i + 1 < GRID_SIZE; ++i)
+		{
+			UINT uiCorner = j * GRID_SIZE + i;
+			vecIndex.insert(vecIndex.end(), { uiCorner, uiCorner + 1, uiCorner + GRID_SIZE + 1 });
+			vecIndex.insert(vecIndex.end(), { uiCorner, uiCorner + GRID_SIZE + 1, uiCorner + GRID_SIZE });
+		}
+	}
+
+	//Skirts hang below the four edges and hide the cracks towards coarser neighbours, drawn double sided
+	for (UINT uiEdge = 0; uiEdge < 4; ++uiEdge)
+	{
+		UINT uiSkirt = GRID_SIZE * GRID_SIZE + uiEdge * GRID_SIZE;
+		for (UINT k = 0; k + 1 < GRID_SIZE; ++k)
+		{
+			auto edgeVertex = [uiEdge](UINT n)
+			{
+				switch (uiEdge)
+				{
+				case 0:		return n;									//v = 0
+				case 1:		return n * GRID_SIZE + GRID_SIZE - 1;		//u = 1
+				case 2:		return (GRID_SIZE - 1) * GRID_SIZE + n;		//v = 1
+				default:	return n * GRID_SIZE;						//u = 0
+				}
+			};
+			vecIndex.insert(vecIndex.end(), { edgeVertex(k), uiSkirt + k, edgeVertex(k + 1) });
+			vecIndex.insert(vecIndex.end(), { edgeVertex(k + 1), uiSkirt + k, uiSkirt + k + 1 });
+		}
+	}
+	return vecIndex;
+}
+
+UINT64 PlanetTerrain::MakeKey(UINT uiBody, UINT uiFace, UINT uiLevel, UINT uiX, UINT uiY)
+{
+	return static_cast<UINT64>(uiBody) | (static_cast<UINT64>(uiFace) << 4) | (static_cast<UINT64>(uiLevel) << 7)
+		| (static_cast<UINT64>(uiX) << 12) | (static_cast<UINT64>(uiY) << 38);
+}
+
+void PlanetTerrain::SplitKey(UINT64 uiKey, UINT& uiBody, UINT& uiFace, UINT& uiLevel, UINT& uiX, UINT& uiY)
+{
+	uiBody = static_cast<UINT>(uiKey & 0xf);
+	uiFace = static_cast<UINT>((uiKey >> 4) & 0x7);
+	uiLevel = static_cast<UINT>((uiKey >> 7) & 0x1f);
+	uiX = static_cast<UINT>((uiKey >> 12) & 0x3ffffff);
+	uiY = static_cast<UINT>((uiKey >> 38) & 0x3ffffff);
+}
+
+glm::vec3 PlanetTerrain::FaceToCube(UINT uiFace, float fU, float fV)
+{
+	//cross(d/du, d/dv) points outwards on every face, so the grid winding is the same for all six
+	switch (uiFace)
+	{
+	case 0:		return { 1.f, fV, -fU };
+	case 1:		return { -1.f, fV, fU };
+	case 2:		return { fU, 1.f, -fV };
+	case 3:		return { fU, -1.f, fV };
+	case 4:		return { fU, fV, 1.f };
+	default:	return { -fU, fV, -1.f };
+	}
+}
+
+bool PlanetTerrain::LoadHeightTile(const std::filesystem::path& tilePath, std::vector<float>& vecHeight)
+{
+	std::error_code errorCode;
+	if (!std::filesystem::exists(tilePath, errorCode))
+		return false;
+
+	std::ifstream file(tilePath, std::ios::binary);
+	std::vector<uint16_t> vecSample(GRID_SIZE * GRID_SIZE);
+	file.read(reinterpret_cast<char*>(vecSample.data()), vecSample.size() * sizeof(uint16_t));
+	if (file.gcount() != static_cast<std::streamsize>(vecSample.size() * sizeof(uint16_t)))
+	{
+		Log::Warn("Terrain tile {} is truncated, using the procedural fallback", tilePath.string());
+		return false;
+	}
+
+	vecHeight.resize(vecSample.size());
+	for (size_t i = 0; i < vecSample.size(); ++i)
+	{
+		vecHeight[i] = vecSample[i] / 65535.f;
+	}
+	return true;
+}
+
+float PlanetTerrain::FractalHeight(const glm::vec3& dir, UINT uiSeed, UINT uiOctave)
+{
+	float fHeight = 0.f;
+	float fAmplitude = 0.5f;
+	float fNormalize = 0.f;
+	glm::vec3 p = dir * 4.f;
+	for (UINT i = 0; i < uiOctave; ++i)
+	{
+		fHeight += ValueNoise(p, uiSeed + i) * fAmplitude;
+		fNormalize += fAmplitude;
+		fAmplitude *= 0.5f;
+		p *= 2.f;
+	}
+	return fHeight / fNormalize;
+}
+
+PlanetTerrain::Chunk PlanetTerrain::BuildChunk(UINT64 uiKey, const BodyDesc& body)
+{
+	UINT uiBody, uiFace, uiLevel, uiX, uiY;
+	SplitKey(uiKey, uiBody, uiFace, uiLevel, uiX, uiY);
+
+	Chunk chunk;
+	chunk.uiKey = uiKey;
+	chunk.vecVertex.resize(CHUNK_VERTEX_COUNT);
+
+	float fTileSize = 2.f / static_cast<float>(1u << uiLevel);
+	auto gridDir = [&](int i, int j)
+	{
+		float fU = -1.f + (uiX + i / static_cast<float>(GRID_SIZE - 1)) * fTileSize;
+		float fV = -1.f + (uiY + j / static_cast<float>(GRID_SIZE - 1)) * fTileSize;
+		return glm::normalize(FaceToCube(uiFace, fU, fV));
+	};
+
+	auto tileDir = body.tileDir / std::to_string(uiFace) / std::to_string(uiLevel);
+	std::vector<float> vecHeight;
+	bool bFromFile = LoadHeightTile(tileDir / std::format("{}_{}.r16", uiX, uiY), vecHeight);
+
+	//Heights on a one sample apron around the grid, so the border normals are central differences like the interior
+	//and both chunks sharing an edge arrive at the same normal, the corners of the apron are never read
+	constexpr int APRON_SIZE = GRID_SIZE + 2;
+	constexpr int LAST = GRID_SIZE - 1;
+	std::vector<float> vecApron(APRON_SIZE * APRON_SIZE, 0.f);
+	auto apron = [&](int i, int j) -> float& { return vecApron[(j + 1) * APRON_SIZE + (i + 1)]; };
+
+	//Finer levels add octaves, the noise is a function of the direction so shared edges match exactly
+	UINT uiOctave = std::min(4 + uiLevel, 16u);
+	if (!bFromFile)
+	{
+		for (int j = -1; j <= LAST + 1; ++j)
+		{
+			for (int i = -1; i <= LAST + 1; ++i)
+			{
+				bool bCorner = (i < 0 || i > LAST) && (j < 0 || j > LAST);
+				if (!bCorner)
+					apron(i, j) = FractalHeight(gridDir(i, j), body.uiSeed, uiOctave);
+			}
+		}
+	}
+	else
+	{
+		for (int j = 0; j <= LAST; ++j)
+		{
+			for (int i = 0; i <= LAST; ++i)
+			{
+				apron(i, j) = vecHeight[j * GRID_SIZE + i];
+			}
+		}
+
+		//Tiles share their edge samples, so the sample beyond the border is the second row of the neighbour on the same face
+		//Across a cube face or without the neighbour tile the border is extrapolated, which falls back to a one sided difference
+		int nTileCount = 1 << uiLevel;
+		std::vector<float> vecNeighbour;
+		auto loadNeighbour = [&](int dx, int dy)
+		{
+			int nX = static_cast<int>(uiX) + dx, nY = static_cast<int>(uiY) + dy;
+			if (nX < 0 || nY < 0 || nX >= nTileCount || nY >= nTileCount)
+				return false;
+			return LoadHeightTile(tileDir / std::format("{}_{}.r16", nX, nY), vecNeighbour);
+		};
+
+		bool bLeft = loadNeighbour(-1, 0);
+		for (int j = 0; j <= LAST; ++j)
+			apron(-1, j) = bLeft ? vecNeighbour[j * GRID_SIZE + LAST - 1] : 2.f * apron(0, j) - apron(1, j);
+		bool bRight = loadNeighbour(1, 0);
+		for (int j = 0; j <= LAST; ++j)
+			apron(LAST + 1, j) = bRight ? vecNeighbour[j * GRID_SIZE + 1] : 2.f * apron(LAST, j) - apron(LAST - 1, j);
+		bool bDown = loadNeighbour(0, -1);
+		for (int i = 0; i <= LAST; ++i)
+			apron(i, -1) = bDown ? vecNeighbour[(LAST - 1) * GRID_SIZE + i] : 2.f * apron(i, 0) - apron(i, 1);
+		bool bUp = loadNeighbour(0, 1);
+		for (int i = 0; i <= LAST; ++i)
+			apron(i, LAST + 1) = bUp ? vecNeighbour[GRID_SIZE + i] : 2.f * apron(i, LAST) - apron(i, LAST - 1);
+	}
+
+	std::vector<glm::vec3> vecApronPos(APRON_SIZE * APRON_SIZE);
+	for (int j = -1; j <= LAST + 1; ++j)
+	{
+		for (int i = -1; i <= LAST + 1; ++i)
+		{
+			vecApronPos[(j + 1) * APRON_SIZE + (i + 1)] = gridDir(i, j) * (1.f + apron(i, j) * body.fHeightScale);
+		}
+	}
+	auto apronPos = [&](int i, int j) { return vecApronPos[(j + 1) * APRON_SIZE + (i + 1)]; };
+
+	glm::vec3 minPos(FLT_MAX), maxPos(-FLT_MAX);
+	for (int j = 0; j <= LAST; ++j)
+	{
+		for (int i = 0; i <= LAST; ++i)
+		{
+			glm::vec3 pos = apronPos(i, j);
+			TerrainVertex& vertex = chunk.vecVertex[j * GRID_SIZE + i];
+			vertex.pos = pos;
+			vertex.normal = glm::normalize(glm::cross(apronPos(i + 1, j) - apronPos(i - 1, j), apronPos(i, j + 1) - apronPos(i, j - 1)));
+			minPos = glm::min(minPos, pos);
+			maxPos = glm::max(maxPos, pos);
+		}
+	}
+
+	//Skirt depth scales with the chunk, a tenth of its edge is far more than the height step to a coarser neighbour
+	float fSkirtDepth = fTileSize * HALF_PI * 0.5f * 0.1f;
+	for (UINT uiEdge = 0; uiEdge < 4; ++uiEdge)
+	{
+		for (UINT k = 0; k < GRID_SIZE; ++k)
+		{
+			UINT uiEdgeIdx = uiEdge == 0 ? k : uiEdge == 1 ? k * GRID_SIZE + GRID_SIZE - 1 : uiEdge == 2 ? (GRID_SIZE - 1) * GRID_SIZE + k : k * GRID_SIZE;
+			TerrainVertex vertex = chunk.vecVertex[uiEdgeIdx];
+			vertex.pos -= glm::normalize(vertex.pos) * fSkirtDepth;
+			chunk.vecVertex[GRID_SIZE * GRID_SIZE + uiEdge * GRID_SIZE + k] = vertex;
+		}
+	}
+
+	chunk.center = (minPos + maxPos) * 0.5f;
+	chunk.fRadius = glm::length(maxPos - minPos) * 0.5f;
+	return chunk;
+}
+
+void PlanetTerrain::WorkerThreadFunc()
+{
+	while (true)
+	{
+		UINT64 uiKey = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_RequestMutex);
+			m_RequestCondition.wait(lock, [this]() { return !m_bRunning || !m_queueRequest.empty(); });
+			if (!m_bRunning)
+				return;
+
+			uiKey = m_queueRequest.top().uiKey;
+			m_queueRequest.pop();
+		}
+
+		UINT uiBody = static_cast<UINT>(uiKey & 0xf);
+		Chunk chunk = BuildChunk(uiKey, m_vecBody[uiBody]);
+
+		std::lock_guard<std::mutex> lock(m_FinishedMutex);
+		m_vecFinished.push_back(std::move(chunk));
+	}
+}
+
+void PlanetTerrain::Request(UINT64 uiKey)
+{
+	if (m_setPending.contains(uiKey))
+		return;
+
+	UINT uiBody, uiFace, uiLevel, uiX, uiY;
+	SplitKey(uiKey, uiBody, uiFace, uiLevel, uiX, uiY);
+
+	m_setPending.insert(uiKey);
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_queueRequest.push({ uiLevel, uiKey });
+	}
+	m_RequestCondition.notify_one();
+}
+
+const PlanetTerrain::Entry* PlanetTerrain::Touch(UINT64 uiKey)
+{
+	auto iter = m_mapResident.find(uiKey);
+	if (iter == m_mapResident.end())
+		return nullptr;
+
+	iter->second.uiLastUsedFrame = m_uiFrame;
+	m_listLRU.splice(m_listLRU.begin(), m_listLRU, iter->second.lruIter);
+	return &iter->second;
+}
+
+bool PlanetTerrain::AllocateSlot(UINT& uiSlot)
+{
+	if (!m_vecFreeSlot.empty())
+	{
+		uiSlot = m_vecFreeSlot.back();
+		m_vecFreeSlot.pop_back();
+		return true;
+	}
+
+	//Least recently drawn chunk that no frame in flight can still read, roots stay resident
+	for (auto iter = m_listLRU.rbegin(); iter != m_listLRU.rend(); ++iter)
+	{
+		auto& entry = m_mapResident.at(*iter);
+		if (entry.uiLastUsedFrame + m_uiFramesInFlight >= m_uiFrame)
+			return false;
+
+		UINT uiBody, uiFace, uiLevel, uiX, uiY;
+		SplitKey(*iter, uiBody, uiFace, uiLevel, uiX, uiY);
+		if (uiLevel == 0)
+			continue;
+
+		uiSlot = entry.uiSlot;
+		m_mapResident.erase(*iter);
+		m_listLRU.erase(std::next(iter).base());
+		return true;
+	}
+	return false;
+}
+
+void PlanetTerrain::DrainFinishedChunks(TerrainVertex* pVertexPool)
+{
+	std::vector<Chunk> vecFinished;
+	{
+		std::lock_guard<std::mutex> lock(m_FinishedMutex);
+		UINT uiCount = std::min(static_cast<UINT>(m_vecFinished.size()), MAX_UPLOAD_PER_FRAME);
+		vecFinished.assign(std::make_move_iterator(m_vecFinished.begin()), std::make_move_iterator(m_vecFinished.begin() + uiCount));
+		m_vecFinished.erase(m_vecFinished.begin(), m_vecFinished.begin() + uiCount);
+	}
+
+	for (auto& chunk : vecFinished)
+	{
+		m_setPending.erase(chunk.uiKey);
+
+		UINT uiSlot = 0;
+		if (m_mapResident.contains(chunk.uiKey) || !AllocateSlot(uiSlot))
+			continue; //cache full of chunks still in use, it is requested again next frame
+
+		//The slot is not referenced by any frame in flight, a plain write into the coherent mapping is enough
+		memcpy(pVertexPool + static_cast<size_t>(uiSlot) * CHUNK_VERTEX_COUNT, chunk.vecVertex.data(), CHUNK_BYTES);
+
+		m_listLRU.push_front(chunk.uiKey);
+		m_mapResident[chunk.uiKey] = { uiSlot, m_uiFrame, chunk.center, chunk.fRadius, m_listLRU.begin() };
+	}
+}
+
+bool PlanetTerrain::Update(int nBody, const glm::mat4& model, const glm::mat4& viewProj, float fPixelScale, TerrainVertex* pVertexPool)
+{
+	++m_uiFrame;
+	m_vecDrawSlot.clear();
+	m_uiDeepestLevel = 0;
+
+	//Only the chunks wanted this frame stay queued, the ones already handed to a worker still finish
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		while (!m_queueRequest.empty())
+		{
+			m_setPending.erase(m_queueRequest.top().uiKey);
+			m_queueRequest.pop();
+		}
+	}
+
+	DrainFinishedChunks(pVertexPool);
+
+	if (nBody < 0 || nBody >= static_cast<int>(m_vecBody.size()) || !m_bRunning)
+		return false;
+
+	UINT uiBody = static_cast<UINT>(nBody);
+	bool bReady = true;
+	for (UINT uiFace = 0; uiFace < 6; ++uiFace)
+	{
+		UINT64 uiKey = MakeKey(uiBody, uiFace, 0, 0, 0);
+		if (!Touch(uiKey))
+		{
+			Request(uiKey);
+			bReady = false;
+		}
+	}
+	if (!bReady)
+		return false;
+
+	//The camera sits at the origin of the camera relative space
+	m_CameraLocal = glm::vec3(glm::inverse(model) * glm::vec4(0.f, 0.f, 0.f, 1.f));
+	DZW_Frustum::ExtractFrustumPlanes(viewProj * model, m_aryFrustumPlane);
+	m_fPixelScale = fPixelScale;
+
+	//Anything farther from the view direction than the horizon of the undisplaced sphere plus the horizon
+	//of the highest possible peak is hidden behind the planet
+	float fCameraDistance = glm::length(m_CameraLocal);
+	m_fHorizonAngle = fCameraDistance > 1.f
+		? std::acos(1.f / fCameraDistance) + std::acos(1.f / (1.f + m_vecBody[uiBody].fHeightScale))
+		: FLT_MAX;
+
+	//No new requests while every slot holds a chunk a frame in flight still draws, they would only be built and dropped
+	m_bCacheSaturated = m_vecFreeSlot.empty() && !m_listLRU.empty()
+		&& m_mapResident.at(m_listLRU.back()).uiLastUsedFrame + m_uiFramesInFlight >= m_uiFrame;
+
+	for (UINT uiFace = 0; uiFace < 6; ++uiFace)
+	{
+		SelectNode(uiBody, uiFace, 0, 0, 0, m_mapResident.at(MakeKey(uiBody, uiFace, 0, 0, 0)));
+	}
+	return true;
+}
+
+void PlanetTerrain::SelectNode(UINT uiBody, UINT uiFace, UINT uiLevel, UINT uiX, UINT uiY, const Entry& entry)
+{
+	//Planes are normalized in planet local space because the model matrix is folded in
+	for (const auto& plane : m_aryFrustumPlane)
+	{
+		if (glm::dot(glm::vec3(plane), entry.center) + plane.w < -entry.fRadius)
+			return;
+	}
+
+	if (m_fHorizonAngle < FLT_MAX)
+	{
+		float fCenterDistance = glm::length(entry.center);
+		float fCos = glm::dot(entry.center, m_CameraLocal) / std::max(fCenterDistance * glm::length(m_CameraLocal), 1e-6f);
+		float fAngle = std::acos(std::clamp(fCos, -1.f, 1.f));
+		float fAngularRadius = entry.fRadius < fCenterDistance ? std::asin(entry.fRadius / fCenterDistance) : HALF_PI * 2.f;
+		if (fAngle - fAngularRadius > m_fHorizonAngle)
+			return;
+	}
+
+	//Vertex spacing of this level projected at the nearest point of the bounding sphere
+	float fSpacing = HALF_PI / static_cast<float>((GRID_SIZE - 1) << uiLevel);
+	float fDistance = std::max(glm::length(m_CameraLocal - entry.center) - entry.fRadius, 1e-6f);
+	bool bSplit = uiLevel < MAX_LEVEL && fSpacing * m_fPixelScale / fDistance > m_fMaxScreenSpaceError;
+
+	if (bSplit)
+	{
+		//Only descend when all four children are resident, otherwise keep drawing this chunk meanwhile
+		std::array<const Entry*, 4> aryChild;
+		bool bChildrenReady = true;
+		for (UINT uiChild = 0; uiChild < 4; ++uiChild)
+		{
+			UINT64 uiKey = MakeKey(uiBody, uiFace, uiLevel + 1, uiX * 2 + (uiChild & 1), uiY * 2 + (uiChild >> 1));
+			aryChild[uiChild] = Touch(uiKey);
+			if (!aryChild[uiChild])
+			{
+				if (!m_bCacheSaturated)
+					Request(uiKey);
+				bChildrenReady = false;
+			}
+		}
+
+		if (bChildrenReady)
+		{
+			for (UINT uiChild = 0; uiChild < 4; ++uiChild)
+			{
+				SelectNode(uiBody, uiFace, uiLevel + 1, uiX * 2 + (uiChild & 1), uiY * 2 + (uiChild >> 1), *aryChild[uiChild]);
+			}
+			return;
+		}
+	}
+
+	m_vecDrawSlot.push_back(entry.uiSlot);
+	m_uiDeepestLevel = std::max(m_uiDeepestLevel, uiLevel);
+}
+
+PlanetTerrain::Stats PlanetTerrain::GetStats() const
+{
+	Stats stats;
+	stats.uiDrawChunkCount = static_cast<UINT>(m_vecDrawSlot.size());
+	stats.uiResidentChunkCount = static_cast<UINT>(m_mapResident.size());
+	stats.uiSlotCount = m_uiSlotCount;
+	stats.uiPendingCount = static_cast<UINT>(m_setPending.size());
+	stats.uiDeepestLevel = m_uiDeepestLevel;
+	return stats;
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "Core.h"
+
+#include "glm/glm.hpp"
+
+#include <list>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+//Planet local space: the undisplaced sphere has radius 1, heights push vertices outwards
+struct TerrainVertex
+{
+	glm::vec3 pos;
+	glm::vec3 normal;
+};
+
+//Cube sphere quadtree terrain for the planet the camera is close to
+//Every node is a GRID_SIZE x GRID_SIZE chunk with a skirt, its heights come from
+//<TileDir>/<face>/<level>/<x>_<y>.r16 (GRID_SIZE^2 little endian uint16, edges shared with the neighbours)
+//or, when that file does not exist, from a seeded fractal noise. Tiles are loaded and turned into vertices
+//on worker threads, the render thread only copies finished chunks into fixed size slots of the vertex pool
+//Resident chunks live in an LRU cache whose byte budget also sizes the vertex pool, a slot is only reused once
+//its chunk has not been drawn for more than the frames in flight
+class PlanetTerrain
+{
+public:
+	static constexpr UINT GRID_SIZE = 33;
+	static constexpr UINT CHUNK_VERTEX_COUNT = GRID_SIZE * GRID_SIZE + 4 * GRID_SIZE;
+	static constexpr UINT CHUNK_BYTES = CHUNK_VERTEX_COUNT * sizeof(TerrainVertex);
+	static constexpr UINT MAX_LEVEL = 14;
+	static constexpr UINT MAX_BODY = 16;
+	static constexpr UINT MAX_UPLOAD_PER_FRAME = 32;
+
+	struct BodyDesc
+	{
+		std::filesystem::path tileDir;
+		float fHeightScale = 0.f;		//height of a full scale tile sample, in planet radii
+		UINT uiSeed = 0;				//fractal noise fallback
+	};
+
+	struct Stats
+	{
+		UINT uiDrawChunkCount;
+		UINT uiResidentChunkCount;
+		UINT uiSlotCount;
+		UINT uiPendingCount;
+		UINT uiDeepestLevel;
+	};
+
+public:
+	PlanetTerrain() = default;
+	~PlanetTerrain();
+
+	PlanetTerrain(const PlanetTerrain&) = delete;
+	PlanetTerrain& operator=(const PlanetTerrain&) = delete;
+
+	//uiBudgetBytes bounds the resident chunks (and so the vertex pool), uiWorkerCount == 0 picks from the core count
+	void Start(UINT64 uiBudgetBytes, UINT uiFramesInFlight, UINT uiWorkerCount = 0);
+	void Stop();
+
+	//Returns the terrain body index used by Update
+	UINT AddBody(const BodyDesc& desc);
+
+	UINT GetSlotCount() const { return m_uiSlotCount; }
+
+	//Shared by every chunk: the grid triangles followed by the skirt quads, draw with vertexOffset = slot * CHUNK_VERTEX_COUNT
+	static std::vector<UINT> BuildIndices();
+
+	//Called once per frame on the render thread, nBody < 0 only drains the worker results
+	//model is the planet model matrix (camera relative), viewProj the matching camera relative view projection,
+	//fPixelScale = |proj[1][1]| * height / 2; finished chunks are copied into pVertexPool (GetSlotCount() slots)
+	//Returns false until the six root chunks of the body are resident, the sphere mesh has to be drawn until then
+	bool Update(int nBody, const glm::mat4& model, const glm::mat4& viewProj, float fPixelScale, TerrainVertex* pVertexPool);
+
+	const std::vector<UINT>& GetDrawSlots() const { return m_vecDrawSlot; }
+	Stats GetStats() const;
+
+	float* GetMaxScreenSpaceError() { return &m_fMaxScreenSpaceError; }
+
+private:
+	struct Chunk
+	{
+		UINT64 uiKey = 0;
+		std::vector<TerrainVertex> vecVertex;
+		glm::vec3 center = glm::vec3(0.f);	//bounding sphere in planet local space
+		float fRadius = 0.f;
+	};
+
+	struct Entry
+	{
+		UINT uiSlot;
+		UINT64 uiLastUsedFrame;
+		glm::vec3 center;
+		float fRadius;
+		std::list<UINT64>::iterator lruIter;
+	};
+
+	struct ChunkRequest
+	{
+		UINT uiLevel;
+		UINT64 uiKey;
+		bool operator<(const ChunkRequest& other) const { return uiLevel > other.uiLevel; } //coarse levels first
+	};
+
+	static UINT64 MakeKey(UINT uiBody, UINT uiFace, UINT uiLevel, UINT uiX, UINT uiY);
+	static void SplitKey(UINT64 uiKey, UINT& uiBody, UINT& uiFace, UINT& uiLevel, UINT& uiX, UINT& uiY);
+	static glm::vec3 FaceToCube(UINT uiFace, float fU, float fV);
+
+	static bool LoadHeightTile(const std::filesystem::path& tilePath, std::vector<float>& vecHeight);
+	static float FractalHeight(const glm::vec3& dir, UINT uiSeed, UINT uiOctave);
+	static Chunk BuildChunk(UINT64 uiKey, const BodyDesc& body);
+
+	void WorkerThreadFunc();
+	void Request(UINT64 uiKey);
+	const Entry* Touch(UINT64 uiKey);
+	void DrainFinishedChunks(TerrainVertex* pVertexPool);
+	bool AllocateSlot(UINT& uiSlot);
+	void SelectNode(UINT uiBody, UINT uiFace, UINT uiLevel, UINT uiX, UINT uiY, const Entry& entry);
+
+private:
+	std::vector<BodyDesc> m_vecBody;
+
+	UINT m_uiSlotCount = 0;
+	UINT m_uiFramesInFlight = 1;
+	UINT64 m_uiFrame = 0;
+	float m_fMaxScreenSpaceError = 4.f;	//pixels between neighbouring vertices before a chunk splits
+
+	//render thread only
+	std::unordered_map<UINT64, Entry> m_mapResident;
+	std::list<UINT64> m_listLRU;			//front = most recently drawn
+	std::vector<UINT> m_vecFreeSlot;
+	std::vector<UINT> m_vecDrawSlot;
+	UINT m_uiDeepestLevel = 0;
+
+	//per Update selection state
+	glm::vec3 m_CameraLocal = glm::vec3(0.f);
+	glm::vec4 m_aryFrustumPlane[6];
+	float m_fPixelScale = 1.f;
+	float m_fHorizonAngle = 0.f;			//radians from the camera direction, FLT_MAX disables horizon culling
+	bool m_bCacheSaturated = false;
+
+	std::vector<std::thread> m_vecWorker;
+	std::atomic<bool> m_bRunning = false;
+	std::mutex m_RequestMutex;
+	std::condition_variable m_RequestCondition;
+	std::priority_queue<ChunkRequest> m_queueRequest;
+	std::set<UINT64> m_setPending;			//queued, being built or finished but not drained yet
+
+	std::mutex m_FinishedMutex;
+	std::vector<Chunk> m_vecFinished;
+};
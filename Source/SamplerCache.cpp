@@ -0,0 +1,84 @@
+#include "SamplerCache.h"
+#include "Log.h"
+
+#include <algorithm>
+
+SamplerCache::~SamplerCache()
+{
+	Clear();
+}
+
+void SamplerCache::Init(VkDevice device, bool bAnisotropyEnabled, float fMaxAnisotropy)
+{
+	Clear();
+
+	m_Device = device;
+	m_bAnisotropyEnabled = bAnisotropyEnabled && fMaxAnisotropy > 1.f;
+	m_fMaxAnisotropy = std::max(fMaxAnisotropy, 1.f);
+
+	if (m_bAnisotropyEnabled)
+		Log::Info("Sampler anisotropy up to {}x", m_fMaxAnisotropy);
+	else
+		Log::Warn("samplerAnisotropy not supported, textures use trilinear filtering only");
+}
+
+void SamplerCache::Clear()
+{
+	for (const auto& entry : m_vecEntry)
+	{
+		vkDestroySampler(m_Device, entry.sampler, nullptr);
+	}
+	m_vecEntry.clear();
+}
+
+bool SamplerCache::IsSameState(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b)
+{
+	return a.flags == b.flags
+		&& a.magFilter == b.magFilter
+		&& a.minFilter == b.minFilter
+		&& a.mipmapMode == b.mipmapMode
+		&& a.addressModeU == b.addressModeU
+		&& a.addressModeV == b.addressModeV
+		&& a.addressModeW == b.addressModeW
+		&& a.mipLodBias == b.mipLodBias
+		&& a.anisotropyEnable == b.anisotropyEnable
+		&& a.maxAnisotropy == b.maxAnisotropy
+		&& a.compareEnable == b.compareEnable
+		&& a.compareOp == b.compareOp
+		&& a.minLod == b.minLod
+		&& a.maxLod == b.maxLod
+		&& a.borderColor == b.borderColor
+		&& a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+VkSampler SamplerCache::Acquire(const VkSamplerCreateInfo& createInfo)
+{
+	ASSERT(m_Device != VK_NULL_HANDLE, "Sampler cache is not initialized");
+	ASSERT(createInfo.pNext == nullptr, "Sampler cache does not support pNext");
+
+	//Normalize the anisotropy request first so equivalent requests share one key
+	VkSamplerCreateInfo normalized = createInfo;
+	if (normalized.anisotropyEnable == VK_TRUE && m_bAnisotropyEnabled && !normalized.unnormalizedCoordinates)
+	{
+		normalized.maxAnisotropy = std::clamp(normalized.maxAnisotropy, 1.f, m_fMaxAnisotropy);
+		if (normalized.maxAnisotropy <= 1.f)
+			normalized.anisotropyEnable = VK_FALSE;
+	}
+	else
+	{
+		normalized.anisotropyEnable = VK_FALSE;
+	}
+	if (normalized.anisotropyEnable == VK_FALSE)
+		normalized.maxAnisotropy = 1.f;
+
+	auto iter = std::find_if(m_vecEntry.begin(), m_vecEntry.end(),
+		[&](const Entry& entry) { return IsSameState(entry.createInfo, normalized); });
+	if (iter != m_vecEntry.end())
+		return iter->sampler;
+
+	Entry entry;
+	entry.createInfo = normalized;
+	VULKAN_ASSERT(vkCreateSampler(m_Device, &normalized, nullptr, &entry.sampler), "Create sampler failed");
+	m_vecEntry.push_back(entry);
+	return entry.sampler;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "Core.h"
+
+#include "vulkan/vulkan.h"
+
+//Shares one VkSampler between every texture and model that asks for the same sampler state
+//Samplers carry no per-image data (mip counts come from the image views), so a scene needs only a handful
+//Anisotropy is applied here: requests with anisotropyEnable get min(maxAnisotropy, device limit) when the device
+//enabled samplerAnisotropy, otherwise anisotropy is turned off. Samplers live until Clear
+class SamplerCache
+{
+public:
+	SamplerCache() = default;
+	~SamplerCache();
+
+	SamplerCache(const SamplerCache&) = delete;
+	SamplerCache& operator=(const SamplerCache&) = delete;
+
+	//fMaxAnisotropy is the device limit, ignored when bAnisotropyEnabled is false
+	void Init(VkDevice device, bool bAnisotropyEnabled, float fMaxAnisotropy);
+	void Clear();
+
+	//pNext chains are not supported
+	VkSampler Acquire(const VkSamplerCreateInfo& createInfo);
+
+	UINT GetSamplerCount() const { return static_cast<UINT>(m_vecEntry.size()); }
+	float GetMaxAnisotropy() const { return m_bAnisotropyEnabled ? m_fMaxAnisotropy : 1.f; }
+
+private:
+	struct Entry
+	{
+		VkSamplerCreateInfo createInfo;
+		VkSampler sampler;
+	};
+
+	static bool IsSameState(const VkSamplerCreateInfo& a, const VkSamplerCreateInfo& b);
+
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	bool m_bAnisotropyEnabled = false;
+	float m_fMaxAnisotropy = 1.f;
+
+	std::vector<Entry> m_vecEntry;
+};
@@ -0,0 +1,179 @@
+#include "ShaderHotReload.h"
+
+#include <chrono>
+#include <sstream>
+
+//libshaderc is only linked in Debug, the only configuration that enables hot reload
+#ifndef NDEBUG
+#include "shaderc/shaderc.hpp"
+#endif
+
+ShaderHotReload::~ShaderHotReload()
+{
+	Stop();
+}
+
+void ShaderHotReload::Start(UINT uiPollIntervalMs)
+{
+	if (m_bRunning)
+		return;
+
+	m_uiPollIntervalMs = uiPollIntervalMs;
+
+	//Record the current timestamps so that startup does not recompile everything
+	m_mapLastWriteTime.clear();
+	ScanShaderSources(false);
+
+	m_bRunning = true;
+	m_WatchThread = std::thread(&ShaderHotReload::WatchThreadFunc, this);
+
+	Log::Info("Shader hot reload watching {} sources", m_mapLastWriteTime.size());
+}
+
+void ShaderHotReload::Stop()
+{
+	if (!m_bRunning)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_StopMutex);
+		m_bRunning = false;
+	}
+	m_StopCondition.notify_all();
+
+	if (m_WatchThread.joinable())
+		m_WatchThread.join();
+}
+
+std::set<const DZW_EmbeddedShader::EmbeddedSpirv*> ShaderHotReload::FetchReloadedShaders()
+{
+	std::lock_guard<std::mutex> lock(m_ReloadedMutex);
+	std::set<const DZW_EmbeddedShader::EmbeddedSpirv*> setReloaded;
+	setReloaded.swap(m_setReloadedShaders);
+	return setReloaded;
+}
+
+void ShaderHotReload::WatchThreadFunc()
+{
+	while (m_bRunning)
+	{
+		ScanShaderSources(true);
+
+		std::unique_lock<std::mutex> lock(m_StopMutex);
+		m_StopCondition.wait_for(lock, std::chrono::milliseconds(m_uiPollIntervalMs), [this]() { return !m_bRunning; });
+	}
+}
+
+void ShaderHotReload::ScanShaderSources(bool bCompileChanged)
+{
+	//A source can back several entries (e.g. Planet and PlanetNoFeedback), check each source once per scan
+	std::set<std::string> setScanned;
+	std::set<std::string> setChanged;
+	for (const auto& embedded : DZW_EmbeddedShader::GetEmbeddedSpirvTable())
+	{
+		std::string strKey = embedded.szSourcePath;
+		if (!setScanned.insert(strKey).second)
+			continue;
+
+		std::error_code errorCode;
+		auto lastWriteTime = std::filesystem::last_write_time(strKey, errorCode);
+		if (errorCode)
+			continue;
+
+		auto iter = m_mapLastWriteTime.find(strKey);
+		bool bChanged = (iter != m_mapLastWriteTime.end()) && (iter->second != lastWriteTime);
+		m_mapLastWriteTime[strKey] = lastWriteTime;
+
+		if (bCompileChanged && bChanged)
+			setChanged.insert(strKey);
+	}
+
+	for (const auto& embedded : DZW_EmbeddedShader::GetEmbeddedSpirvTable())
+	{
+		if (!setChanged.contains(embedded.szSourcePath))
+			continue;
+
+		if (CompileShaderToSpv(embedded))
+		{
+			std::lock_guard<std::mutex> lock(m_ReloadedMutex);
+			m_setReloadedShaders.insert(&embedded);
+		}
+	}
+}
+
+bool ShaderHotReload::CompileShaderToSpv(const DZW_EmbeddedShader::EmbeddedSpirv& embedded)
+{
+	std::filesystem::path srcPath = embedded.szSourcePath;
+#ifdef NDEBUG
+	Log::Error("Shader hot reload compile {} failed: libshaderc is not linked in this configuration", srcPath.string());
+	return false;
+#else
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	std::ifstream srcFile(srcPath);
+	if (!srcFile.is_open())
+	{
+		Log::Warn("Shader hot reload open {} failed", srcPath.string());
+		return false;
+	}
+	std::stringstream srcStream;
+	srcStream << srcFile.rdbuf();
+	std::string strSource = srcStream.str();
+	srcFile.close();
+
+	shaderc_shader_kind kind = shaderc_glsl_vertex_shader;
+	switch (embedded.stage)
+	{
+	case VK_SHADER_STAGE_VERTEX_BIT:	kind = shaderc_glsl_vertex_shader; break;
+	case VK_SHADER_STAGE_FRAGMENT_BIT:	kind = shaderc_glsl_fragment_shader; break;
+	case VK_SHADER_STAGE_COMPUTE_BIT:	kind = shaderc_glsl_compute_shader; break;
+	case VK_SHADER_STAGE_GEOMETRY_BIT:	kind = shaderc_glsl_geometry_shader; break;
+	default: return false;
+	}
+
+	shaderc::Compiler compiler;
+	shaderc::CompileOptions options;
+	options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+	options.SetOptimizationLevel(shaderc_optimization_level_performance);
+	for (const auto& szDefine : embedded.vecDefines)
+	{
+		options.AddMacroDefinition(szDefine);
+	}
+
+	auto result = compiler.CompileGlslToSpv(strSource, kind, srcPath.string().c_str(), options);
+	if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+	{
+		//Keep the old pipeline, the shader is recompiled on the next save
+		Log::Error("Shader hot reload compile {} ({}) failed:\n{}", srcPath.string(), embedded.szName, result.GetErrorMessage());
+		return false;
+	}
+
+	std::vector<UINT> vecSpirv(result.cbegin(), result.cend());
+
+	//Write to a temp file first, the renderer must never read a half written spv
+	std::filesystem::path spvPath = embedded.szSpvPath;
+	auto tmpPath = spvPath;
+	tmpPath += ".tmp";
+	{
+		std::ofstream spvFile(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!spvFile.is_open())
+		{
+			Log::Error("Shader hot reload write {} failed", tmpPath.string());
+			return false;
+		}
+		spvFile.write(reinterpret_cast<const char*>(vecSpirv.data()), vecSpirv.size() * sizeof(UINT));
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(tmpPath, spvPath, errorCode);
+	if (errorCode)
+	{
+		Log::Error("Shader hot reload replace {} failed: {}", spvPath.string(), errorCode.message());
+		return false;
+	}
+
+	float fCostMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	Log::Info("Shader hot reload compiled {} ({}) in {:.2f}ms", srcPath.string(), embedded.szName, fCostMs);
+	return true;
+#endif
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "vulkan/vulkan.h"
+
+#include "Core.h"
+#include "EmbeddedShader.h"
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+//Watches the GLSL sources listed in the embedded shader table, recompiles every table entry
+//of a changed source to SPIR-V on a background thread (libshaderc) with the entry's defines
+//and writes it to the entry's szSpvPath, the same output GenerateEmbeddedSpv.bat embeds
+class ShaderHotReload
+{
+public:
+	ShaderHotReload() = default;
+	~ShaderHotReload();
+
+	ShaderHotReload(const ShaderHotReload&) = delete;
+	ShaderHotReload& operator=(const ShaderHotReload&) = delete;
+
+	void Start(UINT uiPollIntervalMs = 200);
+	void Stop();
+
+	//Called by the render thread at a frame boundary
+	//Returns the table entries whose spv files were rebuilt since the last call
+	std::set<const DZW_EmbeddedShader::EmbeddedSpirv*> FetchReloadedShaders();
+
+private:
+	void WatchThreadFunc();
+	void ScanShaderSources(bool bCompileChanged);
+	bool CompileShaderToSpv(const DZW_EmbeddedShader::EmbeddedSpirv& embedded);
+
+private:
+	UINT m_uiPollIntervalMs = 200;
+
+	std::thread m_WatchThread;
+	std::atomic<bool> m_bRunning = false;
+	std::mutex m_StopMutex;
+	std::condition_variable m_StopCondition;
+
+	//only touched by the watch thread after Start
+	std::unordered_map<std::string, std::filesystem::file_time_type> m_mapLastWriteTime;
+
+	std::mutex m_ReloadedMutex;
+	std::set<const DZW_EmbeddedShader::EmbeddedSpirv*> m_setReloadedShaders;
+};
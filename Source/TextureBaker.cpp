@@ -0,0 +1,531 @@
+#include "TextureBaker.h"
+#include "ColorSpace.h"
+
+#include <array>
+#include <bit>
+#include <cfloat>
+#include <climits>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "ktx.h"
+#include "stb_image.h"
+
+namespace
+{
+	constexpr UCHAR KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+	constexpr UINT KTX_ENDIANNESS = 0x04030201;
+	constexpr UINT KTX_GL_RGB = 0x1907;
+	constexpr UINT KTX_GL_RGBA = 0x1908;
+
+	//Mips are averaged in linear space and stored sRGB encoded like the block formats expect
+	using DZW_ColorSpace::GetSrgbToLinearTable;
+	using DZW_ColorSpace::LinearToSrgb;
+
+	//2x2 box filter, odd edges repeat the last texel
+	std::vector<UCHAR> Downsample(const std::vector<UCHAR>& vecSrc, UINT uiSrcWidth, UINT uiSrcHeight, UINT uiWidth, UINT uiHeight)
+	{
+		const auto& aryToLinear = GetSrgbToLinearTable();
+		std::vector<UCHAR> vecDst(static_cast<size_t>(uiWidth) * uiHeight * 4);
+		for (UINT y = 0; y < uiHeight; ++y)
+		{
+			UINT y0 = std::min(y * 2, uiSrcHeight - 1);
+			UINT y1 = std::min(y * 2 + 1, uiSrcHeight - 1);
+			for (UINT x = 0; x < uiWidth; ++x)
+			{
+				UINT x0 = std::min(x * 2, uiSrcWidth - 1);
+				UINT x1 = std::min(x * 2 + 1, uiSrcWidth - 1);
+				const UCHAR* aryTap[4] = {
+					&vecSrc[(static_cast<size_t>(y0) * uiSrcWidth + x0) * 4],
+					&vecSrc[(static_cast<size_t>(y0) * uiSrcWidth + x1) * 4],
+					&vecSrc[(static_cast<size_t>(y1) * uiSrcWidth + x0) * 4],
+					&vecSrc[(static_cast<size_t>(y1) * uiSrcWidth + x1) * 4],
+				};
+				UCHAR* pDst = &vecDst[(static_cast<size_t>(y) * uiWidth + x) * 4];
+				for (UINT c = 0; c < 3; ++c)
+				{
+					float f = aryToLinear[aryTap[0][c]] + aryToLinear[aryTap[1][c]] + aryToLinear[aryTap[2][c]] + aryToLinear[aryTap[3][c]];
+					pDst[c] = LinearToSrgb(f * 0.25f);
+				}
+				pDst[3] = static_cast<UCHAR>((aryTap[0][3] + aryTap[1][3] + aryTap[2][3] + aryTap[3][3] + 2) / 4);
+			}
+		}
+		return vecDst;
+	}
+
+	uint16_t PackRGB565(const float* pColor)
+	{
+		UINT r = static_cast<UINT>(std::clamp(pColor[0] * 31.f / 255.f + 0.5f, 0.f, 31.f));
+		UINT g = static_cast<UINT>(std::clamp(pColor[1] * 63.f / 255.f + 0.5f, 0.f, 63.f));
+		UINT b = static_cast<UINT>(std::clamp(pColor[2] * 31.f / 255.f + 0.5f, 0.f, 31.f));
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void UnpackRGB565(uint16_t uiColor, int* pColor)
+	{
+		int r = (uiColor >> 11) & 31;
+		int g = (uiColor >> 5) & 63;
+		int b = uiColor & 31;
+		pColor[0] = (r << 3) | (r >> 2);
+		pColor[1] = (g << 2) | (g >> 4);
+		pColor[2] = (b << 3) | (b >> 2);
+	}
+
+	void WriteU16(UCHAR* pDst, uint16_t uiValue)
+	{
+		pDst[0] = static_cast<UCHAR>(uiValue & 0xFF);
+		pDst[1] = static_cast<UCHAR>(uiValue >> 8);
+	}
+}
+
+std::filesystem::path TextureBaker::GetBakedPath(const std::filesystem::path& sourcePath)
+{
+	std::filesystem::path bakedPath = sourcePath;
+	bakedPath += ".bc.ktx";
+	return bakedPath;
+}
+
+std::filesystem::path TextureBaker::Bake(const std::filesystem::path& sourcePath)
+{
+	std::filesystem::path bakedPath = GetBakedPath(sourcePath);
+
+	std::error_code errorCode;
+	bool bSourceExist = std::filesystem::exists(sourcePath, errorCode);
+	bool bUpToDate = std::filesystem::exists(bakedPath, errorCode)
+		&& (!bSourceExist || std::filesystem::last_write_time(bakedPath, errorCode) >= std::filesystem::last_write_time(sourcePath, errorCode));
+	if (bUpToDate)
+		return bakedPath;
+
+	if (!bSourceExist)
+		return sourcePath;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	SourceImage source;
+	if (!LoadSource(sourcePath, source) || !WriteKtx(bakedPath, source))
+		return sourcePath;
+
+	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+	Log::Info("Texture bake: {} -> {} ({} ms)", sourcePath.string(), bakedPath.string(), duration.count());
+	return bakedPath;
+}
+
+VkFormat TextureBaker::GetVulkanFormat(UINT uiGlInternalFormat)
+{
+	switch (uiGlInternalFormat)
+	{
+	case GL_INTERNAL_FORMAT_BC1_SRGB:
+		return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+	case GL_INTERNAL_FORMAT_BC3_SRGB:
+		return VK_FORMAT_BC3_SRGB_BLOCK;
+	default:
+		return VK_FORMAT_UNDEFINED;
+	}
+}
+
+UINT TextureBaker::GetBlockBytes(UINT uiGlInternalFormat)
+{
+	return (uiGlInternalFormat == GL_INTERNAL_FORMAT_BC3_SRGB) ? 16 : 8;
+}
+
+bool TextureBaker::LoadSource(const std::filesystem::path& sourcePath, SourceImage& source)
+{
+	if (sourcePath.extension() == ".ktx")
+	{
+		ktxTexture* pKtxTexture = nullptr;
+		ktxResult result = ktxTexture_CreateFromNamedFile(sourcePath.string().c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &pKtxTexture);
+		if (result != KTX_SUCCESS)
+		{
+			Log::Warn("Texture bake: load {} failed", sourcePath.string());
+			return false;
+		}
+
+		//Only uncompressed RGBA8 2D textures, arrays and cubemaps
+		if (pKtxTexture->isCompressed || pKtxTexture->glFormat != KTX_GL_RGBA || ktxTexture_GetElementSize(pKtxTexture) != 4 || pKtxTexture->numDimensions != 2)
+		{
+			Log::Warn("Texture bake: {} is not an uncompressed RGBA8 2D texture", sourcePath.string());
+			ktxTexture_Destroy(pKtxTexture);
+			return false;
+		}
+
+		source.uiWidth = pKtxTexture->baseWidth;
+		source.uiHeight = pKtxTexture->baseHeight;
+		source.uiLayerNum = pKtxTexture->isArray ? pKtxTexture->numLayers : 0;
+		source.uiFaceNum = pKtxTexture->numFaces;
+
+		const ktx_uint8_t* pData = ktxTexture_GetData(pKtxTexture);
+		size_t imageSize = static_cast<size_t>(source.uiWidth) * source.uiHeight * 4;
+		for (UINT uiLayer = 0; uiLayer < pKtxTexture->numLayers; ++uiLayer)
+		{
+			for (UINT uiFace = 0; uiFace < source.uiFaceNum; ++uiFace)
+			{
+				size_t offset = 0;
+				ktxTexture_GetImageOffset(pKtxTexture, 0, uiLayer, uiFace, &offset);
+				source.vecImage.emplace_back(pData + offset, pData + offset + imageSize);
+			}
+		}
+
+		ktxTexture_Destroy(pKtxTexture);
+		return true;
+	}
+
+	int nWidth = 0;
+	int nHeight = 0;
+	int nChannel = 0;
+	stbi_uc* pPixel = stbi_load(sourcePath.string().c_str(), &nWidth, &nHeight, &nChannel, STBI_rgb_alpha);
+	if (pPixel == nullptr)
+	{
+		Log::Warn("Texture bake: load {} failed", sourcePath.string());
+		return false;
+	}
+
+	source.uiWidth = static_cast<UINT>(nWidth);
+	source.uiHeight = static_cast<UINT>(nHeight);
+	source.uiLayerNum = 0;
+	source.uiFaceNum = 1;
+	source.vecImage.emplace_back(pPixel, pPixel + static_cast<size_t>(nWidth) * nHeight * 4);
+	stbi_image_free(pPixel);
+	return true;
+}
+
+bool TextureBaker::WriteKtx(const std::filesystem::path& bakedPath, const SourceImage& source)
+{
+	bool bAlpha = false;
+	for (const auto& vecImage : source.vecImage)
+	{
+		for (size_t i = 3; i < vecImage.size() && !bAlpha; i += 4)
+		{
+			bAlpha = (vecImage[i] != 255);
+		}
+	}
+
+	UINT uiFormat = bAlpha ? GL_INTERNAL_FORMAT_BC3_SRGB : GL_INTERNAL_FORMAT_BC1_SRGB;
+	UINT uiBlockBytes = GetBlockBytes(uiFormat);
+	UINT uiMipNum = static_cast<UINT>(std::bit_width(std::max(source.uiWidth, source.uiHeight)));
+
+	std::filesystem::path tmpPath = bakedPath;
+	tmpPath += ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			Log::Warn("Texture bake: create {} failed", tmpPath.string());
+			return false;
+		}
+
+		UINT aryHeader[13] = {
+			KTX_ENDIANNESS,
+			0,					//glType, 0 for compressed
+			1,					//glTypeSize
+			0,					//glFormat, 0 for compressed
+			uiFormat,
+			bAlpha ? KTX_GL_RGBA : KTX_GL_RGB,
+			source.uiWidth,
+			source.uiHeight,
+			0,					//pixelDepth
+			source.uiLayerNum,
+			source.uiFaceNum,
+			uiMipNum,
+			0,					//bytesOfKeyValueData
+		};
+		file.write(reinterpret_cast<const char*>(KTX_IDENTIFIER), sizeof(KTX_IDENTIFIER));
+		file.write(reinterpret_cast<const char*>(aryHeader), sizeof(aryHeader));
+
+		std::vector<std::vector<UCHAR>> vecCurrent = source.vecImage;
+		std::vector<UCHAR> vecLevel;
+		UCHAR aryBlock[64];
+		for (UINT uiMip = 0; uiMip < uiMipNum; ++uiMip)
+		{
+			UINT uiWidth = std::max(source.uiWidth >> uiMip, 1u);
+			UINT uiHeight = std::max(source.uiHeight >> uiMip, 1u);
+			UINT uiBlockX = (uiWidth + 3) / 4;
+			UINT uiBlockY = (uiHeight + 3) / 4;
+			size_t imageBytes = static_cast<size_t>(uiBlockX) * uiBlockY * uiBlockBytes;
+
+			vecLevel.resize(imageBytes * vecCurrent.size());
+			for (size_t i = 0; i < vecCurrent.size(); ++i)
+			{
+				if (uiMip > 0)
+					vecCurrent[i] = Downsample(vecCurrent[i], std::max(source.uiWidth >> (uiMip - 1), 1u), std::max(source.uiHeight >> (uiMip - 1), 1u), uiWidth, uiHeight);
+
+				const UCHAR* pImage = vecCurrent[i].data();
+				UCHAR* pDst = vecLevel.data() + imageBytes * i;
+				for (UINT by = 0; by < uiBlockY; ++by)
+				{
+					for (UINT bx = 0; bx < uiBlockX; ++bx)
+					{
+						//Partial edge blocks repeat the last row and column
+						for (UINT p = 0; p < 16; ++p)
+						{
+							UINT x = std::min(bx * 4 + p % 4, uiWidth - 1);
+							UINT y = std::min(by * 4 + p / 4, uiHeight - 1);
+							memcpy(aryBlock + p * 4, pImage + (static_cast<size_t>(y) * uiWidth + x) * 4, 4);
+						}
+
+						if (bAlpha)
+						{
+							EncodeBC3AlphaBlock(aryBlock, pDst);
+							EncodeBC1Block(aryBlock, pDst + 8);
+						}
+						else
+						{
+							EncodeBC1Block(aryBlock, pDst);
+						}
+						pDst += uiBlockBytes;
+					}
+				}
+			}
+
+			//imageSize is one face for non array cubemaps and the whole level otherwise
+			UINT uiImageSize = static_cast<UINT>((source.uiFaceNum == 6 && source.uiLayerNum == 0) ? imageBytes : vecLevel.size());
+			file.write(reinterpret_cast<const char*>(&uiImageSize), sizeof(uiImageSize));
+			file.write(reinterpret_cast<const char*>(vecLevel.data()), vecLevel.size());
+		}
+
+		if (!file.good())
+		{
+			Log::Warn("Texture bake: write {} failed", tmpPath.string());
+			return false;
+		}
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(tmpPath, bakedPath, errorCode);
+	if (errorCode)
+	{
+		Log::Warn("Texture bake: replace {} failed: {}", bakedPath.string(), errorCode.message());
+		std::filesystem::remove(tmpPath, errorCode);
+		return false;
+	}
+	return true;
+}
+
+void TextureBaker::EncodeBC1Block(const UCHAR* pBlock, UCHAR* pDst)
+{
+	//Endpoints at the extreme projections on the principal axis of the block colors, inset by 1/16 against outliers
+	float aryMean[3] = {};
+	for (UINT p = 0; p < 16; ++p)
+	{
+		for (UINT c = 0; c < 3; ++c)
+			aryMean[c] += pBlock[p * 4 + c];
+	}
+	for (UINT c = 0; c < 3; ++c)
+		aryMean[c] /= 16.f;
+
+	float aryCov[3][3] = {};
+	for (UINT p = 0; p < 16; ++p)
+	{
+		float aryDiff[3] = { pBlock[p * 4] - aryMean[0], pBlock[p * 4 + 1] - aryMean[1], pBlock[p * 4 + 2] - aryMean[2] };
+		for (UINT i = 0; i < 3; ++i)
+		{
+			for (UINT j = 0; j < 3; ++j)
+				aryCov[i][j] += aryDiff[i] * aryDiff[j];
+		}
+	}
+
+	float aryAxis[3] = { 1.f, 1.f, 1.f };
+	for (UINT uiIter = 0; uiIter < 4; ++uiIter)
+	{
+		float aryNext[3] = {};
+		for (UINT i = 0; i < 3; ++i)
+			aryNext[i] = aryCov[i][0] * aryAxis[0] + aryCov[i][1] * aryAxis[1] + aryCov[i][2] * aryAxis[2];
+
+		float fLength = std::max({ std::abs(aryNext[0]), std::abs(aryNext[1]), std::abs(aryNext[2]) });
+		if (fLength < 1e-6f)
+			break;
+		for (UINT i = 0; i < 3; ++i)
+			aryAxis[i] = aryNext[i] / fLength;
+	}
+
+	float fMin = FLT_MAX;
+	float fMax = -FLT_MAX;
+	for (UINT p = 0; p < 16; ++p)
+	{
+		float t = (pBlock[p * 4] - aryMean[0]) * aryAxis[0] + (pBlock[p * 4 + 1] - aryMean[1]) * aryAxis[1] + (pBlock[p * 4 + 2] - aryMean[2]) * aryAxis[2];
+		fMin = std::min(fMin, t);
+		fMax = std::max(fMax, t);
+	}
+
+	float aryMax[3];
+	float aryMin[3];
+	for (UINT c = 0; c < 3; ++c)
+	{
+		float fHigh = aryMean[c] + aryAxis[c] * fMax;
+		float fLow = aryMean[c] + aryAxis[c] * fMin;
+		float fInset = (fHigh - fLow) / 16.f;
+		aryMax[c] = fHigh - fInset;
+		aryMin[c] = fLow + fInset;
+	}
+
+	uint16_t uiColor0 = PackRGB565(aryMax);
+	uint16_t uiColor1 = PackRGB565(aryMin);
+	if (uiColor0 < uiColor1)
+		std::swap(uiColor0, uiColor1);
+
+	//color0 > color1 selects the four color mode, equal endpoints leave every index at 0
+	UINT uiIndices = 0;
+	if (uiColor0 != uiColor1)
+	{
+		int aryPalette[4][3];
+		UnpackRGB565(uiColor0, aryPalette[0]);
+		UnpackRGB565(uiColor1, aryPalette[1]);
+		for (UINT c = 0; c < 3; ++c)
+		{
+			aryPalette[2][c] = (2 * aryPalette[0][c] + aryPalette[1][c]) / 3;
+			aryPalette[3][c] = (aryPalette[0][c] + 2 * aryPalette[1][c]) / 3;
+		}
+
+		for (UINT p = 0; p < 16; ++p)
+		{
+			UINT uiBest = 0;
+			int nBestDistance = INT_MAX;
+			for (UINT i = 0; i < 4; ++i)
+			{
+				int dr = pBlock[p * 4] - aryPalette[i][0];
+				int dg = pBlock[p * 4 + 1] - aryPalette[i][1];
+				int db = pBlock[p * 4 + 2] - aryPalette[i][2];
+				int nDistance = dr * dr + dg * dg + db * db;
+				if (nDistance < nBestDistance)
+				{
+					nBestDistance = nDistance;
+					uiBest = i;
+				}
+			}
+			uiIndices |= uiBest << (2 * p);
+		}
+	}
+
+	WriteU16(pDst, uiColor0);
+	WriteU16(pDst + 2, uiColor1);
+	for (UINT i = 0; i < 4; ++i)
+		pDst[4 + i] = static_cast<UCHAR>((uiIndices >> (8 * i)) & 0xFF);
+}
+
+void TextureBaker::EncodeBC3AlphaBlock(const UCHAR* pBlock, UCHAR* pDst)
+{
+	UCHAR uiAlpha0 = 0;
+	UCHAR uiAlpha1 = 255;
+	for (UINT p = 0; p < 16; ++p)
+	{
+		uiAlpha0 = std::max(uiAlpha0, pBlock[p * 4 + 3]);
+		uiAlpha1 = std::min(uiAlpha1, pBlock[p * 4 + 3]);
+	}
+
+	//alpha0 > alpha1 selects the eight value mode, equal values leave every index at 0
+	UINT64 uiIndices = 0;
+	if (uiAlpha0 != uiAlpha1)
+	{
+		int aryPalette[8] = { uiAlpha0, uiAlpha1 };
+		for (int i = 2; i < 8; ++i)
+			aryPalette[i] = ((8 - i) * uiAlpha0 + (i - 1) * uiAlpha1) / 7;
+
+		for (UINT p = 0; p < 16; ++p)
+		{
+			UINT uiBest = 0;
+			int nBestDistance = INT_MAX;
+			for (UINT i = 0; i < 8; ++i)
+			{
+				int nDistance = std::abs(pBlock[p * 4 + 3] - aryPalette[i]);
+				if (nDistance < nBestDistance)
+				{
+					nBestDistance = nDistance;
+					uiBest = i;
+				}
+			}
+			uiIndices |= static_cast<UINT64>(uiBest) << (3 * p);
+		}
+	}
+
+	pDst[0] = uiAlpha0;
+	pDst[1] = uiAlpha1;
+	for (UINT i = 0; i < 6; ++i)
+		pDst[2 + i] = static_cast<UCHAR>((uiIndices >> (8 * i)) & 0xFF);
+}
+
+void TextureBaker::DecodeBC1Block(const UCHAR* pSrc, bool bThreeColorMode, UCHAR* pBlock)
+{
+	uint16_t uiColor0 = static_cast<uint16_t>(pSrc[0] | (pSrc[1] << 8));
+	uint16_t uiColor1 = static_cast<uint16_t>(pSrc[2] | (pSrc[3] << 8));
+
+	int aryPalette[4][3];
+	UnpackRGB565(uiColor0, aryPalette[0]);
+	UnpackRGB565(uiColor1, aryPalette[1]);
+	for (UINT c = 0; c < 3; ++c)
+	{
+		if (uiColor0 > uiColor1 || !bThreeColorMode)
+		{
+			aryPalette[2][c] = (2 * aryPalette[0][c] + aryPalette[1][c]) / 3;
+			aryPalette[3][c] = (aryPalette[0][c] + 2 * aryPalette[1][c]) / 3;
+		}
+		else
+		{
+			aryPalette[2][c] = (aryPalette[0][c] + aryPalette[1][c]) / 2;
+			aryPalette[3][c] = 0;
+		}
+	}
+
+	UINT uiIndices = pSrc[4] | (pSrc[5] << 8) | (pSrc[6] << 16) | (static_cast<UINT>(pSrc[7]) << 24);
+	for (UINT p = 0; p < 16; ++p)
+	{
+		UINT uiIndex = (uiIndices >> (2 * p)) & 3;
+		pBlock[p * 4] = static_cast<UCHAR>(aryPalette[uiIndex][0]);
+		pBlock[p * 4 + 1] = static_cast<UCHAR>(aryPalette[uiIndex][1]);
+		pBlock[p * 4 + 2] = static_cast<UCHAR>(aryPalette[uiIndex][2]);
+		pBlock[p * 4 + 3] = 255;
+	}
+}
+
+void TextureBaker::DecodeBC3AlphaBlock(const UCHAR* pSrc, UCHAR* pBlock)
+{
+	int aryPalette[8] = { pSrc[0], pSrc[1] };
+	if (pSrc[0] > pSrc[1])
+	{
+		for (int i = 2; i < 8; ++i)
+			aryPalette[i] = ((8 - i) * pSrc[0] + (i - 1) * pSrc[1]) / 7;
+	}
+	else
+	{
+		for (int i = 2; i < 6; ++i)
+			aryPalette[i] = ((6 - i) * pSrc[0] + (i - 1) * pSrc[1]) / 5;
+		aryPalette[6] = 0;
+		aryPalette[7] = 255;
+	}
+
+	UINT64 uiIndices = 0;
+	for (UINT i = 0; i < 6; ++i)
+		uiIndices |= static_cast<UINT64>(pSrc[2 + i]) << (8 * i);
+	for (UINT p = 0; p < 16; ++p)
+		pBlock[p * 4 + 3] = static_cast<UCHAR>(aryPalette[(uiIndices >> (3 * p)) & 7]);
+}
+
+void TextureBaker::DecodeImage(UINT uiGlInternalFormat, const UCHAR* pSrc, UINT uiWidth, UINT uiHeight, UCHAR* pDst)
+{
+	bool bBC3 = (uiGlInternalFormat == GL_INTERNAL_FORMAT_BC3_SRGB);
+	UINT uiBlockBytes = GetBlockBytes(uiGlInternalFormat);
+	UCHAR aryBlock[64];
+	for (UINT by = 0; by < (uiHeight + 3) / 4; ++by)
+	{
+		for (UINT bx = 0; bx < (uiWidth + 3) / 4; ++bx)
+		{
+			if (bBC3)
+			{
+				DecodeBC1Block(pSrc + 8, false, aryBlock);
+				DecodeBC3AlphaBlock(pSrc, aryBlock);
+			}
+			else
+			{
+				DecodeBC1Block(pSrc, true, aryBlock);
+			}
+			pSrc += uiBlockBytes;
+
+			for (UINT p = 0; p < 16; ++p)
+			{
+				UINT x = bx * 4 + p % 4;
+				UINT y = by * 4 + p / 4;
+				if (x < uiWidth && y < uiHeight)
+					memcpy(pDst + (static_cast<size_t>(y) * uiWidth + x) * 4, aryBlock + p * 4, 4);
+			}
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Core.h"
+
+#include "vulkan/vulkan.h"
+
+//Bakes RGBA8 textures (stb readable images or uncompressed KTX) into block compressed KTX files with a full mip chain
+//The baked file sits next to the source as <source>.bc.ktx and is rebuilt when the source is newer
+//Opaque images become BC1 (8x smaller than RGBA8), images with alpha become BC3 (4x smaller), both sRGB
+//Devices without BC sampling decode the blocks back to RGBA8 at load, so the baked file is always usable
+class TextureBaker
+{
+public:
+	static constexpr UINT GL_INTERNAL_FORMAT_BC1_SRGB = 0x8C4C;		//GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+	static constexpr UINT GL_INTERNAL_FORMAT_BC3_SRGB = 0x8C4F;		//GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+
+	static std::filesystem::path GetBakedPath(const std::filesystem::path& sourcePath);
+
+	//Returns the path to load: the baked file when it exists or could be baked, otherwise the source itself
+	static std::filesystem::path Bake(const std::filesystem::path& sourcePath);
+
+	//VK_FORMAT_UNDEFINED for internal formats this baker does not write
+	static VkFormat GetVulkanFormat(UINT uiGlInternalFormat);
+	static UINT GetBlockBytes(UINT uiGlInternalFormat);
+
+	//Decodes one image (one level of one layer/face) into tightly packed RGBA8
+	static void DecodeImage(UINT uiGlInternalFormat, const UCHAR* pSrc, UINT uiWidth, UINT uiHeight, UCHAR* pDst);
+
+private:
+	struct SourceImage
+	{
+		UINT uiWidth = 0;
+		UINT uiHeight = 0;
+		UINT uiLayerNum = 0;		//0 when the source is not an array
+		UINT uiFaceNum = 1;
+		std::vector<std::vector<UCHAR>> vecImage;	//level 0 of every layer and face, layer major
+	};
+
+	static bool LoadSource(const std::filesystem::path& sourcePath, SourceImage& source);
+	static bool WriteKtx(const std::filesystem::path& bakedPath, const SourceImage& source);
+
+	static void EncodeBC1Block(const UCHAR* pBlock, UCHAR* pDst);
+	static void EncodeBC3AlphaBlock(const UCHAR* pBlock, UCHAR* pDst);
+	static void DecodeBC1Block(const UCHAR* pSrc, bool bAlphaMode, UCHAR* pBlock);
+	static void DecodeBC3AlphaBlock(const UCHAR* pSrc, UCHAR* pBlock);
+};
@@ -0,0 +1,147 @@
+#include "TextureCache.h"
+#include "VulkanRenderer.h"
+#include "Log.h"
+
+#include <algorithm>
+
+TextureCache::~TextureCache()
+{
+	Clear();
+}
+
+void TextureCache::Init(VulkanRenderer* pRenderer, UINT64 ullBudgetBytes, UINT uiFramesInFlight)
+{
+	m_pRenderer = pRenderer;
+	m_ullConfigBudgetBytes = ullBudgetBytes;
+	m_ullBudgetBytes = ullBudgetBytes;
+	m_uiFramesInFlight = std::max(uiFramesInFlight, 1u);
+	UpdateBudget();
+}
+
+void TextureCache::Clear()
+{
+	//Textures still held by callers are destroyed when the last holder releases them
+	m_mapEntry.clear();
+	m_ullResidentBytes = 0;
+}
+
+std::string TextureCache::MakeKey(const std::filesystem::path& filepath)
+{
+	std::error_code ec;
+	std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(filepath, ec);
+	if (ec)
+		canonicalPath = filepath.lexically_normal();
+	return canonicalPath.generic_string();
+}
+
+std::shared_ptr<DZW_VulkanWrap::Texture> TextureCache::Acquire(const std::filesystem::path& filepath)
+{
+	ASSERT(m_pRenderer != nullptr, "Texture cache is not initialized");
+
+	std::string strKey = MakeKey(filepath);
+	auto iter = m_mapEntry.find(strKey);
+	if (iter != m_mapEntry.end())
+	{
+		++m_ullHitCount;
+		iter->second.ullLastUsedFrame = m_ullFrame;
+		return iter->second.pTexture;
+	}
+
+	++m_ullMissCount;
+	std::shared_ptr<DZW_VulkanWrap::Texture> pTexture = DZW_VulkanWrap::TextureFactor::CreateTexture(m_pRenderer, filepath);
+	if (!pTexture)
+		return nullptr;
+
+	Entry& entry = m_mapEntry[strKey];
+	entry.pTexture = pTexture;
+	entry.ullSize = pTexture->m_MemorySize;
+	entry.ullLastUsedFrame = m_ullFrame;
+	m_ullResidentBytes += entry.ullSize;
+
+	if (m_ullResidentBytes > m_ullBudgetBytes)
+		Log::Warn("Texture cache {} MB exceeds budget {} MB after loading {}", m_ullResidentBytes >> 20, m_ullBudgetBytes >> 20, filepath.string());
+
+	return pTexture;
+}
+
+void TextureCache::Update()
+{
+	++m_ullFrame;
+
+	for (auto& [strKey, entry] : m_mapEntry)
+	{
+		if (entry.pTexture.use_count() > 1)
+			entry.ullLastUsedFrame = m_ullFrame;
+	}
+
+	if (m_ullFrame % BUDGET_QUERY_INTERVAL == 0)
+		UpdateBudget();
+
+	if (m_ullResidentBytes > m_ullBudgetBytes)
+		Evict();
+	else
+		m_bOverBudgetWarned = false;
+}
+
+void TextureCache::UpdateBudget()
+{
+	m_ullBudgetBytes = m_ullConfigBudgetBytes;
+
+	UINT64 ullHeapBudget = 0;
+	UINT64 ullHeapUsage = 0;
+	if (!m_pRenderer->QueryDeviceLocalMemoryBudget(ullHeapBudget, ullHeapUsage))
+		return;
+
+	//Heap usage includes the cache itself, everything else allocated on the device is left untouched
+	UINT64 ullOtherUsage = ullHeapUsage > m_ullResidentBytes ? ullHeapUsage - m_ullResidentBytes : 0;
+	UINT64 ullAvailable = ullHeapBudget > ullOtherUsage ? ullHeapBudget - ullOtherUsage : 0;
+	m_ullBudgetBytes = std::min(m_ullBudgetBytes, ullAvailable);
+}
+
+void TextureCache::Evict()
+{
+	//Only unreferenced textures that no frame in flight can still sample are candidates
+	std::vector<std::unordered_map<std::string, Entry>::iterator> vecCandidate;
+	for (auto iter = m_mapEntry.begin(); iter != m_mapEntry.end(); ++iter)
+	{
+		const Entry& entry = iter->second;
+		if (entry.pTexture.use_count() == 1 && entry.ullLastUsedFrame + m_uiFramesInFlight < m_ullFrame)
+			vecCandidate.push_back(iter);
+	}
+
+	std::sort(vecCandidate.begin(), vecCandidate.end(),
+		[](const auto& a, const auto& b) { return a->second.ullLastUsedFrame < b->second.ullLastUsedFrame; });
+
+	for (const auto& iter : vecCandidate)
+	{
+		if (m_ullResidentBytes <= m_ullBudgetBytes)
+			break;
+
+		m_ullResidentBytes -= iter->second.ullSize;
+		++m_ullEvictionCount;
+		m_mapEntry.erase(iter);
+	}
+
+	if (m_ullResidentBytes > m_ullBudgetBytes && !m_bOverBudgetWarned)
+	{
+		Log::Warn("Texture cache {} MB still exceeds budget {} MB, all remaining textures are in use", m_ullResidentBytes >> 20, m_ullBudgetBytes >> 20);
+		m_bOverBudgetWarned = true;
+	}
+}
+
+TextureCache::Stats TextureCache::GetStats() const
+{
+	Stats stats{};
+	stats.ullHitCount = m_ullHitCount;
+	stats.ullMissCount = m_ullMissCount;
+	stats.ullEvictionCount = m_ullEvictionCount;
+	stats.ullResidentBytes = m_ullResidentBytes;
+	stats.ullBudgetBytes = m_ullBudgetBytes;
+	stats.uiResidentCount = static_cast<UINT>(m_mapEntry.size());
+	for (const auto& [strKey, entry] : m_mapEntry)
+	{
+		if (entry.pTexture.use_count() > 1)
+			++stats.uiReferencedCount;
+	}
+	return stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Core.h"
+
+#include "VulkanWrap.h"
+
+#include <unordered_map>
+
+//Owns every texture loaded by path, so the same file requested by several models is uploaded once
+//Callers hold a shared_ptr for as long as a descriptor set references the texture; while any caller holds
+//it the texture counts as used every frame. Unreferenced textures stay resident as a cache and are evicted
+//least recently used first once the resident bytes exceed the budget
+//The budget is the configured size, lowered to what VK_EXT_memory_budget reports as still available
+//for device local memory when the renderer enabled that extension
+class TextureCache
+{
+public:
+	static constexpr UINT BUDGET_QUERY_INTERVAL = 60;	//frames between memory budget queries
+
+	struct Stats
+	{
+		UINT64 ullHitCount;
+		UINT64 ullMissCount;
+		UINT64 ullEvictionCount;
+		UINT64 ullResidentBytes;
+		UINT64 ullBudgetBytes;
+		UINT uiResidentCount;
+		UINT uiReferencedCount;
+	};
+
+public:
+	TextureCache() = default;
+	~TextureCache();
+
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	//uiFramesInFlight: an unreferenced texture is only destroyed after this many frames without use
+	void Init(VulkanRenderer* pRenderer, UINT64 ullBudgetBytes, UINT uiFramesInFlight);
+	void Clear();
+
+	//nullptr when the file can not be loaded
+	std::shared_ptr<DZW_VulkanWrap::Texture> Acquire(const std::filesystem::path& filepath);
+
+	//Called once per frame on the render thread after the fence of the reused frame has been waited
+	void Update();
+
+	void SetBudgetBytes(UINT64 ullBudgetBytes) { m_ullConfigBudgetBytes = ullBudgetBytes; }
+	Stats GetStats() const;
+
+private:
+	struct Entry
+	{
+		std::shared_ptr<DZW_VulkanWrap::Texture> pTexture;
+		UINT64 ullSize = 0;
+		UINT64 ullLastUsedFrame = 0;
+	};
+
+	static std::string MakeKey(const std::filesystem::path& filepath);
+	void UpdateBudget();
+	void Evict();
+
+private:
+	VulkanRenderer* m_pRenderer = nullptr;
+	UINT m_uiFramesInFlight = 1;
+	UINT64 m_ullFrame = 0;
+
+	std::unordered_map<std::string, Entry> m_mapEntry;
+	UINT64 m_ullResidentBytes = 0;
+
+	UINT64 m_ullConfigBudgetBytes = 0;
+	UINT64 m_ullBudgetBytes = 0;
+	bool m_bOverBudgetWarned = false;
+
+	UINT64 m_ullHitCount = 0;
+	UINT64 m_ullMissCount = 0;
+	UINT64 m_ullEvictionCount = 0;
+};
@@ -0,0 +1,221 @@
+#include "TextureStreamer.h"
+#include "VulkanRenderer.h"
+#include "Log.h"
+
+#include <algorithm>
+
+using DZW_VulkanWrap::Texture;
+
+TextureStreamer::~TextureStreamer()
+{
+	Stop();
+}
+
+void TextureStreamer::Start(VulkanRenderer* pRenderer, UINT uiFramesInFlight, UINT uiWorkerCount)
+{
+	Stop();
+
+	m_pRenderer = pRenderer;
+	m_vecRecorded.resize(std::max(uiFramesInFlight, 1u));
+
+	if (uiWorkerCount == 0)
+		uiWorkerCount = std::clamp(std::thread::hardware_concurrency() / 4, 1u, 2u);
+
+	m_bRunning = true;
+	for (UINT i = 0; i < uiWorkerCount; ++i)
+	{
+		m_vecWorker.emplace_back(&TextureStreamer::WorkerThreadFunc, this);
+	}
+
+	Log::Info("Texture streamer: {} worker threads", uiWorkerCount);
+}
+
+void TextureStreamer::Stop()
+{
+	if (!m_bRunning)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bRunning = false;
+		m_queueRequest.clear();
+	}
+	m_RequestCondition.notify_all();
+	m_StagedCondition.notify_all();
+
+	for (auto& worker : m_vecWorker)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+	m_vecWorker.clear();
+
+	for (auto& pTexture : m_queueStaged)
+	{
+		pTexture->ReleaseStaging();
+	}
+	m_queueStaged.clear();
+
+	for (auto& pTexture : m_vecProgressive)
+	{
+		pTexture->ReleaseStaging();
+	}
+	m_vecProgressive.clear();
+
+	for (auto& vecRecorded : m_vecRecorded)
+	{
+		for (auto& pTexture : vecRecorded)
+		{
+			pTexture->ReleaseStaging();
+		}
+		vecRecorded.clear();
+	}
+	m_uiPendingCount = 0;
+}
+
+void TextureStreamer::Enqueue(const std::shared_ptr<Texture>& pTexture)
+{
+	ASSERT(m_bRunning, "Texture streamer is not started");
+
+	++m_uiPendingCount;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		pTexture->m_LoadState = Texture::LoadState::LOAD_STATE_QUEUED;
+		m_queueRequest.push_back(pTexture);
+	}
+	m_RequestCondition.notify_one();
+}
+
+void TextureStreamer::Finish(const std::shared_ptr<Texture>& pTexture)
+{
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		if (pTexture->m_LoadState == Texture::LoadState::LOAD_STATE_RESIDENT)
+			return;
+
+		auto iterRequest = std::find(m_queueRequest.begin(), m_queueRequest.end(), pTexture);
+		if (pTexture->m_LoadState == Texture::LoadState::LOAD_STATE_PARTIAL)
+		{
+			//Only the remaining finer mips are uploaded below
+			m_vecProgressive.erase(std::find(m_vecProgressive.begin(), m_vecProgressive.end(), pTexture));
+		}
+		else if (iterRequest != m_queueRequest.end())
+		{
+			//Not picked up by a worker yet, prepare it on this thread
+			m_queueRequest.erase(iterRequest);
+			pTexture->m_LoadState = Texture::LoadState::LOAD_STATE_PREPARING;
+			lock.unlock();
+			pTexture->PrepareStaging();
+			lock.lock();
+			pTexture->m_LoadState = Texture::LoadState::LOAD_STATE_STAGED;
+		}
+		else
+		{
+			m_StagedCondition.wait(lock, [&]() { return pTexture->m_LoadState == Texture::LoadState::LOAD_STATE_STAGED; });
+			m_queueStaged.erase(std::find(m_queueStaged.begin(), m_queueStaged.end(), pTexture));
+		}
+	}
+
+	VkImageView retiredView;
+	VkCommandBuffer singleTimeCommandBuffer = m_pRenderer->BeginSingleTimeCommand();
+	pTexture->RecordUpload(singleTimeCommandBuffer, 0, retiredView);
+	m_pRenderer->EndSingleTimeCommand(singleTimeCommandBuffer);
+
+	//Frames in flight may still sample the coarser view
+	m_pRenderer->RetireImageView(retiredView);
+
+	pTexture->ReleaseStaging();
+	--m_uiPendingCount;
+}
+
+void TextureStreamer::Update(UINT uiFrameIdx)
+{
+	auto& vecRecorded = m_vecRecorded[uiFrameIdx % static_cast<UINT>(m_vecRecorded.size())];
+	for (auto& pTexture : vecRecorded)
+	{
+		pTexture->ReleaseStaging();
+	}
+	vecRecorded.clear();
+}
+
+void TextureStreamer::RecordUploads(VkCommandBuffer commandBuffer, UINT uiFrameIdx)
+{
+	std::vector<std::shared_ptr<Texture>> vecUpload;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		UINT64 ullBytes = 0;
+		while (!m_queueStaged.empty() && (vecUpload.empty() || ullBytes + m_queueStaged.front()->m_Size <= MAX_UPLOAD_BYTES_PER_FRAME))
+		{
+			ullBytes += m_queueStaged.front()->m_Size;
+			vecUpload.push_back(std::move(m_queueStaged.front()));
+			m_queueStaged.pop_front();
+		}
+	}
+
+	UINT uiSlot = uiFrameIdx % static_cast<UINT>(m_vecRecorded.size());
+	auto recordUpload = [&](const std::shared_ptr<Texture>& pTexture, UINT uiBaseMipLevel)
+	{
+		VkImageView retiredView;
+		pTexture->RecordUpload(commandBuffer, uiBaseMipLevel, retiredView);
+		//Every frame slot rewrites its descriptor sets before the renderer's deferred destruction frees the view
+		m_pRenderer->RetireImageView(retiredView);
+
+		//The staging buffer is read by every step, it is only released after the last one
+		if (pTexture->IsResident())
+		{
+			m_vecRecorded[uiSlot].push_back(pTexture);
+			--m_uiPendingCount;
+			return true;
+		}
+		return false;
+	};
+
+	std::erase_if(m_vecProgressive, [&](const std::shared_ptr<Texture>& pTexture) { return recordUpload(pTexture, pTexture->m_uiResidentMipLevel - 1); });
+
+	for (auto& pTexture : vecUpload)
+	{
+		if (!recordUpload(pTexture, GetTailMipLevel(*pTexture)))
+			m_vecProgressive.push_back(std::move(pTexture));
+	}
+}
+
+UINT TextureStreamer::GetTailMipLevel(const Texture& texture)
+{
+	if (!texture.IsProgressive())
+		return 0;
+
+	UINT uiMipLevel = 0;
+	while (uiMipLevel + 1 < texture.m_uiMipLevelNum
+		&& std::max(texture.m_uiWidth >> uiMipLevel, texture.m_uiHeight >> uiMipLevel) > PROGRESSIVE_TAIL_EXTENT)
+	{
+		++uiMipLevel;
+	}
+	return uiMipLevel;
+}
+
+void TextureStreamer::WorkerThreadFunc()
+{
+	while (true)
+	{
+		std::shared_ptr<Texture> pTexture;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_RequestCondition.wait(lock, [this]() { return !m_bRunning || !m_queueRequest.empty(); });
+			if (!m_bRunning)
+				return;
+
+			pTexture = std::move(m_queueRequest.front());
+			m_queueRequest.pop_front();
+			pTexture->m_LoadState = Texture::LoadState::LOAD_STATE_PREPARING;
+		}
+
+		pTexture->PrepareStaging();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			pTexture->m_LoadState = Texture::LoadState::LOAD_STATE_STAGED;
+			m_queueStaged.push_back(std::move(pTexture));
+		}
+		m_StagedCondition.notify_all();
+	}
+}
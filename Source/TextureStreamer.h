@@ -0,0 +1,71 @@
+#pragma once
+#include "Core.h"
+
+#include "VulkanWrap.h"
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+//Loads texture data in the background so creating a texture never blocks the render thread on file IO or decoding
+//TextureFactor creates the image and a 1x1 placeholder up front and enqueues the texture here. Worker threads read,
+//decode and write the data into a staging buffer, the render thread records the copy into the command buffer of the
+//current frame and frees the staging buffer once that frame's fence has signaled again
+//Textures with a mip chain in the file are uploaded tail first: every mip up to PROGRESSIVE_TAIL_EXTENT in the first
+//frame, then one larger mip per frame. The image view is recreated to start at the finest resident mip each time and
+//the old one goes through the renderer's deferred destruction queue
+//Holders of a descriptor set compare Texture::m_uiVersion per frame and rewrite their own set when it changed
+class TextureStreamer
+{
+public:
+	static constexpr UINT64 MAX_UPLOAD_BYTES_PER_FRAME = 64ull << 20;	//at least one texture is uploaded every frame
+	static constexpr UINT PROGRESSIVE_TAIL_EXTENT = 128;				//first upload covers every mip no larger than this
+
+public:
+	TextureStreamer() = default;
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	//uiWorkerCount == 0 picks from the core count
+	void Start(VulkanRenderer* pRenderer, UINT uiFramesInFlight, UINT uiWorkerCount = 0);
+	//The device must be idle, staging buffers of queued and recorded uploads are released
+	void Stop();
+
+	void Enqueue(const std::shared_ptr<DZW_VulkanWrap::Texture>& pTexture);
+
+	//Uploads the texture (or its remaining mips) right away with a single time command, for users that copy the image handles
+	void Finish(const std::shared_ptr<DZW_VulkanWrap::Texture>& pTexture);
+
+	//Called once per frame on the render thread after the fence of uiFrameIdx has been waited
+	void Update(UINT uiFrameIdx);
+	//Records the uploads of finished textures and the next mip of partially resident ones before the first render pass
+	void RecordUploads(VkCommandBuffer commandBuffer, UINT uiFrameIdx);
+
+	UINT GetPendingCount() const { return m_uiPendingCount; }
+
+private:
+	void WorkerThreadFunc();
+	static UINT GetTailMipLevel(const DZW_VulkanWrap::Texture& texture);
+
+private:
+	VulkanRenderer* m_pRenderer = nullptr;
+
+	//render thread only
+	std::vector<std::vector<std::shared_ptr<DZW_VulkanWrap::Texture>>> m_vecRecorded;	//per frame, staging freed on reuse
+	std::vector<std::shared_ptr<DZW_VulkanWrap::Texture>> m_vecProgressive;	//partially resident, keep their staging
+
+	std::vector<std::thread> m_vecWorker;
+	std::atomic<bool> m_bRunning = false;
+	std::atomic<UINT> m_uiPendingCount = 0;		//queued, being prepared, staged or partially resident
+
+	//guards the queues and Texture::m_LoadState transitions
+	std::mutex m_Mutex;
+	std::condition_variable m_RequestCondition;
+	std::condition_variable m_StagedCondition;
+	std::deque<std::shared_ptr<DZW_VulkanWrap::Texture>> m_queueRequest;
+	std::deque<std::shared_ptr<DZW_VulkanWrap::Texture>> m_queueStaged;
+};
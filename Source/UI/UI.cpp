@@ -7,6 +7,10 @@
 
 #include "../VulkanRenderer.h"
 #include "../VulkanUtils.h"
+#include "../EmbeddedShader.h"
+#include "../ImageDecoder.h"
+
+#include <thread>
 
 static PhysicalDeviceInfo g_PhysicalDeviceInfo;
 
@@ -132,6 +136,35 @@ void UI::Draw()
     ImGui::Begin("Stat");
     ImGui::Text("FPS: %d", m_pRenderer->GetFPS());
 
+    if (ImGui::CollapsingHeader("Shadow", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::Combo("Mode##Shadow", m_pRenderer->GetShadowMode(), "Hard\0PCF\0PCSS\0");
+        //뾶specialization constant޸ĺrenderer߽֡ؽpipeline
+        if (*m_pRenderer->GetShadowMode() != VulkanRenderer::SHADOW_MODE_HARD)
+            ImGui::SliderInt("PCF Radius##Shadow", m_pRenderer->GetShadowPCFRadius(), VulkanRenderer::SHADOW_FILTER_RADIUS_MIN, VulkanRenderer::SHADOW_FILTER_RADIUS_MAX);
+        if (*m_pRenderer->GetShadowMode() == VulkanRenderer::SHADOW_MODE_PCSS)
+            ImGui::SliderInt("Blocker Search Radius##Shadow", m_pRenderer->GetShadowBlockerSearchRadius(), VulkanRenderer::SHADOW_FILTER_RADIUS_MIN, VulkanRenderer::SHADOW_FILTER_RADIUS_MAX);
+        ImGui::Checkbox("Cache##Shadow", m_pRenderer->GetShadowCacheEnable());
+        ImGui::SameLine();
+        ImGui::Text(m_pRenderer->IsShadowMapRenderedLastFrame() ? "(rendered)" : "(cached)");
+        ImGui::Combo("Light##Shadow", m_pRenderer->GetShadowLightType(), "Directional (CSM)\0Point (Cube)\0");
+        if (*m_pRenderer->GetShadowLightType() == VulkanRenderer::SHADOW_LIGHT_POINT)
+        {
+            ImGui::SliderFloat("Far Plane##Shadow", m_pRenderer->GetOmniShadowFarPlane(), 10.f, 5000.f);
+            ImGui::Text("Cube faces drawn: %u", m_pRenderer->GetOmniShadowDrawnFaceCount());
+        }
+        else
+        {
+            ImGui::SliderInt("Cascades##Shadow", m_pRenderer->GetShadowCascadeCount(), 1, static_cast<int>(VulkanRenderer::SHADOW_CASCADE_MAX));
+            ImGui::SliderFloat("Split Lambda##Shadow", m_pRenderer->GetShadowCascadeSplitLambda(), 0.f, 1.f);
+            for (int i = 0; i < *m_pRenderer->GetShadowCascadeCount(); ++i)
+            {
+                ImGui::Text("Cascade %d: %.1f, casters %u", i, m_pRenderer->GetShadowCascadeSplitDepth(i), m_pRenderer->GetShadowCascadeCasterCount(i));
+            }
+        }
+        ImGui::Text("Common Pass GPU: %.3f ms", m_pRenderer->GetCommonPassGPUTime());
+    }
+
     if (ImGui::CollapsingHeader("Skybox", ImGuiTreeNodeFlags_DefaultOpen))
     {
         ImGui::Checkbox("Enable##Skybox", m_pRenderer->GetSkyboxEnable());
@@ -145,11 +178,124 @@ void UI::Draw()
         ImGui::DragFloat("Split", m_pRenderer->GetMeshGridSplit(), 1.f, 1.f, 100.f, "%.1f");
         ImGui::DragFloat("Line Width", m_pRenderer->GetMeshGridLineWidth(), 1.f, 1.f, 20.f, "%.1f");
     }
+
+    if (ImGui::CollapsingHeader("Texture", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        auto cacheStats = m_pRenderer->GetTextureCache()->GetStats();
+        ImGui::Text("Resident %u (in use %u), %.1f/%.1f MB", cacheStats.uiResidentCount, cacheStats.uiReferencedCount,
+            cacheStats.ullResidentBytes / (1024.0 * 1024.0), cacheStats.ullBudgetBytes / (1024.0 * 1024.0));
+        ImGui::Text("Hit %llu, miss %llu, evict %llu", cacheStats.ullHitCount, cacheStats.ullMissCount, cacheStats.ullEvictionCount);
+        ImGui::Text("Streaming %u", m_pRenderer->GetTextureStreamer()->GetPendingCount());
+        ImGui::Text("Samplers %u, anisotropy %.0fx", m_pRenderer->GetSamplerCache()->GetSamplerCount(), m_pRenderer->GetSamplerCache()->GetMaxAnisotropy());
+
+        static std::vector<ImageDecoder::BenchmarkResult> vecDecodeBenchmarkResult;
+        if (ImGui::Button("Decode Benchmark##Texture"))
+        {
+            UINT uiMaxThread = std::max(std::thread::hardware_concurrency(), 1u);
+            std::vector<UINT> vecThreadCount = { 1 };
+            for (UINT uiThread = 2; uiThread < uiMaxThread; uiThread *= 2)
+                vecThreadCount.push_back(uiThread);
+            if (uiMaxThread > 1)
+                vecThreadCount.push_back(uiMaxThread);
+            vecDecodeBenchmarkResult = ImageDecoder::RunBenchmark(vecThreadCount);
+        }
+        for (const auto& result : vecDecodeBenchmarkResult)
+        {
+            ImGui::Text("%2u threads %-6s: decode %.0f MB/s, expand %.0f MB/s%s", result.uiThreadCount, ImageDecoder::GetSimdLevelName(result.level),
+                result.fDecodeMBPerSecond, result.fExpandMBPerSecond, result.bMatchScalar ? "" : ", mismatch");
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Planet", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::Checkbox("Enable##Planet", m_pRenderer->GetPlanetEnable());
+        ImGui::Checkbox("Impostor##Planet", m_pRenderer->GetPlanetImpostorEnable());
+        ImGui::SliderFloat("Impostor Threshold##Planet", m_pRenderer->GetPlanetImpostorPixelThreshold(), 1.f, 64.f, "%.1f px");
+        ImGui::SliderFloat("Tessellation Error##Planet", m_pRenderer->GetPlanetTessellationError(), 0.1f, 4.f, "%.2f px");
+        ImGui::Text("Mesh %u, impostor %u", m_pRenderer->GetPlanetMeshCount(), m_pRenderer->GetPlanetImpostorCount());
+        const auto& aryLevelCount = m_pRenderer->GetPlanetLevelInstanceCount();
+        std::string strLevel = "Levels:";
+        for (UINT uiCount : aryLevelCount)
+            strLevel += " " + std::to_string(uiCount);
+        ImGui::TextUnformatted(strLevel.c_str());
+
+        ImGui::Checkbox("Terrain##Planet", m_pRenderer->GetPlanetTerrainEnable());
+        ImGui::SliderFloat("Terrain Activate##Planet", m_pRenderer->GetPlanetTerrainActivatePixel(), 32.f, 2048.f, "%.0f px", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Terrain Error##Planet", m_pRenderer->GetPlanetTerrain()->GetMaxScreenSpaceError(), 0.5f, 16.f, "%.1f px");
+        auto terrainStats = m_pRenderer->GetPlanetTerrain()->GetStats();
+        ImGui::Text("Terrain %s: draw %u, resident %u/%u, pending %u, level %u", m_pRenderer->GetPlanetTerrainBodyDesc(),
+            terrainStats.uiDrawChunkCount, terrainStats.uiResidentChunkCount, terrainStats.uiSlotCount,
+            terrainStats.uiPendingCount, terrainStats.uiDeepestLevel);
+
+        if (m_pRenderer->IsVirtualTextureSupported())
+        {
+            ImGui::Checkbox("Virtual Texture##Planet", m_pRenderer->GetVirtualTextureEnable());
+            auto vtStats = m_pRenderer->GetVirtualTexture()->GetStats();
+            ImGui::Text("VT pages %u/%u, pending %u, requested %u, upload %u, layers %u/%u",
+                vtStats.uiResidentPageCount, vtStats.uiSlotCount, vtStats.uiPendingCount, vtStats.uiRequestedPageCount,
+                vtStats.uiUploadCount, vtStats.uiReadyLayerCount, vtStats.uiLayerCount);
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Orbit", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        auto pOrbitSystem = m_pRenderer->GetOrbitSystem();
+        ImGui::Checkbox("Pause##Orbit", pOrbitSystem->GetPaused());
+        ImGui::SliderFloat("Time Warp##Orbit", pOrbitSystem->GetTimeWarp(), -3650.f, 3650.f, "%.2f days/s", ImGuiSliderFlags_Logarithmic);
+        ImGui::Combo("Solver##Orbit", pOrbitSystem->GetSolver(), "Newton\0Halley\0");
+        ImGui::Text("Day %.1f, bodies %u", pOrbitSystem->GetSimulationDays(), pOrbitSystem->GetBodyCount());
+        ImGui::Text("Update: %.3f ms", pOrbitSystem->GetLastUpdateMs());
+
+        static std::vector<OrbitSystem::BenchmarkResult> vecBenchmarkResult;
+        if (ImGui::Button("Benchmark##Orbit"))
+            vecBenchmarkResult = OrbitSystem::RunBenchmark({ 1000, 10000, 50000, 100000 });
+        for (const auto& result : vecBenchmarkResult)
+        {
+            ImGui::Text("%s %6u: %.3f ms, %.0f bodies/ms", (result.solver == OrbitSystem::KEPLER_SOLVER_HALLEY) ? "Halley" : "Newton",
+                result.uiBodyCount, result.fMsPerUpdate, result.fBodiesPerMs);
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Asteroid Belt", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        auto pAsteroidBelt = m_pRenderer->GetAsteroidBelt();
+        ImGui::Checkbox("Enable##AsteroidBelt", m_pRenderer->GetAsteroidBeltEnable());
+        ImGui::SliderInt("Count##AsteroidBelt", m_pRenderer->GetAsteroidCount(), 0, static_cast<int>(VulkanRenderer::ASTEROID_BELT_CAPACITY));
+        ImGui::Checkbox("GPU Compute##AsteroidBelt", m_pRenderer->GetAsteroidBeltGPUCompute());
+        if (*m_pRenderer->GetAsteroidBeltGPUCompute())
+        {
+            ImGui::Text("Update: compute shader, frustum culled indirect draw");
+        }
+        else
+        {
+            ImGui::SliderInt("SIMD##AsteroidBelt", pAsteroidBelt->GetSimdLevel(), 0, AsteroidBelt::GetMaxSupportedSimdLevel(),
+                AsteroidBelt::GetSimdLevelName(static_cast<OrbitSimdLevel>(*pAsteroidBelt->GetSimdLevel())));
+            ImGui::Text("Update: %.3f ms", pAsteroidBelt->GetLastUpdateMs());
+        }
+
+        static std::vector<AsteroidBelt::BenchmarkResult> vecBenchmarkResult;
+        if (ImGui::Button("Benchmark##AsteroidBelt"))
+            vecBenchmarkResult = AsteroidBelt::RunBenchmark({ 100000, 1000000 });
+        for (const auto& result : vecBenchmarkResult)
+        {
+            ImGui::Text("%-6s %7u: %.3f ms, %.0f bodies/ms, err %.1e", AsteroidBelt::GetSimdLevelName(result.level),
+                result.uiBodyCount, result.fMsPerUpdate, result.fBodiesPerMs, result.fMaxError);
+        }
+
+        static std::vector<AsteroidBeltCompute::BenchmarkResult> vecGPUBenchmarkResult;
+        if (ImGui::Button("GPU Benchmark##AsteroidBelt"))
+            vecGPUBenchmarkResult = AsteroidBeltCompute::RunHeadlessBenchmark({ 100000, 1000000 });
+        for (const auto& result : vecGPUBenchmarkResult)
+        {
+            ImGui::Text("%s %7u: %.3f ms, %.0f bodies/ms, err %.1e", result.strDeviceName.c_str(),
+                result.uiBodyCount, result.fMsPerUpdate, result.fBodiesPerMs, result.fMaxError);
+        }
+    }
     ImGui::End();
 
     ImGui::Begin("Camera");
-    auto& pos = m_pRenderer->m_Camera.GetPosition();
-    auto& focalPoint = m_pRenderer->m_Camera.GetFocalPoint();
+    const auto& pos = m_pRenderer->m_Camera.GetWorldPosition();
+    const auto& focalPoint = m_pRenderer->m_Camera.GetWorldFocalPoint();
     auto upDirection = m_pRenderer->m_Camera.GetUpDirection();
 
     ImGui::Text("Pos:   %.2f, %.2f, %.2f", pos.x, pos.y, pos.z);
@@ -157,6 +303,7 @@ void UI::Draw()
     ImGui::Text("Up Dir: %.2f, %.2f, %.2f", upDirection.x, upDirection.y, upDirection.z);
 
     ImGui::Text("Vertical FOV: %.1f", m_pRenderer->m_Camera.GetVerticalFOV());
+    ImGui::Text("Depth: %s", m_pRenderer->m_Camera.IsReversedZ() ? "reversed-Z, infinite far" : "standard");
     ImGui::Text("Yaw:    %.1f", fmod(m_pRenderer->m_Camera.GetYaw(), 360.f));
     ImGui::Text("Pitch:  %.1f", fmod(m_pRenderer->m_Camera.GetPitch(), 360.f));
     ImGui::Text("Roll:   %.1f", fmod(m_pRenderer->m_Camera.GetRoll(), 360.f));
@@ -694,13 +841,14 @@ void UI::CreateUIPipeline()
 
 void UI::CreateUIShaderModule()
 {
-    auto vertShaderData = DZW_VulkanUtils::ReadShaderFile("./Assert/Shader/ImGui/imgui_vert.spv");
-    auto sRGBVertShaderData = DZW_VulkanUtils::ReadShaderFile("./Assert/Shader/ImGui/imgui_vert_srgb.spv");
-    auto fragShaderData = DZW_VulkanUtils::ReadShaderFile("./Assert/Shader/ImGui/imgui_frag.spv");
-
-    m_UIVertexShaderModule = DZW_VulkanUtils::CreateShaderModule(m_pRenderer->GetLogicalDevice(), vertShaderData);
-    m_UIVertexSRGBShaderModule = DZW_VulkanUtils::CreateShaderModule(m_pRenderer->GetLogicalDevice(), sRGBVertShaderData);
-    m_UIFragmentShaderModule = DZW_VulkanUtils::CreateShaderModule(m_pRenderer->GetLogicalDevice(), fragShaderData);
+    auto pVertShader = DZW_EmbeddedShader::FindEmbeddedSpirv("ImGui", VK_SHADER_STAGE_VERTEX_BIT);
+    auto pSRGBVertShader = DZW_EmbeddedShader::FindEmbeddedSpirv("ImGuiSRGB", VK_SHADER_STAGE_VERTEX_BIT);
+    auto pFragShader = DZW_EmbeddedShader::FindEmbeddedSpirv("ImGui", VK_SHADER_STAGE_FRAGMENT_BIT);
+    ASSERT(pVertShader && pSRGBVertShader && pFragShader, "No embedded ImGui spirv");
+
+    m_UIVertexShaderModule = DZW_VulkanUtils::CreateShaderModule(m_pRenderer->GetLogicalDevice(), pVertShader->spirv);
+    m_UIVertexSRGBShaderModule = DZW_VulkanUtils::CreateShaderModule(m_pRenderer->GetLogicalDevice(), pSRGBVertShader->spirv);
+    m_UIFragmentShaderModule = DZW_VulkanUtils::CreateShaderModule(m_pRenderer->GetLogicalDevice(), pFragShader->spirv);
 }
 
 void UI::CreateUIFontSampler()
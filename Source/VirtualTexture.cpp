@@ -0,0 +1,626 @@
+#include "VirtualTexture.h"
+#include "ColorSpace.h"
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "stb_image.h"
+
+namespace
+{
+	constexpr char PAGE_FILE_MAGIC[4] = { 'V', 'T', 'P', 'F' };
+	constexpr UINT PAGE_FILE_VERSION = 1;
+
+	//Mips are averaged in linear space, the pages stay sRGB encoded like the atlas format
+	using DZW_ColorSpace::GetSrgbToLinearTable;
+	using DZW_ColorSpace::LinearToSrgb;
+
+	//Bilinear resize to the baked size, only used when the source is not already a 2:1 power of two
+	std::vector<UCHAR> ResizeImage(const UCHAR* pSrc, UINT uiSrcWidth, UINT uiSrcHeight, UINT uiWidth, UINT uiHeight)
+	{
+		std::vector<UCHAR> vecDst(static_cast<size_t>(uiWidth) * uiHeight * 4);
+		if (uiSrcWidth == uiWidth && uiSrcHeight == uiHeight)
+		{
+			memcpy(vecDst.data(), pSrc, vecDst.size());
+			return vecDst;
+		}
+
+		float fScaleX = static_cast<float>(uiSrcWidth) / uiWidth;
+		float fScaleY = static_cast<float>(uiSrcHeight) / uiHeight;
+		for (UINT y = 0; y < uiHeight; ++y)
+		{
+			float fY = std::clamp((y + 0.5f) * fScaleY - 0.5f, 0.f, static_cast<float>(uiSrcHeight - 1));
+			UINT y0 = static_cast<UINT>(fY);
+			UINT y1 = std::min(y0 + 1, uiSrcHeight - 1);
+			float ty = fY - y0;
+			for (UINT x = 0; x < uiWidth; ++x)
+			{
+				float fX = (x + 0.5f) * fScaleX - 0.5f;
+				if (fX < 0.f)
+					fX += uiSrcWidth;
+				UINT x0 = static_cast<UINT>(fX) % uiSrcWidth;
+				UINT x1 = (x0 + 1) % uiSrcWidth; //u wraps around the planet
+				float tx = fX - std::floor(fX);
+				for (UINT c = 0; c < 4; ++c)
+				{
+					float f00 = pSrc[(static_cast<size_t>(y0) * uiSrcWidth + x0) * 4 + c];
+					float f10 = pSrc[(static_cast<size_t>(y0) * uiSrcWidth + x1) * 4 + c];
+					float f01 = pSrc[(static_cast<size_t>(y1) * uiSrcWidth + x0) * 4 + c];
+					float f11 = pSrc[(static_cast<size_t>(y1) * uiSrcWidth + x1) * 4 + c];
+					float f = (f00 * (1.f - tx) + f10 * tx) * (1.f - ty) + (f01 * (1.f - tx) + f11 * tx) * ty;
+					vecDst[(static_cast<size_t>(y) * uiWidth + x) * 4 + c] = static_cast<UCHAR>(f + 0.5f);
+				}
+			}
+		}
+		return vecDst;
+	}
+
+	std::vector<UCHAR> DownsampleImage(const std::vector<UCHAR>& vecSrc, UINT uiSrcWidth, UINT uiSrcHeight)
+	{
+		const auto& aryToLinear = GetSrgbToLinearTable();
+		UINT uiWidth = uiSrcWidth / 2;
+		UINT uiHeight = uiSrcHeight / 2;
+		std::vector<UCHAR> vecDst(static_cast<size_t>(uiWidth) * uiHeight * 4);
+		for (UINT y = 0; y < uiHeight; ++y)
+		{
+			const UCHAR* pRow0 = vecSrc.data() + static_cast<size_t>(2 * y) * uiSrcWidth * 4;
+			const UCHAR* pRow1 = pRow0 + static_cast<size_t>(uiSrcWidth) * 4;
+			UCHAR* pDst = vecDst.data() + static_cast<size_t>(y) * uiWidth * 4;
+			for (UINT x = 0; x < uiWidth; ++x)
+			{
+				const UCHAR* p00 = pRow0 + 8 * x;
+				const UCHAR* p01 = pRow1 + 8 * x;
+				for (UINT c = 0; c < 3; ++c)
+				{
+					float f = aryToLinear[p00[c]] + aryToLinear[p00[4 + c]] + aryToLinear[p01[c]] + aryToLinear[p01[4 + c]];
+					pDst[4 * x + c] = LinearToSrgb(f * 0.25f);
+				}
+				pDst[4 * x + 3] = static_cast<UCHAR>((p00[3] + p00[7] + p01[3] + p01[7] + 2) / 4);
+			}
+		}
+		return vecDst;
+	}
+}
+
+VirtualTexture::~VirtualTexture()
+{
+	Stop();
+}
+
+void VirtualTexture::Start(const std::vector<std::filesystem::path>& vecSource, UINT uiVirtualWidth, UINT64 uiBudgetBytes,
+	UINT uiMaxAtlasDimension, UINT uiFramesInFlight, UINT uiWorkerCount)
+{
+	Stop();
+
+	//2:1 equirectangular, the coarsest mip is 2 x 1 pages
+	m_uiVirtualWidth = std::bit_floor(std::max(uiVirtualWidth, 2 * PAGE_SIZE));
+	m_uiPageCountX = m_uiVirtualWidth / PAGE_SIZE;
+	m_uiMipCount = static_cast<UINT>(std::countr_zero(m_uiPageCountX / 2)) + 1;
+
+	m_vecMipBase.assign(m_uiMipCount + 1, 0);
+	for (UINT uiMip = 0; uiMip < m_uiMipCount; ++uiMip)
+	{
+		m_vecMipBase[uiMip + 1] = m_vecMipBase[uiMip] + GetMipPageCountX(uiMip) * GetMipPageCountY(uiMip);
+	}
+
+	m_vecLayer.clear();
+	for (const auto& sourcePath : vecSource)
+	{
+		auto pLayer = std::make_unique<Layer>();
+		pLayer->sourcePath = sourcePath;
+		pLayer->pageFilePath = sourcePath;
+		pLayer->pageFilePath += ".vtp";
+		if (sourcePath.empty())
+			pLayer->uiState = LAYER_STATE_FAILED;
+		m_vecLayer.push_back(std::move(pLayer));
+	}
+	m_uiPageIndexCount = m_vecMipBase[m_uiMipCount] * GetLayerCount();
+
+	//Square atlas, big enough for the pinned coarsest mips and the slots waiting for the frames in flight
+	m_uiFramesInFlight = std::max(uiFramesInFlight, 1u);
+	UINT uiMinSlot = 2 * GetLayerCount() + MAX_UPLOAD_PER_FRAME * (m_uiFramesInFlight + 1);
+	UINT uiPagesPerSide = static_cast<UINT>(std::sqrt(static_cast<double>(uiBudgetBytes / PAGE_BYTES)));
+	uiPagesPerSide = std::max(uiPagesPerSide, static_cast<UINT>(std::ceil(std::sqrt(static_cast<double>(uiMinSlot)))));
+	m_uiAtlasPagesPerSide = std::min({ uiPagesPerSide, MAX_ATLAS_PAGES_PER_SIDE, uiMaxAtlasDimension / PAGE_STRIDE });
+	m_uiSlotCount = m_uiAtlasPagesPerSide * m_uiAtlasPagesPerSide;
+	m_uiFrame = 0;
+
+	m_mapResident.clear();
+	m_listLRU.clear();
+	m_vecRetiredSlot.clear();
+	m_vecFreeSlot.resize(m_uiSlotCount);
+	for (UINT i = 0; i < m_uiSlotCount; ++i)
+	{
+		m_vecFreeSlot[i] = m_uiSlotCount - 1 - i;
+	}
+
+	m_vecPageTable.assign(m_uiPageIndexCount, 0);
+	m_bPageTableDirty = false;
+	++m_uiPageTableVersion;
+
+	if (uiWorkerCount == 0)
+		uiWorkerCount = std::clamp(std::thread::hardware_concurrency() / 4, 1u, 2u);
+
+	m_bRunning = true;
+	m_LayerThread = std::thread(&VirtualTexture::LayerThreadFunc, this);
+	for (UINT i = 0; i < uiWorkerCount; ++i)
+	{
+		m_vecWorker.emplace_back(&VirtualTexture::WorkerThreadFunc, this);
+	}
+
+	Log::Info("Virtual texture: {} layers, {}x{} virtual, {} mips, atlas {}x{} pages ({:.1f} MB)", GetLayerCount(),
+		m_uiVirtualWidth, m_uiVirtualWidth / 2, m_uiMipCount, m_uiAtlasPagesPerSide, m_uiAtlasPagesPerSide,
+		static_cast<double>(m_uiSlotCount) * PAGE_BYTES / (1024.0 * 1024.0));
+}
+
+void VirtualTexture::Stop()
+{
+	if (!m_bRunning)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_bRunning = false;
+		m_queueRequest = {};
+	}
+	m_RequestCondition.notify_all();
+
+	//A bake in progress finishes its current layer first
+	if (m_LayerThread.joinable())
+		m_LayerThread.join();
+
+	for (auto& worker : m_vecWorker)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+	m_vecWorker.clear();
+
+	m_setPending.clear();
+	m_vecFinished.clear();
+}
+
+UINT VirtualTexture::MakeIndex(const PageCoord& coord) const
+{
+	UINT uiPageCountX = GetMipPageCountX(coord.uiMip);
+	UINT uiPageCountY = GetMipPageCountY(coord.uiMip);
+	return m_vecMipBase[coord.uiMip] * GetLayerCount() + coord.uiLayer * uiPageCountX * uiPageCountY + coord.uiY * uiPageCountX + coord.uiX;
+}
+
+VirtualTexture::PageCoord VirtualTexture::SplitIndex(UINT uiIndex) const
+{
+	PageCoord coord{};
+	while (coord.uiMip + 1 < m_uiMipCount && m_vecMipBase[coord.uiMip + 1] * GetLayerCount() <= uiIndex)
+	{
+		++coord.uiMip;
+	}
+
+	UINT uiPageCountX = GetMipPageCountX(coord.uiMip);
+	UINT uiLocal = uiIndex - m_vecMipBase[coord.uiMip] * GetLayerCount();
+	UINT uiLayerPageCount = uiPageCountX * GetMipPageCountY(coord.uiMip);
+	coord.uiLayer = uiLocal / uiLayerPageCount;
+	uiLocal %= uiLayerPageCount;
+	coord.uiY = uiLocal / uiPageCountX;
+	coord.uiX = uiLocal % uiPageCountX;
+	return coord;
+}
+
+bool VirtualTexture::OpenPageFile(const std::filesystem::path& pageFilePath, PageFileHeader& header)
+{
+	std::ifstream file(pageFilePath, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	file.read(reinterpret_cast<char*>(&header), sizeof(PageFileHeader));
+	return file.good()
+		&& memcmp(header.szMagic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC)) == 0
+		&& header.uiVersion == PAGE_FILE_VERSION
+		&& header.uiPageSize == PAGE_SIZE
+		&& header.uiBorder == PAGE_BORDER;
+}
+
+bool VirtualTexture::BakePageFile(const std::filesystem::path& sourcePath, const std::filesystem::path& pageFilePath, UINT uiVirtualWidth)
+{
+	auto startTime = std::chrono::high_resolution_clock::now();
+
+	int nWidth = 0;
+	int nHeight = 0;
+	int nChannel = 0;
+	stbi_uc* pPixel = stbi_load(sourcePath.string().c_str(), &nWidth, &nHeight, &nChannel, STBI_rgb_alpha);
+	if (!pPixel)
+	{
+		Log::Warn("Virtual texture bake: load {} failed", sourcePath.string());
+		return false;
+	}
+
+	UINT uiWidth = std::clamp(std::bit_floor(static_cast<UINT>(nWidth)), 2 * PAGE_SIZE, uiVirtualWidth);
+	UINT uiHeight = uiWidth / 2;
+	std::vector<UCHAR> vecLevel = ResizeImage(pPixel, static_cast<UINT>(nWidth), static_cast<UINT>(nHeight), uiWidth, uiHeight);
+	stbi_image_free(pPixel);
+
+	PageFileHeader header{};
+	memcpy(header.szMagic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC));
+	header.uiVersion = PAGE_FILE_VERSION;
+	header.uiWidth = uiWidth;
+	header.uiHeight = uiHeight;
+	header.uiPageSize = PAGE_SIZE;
+	header.uiBorder = PAGE_BORDER;
+	header.uiMipCount = static_cast<UINT>(std::countr_zero(uiHeight / PAGE_SIZE)) + 1;
+
+	//Write to a temp file first, an interrupted bake must not leave a valid looking page file
+	auto tmpPath = pageFilePath;
+	tmpPath += ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			Log::Warn("Virtual texture bake: write {} failed", tmpPath.string());
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(PageFileHeader));
+
+		std::vector<UCHAR> vecPage(PAGE_BYTES);
+		for (UINT uiMip = 0; uiMip < header.uiMipCount; ++uiMip)
+		{
+			UINT uiLevelWidth = uiWidth >> uiMip;
+			UINT uiLevelHeight = uiHeight >> uiMip;
+			for (UINT uiPageY = 0; uiPageY < uiLevelHeight / PAGE_SIZE; ++uiPageY)
+			{
+				for (UINT uiPageX = 0; uiPageX < uiLevelWidth / PAGE_SIZE; ++uiPageX)
+				{
+					for (UINT ty = 0; ty < PAGE_STRIDE; ++ty)
+					{
+						int nY = std::clamp(static_cast<int>(uiPageY * PAGE_SIZE + ty) - static_cast<int>(PAGE_BORDER), 0, static_cast<int>(uiLevelHeight) - 1);
+						for (UINT tx = 0; tx < PAGE_STRIDE; ++tx)
+						{
+							UINT uiX = (uiPageX * PAGE_SIZE + tx + uiLevelWidth - PAGE_BORDER) % uiLevelWidth;
+							memcpy(&vecPage[(static_cast<size_t>(ty) * PAGE_STRIDE + tx) * 4],
+								&vecLevel[(static_cast<size_t>(nY) * uiLevelWidth + uiX) * 4], 4);
+						}
+					}
+					file.write(reinterpret_cast<const char*>(vecPage.data()), PAGE_BYTES);
+				}
+			}
+
+			if (uiMip + 1 < header.uiMipCount)
+				vecLevel = DownsampleImage(vecLevel, uiLevelWidth, uiLevelHeight);
+		}
+
+		if (!file.good())
+		{
+			Log::Warn("Virtual texture bake: write {} failed", tmpPath.string());
+			return false;
+		}
+	}
+
+	std::error_code errorCode;
+	std::filesystem::rename(tmpPath, pageFilePath, errorCode);
+	if (errorCode)
+	{
+		Log::Warn("Virtual texture bake: replace {} failed: {}", pageFilePath.string(), errorCode.message());
+		return false;
+	}
+
+	float fCostSec = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startTime).count();
+	Log::Info("Virtual texture baked {} ({}x{}, {} mips) in {:.1f}s", sourcePath.string(), uiWidth, uiHeight, header.uiMipCount, fCostSec);
+	return true;
+}
+
+bool VirtualTexture::ReadPage(UINT uiIndex, std::vector<UCHAR>& vecPixel) const
+{
+	PageCoord coord = SplitIndex(uiIndex);
+	const Layer& layer = *m_vecLayer[coord.uiLayer];
+
+	//The file starts at the layer's finest mip, page counts per mip match the global ones
+	UINT64 uiPage = m_vecMipBase[coord.uiMip] - m_vecMipBase[layer.uiFinestMip] + coord.uiY * GetMipPageCountX(coord.uiMip) + coord.uiX;
+
+	std::ifstream file(layer.pageFilePath, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	vecPixel.resize(PAGE_BYTES);
+	file.seekg(static_cast<std::streamoff>(sizeof(PageFileHeader) + uiPage * PAGE_BYTES));
+	file.read(reinterpret_cast<char*>(vecPixel.data()), PAGE_BYTES);
+	return file.good();
+}
+
+void VirtualTexture::LayerThreadFunc()
+{
+	for (auto& pLayer : m_vecLayer)
+	{
+		if (!m_bRunning)
+			return;
+		if (pLayer->uiState != LAYER_STATE_LOADING)
+			continue;
+
+		//Rebake when the page file is missing, older than the source or baked for a larger virtual size
+		std::error_code errorCode;
+		bool bSourceExist = std::filesystem::exists(pLayer->sourcePath, errorCode);
+		bool bUpToDate = std::filesystem::exists(pLayer->pageFilePath, errorCode)
+			&& (!bSourceExist || std::filesystem::last_write_time(pLayer->pageFilePath, errorCode) >= std::filesystem::last_write_time(pLayer->sourcePath, errorCode));
+
+		PageFileHeader header{};
+		bool bValid = bUpToDate && OpenPageFile(pLayer->pageFilePath, header) && header.uiWidth <= m_uiVirtualWidth;
+		if (!bValid && bSourceExist)
+			bValid = BakePageFile(pLayer->sourcePath, pLayer->pageFilePath, m_uiVirtualWidth) && OpenPageFile(pLayer->pageFilePath, header);
+
+		if (!bValid)
+		{
+			Log::Warn("Virtual texture: no pages for {}, the texture array is used instead", pLayer->sourcePath.string());
+			pLayer->uiState = LAYER_STATE_FAILED;
+			continue;
+		}
+
+		pLayer->uiFinestMip = static_cast<UINT>(std::countr_zero(m_uiVirtualWidth / header.uiWidth));
+		pLayer->uiState = LAYER_STATE_READY;
+	}
+}
+
+void VirtualTexture::WorkerThreadFunc()
+{
+	while (true)
+	{
+		UINT uiIndex = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_RequestMutex);
+			m_RequestCondition.wait(lock, [this]() { return !m_bRunning || !m_queueRequest.empty(); });
+			if (!m_bRunning)
+				return;
+
+			uiIndex = m_queueRequest.top().uiIndex;
+			m_queueRequest.pop();
+		}
+
+		FinishedPage page;
+		page.uiIndex = uiIndex;
+		if (!ReadPage(uiIndex, page.vecPixel))
+		{
+			//A truncated or replaced page file, stop requesting the layer instead of failing every frame
+			auto& layer = *m_vecLayer[SplitIndex(uiIndex).uiLayer];
+			if (layer.uiState.exchange(LAYER_STATE_FAILED) == LAYER_STATE_READY)
+				Log::Warn("Virtual texture: read page {} of {} failed", uiIndex, layer.pageFilePath.string());
+			page.vecPixel.clear();
+		}
+
+		std::lock_guard<std::mutex> lock(m_FinishedMutex);
+		m_vecFinished.push_back(std::move(page));
+	}
+}
+
+void VirtualTexture::Request(UINT uiIndex)
+{
+	if (m_setPending.contains(uiIndex))
+		return;
+
+	m_setPending.insert(uiIndex);
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_queueRequest.push({ SplitIndex(uiIndex).uiMip, uiIndex });
+	}
+	m_RequestCondition.notify_one();
+}
+
+void VirtualTexture::Touch(UINT uiIndex)
+{
+	auto iter = m_mapResident.find(uiIndex);
+	if (iter == m_mapResident.end())
+		return;
+
+	iter->second.uiLastUsedFrame = m_uiFrame;
+	m_listLRU.splice(m_listLRU.begin(), m_listLRU, iter->second.lruIter);
+}
+
+void VirtualTexture::RetireSlots()
+{
+	//An evicted slot may still be referenced by the page table of a frame in flight
+	auto iter = std::partition(m_vecRetiredSlot.begin(), m_vecRetiredSlot.end(),
+		[this](const auto& retired) { return retired.first + m_uiFramesInFlight > m_uiFrame; });
+	for (auto it = iter; it != m_vecRetiredSlot.end(); ++it)
+	{
+		m_vecFreeSlot.push_back(it->second);
+	}
+	m_vecRetiredSlot.erase(iter, m_vecRetiredSlot.end());
+}
+
+void VirtualTexture::EvictUnused(UINT uiWantedFreeSlot)
+{
+	//Least recently requested pages that the last feedback did not ask for, the coarsest mip stays resident
+	auto iter = m_listLRU.end();
+	while (m_vecFreeSlot.size() + m_vecRetiredSlot.size() < uiWantedFreeSlot && iter != m_listLRU.begin())
+	{
+		--iter;
+		auto& entry = m_mapResident.at(*iter);
+		if (entry.uiLastUsedFrame >= m_uiFrame)
+			break;
+
+		if (SplitIndex(*iter).uiMip + 1 == m_uiMipCount)
+			continue;
+
+		m_vecRetiredSlot.push_back({ m_uiFrame, entry.uiSlot });
+		m_mapResident.erase(*iter);
+		iter = m_listLRU.erase(iter);
+		m_bPageTableDirty = true;
+	}
+}
+
+void VirtualTexture::DrainFinishedPages(std::vector<UINT>& vecUploadSlot, UCHAR* pUploadStaging)
+{
+	std::vector<FinishedPage> vecFinished;
+	{
+		//Pages without a free slot wait in the finished list, they stay pending so they are not read again
+		std::lock_guard<std::mutex> lock(m_FinishedMutex);
+		UINT uiCount = std::min({ static_cast<UINT>(m_vecFinished.size()), MAX_UPLOAD_PER_FRAME, static_cast<UINT>(m_vecFreeSlot.size()) });
+		vecFinished.assign(std::make_move_iterator(m_vecFinished.begin()), std::make_move_iterator(m_vecFinished.begin() + uiCount));
+		m_vecFinished.erase(m_vecFinished.begin(), m_vecFinished.begin() + uiCount);
+	}
+
+	for (auto& page : vecFinished)
+	{
+		m_setPending.erase(page.uiIndex);
+		if (page.vecPixel.empty() || m_mapResident.contains(page.uiIndex))
+			continue;
+
+		UINT uiSlot = m_vecFreeSlot.back();
+		m_vecFreeSlot.pop_back();
+
+		memcpy(pUploadStaging + static_cast<size_t>(vecUploadSlot.size()) * PAGE_BYTES, page.vecPixel.data(), PAGE_BYTES);
+		vecUploadSlot.push_back(uiSlot);
+
+		m_listLRU.push_front(page.uiIndex);
+		m_mapResident[page.uiIndex] = { uiSlot, m_uiFrame, m_listLRU.begin() };
+		m_bPageTableDirty = true;
+	}
+	m_uiUploadCount = static_cast<UINT>(vecUploadSlot.size());
+}
+
+void VirtualTexture::RebuildPageTable()
+{
+	//Coarse to fine, a page that is not resident inherits the entry of its parent
+	for (UINT uiMip = m_uiMipCount; uiMip-- > 0;)
+	{
+		for (UINT uiLayer = 0; uiLayer < GetLayerCount(); ++uiLayer)
+		{
+			for (UINT uiY = 0; uiY < GetMipPageCountY(uiMip); ++uiY)
+			{
+				for (UINT uiX = 0; uiX < GetMipPageCountX(uiMip); ++uiX)
+				{
+					UINT uiIndex = MakeIndex({ uiMip, uiLayer, uiX, uiY });
+					auto iter = m_mapResident.find(uiIndex);
+					if (iter != m_mapResident.end())
+					{
+						UINT uiSlot = iter->second.uiSlot;
+						m_vecPageTable[uiIndex] = (uiSlot % m_uiAtlasPagesPerSide) | ((uiSlot / m_uiAtlasPagesPerSide) << 8) | (uiMip << 16) | (1u << 24);
+					}
+					else if (uiMip + 1 < m_uiMipCount)
+					{
+						m_vecPageTable[uiIndex] = m_vecPageTable[MakeIndex({ uiMip + 1, uiLayer, uiX / 2, uiY / 2 })];
+					}
+					else
+					{
+						m_vecPageTable[uiIndex] = 0;
+					}
+				}
+			}
+		}
+	}
+
+	m_bPageTableDirty = false;
+	++m_uiPageTableVersion;
+}
+
+void VirtualTexture::Update(const UINT* pFeedback, std::vector<UINT>& vecUploadSlot, UCHAR* pUploadStaging)
+{
+	++m_uiFrame;
+	vecUploadSlot.clear();
+	RetireSlots();
+
+	//Only the pages wanted this frame stay queued, the ones already handed to a worker still finish
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		while (!m_queueRequest.empty())
+		{
+			m_setPending.erase(m_queueRequest.top().uiIndex);
+			m_queueRequest.pop();
+		}
+	}
+
+	if (!m_bRunning)
+		return;
+
+	UINT uiTopMip = m_uiMipCount - 1;
+	std::vector<UINT> vecMissing;
+
+	//The coarsest mip is pinned, every lookup ends there
+	for (UINT uiLayer = 0; uiLayer < GetLayerCount(); ++uiLayer)
+	{
+		if (m_vecLayer[uiLayer]->uiState != LAYER_STATE_READY)
+			continue;
+
+		for (UINT uiX = 0; uiX < GetMipPageCountX(uiTopMip); ++uiX)
+		{
+			UINT uiIndex = MakeIndex({ uiTopMip, uiLayer, uiX, 0 });
+			if (m_mapResident.contains(uiIndex))
+				Touch(uiIndex);
+			else
+				Request(uiIndex);
+		}
+	}
+
+	m_uiRequestedPageCount = 0;
+	for (UINT uiWord = 0; pFeedback && uiWord < GetFeedbackWordCount(); ++uiWord)
+	{
+		for (UINT uiBits = pFeedback[uiWord]; uiBits != 0; uiBits &= uiBits - 1)
+		{
+			UINT uiIndex = uiWord * 32 + static_cast<UINT>(std::countr_zero(uiBits));
+			if (uiIndex >= m_uiPageIndexCount)
+				break;
+			++m_uiRequestedPageCount;
+
+			PageCoord coord = SplitIndex(uiIndex);
+			const Layer& layer = *m_vecLayer[coord.uiLayer];
+			if (layer.uiState != LAYER_STATE_READY)
+				continue;
+
+			//Below the finest baked mip the layer has no pages, its finest page covering the area is used
+			if (coord.uiMip < layer.uiFinestMip)
+			{
+				UINT uiShift = layer.uiFinestMip - coord.uiMip;
+				coord = { layer.uiFinestMip, coord.uiLayer, coord.uiX >> uiShift, coord.uiY >> uiShift };
+			}
+
+			//Keep the whole chain up to the pinned mip, so a page that is not resident yet falls back to its nearest ancestor
+			while (true)
+			{
+				UINT uiChainIndex = MakeIndex(coord);
+				auto iter = m_mapResident.find(uiChainIndex);
+				if (iter != m_mapResident.end())
+				{
+					if (iter->second.uiLastUsedFrame == m_uiFrame)
+						break; //the rest of the chain was touched by another page
+					Touch(uiChainIndex);
+				}
+				else if (!m_setPending.contains(uiChainIndex))
+				{
+					vecMissing.push_back(uiChainIndex);
+				}
+
+				if (coord.uiMip == uiTopMip)
+					break;
+				coord = { coord.uiMip + 1, coord.uiLayer, coord.uiX / 2, coord.uiY / 2 };
+			}
+		}
+	}
+
+	EvictUnused(MAX_UPLOAD_PER_FRAME * (m_uiFramesInFlight + 1));
+
+	//Everything resident is still wanted: reading more pages would only evict each other
+	if (!m_vecFreeSlot.empty() || !m_vecRetiredSlot.empty())
+	{
+		for (UINT uiIndex : vecMissing)
+		{
+			Request(uiIndex);
+		}
+	}
+
+	DrainFinishedPages(vecUploadSlot, pUploadStaging);
+
+	if (m_bPageTableDirty)
+		RebuildPageTable();
+}
+
+VirtualTexture::Stats VirtualTexture::GetStats() const
+{
+	Stats stats;
+	stats.uiResidentPageCount = static_cast<UINT>(m_mapResident.size());
+	stats.uiSlotCount = m_uiSlotCount;
+	stats.uiPendingCount = static_cast<UINT>(m_setPending.size());
+	stats.uiRequestedPageCount = m_uiRequestedPageCount;
+	stats.uiUploadCount = m_uiUploadCount;
+	stats.uiReadyLayerCount = static_cast<UINT>(std::count_if(m_vecLayer.begin(), m_vecLayer.end(),
+		[](const auto& pLayer) { return pLayer->uiState == LAYER_STATE_READY; }));
+	stats.uiLayerCount = GetLayerCount();
+	return stats;
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "Core.h"
+
+#include <list>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+//Software virtual texturing for the equirectangular planet maps, no sparse binding needed
+//Every source image is baked once into <source>.vtp: a mip chain cut into PAGE_SIZE pages with a
+//PAGE_BORDER texel border (wrapped in u, clamped in v) so bilinear and anisotropic taps stay inside a page
+//All layers share one page index space sized by the virtual width (aspect 2:1); smaller sources simply
+//have no pages below their finest mip. The index is mip major, then layer, then row:
+//	index = MipBase(mip) * layerCount + layer * pagesX(mip) * pagesY(mip) + y * pagesX(mip) + x
+//which is both the bit written into the GPU feedback buffer and the texel of the page table image
+//Resident pages live in fixed size slots of a physical atlas bounded by a byte budget; pages are read on
+//worker threads, the render thread only copies finished ones into the upload staging memory
+class VirtualTexture
+{
+public:
+	static constexpr UINT PAGE_SIZE = 128;
+	static constexpr UINT PAGE_BORDER = 4;
+	static constexpr UINT PAGE_STRIDE = PAGE_SIZE + 2 * PAGE_BORDER;
+	static constexpr UINT PAGE_BYTES = PAGE_STRIDE * PAGE_STRIDE * 4;
+	static constexpr UINT MAX_ATLAS_PAGES_PER_SIDE = 256;	//page table entries store the atlas page in 8 bits
+	static constexpr UINT MAX_UPLOAD_PER_FRAME = 16;
+
+	struct Stats
+	{
+		UINT uiResidentPageCount;
+		UINT uiSlotCount;
+		UINT uiPendingCount;
+		UINT uiRequestedPageCount;			//distinct pages in the last feedback
+		UINT uiUploadCount;					//pages copied into the atlas by the last Update
+		UINT uiReadyLayerCount;
+		UINT uiLayerCount;
+	};
+
+public:
+	VirtualTexture() = default;
+	~VirtualTexture();
+
+	VirtualTexture(const VirtualTexture&) = delete;
+	VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+	//One layer per source image, an empty path leaves the layer without pages
+	//uiVirtualWidth is rounded down to a power of two, uiMaxAtlasDimension is the device image size limit
+	void Start(const std::vector<std::filesystem::path>& vecSource, UINT uiVirtualWidth, UINT64 uiBudgetBytes,
+		UINT uiMaxAtlasDimension, UINT uiFramesInFlight, UINT uiWorkerCount = 0);
+	void Stop();
+
+	UINT GetLayerCount() const { return static_cast<UINT>(m_vecLayer.size()); }
+	UINT GetPageCountX() const { return m_uiPageCountX; }		//pages along u at mip 0, half as many along v
+	UINT GetMipCount() const { return m_uiMipCount; }
+	UINT GetAtlasPagesPerSide() const { return m_uiAtlasPagesPerSide; }
+	UINT GetPageIndexCount() const { return m_uiPageIndexCount; }
+	UINT GetFeedbackWordCount() const { return (m_uiPageIndexCount + 31) / 32; }
+
+	//Texels of the page table image of one mip, all layers, in upload order
+	UINT GetMipBase(UINT uiMip) const { return m_vecMipBase[uiMip] * GetLayerCount(); }
+	UINT GetMipPageCountX(UINT uiMip) const { return m_uiPageCountX >> uiMip; }
+	UINT GetMipPageCountY(UINT uiMip) const { return (m_uiPageCountX / 2) >> uiMip; }
+
+	//Called once per frame on the render thread
+	//pFeedback is the request bitset (GetFeedbackWordCount() words) of the frame that just finished,
+	//finished pages are written into pUploadStaging (MAX_UPLOAD_PER_FRAME * PAGE_BYTES) and their atlas slots
+	//appended to vecUploadSlot in the same order
+	void Update(const UINT* pFeedback, std::vector<UINT>& vecUploadSlot, UCHAR* pUploadStaging);
+
+	//R = atlas page x, G = atlas page y, B = mip of the page actually resident, A = 1 when any ancestor is resident
+	const std::vector<UINT>& GetPageTable() const { return m_vecPageTable; }
+	UINT64 GetPageTableVersion() const { return m_uiPageTableVersion; }
+
+	Stats GetStats() const;
+
+private:
+	enum LayerState : UINT
+	{
+		LAYER_STATE_LOADING,
+		LAYER_STATE_READY,
+		LAYER_STATE_FAILED,
+	};
+
+	struct PageFileHeader
+	{
+		char szMagic[4];
+		UINT uiVersion;
+		UINT uiWidth;
+		UINT uiHeight;
+		UINT uiPageSize;
+		UINT uiBorder;
+		UINT uiMipCount;
+		UINT uiReserved;
+	};
+
+	struct Layer
+	{
+		std::filesystem::path sourcePath;
+		std::filesystem::path pageFilePath;
+		UINT uiFinestMip = 0;				//global mip of the first page in the file
+		std::atomic<UINT> uiState = LAYER_STATE_LOADING;
+	};
+
+	struct Entry
+	{
+		UINT uiSlot;
+		UINT64 uiLastUsedFrame;
+		std::list<UINT>::iterator lruIter;
+	};
+
+	struct PageRequest
+	{
+		UINT uiMip;
+		UINT uiIndex;
+		bool operator<(const PageRequest& other) const { return uiMip < other.uiMip; } //coarse mips first
+	};
+
+	struct FinishedPage
+	{
+		UINT uiIndex;
+		std::vector<UCHAR> vecPixel;
+	};
+
+	struct PageCoord
+	{
+		UINT uiMip;
+		UINT uiLayer;
+		UINT uiX;
+		UINT uiY;
+	};
+
+	UINT MakeIndex(const PageCoord& coord) const;
+	PageCoord SplitIndex(UINT uiIndex) const;
+
+	static bool OpenPageFile(const std::filesystem::path& pageFilePath, PageFileHeader& header);
+	static bool BakePageFile(const std::filesystem::path& sourcePath, const std::filesystem::path& pageFilePath, UINT uiVirtualWidth);
+	bool ReadPage(UINT uiIndex, std::vector<UCHAR>& vecPixel) const;
+
+	void LayerThreadFunc();
+	void WorkerThreadFunc();
+	void Request(UINT uiIndex);
+	void Touch(UINT uiIndex);
+	void RetireSlots();
+	void EvictUnused(UINT uiWantedFreeSlot);
+	void DrainFinishedPages(std::vector<UINT>& vecUploadSlot, UCHAR* pUploadStaging);
+	void RebuildPageTable();
+
+private:
+	std::vector<std::unique_ptr<Layer>> m_vecLayer;
+	UINT m_uiVirtualWidth = 0;
+	UINT m_uiPageCountX = 0;
+	UINT m_uiMipCount = 0;
+	UINT m_uiPageIndexCount = 0;
+	std::vector<UINT> m_vecMipBase;			//pages of one layer in all finer mips
+
+	UINT m_uiAtlasPagesPerSide = 0;
+	UINT m_uiSlotCount = 0;
+	UINT m_uiFramesInFlight = 1;
+	UINT64 m_uiFrame = 0;
+
+	//render thread only
+	std::unordered_map<UINT, Entry> m_mapResident;
+	std::list<UINT> m_listLRU;				//front = most recently requested
+	std::vector<UINT> m_vecFreeSlot;
+	std::vector<std::pair<UINT64, UINT>> m_vecRetiredSlot;	//frame of the eviction, slot
+	std::vector<UINT> m_vecPageTable;
+	UINT64 m_uiPageTableVersion = 0;
+	bool m_bPageTableDirty = true;
+	UINT m_uiRequestedPageCount = 0;
+	UINT m_uiUploadCount = 0;
+
+	std::thread m_LayerThread;
+	std::vector<std::thread> m_vecWorker;
+	std::atomic<bool> m_bRunning = false;
+	std::mutex m_RequestMutex;
+	std::condition_variable m_RequestCondition;
+	std::priority_queue<PageRequest> m_queueRequest;
+	std::set<UINT> m_setPending;			//queued, being read or finished but not drained yet
+
+	std::mutex m_FinishedMutex;
+	std::vector<FinishedPage> m_vecFinished;
+};
@@ -1,6 +1,8 @@
 #include "Core.h"
 #include "VulkanRenderer.h"
 #include "VulkanUtils.h"
+#include "EmbeddedShader.h"
+#include "ColorSpace.h"
 
 #include "Log.h"
 
@@ -18,8 +20,6 @@
 
 #include "json.hpp"
 
-#define INSTANCE_NUM 9
-
 #include "imgui.h"
 #include "UI/UI.h"
 static UI g_UI;
@@ -28,8 +28,10 @@ VulkanRenderer::VulkanRenderer()
 {
 #ifdef NDEBUG
 	m_bEnableValidationLayer = false;
+	m_bEnableShaderHotReload = false;
 #else
 	m_bEnableValidationLayer = true;
+	m_bEnableShaderHotReload = true;
 #endif
 
 	m_strWindowTitle = "Vulkan Renderer";
@@ -41,9 +43,7 @@ VulkanRenderer::VulkanRenderer()
 	m_uiFPS = 0;
 	m_uiFrameCounter = 0;
 
-	m_DynamicAlignment = 0;
 	m_UboBufferSize = 0;
-	m_DynamicUboBufferSize = 0;
 }
 
 VulkanRenderer::~VulkanRenderer()
@@ -61,6 +61,9 @@ void VulkanRenderer::Init()
 	PickBestPhysicalDevice();
 	CreateLogicalDevice();
 
+	m_SamplerCache.Init(m_LogicalDevice, m_bSamplerAnisotropyEnabled,
+		m_mapPhysicalDeviceInfo.at(m_PhysicalDevice).properties.limits.maxSamplerAnisotropy);
+
 	CreateTransferCommandPool();
 
 	CreateSwapChain();
@@ -78,9 +81,13 @@ void VulkanRenderer::Init()
 	
 	CreateSyncObjects();
 
+	CreateTimestampQueryPool();
+
 	CreatePointLightResource();
+	CreateInstancedResource();
 
 	CreateShadowMapResource();
+	CreateOmniShadowResource();
 
 	SetupCamera();
 
@@ -101,7 +108,11 @@ void VulkanRenderer::Init()
 	CreateCommonGraphicPipelineLayout();
 	CreateCommonGraphicPipeline();
 
+	m_TextureCache.Init(this, m_ullTextureCacheBudgetBytes, static_cast<UINT>(m_vecSwapChainImages.size()));
+	m_TextureStreamer.Start(this, static_cast<UINT>(m_vecSwapChainImages.size()));
+
 	m_testObjModel = DZW_VulkanWrap::ModelFactor::CreateModel(this, "./Assert/Model/Shadow/samplescene.obj");
+	MarkShadowCasterDirty();
 
 	//glTF Model
 	CreateGLTFShader();
@@ -114,21 +125,32 @@ void VulkanRenderer::Init()
 
 	//m_testGLTFModel = DZW_VulkanWrap::ModelFactor::CreateModel(this, "./Assert/Model/samplescene.gltf");
 	
-	//LoadPlanetInfo();
-
-	//LoadModel("./Assert/Model/sphere.obj", m_Model);
-	//LoadTexture("./Assert/Texture/solarsystem_array_rgba8.ktx", m_Texture);
-	//CreateShader();
-	//CreateUniformBuffers();
-	//CreateDescriptorSetLayout();
-	//CreateDescriptorPool();
-	//CreateDescriptorSets();
-	//CreateGraphicPipelineLayout();
-	//CreateGraphicPipeline();
+	LoadPlanetInfo();
+	CreateInstanceBuffer();
+	CreateAsteroidBeltResource();
+
+	//Planets
+	m_PlanetTexture = m_TextureCache.Acquire("./Assert/Texture/solarsystem_array_rgba8.ktx");
+	CheckPlanetTextureLayers();
+	CreateVirtualTextureResource();
+	CreateShader();
+	CreateUniformBuffers();
+	CreateDescriptorSetLayout();
+	CreateDescriptorPool();
+	CreateDescriptorSets();
+	CreateGraphicPipelineLayout();
+	CreateGraphicPipeline();
+
+	//Planet Impostor
+	CreatePlanetImpostorShaderModule();
+	CreatePlanetImpostorPipeline();
+
+	//Planet Terrain
+	CreatePlanetTerrainResource();
 
 	//Skybox
 	m_SkyboxModel = DZW_VulkanWrap::ModelFactor::CreateModel(this, "./Assert/Model/Skybox/cube.gltf");
-	m_SkyboxTexture = DZW_VulkanWrap::TextureFactor::CreateTexture(this, "./Assert/Texture/Skybox/milkyway_cubemap.ktx");
+	m_SkyboxTexture = m_TextureCache.Acquire("./Assert/Texture/Skybox/milkyway_cubemap.ktx");
 	CreateSkyboxShader();
 	CreateSkyboxUniformBuffers();
 	CreateSkyboxDescriptorSetLayout();
@@ -183,6 +205,12 @@ void VulkanRenderer::Init()
 	//CreatePBRDescriptorSets();
 	//CreatePBRGraphicPipelineLayout();
 	//CreatePBRGraphicPipeline();
+
+	RegisterShaderHotReloadTargets();
+	if (m_bEnableShaderHotReload)
+		m_ShaderHotReload.Start();
+
+	m_LastOrbitTime = std::chrono::high_resolution_clock::now();
 }
 
 void VulkanRenderer::Loop()
@@ -212,6 +240,12 @@ void VulkanRenderer::Loop()
 
 void VulkanRenderer::Clean()
 {
+	m_ShaderHotReload.Stop();
+
+	//ȴworkerͷδִstaging
+	m_TextureStreamer.Stop();
+	DestroyRetiredResources(true);
+
 	g_UI.Clean();
 
 	m_PointLightModel.reset();
@@ -323,12 +357,79 @@ void VulkanRenderer::Clean()
 	vkDestroyDescriptorPool(m_LogicalDevice, m_CommonDescriptorPool, nullptr);
 	vkDestroyDescriptorSetLayout(m_LogicalDevice, m_CommonDescriptorSetLayout, nullptr);
 
-	vkDestroyPipeline(m_LogicalDevice, m_CommonGraphicPipeline, nullptr);
+	for (const auto& pipeline : m_aryCommonGraphicPipeline)
+	{
+		vkDestroyPipeline(m_LogicalDevice, pipeline, nullptr);
+	}
 	vkDestroyPipelineLayout(m_LogicalDevice, m_CommonGraphicPipelineLayout, nullptr);
 	vkDestroyPipelineCache(m_LogicalDevice, m_CommonGraphicPipelineCache, nullptr);
 
 	m_testObjModel.reset();
 
+	//Shadow Map
+	for (const auto& shaderModule : m_mapShadowMapShaderModule)
+	{
+		vkDestroyShaderModule(m_LogicalDevice, shaderModule.second, nullptr);
+	}
+
+	vkFreeMemory(m_LogicalDevice, m_ShadowMapUniformBufferMemory, nullptr);
+	vkDestroyBuffer(m_LogicalDevice, m_ShadowMapUniformBuffer, nullptr);
+
+	vkDestroyDescriptorPool(m_LogicalDevice, m_ShadowMapDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_LogicalDevice, m_ShadowMapDescriptorSetLayout, nullptr);
+
+	vkDestroyPipeline(m_LogicalDevice, m_ShadowMapPipeline, nullptr);
+	vkDestroyPipelineLayout(m_LogicalDevice, m_ShadowMapPipelineLayout, nullptr);
+
+	for (UINT i = 0; i < SHADOW_CASCADE_MAX; ++i)
+	{
+		vkDestroyFramebuffer(m_LogicalDevice, m_aryShadowMapFrameBuffer[i], nullptr);
+		vkDestroyImageView(m_LogicalDevice, m_aryShadowMapCascadeImageView[i], nullptr);
+	}
+	vkDestroyRenderPass(m_LogicalDevice, m_ShadowMapRenderPass, nullptr);
+	vkDestroySampler(m_LogicalDevice, m_ShadowMapSampler, nullptr);
+	vkDestroyImageView(m_LogicalDevice, m_ShadowMapDepthImageView, nullptr);
+	vkDestroyImage(m_LogicalDevice, m_ShadowMapDepthImage, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_ShadowMapDepthImageMemory, nullptr);
+
+	//Omni Shadow
+	for (const auto& shaderModule : m_mapOmniShadowShaderModule)
+	{
+		vkDestroyShaderModule(m_LogicalDevice, shaderModule.second, nullptr);
+	}
+
+	vkFreeMemory(m_LogicalDevice, m_OmniShadowUniformBufferMemory, nullptr);
+	vkDestroyBuffer(m_LogicalDevice, m_OmniShadowUniformBuffer, nullptr);
+
+	vkDestroyDescriptorPool(m_LogicalDevice, m_OmniShadowDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_LogicalDevice, m_OmniShadowDescriptorSetLayout, nullptr);
+
+	vkDestroyPipeline(m_LogicalDevice, m_OmniShadowPipeline, nullptr);
+	vkDestroyPipelineLayout(m_LogicalDevice, m_OmniShadowPipelineLayout, nullptr);
+
+	vkDestroyFramebuffer(m_LogicalDevice, m_OmniShadowFrameBuffer, nullptr);
+	vkDestroyRenderPass(m_LogicalDevice, m_OmniShadowRenderPass, nullptr);
+	vkDestroyImageView(m_LogicalDevice, m_OmniShadowLayeredImageView, nullptr);
+	vkDestroyImageView(m_LogicalDevice, m_OmniShadowCubeImageView, nullptr);
+	vkDestroyImage(m_LogicalDevice, m_OmniShadowDepthImage, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_OmniShadowDepthImageMemory, nullptr);
+
+	//Instance Buffer
+	vkUnmapMemory(m_LogicalDevice, m_InstanceBufferMemory);
+	vkFreeMemory(m_LogicalDevice, m_InstanceBufferMemory, nullptr);
+	vkDestroyBuffer(m_LogicalDevice, m_InstanceBuffer, nullptr);
+
+	//Asteroid Belt
+	m_AsteroidBeltCompute.Destroy();
+	m_AsteroidModel.reset();
+
+	for (const auto& shaderModule : m_mapInstancedShaderModule)
+	{
+		vkDestroyShaderModule(m_LogicalDevice, shaderModule.second, nullptr);
+	}
+	vkDestroyPipeline(m_LogicalDevice, m_InstancedPipeline, nullptr);
+	vkDestroyPipelineLayout(m_LogicalDevice, m_InstancedPipelineLayout, nullptr);
+
 	//----------------------------------------------------------------------------
 
 	for (const auto& shaderModule : m_mapGLTFShaderModule)
@@ -345,29 +446,66 @@ void VulkanRenderer::Clean()
 	//m_testGLTFModel.reset();
 
 	//----------------------------------------------------------------------------
-	//_aligned_free(m_DynamicUboData.model);
-
-	//FreeTexture(m_Texture);
-
-	//for (const auto& shaderModule : m_mapShaderModule)
-	//{
-	//	vkDestroyShaderModule(m_LogicalDevice, shaderModule.second, nullptr);
-	//}
-
-	//vkDestroyPipeline(m_LogicalDevice, m_GraphicPipeline, nullptr);
-	//vkDestroyPipelineLayout(m_LogicalDevice, m_GraphicPipelineLayout, nullptr);
+	//Planets
+	m_PlanetTexture.reset();
+
+	//ͣ¶ȡ̣֮߳󲻻дstaging
+	m_VirtualTexture.Stop();
+	vkDestroySampler(m_LogicalDevice, m_VirtualAtlasSampler, nullptr);
+	vkDestroyImageView(m_LogicalDevice, m_VirtualAtlasImageView, nullptr);
+	vkDestroyImage(m_LogicalDevice, m_VirtualAtlasImage, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_VirtualAtlasImageMemory, nullptr);
+	vkDestroySampler(m_LogicalDevice, m_VirtualPageTableSampler, nullptr);
+	for (size_t i = 0; i < m_vecVirtualPageTableImage.size(); ++i)
+	{
+		vkDestroyImageView(m_LogicalDevice, m_vecVirtualPageTableImageView[i], nullptr);
+		vkDestroyImage(m_LogicalDevice, m_vecVirtualPageTableImage[i], nullptr);
+		vkFreeMemory(m_LogicalDevice, m_vecVirtualPageTableImageMemory[i], nullptr);
+	}
+	vkDestroyBuffer(m_LogicalDevice, m_VirtualFeedbackBuffer, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_VirtualFeedbackBufferMemory, nullptr);
+	vkUnmapMemory(m_LogicalDevice, m_VirtualFeedbackReadbackBufferMemory);
+	vkDestroyBuffer(m_LogicalDevice, m_VirtualFeedbackReadbackBuffer, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_VirtualFeedbackReadbackBufferMemory, nullptr);
+	vkUnmapMemory(m_LogicalDevice, m_VirtualStagingBufferMemory);
+	vkDestroyBuffer(m_LogicalDevice, m_VirtualStagingBuffer, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_VirtualStagingBufferMemory, nullptr);
+
+	for (const auto& shaderModule : m_mapShaderModule)
+	{
+		vkDestroyShaderModule(m_LogicalDevice, shaderModule.second, nullptr);
+	}
 
+	vkDestroyPipeline(m_LogicalDevice, m_GraphicPipeline, nullptr);
+	vkDestroyPipelineLayout(m_LogicalDevice, m_GraphicPipelineLayout, nullptr);
 
-	//vkDestroyDescriptorPool(m_LogicalDevice, m_DescriptorPool, nullptr);
-	//vkDestroyDescriptorSetLayout(m_LogicalDevice, m_DescriptorSetLayout, nullptr);
-	//for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
-	//{
-	//	vkFreeMemory(m_LogicalDevice, m_vecUniformBufferMemories[i], nullptr);
-	//	vkDestroyBuffer(m_LogicalDevice, m_vecUniformBuffers[i], nullptr);
+	for (const auto& shaderModule : m_mapPlanetImpostorShaderModule)
+	{
+		vkDestroyShaderModule(m_LogicalDevice, shaderModule.second, nullptr);
+	}
+	vkDestroyPipeline(m_LogicalDevice, m_PlanetImpostorPipeline, nullptr);
 
-	//	vkFreeMemory(m_LogicalDevice, m_vecDynamicUniformBufferMemories[i], nullptr);
-	//	vkDestroyBuffer(m_LogicalDevice, m_vecDynamicUniformBuffers[i], nullptr);
-	//}
+	//ͣ¹̣֮߳󲻻еοд붥
+	m_PlanetTerrain.Stop();
+	for (const auto& shaderModule : m_mapPlanetTerrainShaderModule)
+	{
+		vkDestroyShaderModule(m_LogicalDevice, shaderModule.second, nullptr);
+	}
+	vkDestroyPipeline(m_LogicalDevice, m_PlanetTerrainPipeline, nullptr);
+	vkDestroyPipelineLayout(m_LogicalDevice, m_PlanetTerrainPipelineLayout, nullptr);
+	vkUnmapMemory(m_LogicalDevice, m_PlanetTerrainVertexBufferMemory);
+	vkFreeMemory(m_LogicalDevice, m_PlanetTerrainVertexBufferMemory, nullptr);
+	vkDestroyBuffer(m_LogicalDevice, m_PlanetTerrainVertexBuffer, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_PlanetTerrainIndexBufferMemory, nullptr);
+	vkDestroyBuffer(m_LogicalDevice, m_PlanetTerrainIndexBuffer, nullptr);
+
+	vkDestroyDescriptorPool(m_LogicalDevice, m_DescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_LogicalDevice, m_DescriptorSetLayout, nullptr);
+	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	{
+		vkFreeMemory(m_LogicalDevice, m_vecUniformBufferMemories[i], nullptr);
+		vkDestroyBuffer(m_LogicalDevice, m_vecUniformBuffers[i], nullptr);
+	}
 
 	/********************************************************************/
 
@@ -395,6 +533,13 @@ void VulkanRenderer::Clean()
 		vkDestroyFence(m_LogicalDevice, m_vecInFlightFences[i], nullptr);
 	}
 
+	if (m_TimestampQueryPool != VK_NULL_HANDLE)
+		vkDestroyQueryPool(m_LogicalDevice, m_TimestampQueryPool, nullptr);
+
+	//ģpassͷŸԳеʣµֻcache
+	m_TextureCache.Clear();
+	m_SamplerCache.Clear();
+
 	vkDestroyCommandPool(m_LogicalDevice, m_CommandPool, nullptr);
 	vkDestroyCommandPool(m_LogicalDevice, m_TransferCommandPool, nullptr);
 
@@ -503,6 +648,11 @@ bool VulkanRenderer::CheckChosedExtensionValid()
 
 	QueryAllValidExtensions();
 
+	//ѡVK_EXT_memory_budgetͨvkGetPhysicalDeviceMemoryProperties2KHRѯ
+	m_bPhysicalDeviceProperties2Enabled = IsExtensionValid(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	if (m_bPhysicalDeviceProperties2Enabled)
+		m_vecChosedExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+
 	for (const auto& extensionName : m_vecChosedExtensions)
 	{
 		if (!IsExtensionValid(extensionName))
@@ -755,7 +905,7 @@ int VulkanRenderer::RatePhysicalDevice(PhysicalDeviceInfo& deviceInfo)
 	//ֵ֧ͼߴ,ԽԽ
 	nScore += deviceInfo.properties.limits.maxImageDimension2D;
 
-	//Ƿּ֧ɫ
+	//Ƿּ֧ɫԴcube shadow
 	if (!deviceInfo.features.geometryShader)
 		return 0;
 
@@ -836,7 +986,31 @@ void VulkanRenderer::CreateLogicalDevice()
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.fillModeNonSolid = VK_TRUE;
 	deviceFeatures.wideLines = VK_TRUE;
-	//deviceFeatures.samplerAnisotropy = VK_TRUE; //øԹˣ
+	//Դcube shadowgeometry shaderдgl_LayerRatePhysicalDeviceųֵ֧豸
+	deviceFeatures.geometryShader = physicalDeviceInfo.features.geometryShader;
+	deviceFeatures.textureCompressionBC = physicalDeviceInfo.features.textureCompressionBC; //決ΪBC1/BC3
+	//feedbackfragment shaderдstorage buffer
+	deviceFeatures.fragmentStoresAndAtomics = physicalDeviceInfo.features.fragmentStoresAndAtomics;
+	m_bVirtualTextureSupported = (physicalDeviceInfo.features.fragmentStoresAndAtomics == VK_TRUE);
+	if (!m_bVirtualTextureSupported)
+		Log::Warn("fragmentStoresAndAtomics not supported, planet virtual texture disabled");
+	deviceFeatures.samplerAnisotropy = physicalDeviceInfo.features.samplerAnisotropy; //øԹˣ
+	m_bSamplerAnisotropyEnabled = (physicalDeviceInfo.features.samplerAnisotropy == VK_TRUE);
+
+	std::vector<const char*> vecEnabledExtensions = m_vecDeviceExtensions;
+	m_bMemoryBudgetEnabled = false;
+	if (m_bPhysicalDeviceProperties2Enabled)
+	{
+		for (const auto& extension : physicalDeviceInfo.vecAvaliableDeviceExtensions)
+		{
+			if (extension.extensionName == std::string(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+			{
+				vecEnabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+				m_bMemoryBudgetEnabled = true;
+				break;
+			}
+		}
+	}
 	//deviceFeatures.sampleRateShading = VK_TRUE;	//Sample Rate ShaingMSAA
 
 	VkDeviceCreateInfo createInfo{};
@@ -844,8 +1018,8 @@ void VulkanRenderer::CreateLogicalDevice()
 	createInfo.queueCreateInfoCount = static_cast<UINT>(vecQueueCreateInfo.size());
 	createInfo.pQueueCreateInfos = vecQueueCreateInfo.data();
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.enabledExtensionCount = static_cast<UINT>(m_vecDeviceExtensions.size()); //ע⣡˴extension봴Instanceʱͬ
-	createInfo.ppEnabledExtensionNames = m_vecDeviceExtensions.data();
+	createInfo.enabledExtensionCount = static_cast<UINT>(vecEnabledExtensions.size()); //ע⣡˴extension봴Instanceʱͬ
+	createInfo.ppEnabledExtensionNames = vecEnabledExtensions.data();
 	if (m_bEnableValidationLayer)
 	{
 		createInfo.enabledLayerCount = static_cast<UINT>(m_vecChosedValidationLayers.size());
@@ -992,7 +1166,7 @@ void VulkanRenderer::CreateSwapChain()
 	}
 }
 
-VkImageView VulkanRenderer::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, UINT uiMipLevelCount, UINT uiLayerCount, UINT uiFaceCount)
+VkImageView VulkanRenderer::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, UINT uiMipLevelCount, UINT uiLayerCount, UINT uiFaceCount, UINT uiBaseMipLevel)
 {
 	VkImageViewType imageViewType;
 	if (uiFaceCount == 6 && uiLayerCount == 1)
@@ -1008,7 +1182,7 @@ VkImageView VulkanRenderer::CreateImageView(VkImage image, VkFormat format, VkIm
 	createInfo.viewType = imageViewType;
 	createInfo.format = format;
 	createInfo.subresourceRange.aspectMask = aspectFlags;
-	createInfo.subresourceRange.baseMipLevel = 0;
+	createInfo.subresourceRange.baseMipLevel = uiBaseMipLevel;
 	createInfo.subresourceRange.levelCount = uiMipLevelCount;
 	createInfo.subresourceRange.baseArrayLayer = 0;
 	createInfo.subresourceRange.layerCount = (uiFaceCount == 6) ? uiFaceCount : uiLayerCount;
@@ -1086,10 +1260,10 @@ void VulkanRenderer::CreateSwapChainFrameBuffers()
 
 VkFormat VulkanRenderer::ChooseDepthFormat(bool bCheckSamplingSupport)
 {
-	//ָʽStencil Component
+	//ȲStencilD32_SFLOATreversed-ZȵľȣS8ĸʽStencil Component
 	std::vector<VkFormat> vecFormats = {
-		VK_FORMAT_D32_SFLOAT_S8_UINT,
 		VK_FORMAT_D32_SFLOAT,
+		VK_FORMAT_D32_SFLOAT_S8_UINT,
 		VK_FORMAT_D24_UNORM_S8_UINT,
 		VK_FORMAT_D16_UNORM_S8_UINT,
 		VK_FORMAT_D16_UNORM
@@ -1234,15 +1408,18 @@ void VulkanRenderer::EndSingleTimeCommand(VkCommandBuffer commandBuffer)
 
 void VulkanRenderer::CreateShader()
 {
-	m_mapShaderModule.clear();
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
 
-	ASSERT(m_mapShaderPath.size() > 0, "Detect no shader spv file");
+	m_mapShaderModule.clear();
 
-	for (const auto& spvPath : m_mapShaderPath)
+	//֧fragmentStoresAndAtomicsʱʹòдfeedbackı壬ûstorage buffer
+	for (const auto& stage : vecShaderStage)
 	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
-
-		m_mapShaderModule[spvPath.first] = shaderModule;
+		bool bNoFeedback = (stage == VK_SHADER_STAGE_FRAGMENT_BIT) && !m_bVirtualTextureSupported;
+		m_mapShaderModule[stage] = CreateShaderModuleByName(bNoFeedback ? "PlanetNoFeedback" : "Planet", stage);
 	}
 }
 
@@ -1299,30 +1476,6 @@ void VulkanRenderer::CreateBufferAndBindMemory(VkDeviceSize deviceSize, VkBuffer
 }
 
 
-// Wrapper functions for aligned memory allocation
-// There is currently no standard for this in C++ that works across all platforms and vendors, so we abstract this
-static void* alignedAlloc(size_t size, size_t alignment)
-{
-	void* data = nullptr;
-#if defined(_MSC_VER) || defined(__MINGW32__)
-	data = _aligned_malloc(size, alignment);
-#else
-	int res = posix_memalign(&data, alignment, size);
-	if (res != 0)
-		data = nullptr;
-#endif
-	return data;
-}
-
-static void alignedFree(void* data)
-{
-#if	defined(_MSC_VER) || defined(__MINGW32__)
-	_aligned_free(data);
-#else
-	free(data);
-#endif
-}
-
 void VulkanRenderer::CreateUniformBuffers()
 {
 	m_vecUniformBuffers.resize(m_vecSwapChainImages.size());
@@ -1339,33 +1492,324 @@ void VulkanRenderer::CreateUniformBuffers()
 			m_vecUniformBufferMemories[i]
 		);
 	}
+}
+
+void VulkanRenderer::CreatePlanetTerrainResource()
+{
+	//config.jsonTerrainHeightScale0ǲе
+	m_vecPlanetTerrainBody.assign(m_vecPlanetInfo.size(), -1);
+	for (size_t i = 0; i < m_vecPlanetInfo.size(); ++i)
+	{
+		const auto& info = m_vecPlanetInfo[i];
+		if (info.fTerrainHeightScale <= 0.f)
+			continue;
+
+		PlanetTerrain::BodyDesc desc;
+		desc.tileDir = info.strTerrainDir;
+		desc.fHeightScale = info.fTerrainHeightScale;
+		desc.uiSeed = static_cast<UINT>(i) * 7919u + 1u;
+		m_vecPlanetTerrainBody[i] = static_cast<int>(m_PlanetTerrain.AddBody(desc));
+	}
+
+	//slotֻڳе֡δƺŻḴ
+	m_PlanetTerrain.Start(m_uiPlanetTerrainBudgetBytes, static_cast<UINT>(m_vecSwapChainImages.size()));
+
+	//أÿslot̶CHUNK_VERTEX_COUNT㣬ɵĵοCPUֱд־ӳ
+	VkDeviceSize poolSize = static_cast<VkDeviceSize>(PlanetTerrain::CHUNK_BYTES) * m_PlanetTerrain.GetSlotCount();
+	CreateBufferAndBindMemory(poolSize,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_PlanetTerrainVertexBuffer,
+		m_PlanetTerrainVertexBufferMemory
+	);
+
+	void* pMapped = nullptr;
+	VULKAN_ASSERT(vkMapMemory(m_LogicalDevice, m_PlanetTerrainVertexBufferMemory, 0, VK_WHOLE_SIZE, 0, &pMapped), "Map planet terrain vertex buffer failed");
+	m_pPlanetTerrainVertex = static_cast<TerrainVertex*>(pMapped);
+
+	//еο鹲ͬһ + ȹߣ
+	std::vector<UINT> vecIndex = PlanetTerrain::BuildIndices();
+	m_uiPlanetTerrainIndexCount = static_cast<UINT>(vecIndex.size());
+	VkDeviceSize indexSize = sizeof(UINT) * vecIndex.size();
+	CreateBufferAndBindMemory(indexSize,
+		VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_PlanetTerrainIndexBuffer,
+		m_PlanetTerrainIndexBufferMemory
+	);
+	TransferBufferDataByStageBuffer(vecIndex.data(), indexSize, m_PlanetTerrainIndexBuffer);
+
+	CreatePlanetTerrainShaderModule();
+	CreatePlanetTerrainPipelineLayout();
+	CreatePlanetTerrainPipeline();
+}
+
+void VulkanRenderer::CheckPlanetTextureLayers()
+{
+	//±꼴Ĳ㣬KTXļshaderвclampһ
+	//ͬһ±ҲĲ㣬ܸдʵĲţֻʾ
+	UINT uiLayerCount = std::max(m_PlanetTexture->m_uiLayerNum, 1u);
+	for (size_t i = uiLayerCount; i < m_vecPlanetInfo.size(); ++i)
+	{
+		const auto& info = m_vecPlanetInfo[i];
+		if (m_bVirtualTextureSupported && !info.strTexture.empty())
+			Log::Warn("Planet {} has no layer in {} ({} layers), it shows the last layer until its virtual texture is resident",
+				info.strName, m_PlanetTexture->m_Filepath.string(), uiLayerCount);
+		else
+			Log::Warn("Planet {} has no layer in {} ({} layers) and no virtual texture, it shows the last layer",
+				info.strName, m_PlanetTexture->m_Filepath.string(), uiLayerCount);
+	}
+}
+
+void VulkanRenderer::CreateVirtualTextureResource()
+{
+	//ÿʵһ㣬Ĳһ£ûTextureĲֻʹ
+	std::vector<std::filesystem::path> vecSource;
+	for (const auto& info : m_vecPlanetInfo)
+	{
+		vecSource.push_back(info.strTexture);
+	}
 
+	const auto& limits = m_mapPhysicalDeviceInfo.at(m_PhysicalDevice).properties.limits;
+	UINT uiFrameCount = static_cast<UINT>(m_vecSwapChainImages.size());
+	m_VirtualTexture.Start(vecSource, m_uiVirtualTextureWidth, m_uiVirtualTextureBudgetBytes, limits.maxImageDimension2D, uiFrameCount);
 
-	auto physicalDeviceProperties = m_mapPhysicalDeviceInfo.at(m_PhysicalDevice).properties;
-	size_t minUboAlignment = physicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
-	m_DynamicAlignment = sizeof(glm::mat4) + sizeof(float);
-	if (minUboAlignment > 0)
+	//Atlasÿslotһ߿pageֻpageϴд
+	UINT uiAtlasSize = m_VirtualTexture.GetAtlasPagesPerSide() * VirtualTexture::PAGE_STRIDE;
+	CreateImageAndBindMemory(uiAtlasSize, uiAtlasSize, 1, 1, 1,
+		VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_VirtualAtlasImage, m_VirtualAtlasImageMemory);
+	ChangeImageLayout(m_VirtualAtlasImage, VK_FORMAT_R8G8B8A8_SRGB, 1, 1, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	ChangeImageLayout(m_VirtualAtlasImage, VK_FORMAT_R8G8B8A8_SRGB, 1, 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	m_VirtualAtlasImageView = CreateImageView(m_VirtualAtlasImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, 1);
+
+	//pageڵshaderڱ߿ڣmipݶshaderpage
+	VkSamplerCreateInfo samplerCreateInfo{};
+	samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+	samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+	samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.maxAnisotropy = 1.f;
+	samplerCreateInfo.minLod = 0.f;
+	samplerCreateInfo.maxLod = 0.f;
+	samplerCreateInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	VULKAN_ASSERT(vkCreateSampler(m_LogicalDevice, &samplerCreateInfo, nullptr, &m_VirtualAtlasSampler), "Create virtual atlas sampler failed");
+
+	//Page tableֻnearesttexelFetchȡ
+	samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.maxLod = static_cast<float>(m_VirtualTexture.GetMipCount());
+	VULKAN_ASSERT(vkCreateSampler(m_LogicalDevice, &samplerCreateInfo, nullptr, &m_VirtualPageTableSampler), "Create virtual page table sampler failed");
+
+	//ÿһarray layermipmipһһӦ
+	UINT uiMipCount = m_VirtualTexture.GetMipCount();
+	UINT uiLayerCount = m_VirtualTexture.GetLayerCount();
+	m_vecVirtualPageTableImage.resize(uiFrameCount);
+	m_vecVirtualPageTableImageMemory.resize(uiFrameCount);
+	m_vecVirtualPageTableImageView.resize(uiFrameCount);
+	m_vecVirtualPageTableVersion.assign(uiFrameCount, UINT64_MAX);
+	for (UINT i = 0; i < uiFrameCount; ++i)
 	{
-		m_DynamicAlignment = (m_DynamicAlignment + minUboAlignment - 1) & ~(minUboAlignment - 1);
+		CreateImageAndBindMemory(m_VirtualTexture.GetMipPageCountX(0), m_VirtualTexture.GetMipPageCountY(0), uiMipCount, uiLayerCount, 1,
+			VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_UINT, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_vecVirtualPageTableImage[i], m_vecVirtualPageTableImageMemory[i]);
+		ChangeImageLayout(m_vecVirtualPageTableImage[i], VK_FORMAT_R8G8B8A8_UINT, uiMipCount, uiLayerCount, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		ChangeImageLayout(m_vecVirtualPageTableImage[i], VK_FORMAT_R8G8B8A8_UINT, uiMipCount, uiLayerCount, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		m_vecVirtualPageTableImageView[i] = CreateImageView(m_vecVirtualPageTableImage[i], VK_FORMAT_R8G8B8A8_UINT, VK_IMAGE_ASPECT_COLOR_BIT, uiMipCount, uiLayerCount, 1);
 	}
 
-	m_DynamicUboBufferSize = m_DynamicAlignment * INSTANCE_NUM;
+	//Feedbackÿ֡һΣminStorageBufferOffsetAlignmentƫư
+	VkDeviceSize alignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, sizeof(UINT));
+	m_VirtualFeedbackFrameSize = (sizeof(UINT) * m_VirtualTexture.GetFeedbackWordCount() + alignment - 1) / alignment * alignment;
+	CreateBufferAndBindMemory(m_VirtualFeedbackFrameSize * uiFrameCount,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_VirtualFeedbackBuffer,
+		m_VirtualFeedbackBufferMemory
+	);
+
+	CreateBufferAndBindMemory(m_VirtualFeedbackFrameSize * uiFrameCount,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_VirtualFeedbackReadbackBuffer,
+		m_VirtualFeedbackReadbackBufferMemory
+	);
+
+	void* pMapped = nullptr;
+	VULKAN_ASSERT(vkMapMemory(m_LogicalDevice, m_VirtualFeedbackReadbackBufferMemory, 0, VK_WHOLE_SIZE, 0, &pMapped), "Map virtual feedback readback buffer failed");
+	m_pVirtualFeedbackReadback = static_cast<UCHAR*>(pMapped);
+	memset(m_pVirtualFeedbackReadback, 0, static_cast<size_t>(m_VirtualFeedbackFrameSize * uiFrameCount));
 
-	m_DynamicUboData.model = (glm::mat4*)alignedAlloc(m_DynamicUboBufferSize, minUboAlignment > 0 ? minUboAlignment : m_DynamicAlignment);
-	m_DynamicUboData.fTextureIndex = (float*)((size_t)m_DynamicUboData.model + sizeof(glm::mat4));
+	//Stagingÿ֡MAX_UPLOAD_PER_FRAMEpage֮page table
+	m_VirtualStagingFrameSize = static_cast<VkDeviceSize>(VirtualTexture::PAGE_BYTES) * VirtualTexture::MAX_UPLOAD_PER_FRAME
+		+ sizeof(UINT) * m_VirtualTexture.GetPageIndexCount();
+	CreateBufferAndBindMemory(m_VirtualStagingFrameSize * uiFrameCount,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_VirtualStagingBuffer,
+		m_VirtualStagingBufferMemory
+	);
 
-	m_vecDynamicUniformBuffers.resize(m_vecSwapChainImages.size());
-	m_vecDynamicUniformBufferMemories.resize(m_vecSwapChainImages.size());
+	VULKAN_ASSERT(vkMapMemory(m_LogicalDevice, m_VirtualStagingBufferMemory, 0, VK_WHOLE_SIZE, 0, &pMapped), "Map virtual staging buffer failed");
+	m_pVirtualStaging = static_cast<UCHAR*>(pMapped);
+}
 
-	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+void VulkanRenderer::UpdateVirtualTexture(UINT uiIdx)
+{
+	m_vecVirtualUploadSlot.clear();
+	m_bVirtualPageTableUpload = false;
+	if (!m_bVirtualTextureSupported || !m_bEnableVirtualTexture)
+		return;
+
+	//ѵȴһ֡fencereadbackϴʹԴ֡¼
+	const UINT* pFeedback = reinterpret_cast<const UINT*>(m_pVirtualFeedbackReadback + m_VirtualFeedbackFrameSize * uiIdx);
+	UCHAR* pStaging = m_pVirtualStaging + m_VirtualStagingFrameSize * uiIdx;
+	m_VirtualTexture.Update(pFeedback, m_vecVirtualUploadSlot, pStaging);
+
+	//ÿ֡page table󣬰汾ͬʱش
+	if (m_vecVirtualPageTableVersion[uiIdx] != m_VirtualTexture.GetPageTableVersion())
 	{
-		CreateBufferAndBindMemory(m_DynamicUboBufferSize,
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			m_vecDynamicUniformBuffers[i],
-			m_vecDynamicUniformBufferMemories[i]
-		);
+		const auto& vecPageTable = m_VirtualTexture.GetPageTable();
+		memcpy(pStaging + static_cast<VkDeviceSize>(VirtualTexture::PAGE_BYTES) * VirtualTexture::MAX_UPLOAD_PER_FRAME,
+			vecPageTable.data(), sizeof(UINT) * vecPageTable.size());
+		m_vecVirtualPageTableVersion[uiIdx] = m_VirtualTexture.GetPageTableVersion();
+		m_bVirtualPageTableUpload = true;
+	}
+}
+
+void VulkanRenderer::RecordVirtualTextureUpload(VkCommandBuffer commandBuffer, UINT uiIdx)
+{
+	if (!m_bVirtualTextureSupported || !m_bEnableVirtualTexture)
+		return;
+
+	//ձ֡feedback֮ǵfragment shaderд
+	VkDeviceSize feedbackOffset = m_VirtualFeedbackFrameSize * uiIdx;
+	vkCmdFillBuffer(commandBuffer, m_VirtualFeedbackBuffer, feedbackOffset, m_VirtualFeedbackFrameSize, 0);
+
+	VkBufferMemoryBarrier feedbackBarrier{};
+	feedbackBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	feedbackBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	feedbackBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	feedbackBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	feedbackBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	feedbackBarrier.buffer = m_VirtualFeedbackBuffer;
+	feedbackBarrier.offset = feedbackOffset;
+	feedbackBarrier.size = m_VirtualFeedbackFrameSize;
+
+	//atlas֡ãcopyǰȴ֮ǰ֡ȡ
+	std::vector<VkImageMemoryBarrier> vecToTransfer;
+	std::vector<VkImageMemoryBarrier> vecToShaderRead;
+	auto addImageBarrier = [&](VkImage image, UINT uiMipCount, UINT uiLayerCount)
+	{
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, uiMipCount, 0, uiLayerCount };
+
+		barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		vecToTransfer.push_back(barrier);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		vecToShaderRead.push_back(barrier);
+	};
+
+	if (!m_vecVirtualUploadSlot.empty())
+		addImageBarrier(m_VirtualAtlasImage, 1, 1);
+	if (m_bVirtualPageTableUpload)
+		addImageBarrier(m_vecVirtualPageTableImage[uiIdx], m_VirtualTexture.GetMipCount(), m_VirtualTexture.GetLayerCount());
+
+	if (!vecToTransfer.empty())
+	{
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, static_cast<UINT>(vecToTransfer.size()), vecToTransfer.data());
+	}
+
+	VkDeviceSize stagingOffset = m_VirtualStagingFrameSize * uiIdx;
+	if (!m_vecVirtualUploadSlot.empty())
+	{
+		UINT uiPagesPerSide = m_VirtualTexture.GetAtlasPagesPerSide();
+		std::vector<VkBufferImageCopy> vecRegion;
+		for (size_t i = 0; i < m_vecVirtualUploadSlot.size(); ++i)
+		{
+			UINT uiSlot = m_vecVirtualUploadSlot[i];
+			VkBufferImageCopy region{};
+			region.bufferOffset = stagingOffset + static_cast<VkDeviceSize>(VirtualTexture::PAGE_BYTES) * i;
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			region.imageOffset = {
+				static_cast<int32_t>(uiSlot % uiPagesPerSide * VirtualTexture::PAGE_STRIDE),
+				static_cast<int32_t>(uiSlot / uiPagesPerSide * VirtualTexture::PAGE_STRIDE),
+				0 };
+			region.imageExtent = { VirtualTexture::PAGE_STRIDE, VirtualTexture::PAGE_STRIDE, 1 };
+			vecRegion.push_back(region);
+		}
+		vkCmdCopyBufferToImage(commandBuffer, m_VirtualStagingBuffer, m_VirtualAtlasImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<UINT>(vecRegion.size()), vecRegion.data());
+	}
+
+	if (m_bVirtualPageTableUpload)
+	{
+		//stagingеpage tablemip㡢Уÿmipһregionв
+		VkDeviceSize pageTableOffset = stagingOffset + static_cast<VkDeviceSize>(VirtualTexture::PAGE_BYTES) * VirtualTexture::MAX_UPLOAD_PER_FRAME;
+		std::vector<VkBufferImageCopy> vecRegion;
+		for (UINT uiMip = 0; uiMip < m_VirtualTexture.GetMipCount(); ++uiMip)
+		{
+			VkBufferImageCopy region{};
+			region.bufferOffset = pageTableOffset + sizeof(UINT) * m_VirtualTexture.GetMipBase(uiMip);
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, uiMip, 0, m_VirtualTexture.GetLayerCount() };
+			region.imageExtent = { m_VirtualTexture.GetMipPageCountX(uiMip), m_VirtualTexture.GetMipPageCountY(uiMip), 1 };
+			vecRegion.push_back(region);
+		}
+		vkCmdCopyBufferToImage(commandBuffer, m_VirtualStagingBuffer, m_vecVirtualPageTableImage[uiIdx], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<UINT>(vecRegion.size()), vecRegion.data());
 	}
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 1, &feedbackBarrier, static_cast<UINT>(vecToShaderRead.size()), vecToShaderRead.data());
+}
+
+void VulkanRenderer::RecordVirtualTextureReadback(VkCommandBuffer commandBuffer, UINT uiIdx)
+{
+	if (!m_bVirtualTextureSupported || !m_bEnableVirtualTexture)
+		return;
+
+	//֡Ƶhostɼڴ棬´ʹԴʱCPUȡ
+	VkDeviceSize feedbackOffset = m_VirtualFeedbackFrameSize * uiIdx;
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = m_VirtualFeedbackBuffer;
+	barrier.offset = feedbackOffset;
+	barrier.size = m_VirtualFeedbackFrameSize;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+	VkBufferCopy copyRegion{};
+	copyRegion.srcOffset = feedbackOffset;
+	copyRegion.dstOffset = feedbackOffset;
+	copyRegion.size = m_VirtualFeedbackFrameSize;
+	vkCmdCopyBuffer(commandBuffer, m_VirtualFeedbackBuffer, m_VirtualFeedbackReadbackBuffer, 1, &copyRegion);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	barrier.buffer = m_VirtualFeedbackReadbackBuffer;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
 }
 
 void VulkanRenderer::AllocateImageMemory(VkMemoryPropertyFlags propertyFlags, VkImage& image, VkDeviceMemory& imageMemory)
@@ -1441,7 +1885,7 @@ void VulkanRenderer::ChangeImageLayout(VkImage image, VkFormat format, UINT uiMi
 	barrier.srcAccessMask = 0;
 	barrier.dstAccessMask = 0;
 
-	if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+	if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL || newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL)
 	{
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
 		if (CheckFormatHasStencilComponent(format))
@@ -1478,6 +1922,14 @@ void VulkanRenderer::ChangeImageLayout(VkImage image, VkFormat format, UINT uiMi
 		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 		dstStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 	}
+	else if ((oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) && (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL))
+	{
+		//Ⱦ֮ǰͻᱻdepth imageshadow map
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
 	else
 	{
 		ASSERT(false, "Unsupport image layout change type");
@@ -1532,146 +1984,496 @@ void VulkanRenderer::TransferImageDataByStageBuffer(const void* pData, VkDeviceS
 	vkFreeMemory(m_LogicalDevice, stagingBufferMemory, nullptr);
 }
 
-void VulkanRenderer::CreateDescriptorSetLayout()
+bool VulkanRenderer::CheckFormatSupportSampling(VkFormat format)
 {
-	//UniformBufferObject Binding
-	VkDescriptorSetLayoutBinding uboLayoutBinding{};
-	uboLayoutBinding.binding = 0; //ӦVertex Shaderеlayout binding
-	uboLayoutBinding.descriptorCount = 1;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
-	uboLayoutBinding.pImmutableSamplers = nullptr;
-
-	//Dynamic UniformBufferObject Binding
-	VkDescriptorSetLayoutBinding dynamicUboLayoutBinding{};
-	dynamicUboLayoutBinding.binding = 1; //ӦVertex Shaderеlayout binding
-	dynamicUboLayoutBinding.descriptorCount = 1;
-	dynamicUboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-	dynamicUboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
-	dynamicUboLayoutBinding.pImmutableSamplers = nullptr;
+	//豸֧textureCompressionBCʱBCʽᱨSAMPLED_IMAGE
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &formatProperties);
+	VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
 
-	//CombinedImageSampler Binding
-	VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-	samplerLayoutBinding.binding = 2; ////ӦFragment Shaderеlayout binding
-	samplerLayoutBinding.descriptorCount = 1;
-	samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; //ֻfragment stage
-	samplerLayoutBinding.pImmutableSamplers = nullptr;
+bool VulkanRenderer::QueryDeviceLocalMemoryBudget(UINT64& ullBudget, UINT64& ullUsage)
+{
+	if (!m_bMemoryBudgetEnabled)
+		return false;
 
-	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
-		uboLayoutBinding,
-		dynamicUboLayoutBinding,
-		samplerLayoutBinding,
-	};
+	//ExtensionĺҪʹvkGetInstanceProcAddrȡ
+	auto func = (PFN_vkGetPhysicalDeviceMemoryProperties2KHR)vkGetInstanceProcAddr(m_Instance, "vkGetPhysicalDeviceMemoryProperties2KHR");
+	if (!func)
+		return false;
 
-	VkDescriptorSetLayoutCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
-	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+	budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2KHR memoryProperties{};
+	memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+	memoryProperties.pNext = &budgetProperties;
+	func(m_PhysicalDevice, &memoryProperties);
 
-	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_DescriptorSetLayout), "Create descriptor layout failed");
+	ullBudget = 0;
+	ullUsage = 0;
+	for (UINT i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; ++i)
+	{
+		if (memoryProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			ullBudget += budgetProperties.heapBudget[i];
+			ullUsage += budgetProperties.heapUsage[i];
+		}
+	}
+	return true;
 }
 
-void VulkanRenderer::CreateDescriptorPool()
+bool VulkanRenderer::CheckFormatSupportBlit(VkFormat format)
 {
-	//ubo
-	VkDescriptorPoolSize uboPoolSize{};
-	uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
-
-	//dynamic ubo
-	VkDescriptorPoolSize dynamicUboPoolSize{};
-	dynamicUboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-	dynamicUboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+	//blitmipҪøʽoptimal tilingͬʱΪblitԴĿ֧꣬Թ
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &formatProperties);
+	VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
 
-	//sampler
-	VkDescriptorPoolSize samplerPoolSize{};
-	samplerPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	samplerPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+void VulkanRenderer::TransferImageDataAndGenerateMipmaps(const void* pData, VkImage& image, VkFormat format, UINT uiWidth, UINT uiHeight, UINT uiMipLevelCount, UINT uiLayerCount)
+{
+	size_t levelSize = static_cast<size_t>(uiWidth) * uiHeight * 4 * uiLayerCount;
+	TransferImageDataAndGenerateMipmaps([&](UCHAR* pDst) { memcpy(pDst, pData, levelSize); },
+		image, format, uiWidth, uiHeight, uiMipLevelCount, uiLayerCount);
+}
 
-	std::vector<VkDescriptorPoolSize> vecPoolSize = {
-		uboPoolSize,
-		dynamicUboPoolSize,
-		samplerPoolSize,
-	};
+void VulkanRenderer::TransferImageDataAndGenerateMipmaps(const std::function<void(UCHAR*)>& funcWriteLevel0, VkImage& image, VkFormat format, UINT uiWidth, UINT uiHeight, UINT uiMipLevelCount, UINT uiLayerCount)
+{
+	DZW_VulkanWrap::StagingUpload upload;
+	PrepareMipmapStaging(funcWriteLevel0, format, uiWidth, uiHeight, uiMipLevelCount, uiLayerCount, upload);
 
-	VkDescriptorPoolCreateInfo poolCreateInfo{};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
-	poolCreateInfo.pPoolSizes = vecPoolSize.data();
-	poolCreateInfo.maxSets = static_cast<UINT>(m_vecSwapChainImages.size());
+	VkCommandBuffer singleTimeCommandBuffer = BeginSingleTimeCommand();
+	RecordStagingUpload(singleTimeCommandBuffer, upload, image, uiMipLevelCount, uiLayerCount);
+	EndSingleTimeCommand(singleTimeCommandBuffer);
 
-	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_DescriptorPool), "Create descriptor pool failed");
+	DestroyStagingUpload(upload);
 }
 
-void VulkanRenderer::CreateDescriptorSets()
+void VulkanRenderer::PrepareMipmapStaging(const std::function<void(UCHAR*)>& funcWriteLevel0, VkFormat format, UINT uiWidth, UINT uiHeight, UINT uiMipLevelCount, UINT uiLayerCount, DZW_VulkanWrap::StagingUpload& upload)
 {
-	VkDescriptorSetAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	allocInfo.descriptorSetCount = static_cast<UINT>(m_vecSwapChainImages.size());
-	allocInfo.descriptorPool = m_DescriptorPool;
+	auto mipExtent = [&](UINT uiMip) { return VkExtent2D{ std::max(uiWidth >> uiMip, 1u), std::max(uiHeight >> uiMip, 1u) }; };
 
-	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_DescriptorSetLayout);
-	allocInfo.pSetLayouts = vecDupDescriptorSetLayout.data();
-
-	m_vecDescriptorSets.resize(m_vecSwapChainImages.size());
-	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecDescriptorSets.data()), "Allocate desctiprot sets failed");
+	//ʽ֧blitʱCPU2x2 box filtermipһstaging
+	bool bBlit = (uiMipLevelCount == 1) || CheckFormatSupportBlit(format);
+	if (!bBlit)
+		Log::Warn("Format {} does not support linear blit, generate mipmaps on CPU", static_cast<int>(format));
 
-	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	VkDeviceSize levelSize = static_cast<VkDeviceSize>(uiWidth) * uiHeight * 4 * uiLayerCount;
+	std::vector<VkDeviceSize> vecLevelOffset(1, 0);
+	VkDeviceSize stagingSize = levelSize;
+	if (!bBlit)
 	{
-		//ubo
-		VkDescriptorBufferInfo descriptorBufferInfo{};
-		descriptorBufferInfo.buffer = m_vecUniformBuffers[i];
-		descriptorBufferInfo.offset = 0;
-		descriptorBufferInfo.range = sizeof(UniformBufferObject);
-
-		VkWriteDescriptorSet uboWrite{};
-		uboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		uboWrite.dstSet = m_vecDescriptorSets[i];
-		uboWrite.dstBinding = 0;
-		uboWrite.dstArrayElement = 0;
-		uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uboWrite.descriptorCount = 1;
-		uboWrite.pBufferInfo = &descriptorBufferInfo;
-
-		//dynamic ubo
-		VkDescriptorBufferInfo dynamicDescriptorBufferInfo{};
-		dynamicDescriptorBufferInfo.buffer = m_vecDynamicUniformBuffers[i];
-		dynamicDescriptorBufferInfo.offset = 0;
-		dynamicDescriptorBufferInfo.range = m_DynamicAlignment;
-
-		VkWriteDescriptorSet dynamicUboWrite{};
-		dynamicUboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		dynamicUboWrite.dstSet = m_vecDescriptorSets[i];
-		dynamicUboWrite.dstBinding = 1;
-		dynamicUboWrite.dstArrayElement = 0;
-		dynamicUboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-		dynamicUboWrite.descriptorCount = 1;
-		dynamicUboWrite.pBufferInfo = &dynamicDescriptorBufferInfo;
+		for (UINT uiMip = 1; uiMip < uiMipLevelCount; ++uiMip)
+		{
+			vecLevelOffset.push_back(stagingSize);
+			VkExtent2D extent = mipExtent(uiMip);
+			stagingSize += static_cast<VkDeviceSize>(extent.width) * extent.height * 4 * uiLayerCount;
+		}
+	}
 
-		//sampler
-		VkDescriptorImageInfo imageInfo{};
-		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		//imageInfo.imageView = m_Texture.m_ImageView;
-		//imageInfo.sampler = m_Texture.m_Sampler;
+	CreateBufferAndBindMemory(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		upload.buffer, upload.memory);
+
+	UCHAR* pStaging = nullptr;
+	vkMapMemory(m_LogicalDevice, upload.memory, 0, stagingSize, 0, (void**)&pStaging);
+	if (bBlit)
+	{
+		funcWriteLevel0(pStaging);
+	}
+	else
+	{
+		//stagingwrite combinedڴ棬ͨڴдmip 0ٿ
+		//sRGBʽɫͨתԿռƽֱƽֵmipƫalphaԵ
+		bool bSRGB = (format == VK_FORMAT_R8G8B8A8_SRGB) || (format == VK_FORMAT_B8G8R8A8_SRGB);
+		const auto& aryToLinear = DZW_ColorSpace::GetSrgbToLinearTable();
+
+		std::vector<UCHAR> vecPrev(static_cast<size_t>(levelSize));
+		funcWriteLevel0(vecPrev.data());
+		memcpy(pStaging, vecPrev.data(), vecPrev.size());
+		std::vector<UCHAR> vecCur;
+		for (UINT uiMip = 1; uiMip < uiMipLevelCount; ++uiMip)
+		{
+			VkExtent2D src = mipExtent(uiMip - 1);
+			VkExtent2D dst = mipExtent(uiMip);
+			vecCur.resize(static_cast<size_t>(dst.width) * dst.height * 4 * uiLayerCount);
+			for (UINT uiLayer = 0; uiLayer < uiLayerCount; ++uiLayer)
+			{
+				const UCHAR* pSrc = vecPrev.data() + static_cast<size_t>(src.width) * src.height * 4 * uiLayer;
+				UCHAR* pDst = vecCur.data() + static_cast<size_t>(dst.width) * dst.height * 4 * uiLayer;
+				for (UINT y = 0; y < dst.height; ++y)
+				{
+					UINT y0 = std::min(y * 2, src.height - 1);
+					UINT y1 = std::min(y * 2 + 1, src.height - 1);
+					for (UINT x = 0; x < dst.width; ++x)
+					{
+						UINT x0 = std::min(x * 2, src.width - 1);
+						UINT x1 = std::min(x * 2 + 1, src.width - 1);
+						for (UINT c = 0; c < 4; ++c)
+						{
+							UCHAR uc00 = pSrc[(y0 * src.width + x0) * 4 + c], uc01 = pSrc[(y0 * src.width + x1) * 4 + c];
+							UCHAR uc10 = pSrc[(y1 * src.width + x0) * 4 + c], uc11 = pSrc[(y1 * src.width + x1) * 4 + c];
+							if (bSRGB && c < 3)
+							{
+								float fLinear = aryToLinear[uc00] + aryToLinear[uc01] + aryToLinear[uc10] + aryToLinear[uc11];
+								pDst[(y * dst.width + x) * 4 + c] = DZW_ColorSpace::LinearToSrgb(fLinear * 0.25f);
+							}
+							else
+							{
+								pDst[(y * dst.width + x) * 4 + c] = static_cast<UCHAR>((uc00 + uc01 + uc10 + uc11 + 2) / 4);
+							}
+						}
+					}
+				}
+			}
+			memcpy(pStaging + vecLevelOffset[uiMip], vecCur.data(), vecCur.size());
+			std::swap(vecPrev, vecCur);
+		}
+	}
+	vkUnmapMemory(m_LogicalDevice, upload.memory);
+
+	upload.vecRegion.clear();
+	for (UINT uiMip = 0; uiMip < static_cast<UINT>(vecLevelOffset.size()); ++uiMip)
+	{
+		VkExtent2D extent = mipExtent(uiMip);
+		VkBufferImageCopy region{};
+		region.bufferOffset = vecLevelOffset[uiMip];
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, uiMip, 0, uiLayerCount };
+		region.imageExtent = { extent.width, extent.height, 1 };
+		upload.vecRegion.push_back(region);
+	}
+	upload.uiWidth = uiWidth;
+	upload.uiHeight = uiHeight;
+	upload.bBlitMipmaps = bBlit && uiMipLevelCount > 1;
+}
+
+void VulkanRenderer::RecordStagingUpload(VkCommandBuffer commandBuffer, const DZW_VulkanWrap::StagingUpload& upload, VkImage image, UINT uiMipLevelCount, UINT uiLayerCount)
+{
+	auto mipExtent = [&](UINT uiMip) { return VkExtent2D{ std::max(upload.uiWidth >> uiMip, 1u), std::max(upload.uiHeight >> uiMip, 1u) }; };
+
+	//תcopyblit¼ͬһcommand buffer
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, uiMipLevelCount, 0, uiLayerCount };
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	vkCmdCopyBufferToImage(commandBuffer, upload.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<UINT>(upload.vecRegion.size()), upload.vecRegion.data());
+
+	std::vector<VkImageMemoryBarrier> vecToShaderRead;
+	if (upload.bBlitMipmaps)
+	{
+		//blitһתΪtransfer srcСһ
+		for (UINT uiMip = 1; uiMip < uiMipLevelCount; ++uiMip)
+		{
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, uiMip - 1, 1, 0, uiLayerCount };
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			VkExtent2D src = mipExtent(uiMip - 1);
+			VkExtent2D dst = mipExtent(uiMip);
+			VkImageBlit blit{};
+			blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, uiMip - 1, 0, uiLayerCount };
+			blit.srcOffsets[1] = { static_cast<int32_t>(src.width), static_cast<int32_t>(src.height), 1 };
+			blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, uiMip, 0, uiLayerCount };
+			blit.dstOffsets[1] = { static_cast<int32_t>(dst.width), static_cast<int32_t>(dst.height), 1 };
+			vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+		}
+
+		//һⶼtransfer srcһתΪshader readonly
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, uiMipLevelCount - 1, 0, uiLayerCount };
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		vecToShaderRead.push_back(barrier);
+
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, uiMipLevelCount - 1, 1, 0, uiLayerCount };
+	}
+	else
+	{
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, uiMipLevelCount, 0, uiLayerCount };
+	}
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	vecToShaderRead.push_back(barrier);
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, static_cast<UINT>(vecToShaderRead.size()), vecToShaderRead.data());
+}
+
+void VulkanRenderer::RecordStagingUploadLevels(VkCommandBuffer commandBuffer, const DZW_VulkanWrap::StagingUpload& upload, VkImage image, UINT uiBaseMip, UINT uiEndMip, UINT uiMipLevelCount, UINT uiLayerCount)
+{
+	ASSERT(!upload.bBlitMipmaps && uiBaseMip < uiEndMip && uiEndMip <= uiMipLevelCount, "Invalid staging upload levels [{}, {})", uiBaseMip, uiEndMip);
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+
+	//һϴʱimageundefinedתΪtransfer dstδϴmipһֱtransfer dst
+	if (uiEndMip == uiMipLevelCount)
+	{
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, uiMipLevelCount, 0, uiLayerCount };
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	std::vector<VkBufferImageCopy> vecRegion;
+	for (const auto& region : upload.vecRegion)
+	{
+		if (region.imageSubresource.mipLevel >= uiBaseMip && region.imageSubresource.mipLevel < uiEndMip)
+			vecRegion.push_back(region);
+	}
+	vkCmdCopyBufferToImage(commandBuffer, upload.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<UINT>(vecRegion.size()), vecRegion.data());
+
+	barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, uiBaseMip, uiEndMip - uiBaseMip, 0, uiLayerCount };
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void VulkanRenderer::DestroyStagingUpload(DZW_VulkanWrap::StagingUpload& upload)
+{
+	vkDestroyBuffer(m_LogicalDevice, upload.buffer, nullptr);
+	vkFreeMemory(m_LogicalDevice, upload.memory, nullptr);
+	upload = DZW_VulkanWrap::StagingUpload();
+}
+
+void VulkanRenderer::CreateDescriptorSetLayout()
+{
+	//UniformBufferObject Binding
+	VkDescriptorSetLayoutBinding uboLayoutBinding{};
+	uboLayoutBinding.binding = 0; //ӦVertex Shaderеlayout binding
+	uboLayoutBinding.descriptorCount = 1;
+	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT; //impostorfragment shaderҪproj
+	uboLayoutBinding.pImmutableSamplers = nullptr;
+
+	//CombinedImageSampler Binding
+	VkDescriptorSetLayoutBinding samplerLayoutBinding{};
+	samplerLayoutBinding.binding = 1; ////ӦFragment Shaderеlayout binding
+	samplerLayoutBinding.descriptorCount = 1;
+	samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; //ֻfragment stage
+	samplerLayoutBinding.pImmutableSamplers = nullptr;
+
+	//virtual texture: page table, atlas, feedback
+	VkDescriptorSetLayoutBinding pageTableLayoutBinding = samplerLayoutBinding;
+	pageTableLayoutBinding.binding = 2;
+
+	VkDescriptorSetLayoutBinding atlasLayoutBinding = samplerLayoutBinding;
+	atlasLayoutBinding.binding = 3;
+
+	VkDescriptorSetLayoutBinding feedbackLayoutBinding{};
+	feedbackLayoutBinding.binding = 4;
+	feedbackLayoutBinding.descriptorCount = 1;
+	feedbackLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	feedbackLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	feedbackLayoutBinding.pImmutableSamplers = nullptr;
+
+	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
+		uboLayoutBinding,
+		samplerLayoutBinding,
+		pageTableLayoutBinding,
+		atlasLayoutBinding,
+	};
+
+	//ûfragmentStoresAndAtomicsʱfragment shaderдstorage buffershaderҲûbinding 4
+	if (m_bVirtualTextureSupported)
+		vecDescriptorLayoutBinding.push_back(feedbackLayoutBinding);
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
+	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_DescriptorSetLayout), "Create descriptor layout failed");
+}
+
+void VulkanRenderer::CreateDescriptorPool()
+{
+	//ubo
+	VkDescriptorPoolSize uboPoolSize{};
+	uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+
+	//sampler顢page tableatlas
+	VkDescriptorPoolSize samplerPoolSize{};
+	samplerPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	samplerPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size()) * 3;
+
+	//feedback
+	VkDescriptorPoolSize storagePoolSize{};
+	storagePoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	storagePoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+
+	std::vector<VkDescriptorPoolSize> vecPoolSize = {
+		uboPoolSize,
+		samplerPoolSize,
+	};
+	if (m_bVirtualTextureSupported)
+		vecPoolSize.push_back(storagePoolSize);
+
+	VkDescriptorPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
+	poolCreateInfo.pPoolSizes = vecPoolSize.data();
+	poolCreateInfo.maxSets = static_cast<UINT>(m_vecSwapChainImages.size());
+
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_DescriptorPool), "Create descriptor pool failed");
+}
+
+void VulkanRenderer::CreateDescriptorSets()
+{
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = static_cast<UINT>(m_vecSwapChainImages.size());
+	allocInfo.descriptorPool = m_DescriptorPool;
+
+	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_DescriptorSetLayout);
+	allocInfo.pSetLayouts = vecDupDescriptorSetLayout.data();
+
+	m_vecDescriptorSets.resize(m_vecSwapChainImages.size());
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecDescriptorSets.data()), "Allocate desctiprot sets failed");
+
+	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	{
+		//ubo
+		VkDescriptorBufferInfo descriptorBufferInfo{};
+		descriptorBufferInfo.buffer = m_vecUniformBuffers[i];
+		descriptorBufferInfo.offset = 0;
+		descriptorBufferInfo.range = sizeof(UniformBufferObject);
+
+		VkWriteDescriptorSet uboWrite{};
+		uboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		uboWrite.dstSet = m_vecDescriptorSets[i];
+		uboWrite.dstBinding = 0;
+		uboWrite.dstArrayElement = 0;
+		uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		uboWrite.descriptorCount = 1;
+		uboWrite.pBufferInfo = &descriptorBufferInfo;
+
+		//sampler
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = m_PlanetTexture->m_ImageView;
+		imageInfo.sampler = m_PlanetTexture->m_Sampler;
 
 		VkWriteDescriptorSet samplerWrite{};
 		samplerWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		samplerWrite.dstSet = m_vecDescriptorSets[i];
-		samplerWrite.dstBinding = 2;
+		samplerWrite.dstBinding = 1;
 		samplerWrite.dstArrayElement = 0;
 		samplerWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		samplerWrite.descriptorCount = 1;
 		samplerWrite.pImageInfo = &imageInfo;
 
+		//virtual texture
+		VkDescriptorImageInfo pageTableInfo{};
+		pageTableInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		pageTableInfo.imageView = m_vecVirtualPageTableImageView[i];
+		pageTableInfo.sampler = m_VirtualPageTableSampler;
+
+		VkWriteDescriptorSet pageTableWrite = samplerWrite;
+		pageTableWrite.dstBinding = 2;
+		pageTableWrite.pImageInfo = &pageTableInfo;
+
+		VkDescriptorImageInfo atlasInfo{};
+		atlasInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		atlasInfo.imageView = m_VirtualAtlasImageView;
+		atlasInfo.sampler = m_VirtualAtlasSampler;
+
+		VkWriteDescriptorSet atlasWrite = samplerWrite;
+		atlasWrite.dstBinding = 3;
+		atlasWrite.pImageInfo = &atlasInfo;
+
+		VkDescriptorBufferInfo feedbackInfo{};
+		feedbackInfo.buffer = m_VirtualFeedbackBuffer;
+		feedbackInfo.offset = m_VirtualFeedbackFrameSize * i;
+		feedbackInfo.range = m_VirtualFeedbackFrameSize;
+
+		VkWriteDescriptorSet feedbackWrite{};
+		feedbackWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		feedbackWrite.dstSet = m_vecDescriptorSets[i];
+		feedbackWrite.dstBinding = 4;
+		feedbackWrite.dstArrayElement = 0;
+		feedbackWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		feedbackWrite.descriptorCount = 1;
+		feedbackWrite.pBufferInfo = &feedbackInfo;
+
 		std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
 			uboWrite,
-			dynamicUboWrite,
 			samplerWrite,
+			pageTableWrite,
+			atlasWrite,
 		};
+		if (m_bVirtualTextureSupported)
+			vecDescriptorWrite.push_back(feedbackWrite);
 
 		vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
 	}
+
+	m_vecPlanetTextureVersion.assign(m_vecSwapChainImages.size(), m_PlanetTexture->m_uiVersion);
+}
+
+void VulkanRenderer::UpdateStreamedTextureDescriptorSets(UINT uiIdx)
+{
+	//ֻдǰ֡descriptor set֡setԱеcommand bufferʹãֵʱд
+	std::vector<VkDescriptorImageInfo> vecImageInfo;
+	std::vector<VkWriteDescriptorSet> vecDescriptorWrite;
+	vecImageInfo.reserve(2);
+
+	auto addTextureWrite = [&](const std::shared_ptr<DZW_VulkanWrap::Texture>& pTexture, std::vector<UINT>& vecVersion, VkDescriptorSet descriptorSet, UINT uiBinding)
+	{
+		if (!pTexture || uiIdx >= vecVersion.size() || vecVersion[uiIdx] == pTexture->m_uiVersion)
+			return;
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = pTexture->m_ImageView;
+		imageInfo.sampler = pTexture->m_Sampler;
+		vecImageInfo.push_back(imageInfo);
+
+		VkWriteDescriptorSet samplerWrite{};
+		samplerWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		samplerWrite.dstSet = descriptorSet;
+		samplerWrite.dstBinding = uiBinding;
+		samplerWrite.dstArrayElement = 0;
+		samplerWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		samplerWrite.descriptorCount = 1;
+		samplerWrite.pImageInfo = &vecImageInfo.back();
+		vecDescriptorWrite.push_back(samplerWrite);
+
+		vecVersion[uiIdx] = pTexture->m_uiVersion;
+	};
+
+	if (uiIdx < m_vecDescriptorSets.size())
+		addTextureWrite(m_PlanetTexture, m_vecPlanetTextureVersion, m_vecDescriptorSets[uiIdx], 1);
+	if (uiIdx < m_vecSkyboxDescriptorSets.size())
+		addTextureWrite(m_SkyboxTexture, m_vecSkyboxTextureVersion, m_vecSkyboxDescriptorSets[uiIdx], 1);
+
+	if (!vecDescriptorWrite.empty())
+		vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
 }
 
 void VulkanRenderer::TransferBufferDataByStageBuffer(void* pData, VkDeviceSize bufferSize, VkBuffer& buffer)
@@ -1729,15 +2531,21 @@ void VulkanRenderer::CreateCommandBuffers()
 
 void VulkanRenderer::CreateGraphicPipelineLayout()
 {
+	//impostorãϸֶͨpush constant
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PlanetPushConstant);
+
 	//-----------------------Pipeline Layout--------------------------//
 	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
 	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutCreateInfo.setLayoutCount = 1;
 	pipelineLayoutCreateInfo.pSetLayouts = &m_DescriptorSetLayout;
-	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
 
-	//VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_GraphicPipelineLayout), "Create pipeline layout failed");
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_GraphicPipelineLayout), "Create pipeline layout failed");
 }
 
 void VulkanRenderer::CreateGraphicPipeline()
@@ -1780,14 +2588,16 @@ void VulkanRenderer::CreateGraphicPipeline()
 
 
 	//-----------------------Vertex Input State--------------------------//
-	auto bindingDescription = Vertex3D::GetBindingDescription();
-	auto attributeDescriptions = Vertex3D::GetAttributeDescriptions();
+	//涥gl_VertexIndexɣֻbinding 1: InstanceDataInstanced pipelineͬʵʽ
+	std::array<VkVertexInputBindingDescription, 1> aryBindingDescription = { GetInstanceBindingDescription() };
+	auto vecAttributeDescription = GetInstanceAttributeDescriptions();
+
 	VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
 	vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
-	vertexInputCreateInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(attributeDescriptions.size());
-	vertexInputCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+	vertexInputCreateInfo.vertexBindingDescriptionCount = static_cast<UINT>(aryBindingDescription.size());
+	vertexInputCreateInfo.pVertexBindingDescriptions = aryBindingDescription.data();
+	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(vecAttributeDescription.size());
+	vertexInputCreateInfo.pVertexAttributeDescriptions = vecAttributeDescription.data();
 
 	//-----------------------Input Assembly State------------------------//
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
@@ -1819,7 +2629,7 @@ void VulkanRenderer::CreateGraphicPipeline()
 	//-----------------------Multisample State--------------------------//
 	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
 	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	//multisamplingStateCreateInfo.sampleShadingEnable = (VkBool32)(m_Texture.m_uiMipLevelNum > 1);
+	//multisamplingStateCreateInfo.sampleShadingEnable = (VkBool32)(m_PlanetTexture->m_uiMipLevelNum > 1);
 	multisamplingStateCreateInfo.minSampleShading = 0.8f;
 	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 	multisamplingStateCreateInfo.minSampleShading = 1.f;
@@ -1832,7 +2642,7 @@ void VulkanRenderer::CreateGraphicPipeline()
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
 	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
@@ -1868,127 +2678,60 @@ void VulkanRenderer::CreateGraphicPipeline()
 	colorBlendStateCreateInfo.blendConstants[3] = 0.f;
 
 	/***********************************************************************/
-	//VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
-	//pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	//pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapShaderModule.size());
-	//pipelineCreateInfo.pStages = shaderStageCreateInfos;
-	//pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
-	//pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
-	//pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
-	//pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
-	//pipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
-	//pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
-	//pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
-	//pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-	//pipelineCreateInfo.layout = m_GraphicPipelineLayout;
-	//pipelineCreateInfo.renderPass = m_RenderPass;
-	//pipelineCreateInfo.subpass = 0;
-	//pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
-	//pipelineCreateInfo.basePipelineIndex = -1;
-
-	////ʱṩVkPipelineCacheVulkan᳢Դ
-	////ûпõݣµݻᱻӵ
-	//VkPipelineCache pipelineCache = VK_NULL_HANDLE;
-
-	//VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_GraphicPipeline), "Create graphic pipeline failed");
-}
-
-void VulkanRenderer::CreateSyncObjects()
-{
-	m_vecImageAvailableSemaphores.resize(m_vecSwapChainImages.size());
-	m_vecRenderFinishedSemaphores.resize(m_vecSwapChainImages.size());
-	m_vecInFlightFences.resize(m_vecSwapChainImages.size());
-
-	VkSemaphoreCreateInfo semaphoreCreateInfo{};
-	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-	VkFenceCreateInfo fenceCreateInfo{};
-	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; //ֵΪsignaled
-
-	for (int i = 0; i < m_vecSwapChainImages.size(); ++i)
-	{
-		VULKAN_ASSERT(vkCreateSemaphore(m_LogicalDevice, &semaphoreCreateInfo, nullptr, &m_vecImageAvailableSemaphores[i]), "Create image available semaphore failed");
-		VULKAN_ASSERT(vkCreateSemaphore(m_LogicalDevice, &semaphoreCreateInfo, nullptr, &m_vecRenderFinishedSemaphores[i]), "Create render finished semaphore failed");
-		VULKAN_ASSERT(vkCreateFence(m_LogicalDevice, &fenceCreateInfo, nullptr, &m_vecInFlightFences[i]), "Create inflight fence failed");
-	}
-}
-
-void VulkanRenderer::SetupCamera()
-{
-	m_Camera.Init(45.f, 
-		static_cast<float>(m_SwapChainExtent2D.width), 
-		static_cast<float>(m_SwapChainExtent2D.height), 
-		0.1f, 10000.f,
-		m_pWindow, 
-		{ 0.0, 0.0, 10.0 }, 
-		{ 0.0, 0.0, 0.0 }, 
-		false);
+	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapShaderModule.size());
+	pipelineCreateInfo.pStages = shaderStageCreateInfos;
+	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
+	pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+	pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+	pipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
+	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
+	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
+	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
+	pipelineCreateInfo.layout = m_GraphicPipelineLayout;
+	pipelineCreateInfo.renderPass = m_RenderPass;
+	pipelineCreateInfo.subpass = 0;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
 
-	glfwSetWindowUserPointer(m_pWindow, (void*)&m_Camera);
+	//ʱṩVkPipelineCacheVulkan᳢Դ
+	//ûпõݣµݻᱻӵ
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
 
-	glfwSetScrollCallback(m_pWindow, [](GLFWwindow* window, double dOffsetX, double dOffsetY)
-		{
-			if (ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow))
-				return;
-			auto& camera = *(Camera*)glfwGetWindowUserPointer(window);
-			camera.OnMouseScroll(dOffsetX, dOffsetY);
-		}
-	);
-	glfwSetKeyCallback(m_pWindow, [](GLFWwindow* window, int nKey, int nScanmode, int nAction, int Mods)
-		{
-			if (ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow))
-				return;
-			auto& camera = *(Camera*)glfwGetWindowUserPointer(window);
-			camera.OnKeyPress(nKey);
-		}
-	);
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_GraphicPipeline), "Create graphic pipeline failed");
 }
 
-void VulkanRenderer::CreateSkyboxShader()
+void VulkanRenderer::CreatePlanetImpostorShaderModule()
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapSkyboxShaderPath = {
-		{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/Skybox/vert.spv" },
-		{ VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/Skybox/frag.spv" },
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
 	};
-	ASSERT(mapSkyboxShaderPath.size() > 0, "Detect no shader spv file");
 
-	m_mapSkyboxShaderModule.clear();
+	m_mapPlanetImpostorShaderModule.clear();
 
-	for (const auto& spvPath : mapSkyboxShaderPath)
+	for (const auto& stage : vecShaderStage)
 	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
-
-		m_mapSkyboxShaderModule[spvPath.first] = shaderModule;
+		m_mapPlanetImpostorShaderModule[stage] = CreateShaderModuleByName("PlanetImpostor", stage);
 	}
 }
 
-void VulkanRenderer::CreateSkyboxGraphicPipelineLayout()
-{
-	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
-	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutCreateInfo.setLayoutCount = 1;
-	pipelineLayoutCreateInfo.pSetLayouts = &m_SkyboxDescriptorSetLayout;
-	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
-
-	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_SkyboxGraphicPipelineLayout), "Create skybox pipeline layout failed");
-}
-
-void VulkanRenderer::CreateSkyboxGraphicPipeline()
+void VulkanRenderer::CreatePlanetImpostorPipeline()
 {
 	/****************************ɱ̹*******************************/
 	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
 	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageCreateInfo.module = m_mapSkyboxShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
-	vertShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
+	vertShaderStageCreateInfo.module = m_mapPlanetImpostorShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT);
+	vertShaderStageCreateInfo.pName = "main";
 
 	VkPipelineShaderStageCreateInfo fragShaderStageCreateInfo{};
 	fragShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageCreateInfo.module = m_mapSkyboxShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT); //Bytecode
-	fragShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
+	fragShaderStageCreateInfo.module = m_mapPlanetImpostorShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT);
+	fragShaderStageCreateInfo.pName = "main";
 
 	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
 		vertShaderStageCreateInfo,
@@ -2008,14 +2751,16 @@ void VulkanRenderer::CreateSkyboxGraphicPipeline()
 	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
 
 	//-----------------------Vertex Input State--------------------------//
-	auto bindingDescription = Vertex3D::GetBindingDescription();
-	auto attributeDescriptions = Vertex3D::GetAttributeDescriptions();
+	//û𶥵ݣıζgl_VertexIndexɣbinding 1ΪInstanceData·ͬһbuffer
+	std::array<VkVertexInputBindingDescription, 1> aryBindingDescription = { GetInstanceBindingDescription() };
+	auto vecAttributeDescription = GetInstanceAttributeDescriptions();
+
 	VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
 	vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
-	vertexInputCreateInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(attributeDescriptions.size());
-	vertexInputCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+	vertexInputCreateInfo.vertexBindingDescriptionCount = static_cast<UINT>(aryBindingDescription.size());
+	vertexInputCreateInfo.pVertexBindingDescriptions = aryBindingDescription.data();
+	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(vecAttributeDescription.size());
+	vertexInputCreateInfo.pVertexAttributeDescriptions = vecAttributeDescription.data();
 
 	//-----------------------Input Assembly State------------------------//
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
@@ -2023,7 +2768,6 @@ void VulkanRenderer::CreateSkyboxGraphicPipeline()
 	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
-
 	//-----------------------Viewport State--------------------------//
 	VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
 	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -2033,22 +2777,18 @@ void VulkanRenderer::CreateSkyboxGraphicPipeline()
 	//-----------------------Raserization State--------------------------//
 	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{};
 	rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;	//󣬳ԶƽĲֻᱻضԶƽϣǶ
-	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;	//󣬽ֹͼԪդ
-	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;	//ͼԪģʽFILLLINEPOINT
-	rasterizationStateCreateInfo.lineWidth = 1.f;	//ָդ߶ο
-	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_FRONT_BIT;	//޳Ŀɼ
-	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE; //򣬿˳ʱcwʱccw
-	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE; //ƫƣһShaodw MapбӰ
-	rasterizationStateCreateInfo.depthBiasConstantFactor = 0.f;
-	rasterizationStateCreateInfo.depthBiasClamp = 0.f;
-	rasterizationStateCreateInfo.depthBiasSlopeFactor = 0.f;
+	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
+	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizationStateCreateInfo.lineWidth = 1.f;
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE; //ıγ仯޳
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
 
 	//-----------------------Multisample State--------------------------//
 	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
 	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 	multisamplingStateCreateInfo.sampleShadingEnable = VK_FALSE;
-	multisamplingStateCreateInfo.minSampleShading = 0.8f;
 	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 	multisamplingStateCreateInfo.minSampleShading = 1.f;
 	multisamplingStateCreateInfo.pSampleMask = nullptr;
@@ -2058,23 +2798,15 @@ void VulkanRenderer::CreateSkyboxGraphicPipeline()
 	//-----------------------Depth Stencil State--------------------------//
 	VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depthStencilStateCreateInfo.depthTestEnable = VK_FALSE; //ΪʼԶȼ
-	depthStencilStateCreateInfo.depthWriteEnable = VK_FALSE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
 	depthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
-	depthStencilStateCreateInfo.front = {};
-	depthStencilStateCreateInfo.back = {};
 
 	//-----------------------Color Blend State--------------------------//
-	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{};
-	colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-	colorBlendStateCreateInfo.attachmentCount = 1;
-
 	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
 	colorBlendAttachment.colorWriteMask =
 		VK_COLOR_COMPONENT_R_BIT
@@ -2082,23 +2814,18 @@ void VulkanRenderer::CreateSkyboxGraphicPipeline()
 		| VK_COLOR_COMPONENT_B_BIT
 		| VK_COLOR_COMPONENT_A_BIT;
 	colorBlendAttachment.blendEnable = VK_FALSE;
-	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{};
+	colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+	colorBlendStateCreateInfo.attachmentCount = 1;
 	colorBlendStateCreateInfo.pAttachments = &colorBlendAttachment;
-	colorBlendStateCreateInfo.blendConstants[0] = 0.f;
-	colorBlendStateCreateInfo.blendConstants[1] = 0.f;
-	colorBlendStateCreateInfo.blendConstants[2] = 0.f;
-	colorBlendStateCreateInfo.blendConstants[3] = 0.f;
 
 	/***********************************************************************/
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
 	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapSkyboxShaderModule.size());
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapPlanetImpostorShaderModule.size());
 	pipelineCreateInfo.pStages = shaderStageCreateInfos;
 	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
 	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
@@ -2108,266 +2835,311 @@ void VulkanRenderer::CreateSkyboxGraphicPipeline()
 	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
 	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
 	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-	pipelineCreateInfo.layout = m_SkyboxGraphicPipelineLayout;
+	pipelineCreateInfo.layout = m_GraphicPipelineLayout;
 	pipelineCreateInfo.renderPass = m_RenderPass;
 	pipelineCreateInfo.subpass = 0;
 	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineCreateInfo.basePipelineIndex = -1;
 
-	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_SkyboxGraphicPipeline), "Create skybox graphic pipeline failed");
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_PlanetImpostorPipeline), "Create planet impostor pipeline failed");
 }
 
-void VulkanRenderer::CalcMeshGridVertexData()
+void VulkanRenderer::CreatePlanetTerrainShaderModule()
 {
-	ASSERT(m_fMeshGridSplit >= 1);
-	m_vecMeshGridVertices.clear();
-	UINT uiMeshGridSplitPointCount = static_cast<UINT>(m_fMeshGridSplit) + 1;
-	m_vecMeshGridVertices.resize(uiMeshGridSplitPointCount * uiMeshGridSplitPointCount);
-	float fSplitLen = 1.f / m_fMeshGridSplit;
-	for (UINT i = 0; i < uiMeshGridSplitPointCount; ++i)
-	{
-		for (UINT j = 0; j < uiMeshGridSplitPointCount; ++j)
-		{
-			UINT uiIdx = i * uiMeshGridSplitPointCount + j;
-			float x = static_cast<float>(j) * fSplitLen - 0.5f;
-			float y = static_cast<float>(i) * fSplitLen - 0.5f;
-			m_vecMeshGridVertices[uiIdx].pos = {x, y, 0.f};
-		}
-	}
-}
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
 
-void VulkanRenderer::CalcMeshGridIndexData()
-{
-	UINT uiVertexCount = m_vecMeshGridVertices.size();
-	ASSERT(uiVertexCount >= 4);
-	m_vecMeshGridIndices.clear();
-	UINT uiMeshGridSplitLineCount = static_cast<UINT>(m_fMeshGridSplit);
-	UINT uiMeshGridSplitPointCount = static_cast<UINT>(m_fMeshGridSplit) + 1;
-	
-	//
-	for (UINT i = 0; i < uiMeshGridSplitPointCount; ++i)
-	{
-		for (UINT j = 0; j < uiMeshGridSplitLineCount; ++j)
-		{
-			UINT uiStart = i * uiMeshGridSplitPointCount + j;
-			m_vecMeshGridIndices.push_back(uiStart);
-			m_vecMeshGridIndices.push_back(uiStart + 1);
-		}
-	}
+	m_mapPlanetTerrainShaderModule.clear();
 
-	//
-	for (UINT i = 0; i < uiMeshGridSplitPointCount; ++i)
+	for (const auto& stage : vecShaderStage)
 	{
-		for (UINT j = 0; j < uiMeshGridSplitLineCount; ++j)
-		{
-			UINT uiStart = i + j * uiMeshGridSplitPointCount;
-			m_vecMeshGridIndices.push_back(uiStart);
-			m_vecMeshGridIndices.push_back(uiStart + uiMeshGridSplitPointCount);
-		}
+		bool bNoFeedback = (stage == VK_SHADER_STAGE_FRAGMENT_BIT) && !m_bVirtualTextureSupported;
+		m_mapPlanetTerrainShaderModule[stage] = CreateShaderModuleByName(bNoFeedback ? "PlanetTerrainNoFeedback" : "PlanetTerrain", stage);
 	}
 }
 
-void VulkanRenderer::RecreateMeshGridVertexBuffer()
+void VulkanRenderer::CreatePlanetTerrainPipelineLayout()
 {
-	vkDeviceWaitIdle(m_LogicalDevice);
+	//ģ;ͨpush constant룬ֻһʹõ
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PlanetTerrainPushConstant);
 
-	vkDestroyBuffer(m_LogicalDevice, m_MeshGridVertexBuffer, nullptr);
-	vkFreeMemory(m_LogicalDevice, m_MeshGridVertexBufferMemory, nullptr);
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_DescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
 
-	CreateMeshGridVertexBuffer();
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_PlanetTerrainPipelineLayout), "Create planet terrain pipeline layout failed");
 }
 
-void VulkanRenderer::RecreateMeshGridIndexBuffer()
+void VulkanRenderer::CreatePlanetTerrainPipeline()
 {
-	vkDeviceWaitIdle(m_LogicalDevice);
+	/****************************ɱ̹*******************************/
+	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
+	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	vertShaderStageCreateInfo.module = m_mapPlanetTerrainShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT);
+	vertShaderStageCreateInfo.pName = "main";
 
-	vkDestroyBuffer(m_LogicalDevice, m_MeshGridIndexBuffer, nullptr);
-	vkFreeMemory(m_LogicalDevice, m_MeshGridIndexBufferMemory, nullptr);
+	VkPipelineShaderStageCreateInfo fragShaderStageCreateInfo{};
+	fragShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	fragShaderStageCreateInfo.module = m_mapPlanetTerrainShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT);
+	fragShaderStageCreateInfo.pName = "main";
 
-	CreateMeshGridIndexBuffer();
-}
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
+		vertShaderStageCreateInfo,
+		fragShaderStageCreateInfo,
+	};
 
-void VulkanRenderer::CreateMeshGridVertexBuffer()
-{
-	CalcMeshGridVertexData();
+	/*****************************̶*******************************/
 
-	for (auto& vert : m_vecMeshGridVertices)
-		vert.pos *= (m_fMeshGridSize / 2.f);
+	//-----------------------Dynamic State--------------------------//
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
+	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	std::vector<VkDynamicState> vecDynamicStates = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+	};
+	dynamicStateCreateInfo.dynamicStateCount = static_cast<UINT>(vecDynamicStates.size());
+	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
 
-	ASSERT(m_vecMeshGridVertices.size() > 0, "Vertex data empty");
-	VkDeviceSize verticesSize = sizeof(m_vecMeshGridVertices[0]) * m_vecMeshGridVertices.size();
+	//-----------------------Vertex Input State--------------------------//
+	//binding 0ΪأslotʽͬvertexOffsetѡ
+	std::array<VkVertexInputBindingDescription, 1> aryBindingDescription = {
+		VkVertexInputBindingDescription{ 0, sizeof(TerrainVertex), VK_VERTEX_INPUT_RATE_VERTEX },
+	};
 
-	CreateBufferAndBindMemory(verticesSize,
-		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		m_MeshGridVertexBuffer, m_MeshGridVertexBufferMemory);
-	TransferBufferDataByStageBuffer(m_vecMeshGridVertices.data(), verticesSize, m_MeshGridVertexBuffer);
-}
+	std::vector<VkVertexInputAttributeDescription> vecAttributeDescription = {
+		{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(TerrainVertex, pos) },
+		{ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(TerrainVertex, normal) },
+	};
 
-void VulkanRenderer::CreateMeshGridIndexBuffer()
-{
-	CalcMeshGridIndexData();
+	VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
+	vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputCreateInfo.vertexBindingDescriptionCount = static_cast<UINT>(aryBindingDescription.size());
+	vertexInputCreateInfo.pVertexBindingDescriptions = aryBindingDescription.data();
+	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(vecAttributeDescription.size());
+	vertexInputCreateInfo.pVertexAttributeDescriptions = vecAttributeDescription.data();
 
-	VkDeviceSize indicesSize = sizeof(m_vecMeshGridIndices[0]) * m_vecMeshGridIndices.size();
-	if (indicesSize > 0)
-		CreateBufferAndBindMemory(indicesSize,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			m_MeshGridIndexBuffer, m_MeshGridIndexBufferMemory);
-	TransferBufferDataByStageBuffer(m_vecMeshGridIndices.data(), indicesSize, m_MeshGridIndexBuffer);
+	//-----------------------Input Assembly State------------------------//
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
+	inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+	//-----------------------Viewport State--------------------------//
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
+	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportStateCreateInfo.viewportCount = 1;
+	viewportStateCreateInfo.scissorCount = 1;
+
+	//-----------------------Raserization State--------------------------//
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{};
+	rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
+	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizationStateCreateInfo.lineWidth = 1.f;
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE; //ȹ涼ܳ
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
+
+	//-----------------------Multisample State--------------------------//
+	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
+	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisamplingStateCreateInfo.sampleShadingEnable = VK_FALSE;
+	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisamplingStateCreateInfo.minSampleShading = 1.f;
+	multisamplingStateCreateInfo.pSampleMask = nullptr;
+	multisamplingStateCreateInfo.alphaToCoverageEnable = VK_FALSE;
+	multisamplingStateCreateInfo.alphaToOneEnable = VK_FALSE;
+
+	//-----------------------Depth Stencil State--------------------------//
+	VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
+	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
+	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
+	depthStencilStateCreateInfo.minDepthBounds = 0.f;
+	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
+	depthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
+
+	//-----------------------Color Blend State--------------------------//
+	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+	colorBlendAttachment.colorWriteMask =
+		VK_COLOR_COMPONENT_R_BIT
+		| VK_COLOR_COMPONENT_G_BIT
+		| VK_COLOR_COMPONENT_B_BIT
+		| VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.blendEnable = VK_FALSE;
+
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{};
+	colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+	colorBlendStateCreateInfo.attachmentCount = 1;
+	colorBlendStateCreateInfo.pAttachments = &colorBlendAttachment;
+
+	/***********************************************************************/
+	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapPlanetTerrainShaderModule.size());
+	pipelineCreateInfo.pStages = shaderStageCreateInfos;
+	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
+	pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+	pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+	pipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
+	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
+	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
+	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
+	pipelineCreateInfo.layout = m_PlanetTerrainPipelineLayout;
+	pipelineCreateInfo.renderPass = m_RenderPass;
+	pipelineCreateInfo.subpass = 0;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
+
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_PlanetTerrainPipeline), "Create planet terrain pipeline failed");
 }
 
-void VulkanRenderer::CreateMeshGridShader()
+void VulkanRenderer::CreateSyncObjects()
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapMeshGridShaderPath = {
-		{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/MeshGrid/vert.spv" },
-		{ VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/MeshGrid/frag.spv" },
-	};
-	ASSERT(mapMeshGridShaderPath.size() > 0, "Detect no shader spv file");
+	m_vecImageAvailableSemaphores.resize(m_vecSwapChainImages.size());
+	m_vecRenderFinishedSemaphores.resize(m_vecSwapChainImages.size());
+	m_vecInFlightFences.resize(m_vecSwapChainImages.size());
 
-	m_mapMeshGridShaderModule.clear();
+	VkSemaphoreCreateInfo semaphoreCreateInfo{};
+	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	for (const auto& spvPath : mapMeshGridShaderPath)
-	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
+	VkFenceCreateInfo fenceCreateInfo{};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; //ֵΪsignaled
 
-		m_mapMeshGridShaderModule[spvPath.first] = shaderModule;
+	for (int i = 0; i < m_vecSwapChainImages.size(); ++i)
+	{
+		VULKAN_ASSERT(vkCreateSemaphore(m_LogicalDevice, &semaphoreCreateInfo, nullptr, &m_vecImageAvailableSemaphores[i]), "Create image available semaphore failed");
+		VULKAN_ASSERT(vkCreateSemaphore(m_LogicalDevice, &semaphoreCreateInfo, nullptr, &m_vecRenderFinishedSemaphores[i]), "Create render finished semaphore failed");
+		VULKAN_ASSERT(vkCreateFence(m_LogicalDevice, &fenceCreateInfo, nullptr, &m_vecInFlightFences[i]), "Create inflight fence failed");
 	}
 }
 
-void VulkanRenderer::CreateMeshGridUniformBuffers()
+void VulkanRenderer::CreateTimestampQueryPool()
 {
-	m_vecMeshGridUniformBuffers.resize(m_vecSwapChainImages.size());
-	m_vecMeshGridUniformBufferMemories.resize(m_vecSwapChainImages.size());
-
-	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	auto& deviceInfo = GetPhysicalDeviceInfo();
+	UINT uiTimestampValidBits = deviceInfo.vecQueueFamilies[deviceInfo.graphicFamilyIdx.value()].timestampValidBits;
+	if (uiTimestampValidBits == 0 || !deviceInfo.properties.limits.timestampComputeAndGraphics)
 	{
-		CreateBufferAndBindMemory(sizeof(MeshGridUniformBufferObject),
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			m_vecMeshGridUniformBuffers[i],
-			m_vecMeshGridUniformBufferMemories[i]
-		);
+		Log::Warn("Graphic queue does not support timestamp query");
+		return;
 	}
-}
+	m_fTimestampPeriod = deviceInfo.properties.limits.timestampPeriod;
 
-void VulkanRenderer::UpdateMeshGridUniformBuffer(UINT uiIdx)
-{
-	m_MeshGridUboData.model = glm::rotate(glm::mat4(1.f), glm::radians(90.f), { 1.f, 0.f, 0.f });
-	m_MeshGridUboData.view = m_Camera.GetViewMatrix();
-	m_MeshGridUboData.proj = m_Camera.GetProjMatrix();
+	//ÿ֡timestampCommon passĿʼͽ
+	VkQueryPoolCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = 2 * static_cast<UINT>(m_vecSwapChainImages.size());
 
-	void* uniformBufferData;
-	vkMapMemory(m_LogicalDevice, m_vecMeshGridUniformBufferMemories[uiIdx], 0, sizeof(MeshGridUniformBufferObject), 0, &uniformBufferData);
-	memcpy(uniformBufferData, &m_MeshGridUboData, sizeof(MeshGridUniformBufferObject));
-	vkUnmapMemory(m_LogicalDevice, m_vecMeshGridUniformBufferMemories[uiIdx]);
+	VULKAN_ASSERT(vkCreateQueryPool(m_LogicalDevice, &createInfo, nullptr, &m_TimestampQueryPool), "Create timestamp query pool failed");
+
+	m_vecTimestampWritten.assign(m_vecSwapChainImages.size(), false);
 }
 
-void VulkanRenderer::CreateMeshGridDescriptorSetLayout()
+void VulkanRenderer::ReadTimestampQueryResult(UINT uiIdx)
 {
-	//UniformBufferObject Binding
-	VkDescriptorSetLayoutBinding uboLayoutBinding{};
-	uboLayoutBinding.binding = 0; //ӦVertex Shaderеlayout binding
-	uboLayoutBinding.descriptorCount = 1;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
-	uboLayoutBinding.pImmutableSamplers = nullptr;
-
-	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
-		uboLayoutBinding,
-	};
+	//ǰ֡fenceѾsignaledһ
+	if (m_TimestampQueryPool == VK_NULL_HANDLE || !m_vecTimestampWritten[uiIdx])
+		return;
 
-	VkDescriptorSetLayoutCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
-	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+	std::array<UINT64, 2> aryTimestamp{};
+	VkResult res = vkGetQueryPoolResults(m_LogicalDevice, m_TimestampQueryPool, uiIdx * 2, 2,
+		sizeof(aryTimestamp), aryTimestamp.data(), sizeof(UINT64), VK_QUERY_RESULT_64_BIT);
+	if (res != VK_SUCCESS)
+		return;
 
-	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_MeshGridDescriptorSetLayout), "Create mesh grid descriptor layout failed");
+	m_fCommonPassGPUTime = static_cast<float>(aryTimestamp[1] - aryTimestamp[0]) * m_fTimestampPeriod / 1000000.f;
 }
 
-void VulkanRenderer::CreateMeshGridDescriptorPool()
+void VulkanRenderer::SetupCamera()
 {
-	//ubo
-	VkDescriptorPoolSize uboPoolSize{};
-	uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
-
-	std::vector<VkDescriptorPoolSize> vecPoolSize = {
-		uboPoolSize,
-	};
+	m_Camera.Init(45.f, 
+		static_cast<float>(m_SwapChainExtent2D.width), 
+		static_cast<float>(m_SwapChainExtent2D.height), 
+		0.1f, 10000.f,
+		m_pWindow, 
+		{ 0.0, 0.0, 10.0 }, 
+		{ 0.0, 0.0, 0.0 }, 
+		false);
+	m_Camera.SetReversedZ(m_bReversedZ);
 
-	VkDescriptorPoolCreateInfo poolCreateInfo{};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
-	poolCreateInfo.pPoolSizes = vecPoolSize.data();
-	poolCreateInfo.maxSets = static_cast<UINT>(m_vecSwapChainImages.size());
+	glfwSetWindowUserPointer(m_pWindow, (void*)&m_Camera);
 
-	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_MeshGridDescriptorPool), "Create mesh grid descriptor pool failed");
+	glfwSetScrollCallback(m_pWindow, [](GLFWwindow* window, double dOffsetX, double dOffsetY)
+		{
+			if (ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow))
+				return;
+			auto& camera = *(Camera*)glfwGetWindowUserPointer(window);
+			camera.OnMouseScroll(dOffsetX, dOffsetY);
+		}
+	);
+	glfwSetKeyCallback(m_pWindow, [](GLFWwindow* window, int nKey, int nScanmode, int nAction, int Mods)
+		{
+			if (ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow))
+				return;
+			auto& camera = *(Camera*)glfwGetWindowUserPointer(window);
+			camera.OnKeyPress(nKey);
+		}
+	);
 }
 
-void VulkanRenderer::CreateMeshGridDescriptorSets()
+void VulkanRenderer::CreateSkyboxShader()
 {
-	VkDescriptorSetAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	allocInfo.descriptorSetCount = static_cast<UINT>(m_vecSwapChainImages.size());
-	allocInfo.descriptorPool = m_MeshGridDescriptorPool;
-
-	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_MeshGridDescriptorSetLayout);
-	allocInfo.pSetLayouts = vecDupDescriptorSetLayout.data();
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
 
-	m_vecMeshGridDescriptorSets.resize(m_vecSwapChainImages.size());
-	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecMeshGridDescriptorSets.data()), "Allocate mesh grid desctiprot sets failed");
+	m_mapSkyboxShaderModule.clear();
 
-	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	for (const auto& stage : vecShaderStage)
 	{
-		//ubo
-		VkDescriptorBufferInfo descriptorBufferInfo{};
-		descriptorBufferInfo.buffer = m_vecMeshGridUniformBuffers[i];
-		descriptorBufferInfo.offset = 0;
-		descriptorBufferInfo.range = sizeof(MeshGridUniformBufferObject);
-
-		VkWriteDescriptorSet uboWrite{};
-		uboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		uboWrite.dstSet = m_vecMeshGridDescriptorSets[i];
-		uboWrite.dstBinding = 0;
-		uboWrite.dstArrayElement = 0;
-		uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uboWrite.descriptorCount = 1;
-		uboWrite.pBufferInfo = &descriptorBufferInfo;
-
-		std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
-			uboWrite,
-		};
-
-		vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
+		m_mapSkyboxShaderModule[stage] = CreateShaderModuleByName("Skybox", stage);
 	}
 }
 
-void VulkanRenderer::CreateMeshGridGraphicPipelineLayout()
+void VulkanRenderer::CreateSkyboxGraphicPipelineLayout()
 {
 	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
 	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutCreateInfo.setLayoutCount = 1;
-	pipelineLayoutCreateInfo.pSetLayouts = &m_MeshGridDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_SkyboxDescriptorSetLayout;
 	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
 	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
 
-	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_MeshGridGraphicPipelineLayout), "Create mesh grid pipeline layout failed");
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_SkyboxGraphicPipelineLayout), "Create skybox pipeline layout failed");
 }
 
-void VulkanRenderer::CreateMeshGridGraphicPipeline()
+void VulkanRenderer::CreateSkyboxGraphicPipeline()
 {
 	/****************************ɱ̹*******************************/
 	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
 	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageCreateInfo.module = m_mapMeshGridShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
+	vertShaderStageCreateInfo.module = m_mapSkyboxShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
 	vertShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
 
 	VkPipelineShaderStageCreateInfo fragShaderStageCreateInfo{};
 	fragShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageCreateInfo.module = m_mapMeshGridShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT); //Bytecode
+	fragShaderStageCreateInfo.module = m_mapSkyboxShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT); //Bytecode
 	fragShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
 
 	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
@@ -2383,7 +3155,6 @@ void VulkanRenderer::CreateMeshGridGraphicPipeline()
 	std::vector<VkDynamicState> vecDynamicStates = {
 		VK_DYNAMIC_STATE_VIEWPORT,
 		VK_DYNAMIC_STATE_SCISSOR,
-		VK_DYNAMIC_STATE_LINE_WIDTH,
 	};
 	dynamicStateCreateInfo.dynamicStateCount = static_cast<UINT>(vecDynamicStates.size());
 	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
@@ -2401,7 +3172,7 @@ void VulkanRenderer::CreateMeshGridGraphicPipeline()
 	//-----------------------Input Assembly State------------------------//
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
 	inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
 
@@ -2416,10 +3187,10 @@ void VulkanRenderer::CreateMeshGridGraphicPipeline()
 	rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
 	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;	//󣬳ԶƽĲֻᱻضԶƽϣǶ
 	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;	//󣬽ֹͼԪդ
-	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_LINE;	//ͼԪģʽFILLLINEPOINT
-	rasterizationStateCreateInfo.lineWidth = m_fMeshGridLineWidth;	//ָդ߶ο
-	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
-	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //򣬿˳ʱcwʱccw
+	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;	//ͼԪģʽFILLLINEPOINT
+	rasterizationStateCreateInfo.lineWidth = 1.f;	//ָդ߶ο
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_FRONT_BIT;	//޳Ŀɼ
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE; //򣬿˳ʱcwʱccw
 	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE; //ƫƣһShaodw MapбӰ
 	rasterizationStateCreateInfo.depthBiasConstantFactor = 0.f;
 	rasterizationStateCreateInfo.depthBiasClamp = 0.f;
@@ -2439,9 +3210,9 @@ void VulkanRenderer::CreateMeshGridGraphicPipeline()
 	//-----------------------Depth Stencil State--------------------------//
 	VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE; //ΪʼԶȼ
-	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthTestEnable = VK_FALSE; //ΪʼԶȼ
+	depthStencilStateCreateInfo.depthWriteEnable = VK_FALSE;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
@@ -2479,7 +3250,7 @@ void VulkanRenderer::CreateMeshGridGraphicPipeline()
 	/***********************************************************************/
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
 	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapMeshGridShaderModule.size());
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapSkyboxShaderModule.size());
 	pipelineCreateInfo.pStages = shaderStageCreateInfos;
 	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
 	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
@@ -2489,96 +3260,198 @@ void VulkanRenderer::CreateMeshGridGraphicPipeline()
 	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
 	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
 	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-	pipelineCreateInfo.layout = m_MeshGridGraphicPipelineLayout;
+	pipelineCreateInfo.layout = m_SkyboxGraphicPipelineLayout;
 	pipelineCreateInfo.renderPass = m_RenderPass;
 	pipelineCreateInfo.subpass = 0;
 	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineCreateInfo.basePipelineIndex = -1;
 
-	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_MeshGridGraphicPipeline), "Create mesh grid graphic pipeline failed");
-}
-
-void VulkanRenderer::CreateEllipseVertexBuffer()
-{
-	ASSERT(m_Ellipse.m_vecVertices.size() > 0, "Vertex data empty");
-	VkDeviceSize verticesSize = sizeof(m_Ellipse.m_vecVertices[0]) * m_Ellipse.m_vecVertices.size();
-
-	CreateBufferAndBindMemory(verticesSize,
-		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		m_EllipseVertexBuffer, m_EllipseVertexBufferMemory);
-	TransferBufferDataByStageBuffer(m_Ellipse.m_vecVertices.data(), verticesSize, m_EllipseVertexBuffer);
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_SkyboxGraphicPipeline), "Create skybox graphic pipeline failed");
 }
 
-void VulkanRenderer::CreateEllipseIndexBuffer()
+void VulkanRenderer::CalcMeshGridVertexData()
 {
-	VkDeviceSize indicesSize = sizeof(m_Ellipse.m_vecIndices[0]) * m_Ellipse.m_vecIndices.size();
-	if (indicesSize > 0)
-		CreateBufferAndBindMemory(indicesSize,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			m_EllipseIndexBuffer, m_EllipseIndexBufferMemory);
-	TransferBufferDataByStageBuffer(m_Ellipse.m_vecIndices.data(), indicesSize, m_EllipseIndexBuffer);
+	ASSERT(m_fMeshGridSplit >= 1);
+	m_vecMeshGridVertices.clear();
+	UINT uiMeshGridSplitPointCount = static_cast<UINT>(m_fMeshGridSplit) + 1;
+	m_vecMeshGridVertices.resize(uiMeshGridSplitPointCount * uiMeshGridSplitPointCount);
+	float fSplitLen = 1.f / m_fMeshGridSplit;
+	for (UINT i = 0; i < uiMeshGridSplitPointCount; ++i)
+	{
+		for (UINT j = 0; j < uiMeshGridSplitPointCount; ++j)
+		{
+			UINT uiIdx = i * uiMeshGridSplitPointCount + j;
+			float x = static_cast<float>(j) * fSplitLen - 0.5f;
+			float y = static_cast<float>(i) * fSplitLen - 0.5f;
+			m_vecMeshGridVertices[uiIdx].pos = {x, y, 0.f};
+		}
+	}
 }
 
-void VulkanRenderer::CreateEllipseUniformBuffers()
+void VulkanRenderer::CalcMeshGridIndexData()
 {
-	m_vecEllipseUniformBuffers.resize(m_vecSwapChainImages.size());
-	m_vecEllipseUniformBufferMemories.resize(m_vecSwapChainImages.size());
+	UINT uiVertexCount = m_vecMeshGridVertices.size();
+	ASSERT(uiVertexCount >= 4);
+	m_vecMeshGridIndices.clear();
+	UINT uiMeshGridSplitLineCount = static_cast<UINT>(m_fMeshGridSplit);
+	UINT uiMeshGridSplitPointCount = static_cast<UINT>(m_fMeshGridSplit) + 1;
+	
+	//
+	for (UINT i = 0; i < uiMeshGridSplitPointCount; ++i)
+	{
+		for (UINT j = 0; j < uiMeshGridSplitLineCount; ++j)
+		{
+			UINT uiStart = i * uiMeshGridSplitPointCount + j;
+			m_vecMeshGridIndices.push_back(uiStart);
+			m_vecMeshGridIndices.push_back(uiStart + 1);
+		}
+	}
 
-	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	//
+	for (UINT i = 0; i < uiMeshGridSplitPointCount; ++i)
 	{
-		CreateBufferAndBindMemory(sizeof(MeshGridUniformBufferObject),
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			m_vecEllipseUniformBuffers[i],
-			m_vecEllipseUniformBufferMemories[i]
-		);
+		for (UINT j = 0; j < uiMeshGridSplitLineCount; ++j)
+		{
+			UINT uiStart = i + j * uiMeshGridSplitPointCount;
+			m_vecMeshGridIndices.push_back(uiStart);
+			m_vecMeshGridIndices.push_back(uiStart + uiMeshGridSplitPointCount);
+		}
 	}
 }
 
-void VulkanRenderer::UpdateEllipseUniformBuffer(UINT uiIdx)
+void VulkanRenderer::RecreateMeshGridVertexBuffer()
 {
-	m_EllipseUboData.model = glm::rotate(glm::mat4(1.f), glm::radians(90.f), { 1.f, 0.f, 0.f }) * glm::scale(glm::mat4(1.f), {100.f, 100.f, 1.f});
-	m_EllipseUboData.view = m_Camera.GetViewMatrix();
-	m_EllipseUboData.proj = m_Camera.GetProjMatrix();
+	//bufferԱin-flight֡ʹãӳ
+	RetireBuffer(m_MeshGridVertexBuffer, m_MeshGridVertexBufferMemory);
+	m_MeshGridVertexBuffer = VK_NULL_HANDLE;
+	m_MeshGridVertexBufferMemory = VK_NULL_HANDLE;
 
-	void* uniformBufferData;
-	vkMapMemory(m_LogicalDevice, m_vecEllipseUniformBufferMemories[uiIdx], 0, sizeof(MeshGridUniformBufferObject), 0, &uniformBufferData);
-	memcpy(uniformBufferData, &m_EllipseUboData, sizeof(MeshGridUniformBufferObject));
-	vkUnmapMemory(m_LogicalDevice, m_vecEllipseUniformBufferMemories[uiIdx]);
+	CreateMeshGridVertexBuffer();
 }
 
-void VulkanRenderer::CreateEllipseDescriptorSetLayout()
+void VulkanRenderer::RecreateMeshGridIndexBuffer()
 {
-	//UniformBufferObject Binding
-	VkDescriptorSetLayoutBinding uboLayoutBinding{};
-	uboLayoutBinding.binding = 0; //ӦVertex Shaderеlayout binding
-	uboLayoutBinding.descriptorCount = 1;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
-	uboLayoutBinding.pImmutableSamplers = nullptr;
-
-	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
-		uboLayoutBinding,
-	};
-
-	VkDescriptorSetLayoutCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
-	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+	RetireBuffer(m_MeshGridIndexBuffer, m_MeshGridIndexBufferMemory);
+	m_MeshGridIndexBuffer = VK_NULL_HANDLE;
+	m_MeshGridIndexBufferMemory = VK_NULL_HANDLE;
 
-	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_EllipseDescriptorSetLayout), "Create ellipse descriptor layout failed");
+	CreateMeshGridIndexBuffer();
 }
 
-void VulkanRenderer::CreateEllipseDescriptorPool()
+void VulkanRenderer::CreateMeshGridVertexBuffer()
 {
-	//ubo
-	VkDescriptorPoolSize uboPoolSize{};
-	uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+	CalcMeshGridVertexData();
 
-	std::vector<VkDescriptorPoolSize> vecPoolSize = {
+	for (auto& vert : m_vecMeshGridVertices)
+		vert.pos *= (m_fMeshGridSize / 2.f);
+
+	ASSERT(m_vecMeshGridVertices.size() > 0, "Vertex data empty");
+	VkDeviceSize verticesSize = sizeof(m_vecMeshGridVertices[0]) * m_vecMeshGridVertices.size();
+
+	//¼command bufferʱؽֱдhost visibleڴ棬stagingvkQueueWaitIdle
+	CreateBufferAndBindMemory(verticesSize,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_MeshGridVertexBuffer, m_MeshGridVertexBufferMemory);
+
+	void* pMapped = nullptr;
+	VULKAN_ASSERT(vkMapMemory(m_LogicalDevice, m_MeshGridVertexBufferMemory, 0, verticesSize, 0, &pMapped), "Map mesh grid vertex buffer failed");
+	memcpy(pMapped, m_vecMeshGridVertices.data(), static_cast<size_t>(verticesSize));
+	vkUnmapMemory(m_LogicalDevice, m_MeshGridVertexBufferMemory);
+}
+
+void VulkanRenderer::CreateMeshGridIndexBuffer()
+{
+	CalcMeshGridIndexData();
+
+	VkDeviceSize indicesSize = sizeof(m_vecMeshGridIndices[0]) * m_vecMeshGridIndices.size();
+	if (indicesSize == 0)
+		return;
+
+	CreateBufferAndBindMemory(indicesSize,
+		VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_MeshGridIndexBuffer, m_MeshGridIndexBufferMemory);
+
+	void* pMapped = nullptr;
+	VULKAN_ASSERT(vkMapMemory(m_LogicalDevice, m_MeshGridIndexBufferMemory, 0, indicesSize, 0, &pMapped), "Map mesh grid index buffer failed");
+	memcpy(pMapped, m_vecMeshGridIndices.data(), static_cast<size_t>(indicesSize));
+	vkUnmapMemory(m_LogicalDevice, m_MeshGridIndexBufferMemory);
+}
+
+void VulkanRenderer::CreateMeshGridShader()
+{
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
+
+	m_mapMeshGridShaderModule.clear();
+
+	for (const auto& stage : vecShaderStage)
+	{
+		m_mapMeshGridShaderModule[stage] = CreateShaderModuleByName("MeshGrid", stage);
+	}
+}
+
+void VulkanRenderer::CreateMeshGridUniformBuffers()
+{
+	m_vecMeshGridUniformBuffers.resize(m_vecSwapChainImages.size());
+	m_vecMeshGridUniformBufferMemories.resize(m_vecSwapChainImages.size());
+
+	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	{
+		CreateBufferAndBindMemory(sizeof(MeshGridUniformBufferObject),
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			m_vecMeshGridUniformBuffers[i],
+			m_vecMeshGridUniformBufferMemories[i]
+		);
+	}
+}
+
+void VulkanRenderer::UpdateMeshGridUniformBuffer(UINT uiIdx)
+{
+	m_MeshGridUboData.model = glm::rotate(glm::mat4(1.f), glm::radians(90.f), { 1.f, 0.f, 0.f });
+	m_MeshGridUboData.view = m_Camera.GetViewMatrix();
+	m_MeshGridUboData.proj = m_Camera.GetProjMatrix();
+
+	void* uniformBufferData;
+	vkMapMemory(m_LogicalDevice, m_vecMeshGridUniformBufferMemories[uiIdx], 0, sizeof(MeshGridUniformBufferObject), 0, &uniformBufferData);
+	memcpy(uniformBufferData, &m_MeshGridUboData, sizeof(MeshGridUniformBufferObject));
+	vkUnmapMemory(m_LogicalDevice, m_vecMeshGridUniformBufferMemories[uiIdx]);
+}
+
+void VulkanRenderer::CreateMeshGridDescriptorSetLayout()
+{
+	//UniformBufferObject Binding
+	VkDescriptorSetLayoutBinding uboLayoutBinding{};
+	uboLayoutBinding.binding = 0; //ӦVertex Shaderеlayout binding
+	uboLayoutBinding.descriptorCount = 1;
+	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
+	uboLayoutBinding.pImmutableSamplers = nullptr;
+
+	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
+		uboLayoutBinding,
+	};
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
+	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_MeshGridDescriptorSetLayout), "Create mesh grid descriptor layout failed");
+}
+
+void VulkanRenderer::CreateMeshGridDescriptorPool()
+{
+	//ubo
+	VkDescriptorPoolSize uboPoolSize{};
+	uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+
+	std::vector<VkDescriptorPoolSize> vecPoolSize = {
 		uboPoolSize,
 	};
 
@@ -2588,33 +3461,33 @@ void VulkanRenderer::CreateEllipseDescriptorPool()
 	poolCreateInfo.pPoolSizes = vecPoolSize.data();
 	poolCreateInfo.maxSets = static_cast<UINT>(m_vecSwapChainImages.size());
 
-	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_EllipseDescriptorPool), "Create ellipse descriptor pool failed");
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_MeshGridDescriptorPool), "Create mesh grid descriptor pool failed");
 }
 
-void VulkanRenderer::CreateEllipseDescriptorSets()
+void VulkanRenderer::CreateMeshGridDescriptorSets()
 {
 	VkDescriptorSetAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	allocInfo.descriptorSetCount = static_cast<UINT>(m_vecSwapChainImages.size());
-	allocInfo.descriptorPool = m_EllipseDescriptorPool;
+	allocInfo.descriptorPool = m_MeshGridDescriptorPool;
 
-	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_EllipseDescriptorSetLayout);
+	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_MeshGridDescriptorSetLayout);
 	allocInfo.pSetLayouts = vecDupDescriptorSetLayout.data();
 
-	m_vecEllipseDescriptorSets.resize(m_vecSwapChainImages.size());
-	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecEllipseDescriptorSets.data()), "Allocate ellipse desctiprot sets failed");
+	m_vecMeshGridDescriptorSets.resize(m_vecSwapChainImages.size());
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecMeshGridDescriptorSets.data()), "Allocate mesh grid desctiprot sets failed");
 
 	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
 	{
 		//ubo
 		VkDescriptorBufferInfo descriptorBufferInfo{};
-		descriptorBufferInfo.buffer = m_vecEllipseUniformBuffers[i];
+		descriptorBufferInfo.buffer = m_vecMeshGridUniformBuffers[i];
 		descriptorBufferInfo.offset = 0;
 		descriptorBufferInfo.range = sizeof(MeshGridUniformBufferObject);
 
 		VkWriteDescriptorSet uboWrite{};
 		uboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		uboWrite.dstSet = m_vecEllipseDescriptorSets[i];
+		uboWrite.dstSet = m_vecMeshGridDescriptorSets[i];
 		uboWrite.dstBinding = 0;
 		uboWrite.dstArrayElement = 0;
 		uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -2629,19 +3502,19 @@ void VulkanRenderer::CreateEllipseDescriptorSets()
 	}
 }
 
-void VulkanRenderer::CreateEllipseGraphicPipelineLayout()
+void VulkanRenderer::CreateMeshGridGraphicPipelineLayout()
 {
 	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
 	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutCreateInfo.setLayoutCount = 1;
-	pipelineLayoutCreateInfo.pSetLayouts = &m_EllipseDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_MeshGridDescriptorSetLayout;
 	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
 	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
 
-	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_EllipseGraphicPipelineLayout), "Create ellipse pipeline layout failed");
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_MeshGridGraphicPipelineLayout), "Create mesh grid pipeline layout failed");
 }
 
-void VulkanRenderer::CreateEllipseGraphicPipeline()
+void VulkanRenderer::CreateMeshGridGraphicPipeline()
 {
 	/****************************ɱ̹*******************************/
 	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
@@ -2687,7 +3560,7 @@ void VulkanRenderer::CreateEllipseGraphicPipeline()
 	//-----------------------Input Assembly State------------------------//
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
 	inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
 	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
 
@@ -2727,7 +3600,7 @@ void VulkanRenderer::CreateEllipseGraphicPipeline()
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE; //ΪʼԶȼ
 	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
@@ -2775,51 +3648,67 @@ void VulkanRenderer::CreateEllipseGraphicPipeline()
 	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
 	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
 	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-	pipelineCreateInfo.layout = m_EllipseGraphicPipelineLayout;
+	pipelineCreateInfo.layout = m_MeshGridGraphicPipelineLayout;
 	pipelineCreateInfo.renderPass = m_RenderPass;
 	pipelineCreateInfo.subpass = 0;
 	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineCreateInfo.basePipelineIndex = -1;
 
-	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_EllipseGraphicPipeline), "Create ellipse graphic pipeline failed");
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_MeshGridGraphicPipeline), "Create mesh grid graphic pipeline failed");
 }
 
-void VulkanRenderer::CreateSkyboxUniformBuffers()
+void VulkanRenderer::CreateEllipseVertexBuffer()
 {
-	m_vecSkyboxUniformBuffers.resize(m_vecSwapChainImages.size());
-	m_vecSkyboxUniformBufferMemories.resize(m_vecSwapChainImages.size());
+	ASSERT(m_Ellipse.m_vecVertices.size() > 0, "Vertex data empty");
+	VkDeviceSize verticesSize = sizeof(m_Ellipse.m_vecVertices[0]) * m_Ellipse.m_vecVertices.size();
+
+	CreateBufferAndBindMemory(verticesSize,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_EllipseVertexBuffer, m_EllipseVertexBufferMemory);
+	TransferBufferDataByStageBuffer(m_Ellipse.m_vecVertices.data(), verticesSize, m_EllipseVertexBuffer);
+}
+
+void VulkanRenderer::CreateEllipseIndexBuffer()
+{
+	VkDeviceSize indicesSize = sizeof(m_Ellipse.m_vecIndices[0]) * m_Ellipse.m_vecIndices.size();
+	if (indicesSize > 0)
+		CreateBufferAndBindMemory(indicesSize,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_EllipseIndexBuffer, m_EllipseIndexBufferMemory);
+	TransferBufferDataByStageBuffer(m_Ellipse.m_vecIndices.data(), indicesSize, m_EllipseIndexBuffer);
+}
+
+void VulkanRenderer::CreateEllipseUniformBuffers()
+{
+	m_vecEllipseUniformBuffers.resize(m_vecSwapChainImages.size());
+	m_vecEllipseUniformBufferMemories.resize(m_vecSwapChainImages.size());
 
 	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
 	{
-		CreateBufferAndBindMemory(sizeof(SkyboxUniformBufferObject),
+		CreateBufferAndBindMemory(sizeof(MeshGridUniformBufferObject),
 			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			m_vecSkyboxUniformBuffers[i],
-			m_vecSkyboxUniformBufferMemories[i]
+			m_vecEllipseUniformBuffers[i],
+			m_vecEllipseUniformBufferMemories[i]
 		);
 	}
 }
 
-void VulkanRenderer::UpdateSkyboxUniformBuffer(UINT uiIdx)
+void VulkanRenderer::UpdateEllipseUniformBuffer(UINT uiIdx)
 {
-	static auto startTime = std::chrono::high_resolution_clock::now();
-	auto currentTime = std::chrono::high_resolution_clock::now();
-
-	float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
-
-	auto rotateComponent = glm::rotate(glm::mat4(1.f), glm::radians(m_fSkyboxRotateSpeed * time), { 0.f, 1.f, 0.f });
-
-	m_SkyboxUboData.modelView = m_Camera.GetViewMatrix() * rotateComponent;
-	m_SkyboxUboData.modelView[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); //ƳƽƷ
-	m_SkyboxUboData.proj = m_Camera.GetProjMatrix();
+	m_EllipseUboData.model = glm::rotate(glm::mat4(1.f), glm::radians(90.f), { 1.f, 0.f, 0.f }) * glm::scale(glm::mat4(1.f), {100.f, 100.f, 1.f});
+	m_EllipseUboData.view = m_Camera.GetViewMatrix();
+	m_EllipseUboData.proj = m_Camera.GetProjMatrix();
 
 	void* uniformBufferData;
-	vkMapMemory(m_LogicalDevice, m_vecSkyboxUniformBufferMemories[uiIdx], 0, sizeof(SkyboxUniformBufferObject), 0, &uniformBufferData);
-	memcpy(uniformBufferData, &m_SkyboxUboData, sizeof(SkyboxUniformBufferObject));
-	vkUnmapMemory(m_LogicalDevice, m_vecSkyboxUniformBufferMemories[uiIdx]);
+	vkMapMemory(m_LogicalDevice, m_vecEllipseUniformBufferMemories[uiIdx], 0, sizeof(MeshGridUniformBufferObject), 0, &uniformBufferData);
+	memcpy(uniformBufferData, &m_EllipseUboData, sizeof(MeshGridUniformBufferObject));
+	vkUnmapMemory(m_LogicalDevice, m_vecEllipseUniformBufferMemories[uiIdx]);
 }
 
-void VulkanRenderer::CreateSkyboxDescriptorSetLayout()
+void VulkanRenderer::CreateEllipseDescriptorSetLayout()
 {
 	//UniformBufferObject Binding
 	VkDescriptorSetLayoutBinding uboLayoutBinding{};
@@ -2829,17 +3718,8 @@ void VulkanRenderer::CreateSkyboxDescriptorSetLayout()
 	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
 	uboLayoutBinding.pImmutableSamplers = nullptr;
 
-	//Cubemap ImageSampler Binding
-	VkDescriptorSetLayoutBinding CubemapSamplerLayoutBinding{};
-	CubemapSamplerLayoutBinding.binding = 1; ////ӦFragment Shaderеlayout binding
-	CubemapSamplerLayoutBinding.descriptorCount = 1;
-	CubemapSamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	CubemapSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; //ֻfragment stage
-	CubemapSamplerLayoutBinding.pImmutableSamplers = nullptr;
-
 	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
 		uboLayoutBinding,
-		CubemapSamplerLayoutBinding,
 	};
 
 	VkDescriptorSetLayoutCreateInfo createInfo{};
@@ -2847,24 +3727,18 @@ void VulkanRenderer::CreateSkyboxDescriptorSetLayout()
 	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
 	createInfo.pBindings = vecDescriptorLayoutBinding.data();
 
-	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_SkyboxDescriptorSetLayout), "Create skybox descriptor layout failed");
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_EllipseDescriptorSetLayout), "Create ellipse descriptor layout failed");
 }
 
-void VulkanRenderer::CreateSkyboxDescriptorPool()
+void VulkanRenderer::CreateEllipseDescriptorPool()
 {
 	//ubo
 	VkDescriptorPoolSize uboPoolSize{};
 	uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	uboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
 
-	//cubemap sampler
-	VkDescriptorPoolSize cubemapSamplerPoolSize{};
-	cubemapSamplerPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	cubemapSamplerPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
-
 	std::vector<VkDescriptorPoolSize> vecPoolSize = {
 		uboPoolSize,
-		cubemapSamplerPoolSize,
 	};
 
 	VkDescriptorPoolCreateInfo poolCreateInfo{};
@@ -2873,725 +3747,1944 @@ void VulkanRenderer::CreateSkyboxDescriptorPool()
 	poolCreateInfo.pPoolSizes = vecPoolSize.data();
 	poolCreateInfo.maxSets = static_cast<UINT>(m_vecSwapChainImages.size());
 
-	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_SkyboxDescriptorPool), "Create skybox descriptor pool failed");
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_EllipseDescriptorPool), "Create ellipse descriptor pool failed");
 }
 
-void VulkanRenderer::CreateSkyboxDescriptorSets()
+void VulkanRenderer::CreateEllipseDescriptorSets()
 {
 	VkDescriptorSetAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	allocInfo.descriptorSetCount = static_cast<UINT>(m_vecSwapChainImages.size());
-	allocInfo.descriptorPool = m_SkyboxDescriptorPool;
+	allocInfo.descriptorPool = m_EllipseDescriptorPool;
 
-	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_SkyboxDescriptorSetLayout);
+	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_EllipseDescriptorSetLayout);
 	allocInfo.pSetLayouts = vecDupDescriptorSetLayout.data();
 
-	m_vecSkyboxDescriptorSets.resize(m_vecSwapChainImages.size());
-	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecSkyboxDescriptorSets.data()), "Allocate skybox desctiprot sets failed");
+	m_vecEllipseDescriptorSets.resize(m_vecSwapChainImages.size());
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecEllipseDescriptorSets.data()), "Allocate ellipse desctiprot sets failed");
 
 	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
 	{
 		//ubo
 		VkDescriptorBufferInfo descriptorBufferInfo{};
-		descriptorBufferInfo.buffer = m_vecSkyboxUniformBuffers[i];
+		descriptorBufferInfo.buffer = m_vecEllipseUniformBuffers[i];
 		descriptorBufferInfo.offset = 0;
-		descriptorBufferInfo.range = sizeof(SkyboxUniformBufferObject);
+		descriptorBufferInfo.range = sizeof(MeshGridUniformBufferObject);
 
 		VkWriteDescriptorSet uboWrite{};
 		uboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		uboWrite.dstSet = m_vecSkyboxDescriptorSets[i];
+		uboWrite.dstSet = m_vecEllipseDescriptorSets[i];
 		uboWrite.dstBinding = 0;
 		uboWrite.dstArrayElement = 0;
 		uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		uboWrite.descriptorCount = 1;
 		uboWrite.pBufferInfo = &descriptorBufferInfo;
 
-		//cubemap sampler
-		VkDescriptorImageInfo imageInfo{};
-		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imageInfo.imageView = m_SkyboxTexture->m_ImageView;
-		imageInfo.sampler = m_SkyboxTexture->m_Sampler;
-
-		VkWriteDescriptorSet cubemapSamplerWrite{};
-		cubemapSamplerWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		cubemapSamplerWrite.dstSet = m_vecSkyboxDescriptorSets[i];
-		cubemapSamplerWrite.dstBinding = 1;
-		cubemapSamplerWrite.dstArrayElement = 0;
-		cubemapSamplerWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		cubemapSamplerWrite.descriptorCount = 1;
-		cubemapSamplerWrite.pImageInfo = &imageInfo;
-
 		std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
 			uboWrite,
-			cubemapSamplerWrite,
 		};
 
 		vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
 	}
 }
 
-void VulkanRenderer::RecordCommandBuffer(VkCommandBuffer& commandBuffer, UINT uiIdx)
+void VulkanRenderer::CreateEllipseGraphicPipelineLayout()
 {
-	UpdatePointLight();
-
-	//Record֮ǰUBO
-
-	//UpdateUniformBuffer(m_uiCurFrameIdx);
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_EllipseDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
 
-	UpdateShadowMapUniformBuffer();
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_EllipseGraphicPipelineLayout), "Create ellipse pipeline layout failed");
+}
 
-	UpdateCommonMVPUniformBuffer(m_uiCurFrameIdx);
+void VulkanRenderer::CreateEllipseGraphicPipeline()
+{
+	/****************************ɱ̹*******************************/
+	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
+	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	vertShaderStageCreateInfo.module = m_mapMeshGridShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
+	vertShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
 
-	if (m_bEnableSkybox)
+	VkPipelineShaderStageCreateInfo fragShaderStageCreateInfo{};
+	fragShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	fragShaderStageCreateInfo.module = m_mapMeshGridShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT); //Bytecode
+	fragShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
+
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
+		vertShaderStageCreateInfo,
+		fragShaderStageCreateInfo,
+	};
+
+	/*****************************̶*******************************/
+
+	//-----------------------Dynamic State--------------------------//
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
+	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	std::vector<VkDynamicState> vecDynamicStates = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+		VK_DYNAMIC_STATE_LINE_WIDTH,
+	};
+	dynamicStateCreateInfo.dynamicStateCount = static_cast<UINT>(vecDynamicStates.size());
+	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
+
+	//-----------------------Vertex Input State--------------------------//
+	auto bindingDescription = Vertex3D::GetBindingDescription();
+	auto attributeDescriptions = Vertex3D::GetAttributeDescriptions();
+	VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
+	vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
+	vertexInputCreateInfo.pVertexBindingDescriptions = &bindingDescription;
+	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(attributeDescriptions.size());
+	vertexInputCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+	//-----------------------Input Assembly State------------------------//
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
+	inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+
+	//-----------------------Viewport State--------------------------//
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
+	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportStateCreateInfo.viewportCount = 1;
+	viewportStateCreateInfo.scissorCount = 1;
+
+	//-----------------------Raserization State--------------------------//
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{};
+	rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;	//󣬳ԶƽĲֻᱻضԶƽϣǶ
+	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;	//󣬽ֹͼԪդ
+	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_LINE;	//ͼԪģʽFILLLINEPOINT
+	rasterizationStateCreateInfo.lineWidth = m_fMeshGridLineWidth;	//ָդ߶ο
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //򣬿˳ʱcwʱccw
+	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE; //ƫƣһShaodw MapбӰ
+	rasterizationStateCreateInfo.depthBiasConstantFactor = 0.f;
+	rasterizationStateCreateInfo.depthBiasClamp = 0.f;
+	rasterizationStateCreateInfo.depthBiasSlopeFactor = 0.f;
+
+	//-----------------------Multisample State--------------------------//
+	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
+	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisamplingStateCreateInfo.sampleShadingEnable = VK_FALSE;
+	multisamplingStateCreateInfo.minSampleShading = 0.8f;
+	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisamplingStateCreateInfo.minSampleShading = 1.f;
+	multisamplingStateCreateInfo.pSampleMask = nullptr;
+	multisamplingStateCreateInfo.alphaToCoverageEnable = VK_FALSE;
+	multisamplingStateCreateInfo.alphaToOneEnable = VK_FALSE;
+
+	//-----------------------Depth Stencil State--------------------------//
+	VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
+	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE; //ΪʼԶȼ
+	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
+	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
+	depthStencilStateCreateInfo.minDepthBounds = 0.f;
+	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
+	depthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
+	depthStencilStateCreateInfo.front = {};
+	depthStencilStateCreateInfo.back = {};
+
+	//-----------------------Color Blend State--------------------------//
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{};
+	colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+	colorBlendStateCreateInfo.attachmentCount = 1;
+
+	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+	colorBlendAttachment.colorWriteMask =
+		VK_COLOR_COMPONENT_R_BIT
+		| VK_COLOR_COMPONENT_G_BIT
+		| VK_COLOR_COMPONENT_B_BIT
+		| VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.blendEnable = VK_FALSE;
+	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+	colorBlendStateCreateInfo.pAttachments = &colorBlendAttachment;
+	colorBlendStateCreateInfo.blendConstants[0] = 0.f;
+	colorBlendStateCreateInfo.blendConstants[1] = 0.f;
+	colorBlendStateCreateInfo.blendConstants[2] = 0.f;
+	colorBlendStateCreateInfo.blendConstants[3] = 0.f;
+
+	/***********************************************************************/
+	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapMeshGridShaderModule.size());
+	pipelineCreateInfo.pStages = shaderStageCreateInfos;
+	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
+	pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+	pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+	pipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
+	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
+	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
+	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
+	pipelineCreateInfo.layout = m_EllipseGraphicPipelineLayout;
+	pipelineCreateInfo.renderPass = m_RenderPass;
+	pipelineCreateInfo.subpass = 0;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
+
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_EllipseGraphicPipeline), "Create ellipse graphic pipeline failed");
+}
+
+void VulkanRenderer::CreateSkyboxUniformBuffers()
+{
+	m_vecSkyboxUniformBuffers.resize(m_vecSwapChainImages.size());
+	m_vecSkyboxUniformBufferMemories.resize(m_vecSwapChainImages.size());
+
+	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	{
+		CreateBufferAndBindMemory(sizeof(SkyboxUniformBufferObject),
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			m_vecSkyboxUniformBuffers[i],
+			m_vecSkyboxUniformBufferMemories[i]
+		);
+	}
+}
+
+void VulkanRenderer::UpdateSkyboxUniformBuffer(UINT uiIdx)
+{
+	static auto startTime = std::chrono::high_resolution_clock::now();
+	auto currentTime = std::chrono::high_resolution_clock::now();
+
+	float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+
+	auto rotateComponent = glm::rotate(glm::mat4(1.f), glm::radians(m_fSkyboxRotateSpeed * time), { 0.f, 1.f, 0.f });
+
+	m_SkyboxUboData.modelView = m_Camera.GetViewMatrix() * rotateComponent;
+	m_SkyboxUboData.modelView[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); //ƳƽƷ
+	m_SkyboxUboData.proj = m_Camera.GetProjMatrix();
+
+	void* uniformBufferData;
+	vkMapMemory(m_LogicalDevice, m_vecSkyboxUniformBufferMemories[uiIdx], 0, sizeof(SkyboxUniformBufferObject), 0, &uniformBufferData);
+	memcpy(uniformBufferData, &m_SkyboxUboData, sizeof(SkyboxUniformBufferObject));
+	vkUnmapMemory(m_LogicalDevice, m_vecSkyboxUniformBufferMemories[uiIdx]);
+}
+
+void VulkanRenderer::CreateSkyboxDescriptorSetLayout()
+{
+	//UniformBufferObject Binding
+	VkDescriptorSetLayoutBinding uboLayoutBinding{};
+	uboLayoutBinding.binding = 0; //ӦVertex Shaderеlayout binding
+	uboLayoutBinding.descriptorCount = 1;
+	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
+	uboLayoutBinding.pImmutableSamplers = nullptr;
+
+	//Cubemap ImageSampler Binding
+	VkDescriptorSetLayoutBinding CubemapSamplerLayoutBinding{};
+	CubemapSamplerLayoutBinding.binding = 1; ////ӦFragment Shaderеlayout binding
+	CubemapSamplerLayoutBinding.descriptorCount = 1;
+	CubemapSamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	CubemapSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; //ֻfragment stage
+	CubemapSamplerLayoutBinding.pImmutableSamplers = nullptr;
+
+	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
+		uboLayoutBinding,
+		CubemapSamplerLayoutBinding,
+	};
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
+	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_SkyboxDescriptorSetLayout), "Create skybox descriptor layout failed");
+}
+
+void VulkanRenderer::CreateSkyboxDescriptorPool()
+{
+	//ubo
+	VkDescriptorPoolSize uboPoolSize{};
+	uboPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+
+	//cubemap sampler
+	VkDescriptorPoolSize cubemapSamplerPoolSize{};
+	cubemapSamplerPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	cubemapSamplerPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+
+	std::vector<VkDescriptorPoolSize> vecPoolSize = {
+		uboPoolSize,
+		cubemapSamplerPoolSize,
+	};
+
+	VkDescriptorPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
+	poolCreateInfo.pPoolSizes = vecPoolSize.data();
+	poolCreateInfo.maxSets = static_cast<UINT>(m_vecSwapChainImages.size());
+
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_SkyboxDescriptorPool), "Create skybox descriptor pool failed");
+}
+
+void VulkanRenderer::CreateSkyboxDescriptorSets()
+{
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = static_cast<UINT>(m_vecSwapChainImages.size());
+	allocInfo.descriptorPool = m_SkyboxDescriptorPool;
+
+	std::vector<VkDescriptorSetLayout> vecDupDescriptorSetLayout(m_vecSwapChainImages.size(), m_SkyboxDescriptorSetLayout);
+	allocInfo.pSetLayouts = vecDupDescriptorSetLayout.data();
+
+	m_vecSkyboxDescriptorSets.resize(m_vecSwapChainImages.size());
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, m_vecSkyboxDescriptorSets.data()), "Allocate skybox desctiprot sets failed");
+
+	for (size_t i = 0; i < m_vecSwapChainImages.size(); ++i)
+	{
+		//ubo
+		VkDescriptorBufferInfo descriptorBufferInfo{};
+		descriptorBufferInfo.buffer = m_vecSkyboxUniformBuffers[i];
+		descriptorBufferInfo.offset = 0;
+		descriptorBufferInfo.range = sizeof(SkyboxUniformBufferObject);
+
+		VkWriteDescriptorSet uboWrite{};
+		uboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		uboWrite.dstSet = m_vecSkyboxDescriptorSets[i];
+		uboWrite.dstBinding = 0;
+		uboWrite.dstArrayElement = 0;
+		uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		uboWrite.descriptorCount = 1;
+		uboWrite.pBufferInfo = &descriptorBufferInfo;
+
+		//cubemap sampler
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = m_SkyboxTexture->m_ImageView;
+		imageInfo.sampler = m_SkyboxTexture->m_Sampler;
+
+		VkWriteDescriptorSet cubemapSamplerWrite{};
+		cubemapSamplerWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		cubemapSamplerWrite.dstSet = m_vecSkyboxDescriptorSets[i];
+		cubemapSamplerWrite.dstBinding = 1;
+		cubemapSamplerWrite.dstArrayElement = 0;
+		cubemapSamplerWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		cubemapSamplerWrite.descriptorCount = 1;
+		cubemapSamplerWrite.pImageInfo = &imageInfo;
+
+		std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
+			uboWrite,
+			cubemapSamplerWrite,
+		};
+
+		vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
+	}
+
+	m_vecSkyboxTextureVersion.assign(m_vecSwapChainImages.size(), m_SkyboxTexture->m_uiVersion);
+}
+
+void VulkanRenderer::RecordCommandBuffer(VkCommandBuffer& commandBuffer, UINT uiIdx)
+{
+	UpdatePointLight();
+
+	//Record֮ǰUBO
+
+	if (m_bEnablePlanet)
+		UpdateUniformBuffer(m_uiCurFrameIdx);
+
+	UpdateVirtualTexture(uiIdx);
+
+	if (m_nShadowLightType == SHADOW_LIGHT_POINT)
+		UpdateOmniShadowUniformBuffer();
+	else
+		UpdateShadowMapUniformBuffer();
+
+	UpdateCommonMVPUniformBuffer(m_uiCurFrameIdx);
+
+	if (m_bEnableSkybox)
 		UpdateSkyboxUniformBuffer(m_uiCurFrameIdx);
 
-	//if (m_bEnableMeshGrid)
-	//	UpdateMeshGridUniformBuffer(m_uiCurFrameIdx);
+	//if (m_bEnableMeshGrid)
+	//	UpdateMeshGridUniformBuffer(m_uiCurFrameIdx);
+
+	//if (m_bEnableEllipse)
+	//	UpdateEllipseUniformBuffer(m_uiCurFrameIdx);
+
+	//if (m_bEnableBlinnPhong)
+	//{
+	//	UpdateBlinnPhongMVPUniformBuffer(m_uiCurFrameIdx);
+	//	UpdateBlinnPhongLightUniformBuffer(m_uiCurFrameIdx);
+	//	UpdateBlinnPhongMaterialUniformBuffer(m_uiCurFrameIdx);
+	//}
+
+	//if (m_bEnablePBR)
+	//{
+	//	UpdatePBRMVPUniformBuffer(m_uiCurFrameIdx);
+	//	UpdatePBRLightUniformBuffer(m_uiCurFrameIdx);
+	//	UpdatePBRMaterialUniformBuffer(m_uiCurFrameIdx);
+	//}
+
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo{};
+	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	commandBufferBeginInfo.flags = 0;
+	commandBufferBeginInfo.pInheritanceInfo = nullptr;
+
+	VULKAN_ASSERT(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo), "Begin command buffer failed");
+
+	if (m_TimestampQueryPool != VK_NULL_HANDLE)
+		vkCmdResetQueryPool(commandBuffer, m_TimestampQueryPool, uiIdx * 2, 2);
+
+	RecordAsteroidBeltCompute(commandBuffer);
+	RecordVirtualTextureUpload(commandBuffer, uiIdx);
+
+	//̨ɵڵһrender pass֮ǰϴ֡descriptor set漴лʵ
+	m_TextureStreamer.RecordUploads(commandBuffer, uiIdx);
+	UpdateStreamedTextureDescriptorSets(uiIdx);
+
+	//First renderpass
+	m_bShadowMapRenderedLastFrame = IsShadowMapDirty();
+	if (m_bShadowMapRenderedLastFrame)
+	{
+		m_uiShadowMapRenderedLightVersion = m_uiShadowLightVersion;
+		m_uiShadowMapRenderedCasterVersion = m_uiShadowCasterVersion;
+		m_nShadowMapRenderedLightType = m_nShadowLightType;
+	}
+
+	if (m_bShadowMapRenderedLastFrame && m_nShadowLightType == SHADOW_LIGHT_POINT)
+	{
+		//һrender passдcube6棬geometry shaderface maskηӦlayer
+		VkRenderPassBeginInfo omniShadowRenderPassBeginInfo{};
+		omniShadowRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		omniShadowRenderPassBeginInfo.renderPass = m_OmniShadowRenderPass;
+		omniShadowRenderPassBeginInfo.framebuffer = m_OmniShadowFrameBuffer;
+		omniShadowRenderPassBeginInfo.renderArea.offset = { 0, 0 };
+		omniShadowRenderPassBeginInfo.renderArea.extent = m_OmniShadowExtent2D;
+		VkClearValue omniShadowClearValue;
+		omniShadowClearValue.depthStencil = { 1.f, 0 };
+		omniShadowRenderPassBeginInfo.clearValueCount = 1;
+		omniShadowRenderPassBeginInfo.pClearValues = &omniShadowClearValue;
+		vkCmdBeginRenderPass(commandBuffer, &omniShadowRenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		VkViewport omniShadowViewport{};
+		omniShadowViewport.x = 0.f;
+		omniShadowViewport.y = 0.f;
+		omniShadowViewport.width = static_cast<float>(m_OmniShadowExtent2D.width);
+		omniShadowViewport.height = static_cast<float>(m_OmniShadowExtent2D.height);
+		omniShadowViewport.minDepth = 0.f;
+		omniShadowViewport.maxDepth = 1.f;
+		vkCmdSetViewport(commandBuffer, 0, 1, &omniShadowViewport);
+
+		VkRect2D omniShadowScissor{};
+		omniShadowScissor.offset = { 0, 0 };
+		omniShadowScissor.extent = m_OmniShadowExtent2D;
+		vkCmdSetScissor(commandBuffer, 0, 1, &omniShadowScissor);
+
+		if (m_testObjModel->m_vecSubMeshes.empty())
+		{
+			UINT uiFaceMask = 0x3F;
+			vkCmdPushConstants(commandBuffer, m_OmniShadowPipelineLayout, VK_SHADER_STAGE_GEOMETRY_BIT, 0, sizeof(UINT), &uiFaceMask);
+			m_testObjModel->Draw(commandBuffer, m_OmniShadowPipeline, m_OmniShadowPipelineLayout, &m_OmniShadowDescriptorSet);
+		}
+		else
+		{
+			std::vector<UINT> vecCasters;
+			for (UINT i = 0; i < static_cast<UINT>(m_vecOmniShadowFaceMask.size()); ++i)
+			{
+				if (m_vecOmniShadowFaceMask[i] != 0)
+					vecCasters.push_back(i);
+			}
+
+			m_testObjModel->DrawSubMeshes(commandBuffer, m_OmniShadowPipeline, m_OmniShadowPipelineLayout, &m_OmniShadowDescriptorSet, vecCasters,
+				[&](UINT uiSubMeshIdx)
+				{
+					vkCmdPushConstants(commandBuffer, m_OmniShadowPipelineLayout, VK_SHADER_STAGE_GEOMETRY_BIT, 0, sizeof(UINT), &m_vecOmniShadowFaceMask[uiSubMeshIdx]);
+				});
+		}
+
+		vkCmdEndRenderPass(commandBuffer);
+	}
+	else if (m_bShadowMapRenderedLastFrame)
+	{
+		//ÿcascadeȾdepth arrayһ
+		//δõĲҲִһclear֤array viewREAD_ONLY
+		for (UINT uiCascadeIdx = 0; uiCascadeIdx < SHADOW_CASCADE_MAX; ++uiCascadeIdx)
+		{
+			VkRenderPassBeginInfo shadowMapRenderPassBeginInfo{};
+			shadowMapRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			shadowMapRenderPassBeginInfo.renderPass = m_ShadowMapRenderPass;
+			shadowMapRenderPassBeginInfo.framebuffer = m_aryShadowMapFrameBuffer[uiCascadeIdx];
+			shadowMapRenderPassBeginInfo.renderArea.offset = { 0, 0 };
+			shadowMapRenderPassBeginInfo.renderArea.extent = m_ShadowMapExtent2D;
+			std::array<VkClearValue, 2> shadowMapAryClearColor;
+			shadowMapAryClearColor[0].color = { 1.f, 1.f, 1.f, 1.f };
+			shadowMapAryClearColor[1].depthStencil = { 1.f, 0 };
+			shadowMapRenderPassBeginInfo.clearValueCount = static_cast<UINT>(shadowMapAryClearColor.size());
+			shadowMapRenderPassBeginInfo.pClearValues = shadowMapAryClearColor.data();
+			vkCmdBeginRenderPass(commandBuffer, &shadowMapRenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			if (uiCascadeIdx < static_cast<UINT>(m_nShadowCascadeCount))
+			{
+				VkViewport shadowMapViewport{};
+				shadowMapViewport.x = 0.f;
+				shadowMapViewport.y = 0.f;
+				shadowMapViewport.width = static_cast<float>(m_ShadowMapExtent2D.width);
+				shadowMapViewport.height = static_cast<float>(m_ShadowMapExtent2D.height);
+				shadowMapViewport.minDepth = 0.f;
+				shadowMapViewport.maxDepth = 1.f;
+				vkCmdSetViewport(commandBuffer, 0, 1, &shadowMapViewport);
+
+				VkRect2D shadowMapScissor{};
+				shadowMapScissor.offset = { 0, 0 };
+				shadowMapScissor.extent = m_ShadowMapExtent2D;
+				vkCmdSetScissor(commandBuffer, 0, 1, &shadowMapScissor);
+
+				float depthBiasConstant = 1.25f;
+				float depthBiasSlope = 1.75f;
+				vkCmdSetDepthBias(commandBuffer, depthBiasConstant, 0.0f, depthBiasSlope);
+
+				vkCmdPushConstants(commandBuffer, m_ShadowMapPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UINT), &uiCascadeIdx);
+
+				if (m_testObjModel->m_vecSubMeshes.empty())
+					m_testObjModel->Draw(commandBuffer, m_ShadowMapPipeline, m_ShadowMapPipelineLayout, &m_ShadowMapDescriptorSet);
+				else
+					m_testObjModel->DrawSubMeshes(commandBuffer, m_ShadowMapPipeline, m_ShadowMapPipelineLayout, &m_ShadowMapDescriptorSet, m_aryShadowCascadeCasters[uiCascadeIdx]);
+			}
+
+			vkCmdEndRenderPass(commandBuffer);
+		}
+	}
+	
+	//Second RenderPass
+	{
+		VkRenderPassBeginInfo renderPassBeginInfo{};
+		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBeginInfo.renderPass = m_RenderPass;
+		renderPassBeginInfo.framebuffer = m_vecSwapChainFrameBuffers[uiIdx];
+		renderPassBeginInfo.renderArea.offset = { 0, 0 };
+		renderPassBeginInfo.renderArea.extent = m_SwapChainExtent2D;
+		std::array<VkClearValue, 2> aryClearColor;
+		aryClearColor[0].color = { 0.f, 0.f, 0.f, 1.f };
+		aryClearColor[1].depthStencil = { GetDepthClearValue(), 0 };
+		renderPassBeginInfo.clearValueCount = static_cast<UINT>(aryClearColor.size());
+		renderPassBeginInfo.pClearValues = aryClearColor.data();
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		//vkCmdSetViewportvkCmdSetScissorƺӦcommandBufferеĻ
+		//ӦʼȾ֮ǰ
+		VkViewport viewport{};
+		viewport.x = 0.f;
+		viewport.y = 0.f;
+		viewport.width = static_cast<float>(m_SwapChainExtent2D.width);
+		viewport.height = static_cast<float>(m_SwapChainExtent2D.height);
+		viewport.minDepth = 0.f;
+		viewport.maxDepth = 1.f;
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+		VkRect2D scissor{};
+		scissor.offset = { 0, 0 };
+		scissor.extent = m_SwapChainExtent2D;
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		if (m_bEnableSkybox)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_SkyboxGraphicPipeline);
+			VkBuffer skyboxVertexBuffers[] = {
+				m_SkyboxModel->m_VertexBuffer,
+			};
+			VkDeviceSize skyboxOffsets[]{ 0 };
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, skyboxVertexBuffers, skyboxOffsets);
+			vkCmdBindIndexBuffer(commandBuffer, m_SkyboxModel->m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindDescriptorSets(commandBuffer,
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				m_SkyboxGraphicPipelineLayout,
+				0, 1,
+				&m_vecSkyboxDescriptorSets[uiIdx],
+				0, NULL);
+
+			vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_SkyboxModel->m_vecIndices.size()), 1, 0, 0, 0);
+		}
+
+		if (m_bEnableMeshGrid)
+		{
+			if (m_fLastMeshGridSplit != m_fMeshGridSplit)
+			{
+				RecreateMeshGridVertexBuffer();
+				RecreateMeshGridIndexBuffer();
+				m_fLastMeshGridSplit = m_fMeshGridSplit;
+			}
+			if (m_fLastMeshGridSize != m_fMeshGridSize)
+			{
+				RecreateMeshGridVertexBuffer();
+				m_fLastMeshGridSize = m_fMeshGridSize;
+			}
+		}
+
+		//ָΪ0ʱCreateMeshGridIndexBufferindex bufferʱûпɻ
+		if (m_bEnableMeshGrid && m_MeshGridIndexBuffer != VK_NULL_HANDLE && !m_vecMeshGridIndices.empty())
+		{
+			vkCmdSetLineWidth(commandBuffer, m_fMeshGridLineWidth);
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_MeshGridGraphicPipeline);
+			VkBuffer meshGridVertexBuffers[] = {
+				m_MeshGridVertexBuffer,
+			};
+			VkDeviceSize meshGridOffsets[]{ 0 };
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, meshGridVertexBuffers, meshGridOffsets);
+			vkCmdBindIndexBuffer(commandBuffer, m_MeshGridIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindDescriptorSets(commandBuffer,
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				m_MeshGridGraphicPipelineLayout,
+				0, 1,
+				&m_vecMeshGridDescriptorSets[uiIdx],
+				0, NULL);
+
+			vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_vecMeshGridIndices.size()), 1, 0, 0, 0);
+			vkCmdSetLineWidth(commandBuffer, 1.f);
+		}
+
+		if (m_bEnableEllipse)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_EllipseGraphicPipeline);
+			VkBuffer ellipseVertexBuffers[] = {
+				m_EllipseVertexBuffer,
+			};
+			VkDeviceSize ellipseOffsets[]{ 0 };
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, ellipseVertexBuffers, ellipseOffsets);
+			vkCmdBindIndexBuffer(commandBuffer, m_EllipseIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindDescriptorSets(commandBuffer,
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				m_EllipseGraphicPipelineLayout,
+				0, 1,
+				&m_vecEllipseDescriptorSets[uiIdx],
+				0, NULL);
+
+			vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_Ellipse.m_vecIndices.size()), 1, 0, 0, 0);
+		}
+
+		//if (m_bEnableBlinnPhong)
+		//{
+		//	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_BlinnPhongGraphicPipeline);
+		//	VkBuffer blinnPhongVertexBuffers[] = {
+		//		m_BlinnPhongModel.m_VertexBuffer,
+		//	};
+		//	VkDeviceSize blinnPhongOffsets[]{ 0 };
+		//	vkCmdBindVertexBuffers(commandBuffer, 0, 1, blinnPhongVertexBuffers, blinnPhongOffsets);
+		//	vkCmdBindIndexBuffer(commandBuffer, m_BlinnPhongModel.m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+		//	vkCmdBindDescriptorSets(commandBuffer,
+		//		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		//		m_BlinnPhongGraphicPipelineLayout,
+		//		0, 1,
+		//		&m_vecBlinnPhongDescriptorSets[uiIdx],
+		//		0, NULL);
+
+		//	vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_BlinnPhongModel.m_vecIndices.size()), 1, 0, 0, 0);
+		//}
+
+		//if (m_bEnablePBR)
+		//{
+		//	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PBRGraphicPipeline);
+		//	VkBuffer PBRVertexBuffers[] = {
+		//		m_PBRModel.m_VertexBuffer,
+		//	};
+		//	VkDeviceSize PBROffsets[]{ 0 };
+		//	vkCmdBindVertexBuffers(commandBuffer, 0, 1, PBRVertexBuffers, PBROffsets);
+		//	vkCmdBindIndexBuffer(commandBuffer, m_PBRModel.m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+		//	vkCmdBindDescriptorSets(commandBuffer,
+		//		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		//		m_PBRGraphicPipelineLayout,
+		//		0, 1,
+		//		&m_vecPBRDescriptorSets[uiIdx],
+		//		0, NULL);
+
+		//	vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_PBRModel.m_vecIndices.size()), 1, 0, 0, 0);
+		//}
+
+		DrawPlanets(commandBuffer, uiIdx);
+
+		//Common passӰˣGPUʱڱȽϸӰģʽ
+		if (m_TimestampQueryPool != VK_NULL_HANDLE)
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampQueryPool, uiIdx * 2);
+
+		m_testObjModel->Draw(commandBuffer, m_aryCommonGraphicPipeline[m_nShadowMode], m_CommonGraphicPipelineLayout, &m_CommonDescriptorSet);
+
+		if (m_TimestampQueryPool != VK_NULL_HANDLE)
+		{
+			vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampQueryPool, uiIdx * 2 + 1);
+			m_vecTimestampWritten[uiIdx] = true;
+		}
+
+		//m_testGLTFModel->Draw(commandBuffer, m_GLTFGraphicPipeline, m_GLTFGraphicPipelineLayout);
+
+		DrawAsteroidBelt(commandBuffer, uiIdx);
+
+		m_PointLightModel->Draw(commandBuffer, m_PointLightPipeline, m_PointLightPipelineLayout, &m_PointLightDescriptorSet);
+
+		g_UI.Render(uiIdx);
+
+		vkCmdEndRenderPass(commandBuffer);
+	}
+	
+	RecordVirtualTextureReadback(commandBuffer, uiIdx);
+
+	VULKAN_ASSERT(vkEndCommandBuffer(commandBuffer), "End command buffer failed");
+}
+
+void VulkanRenderer::UpdateUniformBuffer(UINT uiIdx)
+{
+	//ǵģ;viewֻת
+	m_UboData.view = m_Camera.GetRelativeViewMatrix();
+	m_UboData.proj = m_Camera.GetProjMatrix();
+	m_UboData.uiVirtualTextureEnable = (m_bVirtualTextureSupported && m_bEnableVirtualTexture) ? 1 : 0;
+	m_UboData.uiVirtualPageCountX = m_VirtualTexture.GetPageCountX();
+	m_UboData.uiVirtualMipCount = m_VirtualTexture.GetMipCount();
+	m_UboData.uiVirtualLayerCount = m_VirtualTexture.GetLayerCount();
+
+	void* uniformBufferData;
+	vkMapMemory(m_LogicalDevice, m_vecUniformBufferMemories[uiIdx], 0, m_UboBufferSize, 0, &uniformBufferData);
+	memcpy(uniformBufferData, &m_UboData, m_UboBufferSize);
+	vkUnmapMemory(m_LogicalDevice, m_vecUniformBufferMemories[uiIdx]);
+
+	UINT uiPlanetCount = static_cast<UINT>(m_vecPlanetInfo.size());
+	ASSERT(m_OrbitSystem.GetBodyCount() >= uiPlanetCount, "Orbit system has fewer bodies than planet instances");
+
+	std::vector<glm::mat4> aryModel(uiPlanetCount);
+	m_OrbitSystem.WriteModelMatrices(aryModel.data(), sizeof(glm::mat4), 0, uiPlanetCount, m_Camera.GetWorldPosition());
+
+	//ĻϵͶӰ뾶ѡϸּimpostorr / sqrt(d^2 - r^2)Ϊİ
+	//±PLANET_SUBDIVISION_LEVEL_COUNTΪimpostorٺһΪΣʵ
+	constexpr UINT uiImpostorGroup = PLANET_SUBDIVISION_LEVEL_COUNT;
+	constexpr UINT uiTerrainGroup = PLANET_SUBDIVISION_LEVEL_COUNT + 1;
+	float fPixelScale = std::abs(m_UboData.proj[1][1]) * 0.5f * static_cast<float>(m_SwapChainExtent2D.height);
+	std::vector<float> aryPixelRadius(uiPlanetCount);
+	for (UINT i = 0; i < uiPlanetCount; ++i)
+	{
+		//뾶Ϊ1ģ;żΪռ뾶
+		float fRadius = glm::length(glm::vec3(aryModel[i][0]));
+		glm::vec3 center = aryModel[i][3];
+		float fDistSquare = glm::dot(center, center);
+
+		aryPixelRadius[i] = FLT_MAX; //ڻ
+		if (fDistSquare > fRadius * fRadius * 1.01f)
+			aryPixelRadius[i] = fRadius / std::sqrt(fDistSquare - fRadius * fRadius) * fPixelScale;
+	}
+
+	//Ļ˵εǸĲΣڵפ֮ǰԻ
+	int nTerrainCandidate = -1;
+	if (m_bEnablePlanetTerrain)
+	{
+		for (UINT i = 0; i < uiPlanetCount && i < m_vecPlanetTerrainBody.size(); ++i)
+		{
+			if (m_vecPlanetTerrainBody[i] < 0 || aryPixelRadius[i] < m_fPlanetTerrainActivatePixel)
+				continue;
+			if (nTerrainCandidate < 0 || aryPixelRadius[i] > aryPixelRadius[nTerrainCandidate])
+				nTerrainCandidate = static_cast<int>(i);
+		}
+	}
+
+	//ûкѡʱҲҪã߳ɵĵοճս
+	m_nPlanetTerrainInstance = -1;
+	glm::mat4 terrainModel = nTerrainCandidate < 0 ? glm::mat4(1.f) : aryModel[nTerrainCandidate];
+	if (m_PlanetTerrain.Update(nTerrainCandidate < 0 ? -1 : m_vecPlanetTerrainBody[nTerrainCandidate],
+		terrainModel, m_UboData.proj * m_UboData.view, fPixelScale, m_pPlanetTerrainVertex))
+	{
+		m_nPlanetTerrainInstance = nTerrainCandidate;
+		m_PlanetTerrainModel = terrainModel;
+	}
+
+	std::vector<UINT> aryGroup(uiPlanetCount);
+	std::array<UINT, PLANET_SUBDIVISION_LEVEL_COUNT + 2> aryGroupCount{};
+	for (UINT i = 0; i < uiPlanetCount; ++i)
+	{
+		float fPixelRadius = aryPixelRadius[i];
+
+		UINT uiGroup = PLANET_SUBDIVISION_LEVEL_COUNT - 1; //ڻ棬ϸ
+		if (static_cast<int>(i) == m_nPlanetTerrainInstance)
+		{
+			uiGroup = uiTerrainGroup;
+		}
+		else if (fPixelRadius != FLT_MAX)
+		{
+			if (m_bEnablePlanetImpostor && fPixelRadius < m_fPlanetImpostorPixelThreshold)
+			{
+				uiGroup = uiImpostorGroup;
+			}
+			else
+			{
+				//ԲƫR(1 - cos(/2))  R^2/8ݲʮıԼӦ1.107
+				float fSegment = 1.107f * std::sqrt(fPixelRadius / (8.f * std::max(m_fPlanetTessellationErrorPixel, 0.01f)));
+				float fLevel = std::max(std::ceil(std::log2(fSegment)), 0.f);
+				uiGroup = std::min(static_cast<UINT>(fLevel), PLANET_SUBDIVISION_LEVEL_COUNT - 1);
+			}
+		}
+
+		aryGroup[i] = uiGroup;
+		++aryGroupCount[uiGroup];
+	}
+
+	std::array<UINT, PLANET_SUBDIVISION_LEVEL_COUNT + 2> aryGroupOffset{};
+	for (UINT uiGroup = 1; uiGroup < aryGroupOffset.size(); ++uiGroup)
+	{
+		aryGroupOffset[uiGroup] = aryGroupOffset[uiGroup - 1] + aryGroupCount[uiGroup - 1];
+	}
+	std::copy(aryGroupCount.begin(), aryGroupCount.begin() + PLANET_SUBDIVISION_LEVEL_COUNT, m_aryPlanetLevelInstanceCount.begin());
+	m_uiPlanetImpostorCount = aryGroupCount[uiImpostorGroup];
+	m_uiPlanetMeshCount = uiPlanetCount - m_uiPlanetImpostorCount - aryGroupCount[uiTerrainGroup];
+
+	//ǰѵȴǰ֡fenceֱд־ӳһΣϸּУ֮impostorʵ
+	//glmд洢תúǰмΪInstanceDataУparams.xΪĲ
+	InstanceData* pInstanceData = m_pInstanceData + uiIdx * m_uiInstanceFrameCount + ASTEROID_BELT_CAPACITY;
+	for (UINT i = 0; i < uiPlanetCount; ++i)
+	{
+		glm::mat4 rows = glm::transpose(aryModel[i]);
+		InstanceData& instance = pInstanceData[aryGroupOffset[aryGroup[i]]++];
+		instance.row0 = rows[0];
+		instance.row1 = rows[1];
+		instance.row2 = rows[2];
+		instance.params = glm::vec4(static_cast<float>(i), 0.f, 0.f, 0.f);
+	}
+}
+
+void VulkanRenderer::DrawPlanets(VkCommandBuffer commandBuffer, UINT uiIdx)
+{
+	if (!m_bEnablePlanet)
+		return;
+
+	//pipelinepipeline layoutbinding 1ĸʽdescriptor setʵbufferֻһ
+	VkDeviceSize instanceOffset = sizeof(InstanceData) * (static_cast<VkDeviceSize>(m_uiInstanceFrameCount) * uiIdx + ASTEROID_BELT_CAPACITY);
+	vkCmdBindVertexBuffers(commandBuffer, 1, 1, &m_InstanceBuffer, &instanceOffset);
+
+	vkCmdBindDescriptorSets(commandBuffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		m_GraphicPipelineLayout,
+		0, 1,
+		&m_vecDescriptorSets[uiIdx],
+		0, nullptr);
+
+	if (m_uiPlanetMeshCount > 0)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipeline);
+
+		//ûжbufferÿ20 * n * nΣfirstInstanceǰ漶ʵ
+		UINT uiFirstInstance = 0;
+		for (UINT uiLevel = 0; uiLevel < PLANET_SUBDIVISION_LEVEL_COUNT; ++uiLevel)
+		{
+			UINT uiInstanceCount = m_aryPlanetLevelInstanceCount[uiLevel];
+			if (uiInstanceCount == 0)
+				continue;
+
+			PlanetPushConstant pushConstant{ 1u << uiLevel };
+			vkCmdPushConstants(commandBuffer, m_GraphicPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PlanetPushConstant), &pushConstant);
+
+			UINT uiVertexCount = 20 * pushConstant.uiSubdivision * pushConstant.uiSubdivision * 3;
+			vkCmdDraw(commandBuffer, uiVertexCount, uiInstanceCount, 0, uiFirstInstance);
+			uiFirstInstance += uiInstanceCount;
+		}
+	}
+
+	if (m_uiPlanetImpostorCount > 0)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PlanetImpostorPipeline);
+
+		//ÿimpostor 6㣬firstInstanceǰʵ
+		vkCmdDraw(commandBuffer, 6, m_uiPlanetImpostorCount, 0, m_uiPlanetMeshCount);
+	}
+
+	DrawPlanetTerrain(commandBuffer, uiIdx);
+}
+
+void VulkanRenderer::DrawPlanetTerrain(VkCommandBuffer commandBuffer, UINT uiIdx)
+{
+	if (m_nPlanetTerrainInstance < 0 || m_PlanetTerrain.GetDrawSlots().empty())
+		return;
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PlanetTerrainPipeline);
+
+	VkDeviceSize vertexOffset = 0;
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_PlanetTerrainVertexBuffer, &vertexOffset);
+	vkCmdBindIndexBuffer(commandBuffer, m_PlanetTerrainIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+	vkCmdBindDescriptorSets(commandBuffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS,
+		m_PlanetTerrainPipelineLayout,
+		0, 1,
+		&m_vecDescriptorSets[uiIdx],
+		0, nullptr);
+
+	PlanetTerrainPushConstant pushConstant{ m_PlanetTerrainModel, static_cast<float>(m_nPlanetTerrainInstance) };
+	vkCmdPushConstants(commandBuffer, m_PlanetTerrainPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PlanetTerrainPushConstant), &pushConstant);
+
+	//vertexOffsetѡ񶥵еslot
+	for (UINT uiSlot : m_PlanetTerrain.GetDrawSlots())
+	{
+		vkCmdDrawIndexed(commandBuffer, m_uiPlanetTerrainIndexCount, 1, 0, static_cast<int32_t>(uiSlot * PlanetTerrain::CHUNK_VERTEX_COUNT), 0);
+	}
+}
+
+void VulkanRenderer::Render()
+{	
+	if (!ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow) && !ImGui::IsAnyItemActive())
+		m_Camera.Tick();
+
+	//ȴfenceֵΪsignaled
+	vkWaitForFences(m_LogicalDevice, 1, &m_vecInFlightFences[m_uiCurFrameIdx], VK_TRUE, UINT64_MAX);
+
+	//ǰ֡fencesignaleḓԤҲʹõ
+	m_TextureCache.Update();
+	m_TextureStreamer.Update(m_uiCurFrameIdx);
+	DestroyRetiredResources(false);
+
+	if (m_bNeedResize)
+	{
+		WindowResize();
+		m_bNeedResize = false;
+	}
+
+	ReadTimestampQueryResult(m_uiCurFrameIdx);
+
+	//߽֡磺ǰ֡fencesignaled԰ȫ滻pipeline
+	ProcessShaderHotReload();
+	RecreateCommonGraphicPipelineIfFilterChanged();
+
+	//ǹתʵʱƽʱOrbitSystem
+	auto nowOrbitTime = std::chrono::high_resolution_clock::now();
+	m_OrbitSystem.Update(std::chrono::duration<float>(nowOrbitTime - m_LastOrbitTime).count());
+	m_LastOrbitTime = nowOrbitTime;
+
+	UpdateAsteroidBelt(m_uiCurFrameIdx);
+
+	g_UI.StartNewFrame();
+
+	uint32_t uiImageIdx;
+	VkResult res = vkAcquireNextImageKHR(m_LogicalDevice, m_SwapChain, UINT64_MAX,
+		m_vecImageAvailableSemaphores[m_uiCurFrameIdx], VK_NULL_HANDLE, &uiImageIdx);
+	if (res != VK_SUCCESS)
+	{
+		if (res == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			//SwapChainWindowSurfaceݣ޷Ⱦ
+			//һ㷢windowߴıʱ
+			m_bNeedResize = true;
+			return;
+		}
+		else if (res == VK_SUBOPTIMAL_KHR)
+		{
+			//SwapChainȻãWindowSurfacepropertiesȫƥ
+		}
+		else
+		{
+			ASSERT(false, "Accquire next swap chain image failed");
+		}
+	}
+
+	//fenceΪunsignaled
+	vkResetFences(m_LogicalDevice, 1, &m_vecInFlightFences[m_uiCurFrameIdx]);
 
-	//if (m_bEnableEllipse)
-	//	UpdateEllipseUniformBuffer(m_uiCurFrameIdx);
+	vkResetCommandBuffer(m_vecCommandBuffers[m_uiCurFrameIdx], 0);
 
-	//if (m_bEnableBlinnPhong)
-	//{
-	//	UpdateBlinnPhongMVPUniformBuffer(m_uiCurFrameIdx);
-	//	UpdateBlinnPhongLightUniformBuffer(m_uiCurFrameIdx);
-	//	UpdateBlinnPhongMaterialUniformBuffer(m_uiCurFrameIdx);
-	//}
+	RecordCommandBuffer(m_vecCommandBuffers[m_uiCurFrameIdx], m_uiCurFrameIdx);
 
-	//if (m_bEnablePBR)
-	//{
-	//	UpdatePBRMVPUniformBuffer(m_uiCurFrameIdx);
-	//	UpdatePBRLightUniformBuffer(m_uiCurFrameIdx);
-	//	UpdatePBRMaterialUniformBuffer(m_uiCurFrameIdx);
-	//}
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+	VkSemaphore waitSemaphores[] = {
+		m_vecImageAvailableSemaphores[m_uiCurFrameIdx],
+	};
+	VkPipelineStageFlags waitStages[] = {
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+	};
+	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.pWaitSemaphores = waitSemaphores;
+	submitInfo.pWaitDstStageMask = waitStages;
+
+	std::vector<VkCommandBuffer> commandBuffers = {
+		m_vecCommandBuffers[m_uiCurFrameIdx],
+		//uiCommandBuffer,
+	};
+	submitInfo.commandBufferCount = static_cast<UINT>(commandBuffers.size());
+	submitInfo.pCommandBuffers = commandBuffers.data();
+
+	VkSemaphore signalSemaphore[] = {
+		m_vecRenderFinishedSemaphores[m_uiCurFrameIdx],
+	};
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = signalSemaphore;
+
+	//submit֮󣬻ὫfenceΪsignaled
+	VULKAN_ASSERT(vkQueueSubmit(m_GraphicQueue, 1, &submitInfo, m_vecInFlightFences[m_uiCurFrameIdx]), "Submit command buffer failed");
+
+	VkPresentInfoKHR presentInfo{};
+	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores = signalSemaphore;
+
+	std::vector<VkSwapchainKHR> vecSwapChains = {
+		m_SwapChain,
+	};
+
+	std::vector<UINT> vecImageIndices = {
+		uiImageIdx,
+	};
+	presentInfo.swapchainCount = static_cast<UINT>(vecSwapChains.size());
+	presentInfo.pSwapchains = vecSwapChains.data();
+	presentInfo.pImageIndices = vecImageIndices.data();
+	presentInfo.pResults = nullptr;
+
+	res = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
+	if (res != VK_SUCCESS)
+	{
+		if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR || m_bFrameBufferResized)
+		{
+			m_bNeedResize = true;
+			m_bFrameBufferResized = false;
+		}
+		else
+		{
+			throw std::runtime_error("Present Swap Chain Image To Queue Failed");
+		}
+	}
+
+	m_uiFrameCounter++;
+	m_uiFrameNumber++;
+
+	m_uiCurFrameIdx = (m_uiCurFrameIdx + 1) % static_cast<UINT>(m_vecSwapChainImages.size());
+}
+
+void VulkanRenderer::WindowResize()
+{
+	//⴦С
+	int nWidth = 0;
+	int nHeight = 0;
+	glfwGetFramebufferSize(m_pWindow, &nWidth, &nHeight);
+	while (nWidth == 0 || nHeight == 0)
+	{
+		glfwGetFramebufferSize(m_pWindow, &nWidth, &nHeight);
+		glfwWaitEvents();
+	}
+
+	m_Camera.SetViewportSize(static_cast<float>(nWidth), static_cast<float>(nHeight));
+
+	//ҪؽԴ
+	//1. ʹڴСصģDepth(Image, Memory, ImageView)SwapChain ImageViewport/Scissors
+	//2. DepthImageViewģFrameBuffer
+	//3. SwapChain ImageģFrameBuffer
+	//4. FrameBufferģCommandBuffer(RenderPassBeginInfo)
+	//5. ViewportScissorsģPipelineviewport/scissordynamic
+	//6. ɫʽɫʿռ䷢˱仯RenderPass
+	//7. SwapChainеImageCount˱仯صĸͬfencesemaphore
+
+	vkDeviceWaitIdle(m_LogicalDevice);
+
+	//swap cain
+	CreateSwapChain(); //ڴپɵSwapChain
+
+	//depth
+	vkDestroyImageView(m_LogicalDevice, m_DepthImageView, nullptr);
+	vkDestroyImage(m_LogicalDevice, m_DepthImage, nullptr);
+	vkFreeMemory(m_LogicalDevice, m_DepthImageMemory, nullptr);
+	CreateDepthImage();
+	CreateDepthImageView();
+
+	//image views
+	for (const auto& imageView : m_vecSwapChainImageViews)
+	{
+		vkDestroyImageView(m_LogicalDevice, imageView, nullptr);
+	}
+	CreateSwapChainImages();
+	CreateSwapChainImageViews();
+
+	//frame buffers
+	for (const auto& frameBuffer : m_vecSwapChainFrameBuffers)
+	{
+		vkDestroyFramebuffer(m_LogicalDevice, frameBuffer, nullptr);
+	}
+	CreateSwapChainFrameBuffers();
+
+	//UI
+	g_UI.Resize();
+
+	//command buffers
+	vkFreeCommandBuffers(m_LogicalDevice, m_CommandPool,
+		static_cast<UINT>(m_vecCommandBuffers.size()),
+		m_vecCommandBuffers.data());
+	
+	CreateCommandBuffers();
+}
+
+void VulkanRenderer::CreatePointLightResource()
+{
+	m_PointLightModel = DZW_VulkanWrap::ModelFactor::CreateModel(this, "./Assert/Model/sphere_lowpoly.obj");
+	CreatePointLightUniformBufferAndMemory();
+	CreatePointLightShaderModule();
+	CreatePointLightDescriptorSetLayout();
+	CreatePointLightDescriptorPool();
+	CreatePointLightDescriptorSet();
+	CreatePointLightPipelineLayout();
+	CreatePointLightPipeline();
+}
+
+void VulkanRenderer::CreatePointLightUniformBufferAndMemory()
+{
+	CreateBufferAndBindMemory(sizeof(MVPUniformBufferObject),
+		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_PointLightUniformBuffer,
+		m_PointLightUniformBufferMemory
+	);
+}
+
+void VulkanRenderer::UpdatePointLight()
+{
+	static auto lastTime = std::chrono::high_resolution_clock::now();
+	auto currentTime = std::chrono::high_resolution_clock::now();
+
+	float deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - lastTime).count();
+
+	lastTime = currentTime;
+
+	static float fDegree = 0.f;
+	fDegree += deltaTime * 10.f;
+
+	auto rotate = glm::rotate(glm::mat4(1.f), glm::radians(fDegree), { 0.0, 1.0, 0.0 });
+	m_PointLight.color = { 1.0, 1.0, 1.0, 1.0 };
+	//m_PointLight.position = glm::vec3(rotate * glm::vec4(5.0, -5.0, 5.0, 1.0));
+
+	m_PointLight.position = { -20.68, -8.31, 18.88 };
+
+	auto model = glm::translate(glm::mat4(1.f), m_PointLight.position);
+	auto& view = m_Camera.GetViewMatrix();
+	auto& proj = m_Camera.GetProjMatrix();
+
+	m_PointLightUBOData.mvp = proj * view * model;
+
+	void* uniformBufferData;
+	vkMapMemory(m_LogicalDevice, m_PointLightUniformBufferMemory, 0, sizeof(MVPUniformBufferObject), 0, &uniformBufferData);
+	memcpy(uniformBufferData, &m_PointLightUBOData, sizeof(MVPUniformBufferObject));
+	vkUnmapMemory(m_LogicalDevice, m_PointLightUniformBufferMemory);
+}
+
+void VulkanRenderer::CreatePointLightShaderModule()
+{
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
+
+	m_mapPointLightShaderModule.clear();
+
+	for (const auto& stage : vecShaderStage)
+	{
+		m_mapPointLightShaderModule[stage] = CreateShaderModuleByName("PointLight", stage);
+	}
+}
+
+void VulkanRenderer::CreatePointLightDescriptorSetLayout()
+{
+	//MVP UBO Binding
+	VkDescriptorSetLayoutBinding MVPUBOLayoutBinding{};
+	MVPUBOLayoutBinding.binding = 0;
+	MVPUBOLayoutBinding.descriptorCount = 1;
+	MVPUBOLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	MVPUBOLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	MVPUBOLayoutBinding.pImmutableSamplers = nullptr;
+
+	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
+		MVPUBOLayoutBinding,
+	};
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
+	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_PointLightDescriptorSetLayout), "Create point light descriptor layout failed");
+}
+
+void VulkanRenderer::CreatePointLightDescriptorPool()
+{
+	VkDescriptorPoolSize MVPUBOPoolSize{};
+	MVPUBOPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	MVPUBOPoolSize.descriptorCount = 1;
+
+	std::vector<VkDescriptorPoolSize> vecPoolSize = {
+		MVPUBOPoolSize,
+	};
+
+	VkDescriptorPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
+	poolCreateInfo.pPoolSizes = vecPoolSize.data();
+	poolCreateInfo.maxSets = 1;
+
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_PointLightDescriptorPool), "Create point light descriptor pool failed");
+}
+
+void VulkanRenderer::CreatePointLightDescriptorSet()
+{
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.descriptorPool = m_PointLightDescriptorPool;
+	allocInfo.pSetLayouts = &m_PointLightDescriptorSetLayout;
 
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, &m_PointLightDescriptorSet), "Allocate point light desctiprot sets failed");
 
-	VkCommandBufferBeginInfo commandBufferBeginInfo{};
-	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	commandBufferBeginInfo.flags = 0;
-	commandBufferBeginInfo.pInheritanceInfo = nullptr;
+	VkDescriptorBufferInfo MVPDescriptorBufferInfo{};
+	MVPDescriptorBufferInfo.buffer = m_PointLightUniformBuffer;
+	MVPDescriptorBufferInfo.offset = 0;
+	MVPDescriptorBufferInfo.range = sizeof(MVPUniformBufferObject);
 
-	VULKAN_ASSERT(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo), "Begin command buffer failed");
+	VkWriteDescriptorSet MVPUBOWrite{};
+	MVPUBOWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	MVPUBOWrite.dstSet = m_PointLightDescriptorSet;
+	MVPUBOWrite.dstBinding = 0;
+	MVPUBOWrite.dstArrayElement = 0;
+	MVPUBOWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	MVPUBOWrite.descriptorCount = 1;
+	MVPUBOWrite.pBufferInfo = &MVPDescriptorBufferInfo;
 
-	//First renderpass
-	{
-		VkRenderPassBeginInfo shadowMapRenderPassBeginInfo{};
-		shadowMapRenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		shadowMapRenderPassBeginInfo.renderPass = m_ShadowMapRenderPass;
-		shadowMapRenderPassBeginInfo.framebuffer = m_ShadowMapFrameBuffer;
-		shadowMapRenderPassBeginInfo.renderArea.offset = { 0, 0 };
-		shadowMapRenderPassBeginInfo.renderArea.extent = m_ShadowMapExtent2D;
-		std::array<VkClearValue, 2> shadowMapAryClearColor;
-		shadowMapAryClearColor[0].color = { 1.f, 1.f, 1.f, 1.f };
-		shadowMapAryClearColor[1].depthStencil = { 1.f, 0 };
-		shadowMapRenderPassBeginInfo.clearValueCount = static_cast<UINT>(shadowMapAryClearColor.size());
-		shadowMapRenderPassBeginInfo.pClearValues = shadowMapAryClearColor.data();
-		vkCmdBeginRenderPass(commandBuffer, &shadowMapRenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-		VkViewport shadowMapViewport{};
-		shadowMapViewport.x = 0.f;
-		shadowMapViewport.y = 0.f;
-		shadowMapViewport.width = static_cast<float>(m_ShadowMapExtent2D.width);
-		shadowMapViewport.height = static_cast<float>(m_ShadowMapExtent2D.height);
-		shadowMapViewport.minDepth = 0.f;
-		shadowMapViewport.maxDepth = 1.f;
-		vkCmdSetViewport(commandBuffer, 0, 1, &shadowMapViewport);
-
-		VkRect2D shadowMapScissor{};
-		shadowMapScissor.offset = { 0, 0 };
-		shadowMapScissor.extent = m_ShadowMapExtent2D;
-		vkCmdSetScissor(commandBuffer, 0, 1, &shadowMapScissor);
-
-		float depthBiasConstant = 1.25f;
-		float depthBiasSlope = 1.75f;
-		vkCmdSetDepthBias(commandBuffer, depthBiasConstant, 0.0f, depthBiasSlope);
-
-		m_testObjModel->Draw(commandBuffer, m_ShadowMapPipeline, m_ShadowMapPipelineLayout, &m_ShadowMapDescriptorSet);
+	std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
+		MVPUBOWrite,
+	};
 
-		vkCmdEndRenderPass(commandBuffer);
-	}
-	
-	//Second RenderPass
-	{
-		VkRenderPassBeginInfo renderPassBeginInfo{};
-		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassBeginInfo.renderPass = m_RenderPass;
-		renderPassBeginInfo.framebuffer = m_vecSwapChainFrameBuffers[uiIdx];
-		renderPassBeginInfo.renderArea.offset = { 0, 0 };
-		renderPassBeginInfo.renderArea.extent = m_SwapChainExtent2D;
-		std::array<VkClearValue, 2> aryClearColor;
-		aryClearColor[0].color = { 0.f, 0.f, 0.f, 1.f };
-		aryClearColor[1].depthStencil = { 1.f, 0 };
-		renderPassBeginInfo.clearValueCount = static_cast<UINT>(aryClearColor.size());
-		renderPassBeginInfo.pClearValues = aryClearColor.data();
+	vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
+}
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+void VulkanRenderer::CreatePointLightPipelineLayout()
+{
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_PointLightDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
 
-		//vkCmdSetViewportvkCmdSetScissorƺӦcommandBufferеĻ
-		//ӦʼȾ֮ǰ
-		VkViewport viewport{};
-		viewport.x = 0.f;
-		viewport.y = 0.f;
-		viewport.width = static_cast<float>(m_SwapChainExtent2D.width);
-		viewport.height = static_cast<float>(m_SwapChainExtent2D.height);
-		viewport.minDepth = 0.f;
-		viewport.maxDepth = 1.f;
-		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_PointLightPipelineLayout), "Create point light pipeline layout failed");
+}
 
-		VkRect2D scissor{};
-		scissor.offset = { 0, 0 };
-		scissor.extent = m_SwapChainExtent2D;
-		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+void VulkanRenderer::CreatePointLightPipeline()
+{
+	/****************************ɱ̹*******************************/
+	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
+	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	vertShaderStageCreateInfo.module = m_mapPointLightShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
+	vertShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
 
-		if (m_bEnableSkybox)
-		{
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_SkyboxGraphicPipeline);
-			VkBuffer skyboxVertexBuffers[] = {
-				m_SkyboxModel->m_VertexBuffer,
-			};
-			VkDeviceSize skyboxOffsets[]{ 0 };
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, skyboxVertexBuffers, skyboxOffsets);
-			vkCmdBindIndexBuffer(commandBuffer, m_SkyboxModel->m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-			vkCmdBindDescriptorSets(commandBuffer,
-				VK_PIPELINE_BIND_POINT_GRAPHICS,
-				m_SkyboxGraphicPipelineLayout,
-				0, 1,
-				&m_vecSkyboxDescriptorSets[uiIdx],
-				0, NULL);
+	VkPipelineShaderStageCreateInfo fragShaderStageCreateInfo{};
+	fragShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	fragShaderStageCreateInfo.module = m_mapPointLightShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT); //Bytecode
+	fragShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
 
-			vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_SkyboxModel->m_vecIndices.size()), 1, 0, 0, 0);
-		}
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
+		vertShaderStageCreateInfo,
+		fragShaderStageCreateInfo,
+	};
 
-		if (m_bEnableMeshGrid)
-		{
-			if (m_fLastMeshGridSplit != m_fMeshGridSplit)
-			{
-				RecreateMeshGridVertexBuffer();
-				RecreateMeshGridIndexBuffer();
-				m_fLastMeshGridSplit = m_fMeshGridSplit;
-			}
-			if (m_fLastMeshGridSize != m_fMeshGridSize)
-			{
-				RecreateMeshGridVertexBuffer();
-				m_fLastMeshGridSize = m_fMeshGridSize;
-			}
-			vkCmdSetLineWidth(commandBuffer, m_fMeshGridLineWidth);
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_MeshGridGraphicPipeline);
-			VkBuffer meshGridVertexBuffers[] = {
-				m_MeshGridVertexBuffer,
-			};
-			VkDeviceSize meshGridOffsets[]{ 0 };
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, meshGridVertexBuffers, meshGridOffsets);
-			vkCmdBindIndexBuffer(commandBuffer, m_MeshGridIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-			vkCmdBindDescriptorSets(commandBuffer,
-				VK_PIPELINE_BIND_POINT_GRAPHICS,
-				m_MeshGridGraphicPipelineLayout,
-				0, 1,
-				&m_vecMeshGridDescriptorSets[uiIdx],
-				0, NULL);
+	/*****************************̶*******************************/
 
-			vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_vecMeshGridIndices.size()), 1, 0, 0, 0);
-			vkCmdSetLineWidth(commandBuffer, 1.f);
-		}
+	//-----------------------Dynamic State--------------------------//
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
+	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	std::vector<VkDynamicState> vecDynamicStates = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+	};
+	dynamicStateCreateInfo.dynamicStateCount = static_cast<UINT>(vecDynamicStates.size());
+	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
 
-		if (m_bEnableEllipse)
-		{
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_EllipseGraphicPipeline);
-			VkBuffer ellipseVertexBuffers[] = {
-				m_EllipseVertexBuffer,
-			};
-			VkDeviceSize ellipseOffsets[]{ 0 };
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, ellipseVertexBuffers, ellipseOffsets);
-			vkCmdBindIndexBuffer(commandBuffer, m_EllipseIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-			vkCmdBindDescriptorSets(commandBuffer,
-				VK_PIPELINE_BIND_POINT_GRAPHICS,
-				m_EllipseGraphicPipelineLayout,
-				0, 1,
-				&m_vecEllipseDescriptorSets[uiIdx],
-				0, NULL);
+	//-----------------------Vertex Input State--------------------------//
+	auto bindingDescription = Vertex3D::GetBindingDescription();
+	auto attributeDescriptions = Vertex3D::GetAttributeDescriptions();
+	VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
+	vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputCreateInfo.vertexBindingDescriptionCount = 1;
+	vertexInputCreateInfo.pVertexBindingDescriptions = &bindingDescription;
+	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(attributeDescriptions.size());
+	vertexInputCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
-			vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_Ellipse.m_vecIndices.size()), 1, 0, 0, 0);
-		}
+	//-----------------------Input Assembly State------------------------//
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
+	inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
-		//if (m_bEnableBlinnPhong)
-		//{
-		//	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_BlinnPhongGraphicPipeline);
-		//	VkBuffer blinnPhongVertexBuffers[] = {
-		//		m_BlinnPhongModel.m_VertexBuffer,
-		//	};
-		//	VkDeviceSize blinnPhongOffsets[]{ 0 };
-		//	vkCmdBindVertexBuffers(commandBuffer, 0, 1, blinnPhongVertexBuffers, blinnPhongOffsets);
-		//	vkCmdBindIndexBuffer(commandBuffer, m_BlinnPhongModel.m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		//	vkCmdBindDescriptorSets(commandBuffer,
-		//		VK_PIPELINE_BIND_POINT_GRAPHICS,
-		//		m_BlinnPhongGraphicPipelineLayout,
-		//		0, 1,
-		//		&m_vecBlinnPhongDescriptorSets[uiIdx],
-		//		0, NULL);
 
-		//	vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_BlinnPhongModel.m_vecIndices.size()), 1, 0, 0, 0);
-		//}
+	//-----------------------Viewport State--------------------------//
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
+	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportStateCreateInfo.viewportCount = 1;
+	viewportStateCreateInfo.scissorCount = 1;
 
-		//if (m_bEnablePBR)
-		//{
-		//	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PBRGraphicPipeline);
-		//	VkBuffer PBRVertexBuffers[] = {
-		//		m_PBRModel.m_VertexBuffer,
-		//	};
-		//	VkDeviceSize PBROffsets[]{ 0 };
-		//	vkCmdBindVertexBuffers(commandBuffer, 0, 1, PBRVertexBuffers, PBROffsets);
-		//	vkCmdBindIndexBuffer(commandBuffer, m_PBRModel.m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		//	vkCmdBindDescriptorSets(commandBuffer,
-		//		VK_PIPELINE_BIND_POINT_GRAPHICS,
-		//		m_PBRGraphicPipelineLayout,
-		//		0, 1,
-		//		&m_vecPBRDescriptorSets[uiIdx],
-		//		0, NULL);
+	//-----------------------Raserization State--------------------------//
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{};
+	rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;	//󣬳ԶƽĲֻᱻضԶƽϣǶ
+	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;	//󣬽ֹͼԪդ
+	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;	//ͼԪģʽFILLLINEPOINT
+	rasterizationStateCreateInfo.lineWidth = 1.f;	//ָդ߶ο
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //򣬿˳ʱcwʱccw
+	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE; //ƫƣһShaodw MapбӰ
+	rasterizationStateCreateInfo.depthBiasConstantFactor = 0.f;
+	rasterizationStateCreateInfo.depthBiasClamp = 0.f;
+	rasterizationStateCreateInfo.depthBiasSlopeFactor = 0.f;
 
-		//	vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_PBRModel.m_vecIndices.size()), 1, 0, 0, 0);
-		//}
+	//-----------------------Multisample State--------------------------//
+	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
+	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisamplingStateCreateInfo.sampleShadingEnable = VK_FALSE;
+	multisamplingStateCreateInfo.minSampleShading = 0.8f;
+	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisamplingStateCreateInfo.minSampleShading = 1.f;
+	multisamplingStateCreateInfo.pSampleMask = nullptr;
+	multisamplingStateCreateInfo.alphaToCoverageEnable = VK_FALSE;
+	multisamplingStateCreateInfo.alphaToOneEnable = VK_FALSE;
+
+	//-----------------------Depth Stencil State--------------------------//
+	VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
+	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
+	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
+	depthStencilStateCreateInfo.minDepthBounds = 0.f;
+	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
+	depthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
+	depthStencilStateCreateInfo.front = {};
+	depthStencilStateCreateInfo.back = {};
 
-		//vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicPipeline);
-		//VkBuffer vertexBuffers[] = {
-		//	m_Model.m_VertexBuffer,
-		//};
-		//VkDeviceSize offsets[]{ 0 };
-		//vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+	//-----------------------Color Blend State--------------------------//
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{};
+	colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+	colorBlendStateCreateInfo.attachmentCount = 1;
 
-		//vkCmdBindIndexBuffer(commandBuffer, m_Model.m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+	colorBlendAttachment.colorWriteMask =
+		VK_COLOR_COMPONENT_R_BIT
+		| VK_COLOR_COMPONENT_G_BIT
+		| VK_COLOR_COMPONENT_B_BIT
+		| VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.blendEnable = VK_FALSE;
+	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
-		//for (UINT i = 0; i < INSTANCE_NUM; ++i)
-		//{
-		//	UINT uiDynamicOffset = i * static_cast<UINT>(m_DynamicAlignment);
+	colorBlendStateCreateInfo.pAttachments = &colorBlendAttachment;
+	colorBlendStateCreateInfo.blendConstants[0] = 0.f;
+	colorBlendStateCreateInfo.blendConstants[1] = 0.f;
+	colorBlendStateCreateInfo.blendConstants[2] = 0.f;
+	colorBlendStateCreateInfo.blendConstants[3] = 0.f;
 
-		//	vkCmdBindDescriptorSets(commandBuffer,
-		//		VK_PIPELINE_BIND_POINT_GRAPHICS, //descriptorSetPipelineУҪָGraphic PipelineCompute Pipeline
-		//		m_GraphicPipelineLayout, //PipelineLayoutָdescriptorSetLayout
-		//		0,	//descriptorSetеһԪص± 
-		//		1,	//descriptorSetԪصĸ
-		//		&m_vecDescriptorSets[uiIdx],
-		//		1, //ö̬Uniformƫ
-		//		&uiDynamicOffset	//ָ̬Uniformƫ
-		//	);
-
-		//	vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_Model.m_vecIndices.size()), 1, 0, 0, 0);
-		//}
+	/***********************************************************************/
+	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapPointLightShaderModule.size());
+	pipelineCreateInfo.pStages = shaderStageCreateInfos;
+	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
+	pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+	pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+	pipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
+	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
+	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
+	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
+	pipelineCreateInfo.layout = m_PointLightPipelineLayout;
+	pipelineCreateInfo.renderPass = m_RenderPass;
+	pipelineCreateInfo.subpass = 0;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
 
-		m_testObjModel->Draw(commandBuffer, m_CommonGraphicPipeline, m_CommonGraphicPipelineLayout, &m_CommonDescriptorSet);
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_PointLightPipeline), "Create point light pipeline failed");
+}
 
-		//m_testGLTFModel->Draw(commandBuffer, m_GLTFGraphicPipeline, m_GLTFGraphicPipelineLayout);
+VkVertexInputBindingDescription VulkanRenderer::GetInstanceBindingDescription()
+{
+	return VkVertexInputBindingDescription{ 1, sizeof(InstanceData), VK_VERTEX_INPUT_RATE_INSTANCE };
+}
 
-		m_PointLightModel->Draw(commandBuffer, m_PointLightPipeline, m_PointLightPipelineLayout, &m_PointLightDescriptorSet);
+std::array<VkVertexInputAttributeDescription, 4> VulkanRenderer::GetInstanceAttributeDescriptions()
+{
+	//location 4~6Ϊģ;Уlocation 7Ϊparams.xǵ㣩
+	return {
+		VkVertexInputAttributeDescription{ 4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, row0) },
+		VkVertexInputAttributeDescription{ 5, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, row1) },
+		VkVertexInputAttributeDescription{ 6, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, row2) },
+		VkVertexInputAttributeDescription{ 7, 1, VK_FORMAT_R32_SFLOAT, offsetof(InstanceData, params) },
+	};
+}
 
-		g_UI.Render(uiIdx);
+void VulkanRenderer::CreateInstanceBuffer()
+{
+	//ÿ֡CPUдHOST_COHERENT + ־ӳ䣬SIMD kernelֱstreaming storeд
+	//ȡdynamic uniformminUniformBufferOffsetAlignmentԼҲҪʵbind descriptor set
+	m_uiInstanceFrameCount = ASTEROID_BELT_CAPACITY + static_cast<UINT>(m_vecPlanetInfo.size());
+	VkDeviceSize frameSize = sizeof(InstanceData) * m_uiInstanceFrameCount;
+	CreateBufferAndBindMemory(frameSize * m_vecSwapChainImages.size(),
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_InstanceBuffer,
+		m_InstanceBufferMemory
+	);
 
-		vkCmdEndRenderPass(commandBuffer);
-	}
-	
+	void* pMapped = nullptr;
+	VULKAN_ASSERT(vkMapMemory(m_LogicalDevice, m_InstanceBufferMemory, 0, VK_WHOLE_SIZE, 0, &pMapped), "Map instance buffer failed");
+	m_pInstanceData = static_cast<InstanceData*>(pMapped);
+}
 
-	VULKAN_ASSERT(vkEndCommandBuffer(commandBuffer), "End command buffer failed");
+void VulkanRenderer::CreateInstancedResource()
+{
+	CreateInstancedShaderModule();
+	CreateInstancedPipelineLayout();
+	CreateInstancedPipeline();
 }
 
-void VulkanRenderer::UpdateUniformBuffer(UINT uiIdx)
+void VulkanRenderer::CreateInstancedShaderModule()
 {
-	static auto startTime = std::chrono::high_resolution_clock::now();
-	auto currentTime = std::chrono::high_resolution_clock::now();
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
 
-	float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+	m_mapInstancedShaderModule.clear();
 
+	for (const auto& stage : vecShaderStage)
+	{
+		m_mapInstancedShaderModule[stage] = CreateShaderModuleByName("Instanced", stage);
+	}
+}
 
-	m_UboData.view = m_Camera.GetViewMatrix();
-	m_UboData.proj = m_Camera.GetProjMatrix();
+void VulkanRenderer::CreateInstancedPipelineLayout()
+{
+	//view projɫͨpush constant룬ʵȫvertex binding 1Ҫdescriptor set
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(InstancedPushConstant);
 
-	void* uniformBufferData;
-	vkMapMemory(m_LogicalDevice, m_vecUniformBufferMemories[uiIdx], 0, m_UboBufferSize, 0, &uniformBufferData);
-	memcpy(uniformBufferData, &m_UboData, m_UboBufferSize);
-	vkUnmapMemory(m_LogicalDevice, m_vecUniformBufferMemories[uiIdx]);
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 0;
+	pipelineLayoutCreateInfo.pSetLayouts = nullptr;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
 
-	glm::mat4* pModelMat = nullptr;
-	float* pTextureIdx = nullptr;
-	for (UINT i = 0; i < INSTANCE_NUM; ++i)
-	{
-		ASSERT(i < m_vecPlanetInfo.size());
-		auto planetInfo = m_vecPlanetInfo[i];
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_InstancedPipelineLayout), "Create instanced pipeline layout failed");
+}
 
-		pModelMat = (glm::mat4*)((size_t)m_DynamicUboData.model + (i * m_DynamicAlignment));
+void VulkanRenderer::CreateInstancedPipeline()
+{
+	/****************************ɱ̹*******************************/
+	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
+	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	vertShaderStageCreateInfo.module = m_mapInstancedShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT);
+	vertShaderStageCreateInfo.pName = "main";
 
-		//auto translateComponent = glm::translate(glm::mat4(1.f), { planetInfo.fOrbitRadius * 100.f, 0.f, 0.f });
-		//auto rotateComponent = glm::rotate(glm::mat4(1.f), glm::radians(planetInfo.fRotationAxisDegree), { 0.f, 0.f, -1.f });
-		//auto scaleComponent = glm::scale(glm::mat4(1.f), glm::vec3(static_cast<float>(planetInfo.fDiameter / 100.f)));
+	VkPipelineShaderStageCreateInfo fragShaderStageCreateInfo{};
+	fragShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	fragShaderStageCreateInfo.module = m_mapInstancedShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT);
+	fragShaderStageCreateInfo.pName = "main";
 
-		//*pModelMat = translateComponent * rotateComponent * scaleComponent;
-		*pModelMat = glm::translate(glm::mat4(1.f), { (float)i * 10.f, 0.f, 0.f});
-		
-		pTextureIdx = (float*)((size_t)m_DynamicUboData.fTextureIndex + (i * m_DynamicAlignment));
-		*pTextureIdx = (float)(i % INSTANCE_NUM);
-	}
+	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
+		vertShaderStageCreateInfo,
+		fragShaderStageCreateInfo,
+	};
 
-	void* dynamicUniformBufferData;
-	vkMapMemory(m_LogicalDevice, m_vecDynamicUniformBufferMemories[uiIdx], 0, m_DynamicUboBufferSize, 0, &dynamicUniformBufferData);
-	memcpy(dynamicUniformBufferData, m_DynamicUboData.model, m_DynamicUboBufferSize);
-	vkUnmapMemory(m_LogicalDevice, m_vecDynamicUniformBufferMemories[uiIdx]);
-}
+	/*****************************̶*******************************/
 
-void VulkanRenderer::Render()
-{	
-	if (!ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow) && !ImGui::IsAnyItemActive())
-		m_Camera.Tick();
+	//-----------------------Dynamic State--------------------------//
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
+	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	std::vector<VkDynamicState> vecDynamicStates = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+	};
+	dynamicStateCreateInfo.dynamicStateCount = static_cast<UINT>(vecDynamicStates.size());
+	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
 
-	//ȴfenceֵΪsignaled
-	vkWaitForFences(m_LogicalDevice, 1, &m_vecInFlightFences[m_uiCurFrameIdx], VK_TRUE, UINT64_MAX);
+	//-----------------------Vertex Input State--------------------------//
+	//binding 0: Vertex3Dbinding 1: InstanceDataʵlocation 4~6Ϊģ;
+	std::array<VkVertexInputBindingDescription, 2> aryBindingDescription = {
+		Vertex3D::GetBindingDescription(),
+		GetInstanceBindingDescription(),
+	};
 
-	if (m_bNeedResize)
-	{
-		WindowResize();
-		m_bNeedResize = false;
-	}
+	auto vertexAttributeDescriptions = Vertex3D::GetAttributeDescriptions();
+	auto instanceAttributeDescriptions = GetInstanceAttributeDescriptions();
+	std::vector<VkVertexInputAttributeDescription> vecAttributeDescription(vertexAttributeDescriptions.begin(), vertexAttributeDescriptions.end());
+	vecAttributeDescription.insert(vecAttributeDescription.end(), instanceAttributeDescriptions.begin(), instanceAttributeDescriptions.end());
 
-	g_UI.StartNewFrame();
+	VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
+	vertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInputCreateInfo.vertexBindingDescriptionCount = static_cast<UINT>(aryBindingDescription.size());
+	vertexInputCreateInfo.pVertexBindingDescriptions = aryBindingDescription.data();
+	vertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<UINT>(vecAttributeDescription.size());
+	vertexInputCreateInfo.pVertexAttributeDescriptions = vecAttributeDescription.data();
 
-	uint32_t uiImageIdx;
-	VkResult res = vkAcquireNextImageKHR(m_LogicalDevice, m_SwapChain, UINT64_MAX,
-		m_vecImageAvailableSemaphores[m_uiCurFrameIdx], VK_NULL_HANDLE, &uiImageIdx);
-	if (res != VK_SUCCESS)
-	{
-		if (res == VK_ERROR_OUT_OF_DATE_KHR)
-		{
-			//SwapChainWindowSurfaceݣ޷Ⱦ
-			//һ㷢windowߴıʱ
-			m_bNeedResize = true;
-			return;
-		}
-		else if (res == VK_SUBOPTIMAL_KHR)
-		{
-			//SwapChainȻãWindowSurfacepropertiesȫƥ
-		}
-		else
-		{
-			ASSERT(false, "Accquire next swap chain image failed");
-		}
-	}
+	//-----------------------Input Assembly State------------------------//
+	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
+	inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
-	//fenceΪunsignaled
-	vkResetFences(m_LogicalDevice, 1, &m_vecInFlightFences[m_uiCurFrameIdx]);
+	//-----------------------Viewport State--------------------------//
+	VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
+	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportStateCreateInfo.viewportCount = 1;
+	viewportStateCreateInfo.scissorCount = 1;
 
-	vkResetCommandBuffer(m_vecCommandBuffers[m_uiCurFrameIdx], 0);
+	//-----------------------Raserization State--------------------------//
+	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{};
+	rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
+	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizationStateCreateInfo.lineWidth = 1.f;
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
 
-	RecordCommandBuffer(m_vecCommandBuffers[m_uiCurFrameIdx], m_uiCurFrameIdx);
+	//-----------------------Multisample State--------------------------//
+	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
+	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisamplingStateCreateInfo.sampleShadingEnable = VK_FALSE;
+	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+	multisamplingStateCreateInfo.minSampleShading = 1.f;
+	multisamplingStateCreateInfo.pSampleMask = nullptr;
+	multisamplingStateCreateInfo.alphaToCoverageEnable = VK_FALSE;
+	multisamplingStateCreateInfo.alphaToOneEnable = VK_FALSE;
 
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	//-----------------------Depth Stencil State--------------------------//
+	VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
+	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
+	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
+	depthStencilStateCreateInfo.minDepthBounds = 0.f;
+	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
+	depthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
 
-	VkSemaphore waitSemaphores[] = {
-		m_vecImageAvailableSemaphores[m_uiCurFrameIdx],
-	};
-	VkPipelineStageFlags waitStages[] = {
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-	};
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+	//-----------------------Color Blend State--------------------------//
+	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+	colorBlendAttachment.colorWriteMask =
+		VK_COLOR_COMPONENT_R_BIT
+		| VK_COLOR_COMPONENT_G_BIT
+		| VK_COLOR_COMPONENT_B_BIT
+		| VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.blendEnable = VK_FALSE;
 
-	std::vector<VkCommandBuffer> commandBuffers = {
-		m_vecCommandBuffers[m_uiCurFrameIdx],
-		//uiCommandBuffer,
-	};
-	submitInfo.commandBufferCount = static_cast<UINT>(commandBuffers.size());
-	submitInfo.pCommandBuffers = commandBuffers.data();
+	VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo{};
+	colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+	colorBlendStateCreateInfo.attachmentCount = 1;
+	colorBlendStateCreateInfo.pAttachments = &colorBlendAttachment;
 
-	VkSemaphore signalSemaphore[] = {
-		m_vecRenderFinishedSemaphores[m_uiCurFrameIdx],
-	};
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphore;
+	/***********************************************************************/
+	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapInstancedShaderModule.size());
+	pipelineCreateInfo.pStages = shaderStageCreateInfos;
+	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
+	pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+	pipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+	pipelineCreateInfo.pRasterizationState = &rasterizationStateCreateInfo;
+	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
+	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
+	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
+	pipelineCreateInfo.layout = m_InstancedPipelineLayout;
+	pipelineCreateInfo.renderPass = m_RenderPass;
+	pipelineCreateInfo.subpass = 0;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
 
-	//submit֮󣬻ὫfenceΪsignaled
-	VULKAN_ASSERT(vkQueueSubmit(m_GraphicQueue, 1, &submitInfo, m_vecInFlightFences[m_uiCurFrameIdx]), "Submit command buffer failed");
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_InstancedPipeline), "Create instanced pipeline failed");
+}
 
-	VkPresentInfoKHR presentInfo{};
-	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalSemaphore;
+void VulkanRenderer::CreateShadowMapResource()
+{
+	CreateShadowMapImage();
+	CreateShadowMapSampler();
+	CreateShadowMapRenderPass();
+	CreateShadowMapFrameBuffer();
+	CreateShadowMapUniformBufferAndMemory();
+	CreateShadowMapShaderModule();
+	CreateShadowMapDescriptorSetLayout();
+	CreateShadowMapDescriptorPool();
+	CreateShadowMapDescriptorSet();
+	CreateShadowMapPipelineLayout();
+	CreateShadowMapPipeline();
+}
 
-	std::vector<VkSwapchainKHR> vecSwapChains = {
-		m_SwapChain,
-	};
+void VulkanRenderer::CreateShadowMapImage()
+{
+	//Image, ImageView, Memory
+	//ÿcascadeռһ
+	CreateImageAndBindMemory(m_ShadowMapExtent2D.width, m_ShadowMapExtent2D.height,
+		1, SHADOW_CASCADE_MAX, 1,
+		VK_SAMPLE_COUNT_1_BIT,
+		m_ShadowMapFormat,
+		VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, //sampler
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_ShadowMapDepthImage, m_ShadowMapDepthImageMemory);
 
-	std::vector<UINT> vecImageIndices = {
-		uiImageIdx,
-	};
-	presentInfo.swapchainCount = static_cast<UINT>(vecSwapChains.size());
-	presentInfo.pSwapchains = vecSwapChains.data();
-	presentInfo.pImageIndices = vecImageIndices.data();
-	presentInfo.pResults = nullptr;
+	m_ShadowMapDepthImageView = CreateImageView(m_ShadowMapDepthImage, m_ShadowMapFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, SHADOW_CASCADE_MAX, 1);
 
-	res = vkQueuePresentKHR(m_PresentQueue, &presentInfo);
-	if (res != VK_SUCCESS)
+	//viewΪÿcascade framebufferattachment
+	for (UINT i = 0; i < SHADOW_CASCADE_MAX; ++i)
 	{
-		if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR || m_bFrameBufferResized)
-		{
-			m_bNeedResize = true;
-			m_bFrameBufferResized = false;
-		}
-		else
-		{
-			throw std::runtime_error("Present Swap Chain Image To Queue Failed");
-		}
+		VkImageViewCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		createInfo.image = m_ShadowMapDepthImage;
+		createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		createInfo.format = m_ShadowMapFormat;
+		createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+		createInfo.subresourceRange.baseMipLevel = 0;
+		createInfo.subresourceRange.levelCount = 1;
+		createInfo.subresourceRange.baseArrayLayer = i;
+		createInfo.subresourceRange.layerCount = 1;
+
+		VULKAN_ASSERT(vkCreateImageView(m_LogicalDevice, &createInfo, nullptr, &m_aryShadowMapCascadeImageView[i]), "Create shadow map cascade image view failed");
 	}
 
-	m_uiFrameCounter++;
-
-	m_uiCurFrameIdx = (m_uiCurFrameIdx + 1) % static_cast<UINT>(m_vecSwapChainImages.size());
+	//render passfinalLayoutһ£ǰԴǷʱCSMᱻȾcommon descriptor setԸò
+	ChangeImageLayout(m_ShadowMapDepthImage, m_ShadowMapFormat,
+		1, SHADOW_CASCADE_MAX, 1,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
 }
 
-void VulkanRenderer::WindowResize()
+void VulkanRenderer::CreateShadowMapSampler()
 {
-	//⴦С
-	int nWidth = 0;
-	int nHeight = 0;
-	glfwGetFramebufferSize(m_pWindow, &nWidth, &nHeight);
-	while (nWidth == 0 || nHeight == 0)
-	{
-		glfwGetFramebufferSize(m_pWindow, &nWidth, &nHeight);
-		glfwWaitEvents();
-	}
-
-	m_Camera.SetViewportSize(static_cast<float>(nWidth), static_cast<float>(nHeight));
+	//Sampler
+	VkSamplerCreateInfo sampler = {};
+	sampler.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	sampler.magFilter = VK_FILTER_LINEAR;
+	sampler.minFilter = VK_FILTER_LINEAR;
+	sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	sampler.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	sampler.addressModeV = sampler.addressModeU;
+	sampler.addressModeW = sampler.addressModeU;
+	sampler.mipLodBias = 0.0f;
+	sampler.maxAnisotropy = 1.0f;
+	sampler.minLod = 0.0f;
+	sampler.maxLod = 1.0f;
+	sampler.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	VULKAN_ASSERT(vkCreateSampler(m_LogicalDevice, &sampler, nullptr, &m_ShadowMapSampler));
+}
 
-	//ҪؽԴ
-	//1. ʹڴСصģDepth(Image, Memory, ImageView)SwapChain ImageViewport/Scissors
-	//2. DepthImageViewģFrameBuffer
-	//3. SwapChain ImageģFrameBuffer
-	//4. FrameBufferģCommandBuffer(RenderPassBeginInfo)
-	//5. ViewportScissorsģPipelineviewport/scissordynamic
-	//6. ɫʽɫʿռ䷢˱仯RenderPass
-	//7. SwapChainеImageCount˱仯صĸͬfencesemaphore
+void VulkanRenderer::CreateShadowMapRenderPass()
+{
+	//Render Pass
+	VkAttachmentDescription attachmentDescription{};
+	attachmentDescription.format = m_ShadowMapFormat;
+	attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
+	attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE; //Ⱦ
+	attachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachmentDescription.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
-	vkDeviceWaitIdle(m_LogicalDevice);
+	VkAttachmentReference depthReference = {};
+	depthReference.attachment = 0;
+	depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-	//swap cain
-	CreateSwapChain(); //ڴپɵSwapChain
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 0;
+	subpass.pDepthStencilAttachment = &depthReference; //ûcolor attachmentֻһdepth attachment
 
-	//depth
-	vkDestroyImageView(m_LogicalDevice, m_DepthImageView, nullptr);
-	vkDestroyImage(m_LogicalDevice, m_DepthImage, nullptr);
-	vkFreeMemory(m_LogicalDevice, m_DepthImageMemory, nullptr);
-	CreateDepthImage();
-	CreateDepthImageView();
+	std::array<VkSubpassDependency, 2> dependencies = {};
 
-	//image views
-	for (const auto& imageView : m_vecSwapChainImageViews)
-	{
-		vkDestroyImageView(m_LogicalDevice, imageView, nullptr);
-	}
-	CreateSwapChainImages();
-	CreateSwapChainImageViews();
+	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[0].dstSubpass = 0;
+	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
-	//frame buffers
-	for (const auto& frameBuffer : m_vecSwapChainFrameBuffers)
-	{
-		vkDestroyFramebuffer(m_LogicalDevice, frameBuffer, nullptr);
-	}
-	CreateSwapChainFrameBuffers();
+	dependencies[1].srcSubpass = 0;
+	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
-	//UI
-	g_UI.Resize();
+	VkRenderPassCreateInfo renderPassCreateInfo = {};
+	renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount = 1;
+	renderPassCreateInfo.pAttachments = &attachmentDescription;
+	renderPassCreateInfo.subpassCount = 1;
+	renderPassCreateInfo.pSubpasses = &subpass;
+	renderPassCreateInfo.dependencyCount = static_cast<UINT>(dependencies.size());
+	renderPassCreateInfo.pDependencies = dependencies.data();
 
-	//command buffers
-	vkFreeCommandBuffers(m_LogicalDevice, m_CommandPool,
-		static_cast<UINT>(m_vecCommandBuffers.size()),
-		m_vecCommandBuffers.data());
-	
-	CreateCommandBuffers();
+	VULKAN_ASSERT(vkCreateRenderPass(m_LogicalDevice, &renderPassCreateInfo, nullptr, &m_ShadowMapRenderPass), "Create shadow map renderpass failed");
 }
 
-void VulkanRenderer::CreatePointLightResource()
+void VulkanRenderer::CreateShadowMapFrameBuffer()
 {
-	m_PointLightModel = DZW_VulkanWrap::ModelFactor::CreateModel(this, "./Assert/Model/sphere_lowpoly.obj");
-	CreatePointLightUniformBufferAndMemory();
-	CreatePointLightShaderModule();
-	CreatePointLightDescriptorSetLayout();
-	CreatePointLightDescriptorPool();
-	CreatePointLightDescriptorSet();
-	CreatePointLightPipelineLayout();
-	CreatePointLightPipeline();
+	//FrameBufferÿcascadeһ
+	for (UINT i = 0; i < SHADOW_CASCADE_MAX; ++i)
+	{
+		VkFramebufferCreateInfo fbufCreateInfo = {};
+		fbufCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		fbufCreateInfo.renderPass = m_ShadowMapRenderPass;
+		fbufCreateInfo.attachmentCount = 1;
+		fbufCreateInfo.pAttachments = &m_aryShadowMapCascadeImageView[i];
+		fbufCreateInfo.width = m_ShadowMapExtent2D.width;
+		fbufCreateInfo.height = m_ShadowMapExtent2D.height;
+		fbufCreateInfo.layers = 1;
+		VULKAN_ASSERT(vkCreateFramebuffer(m_LogicalDevice, &fbufCreateInfo, nullptr, &m_aryShadowMapFrameBuffer[i]), "Create shadow map frameBuffer failed");
+	}
 }
 
-void VulkanRenderer::CreatePointLightUniformBufferAndMemory()
+void VulkanRenderer::CreateShadowMapUniformBufferAndMemory()
 {
-	CreateBufferAndBindMemory(sizeof(MVPUniformBufferObject),
+	CreateBufferAndBindMemory(sizeof(ShadowCascadeUniformBufferObject),
 		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
 		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		m_PointLightUniformBuffer,
-		m_PointLightUniformBufferMemory
+		m_ShadowMapUniformBuffer,
+		m_ShadowMapUniformBufferMemory
 	);
 }
 
-void VulkanRenderer::UpdatePointLight()
+void VulkanRenderer::UpdateShadowMapUniformBuffer()
 {
-	static auto lastTime = std::chrono::high_resolution_clock::now();
-	auto currentTime = std::chrono::high_resolution_clock::now();
-
-	float deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - lastTime).count();
-
-	lastTime = currentTime;
+	//ƽй⴦ԭȵԴĽ
+	glm::vec3 lightFocus = { -13.39, -6.80, 12.21 };
+	glm::vec3 lightDir = glm::normalize(lightFocus - m_PointLight.position);
+	glm::vec3 lightUp = { -0.11, 0.99, 0.10 };
+	if (std::abs(glm::dot(lightDir, glm::normalize(lightUp))) > 0.99f)
+		lightUp = { 0.f, 0.f, 1.f };
+
+	m_nShadowCascadeCount = std::clamp(m_nShadowCascadeCount, 1, static_cast<int>(SHADOW_CASCADE_MAX));
+	UINT uiCascadeCount = static_cast<UINT>(m_nShadowCascadeCount);
+
+	//Practical Split Schemeззְlambda
+	float fNearClip = m_Camera.GetNearClip();
+	float fFarClip = m_Camera.GetFarClip();
+	float fClipRange = fFarClip - fNearClip;
+	float fClipRatio = fFarClip / fNearClip;
+
+	std::array<float, SHADOW_CASCADE_MAX> arySplit{};
+	for (UINT i = 0; i < uiCascadeCount; ++i)
+	{
+		float p = static_cast<float>(i + 1) / static_cast<float>(uiCascadeCount);
+		float fLog = fNearClip * std::pow(fClipRatio, p);
+		float fUniform = fNearClip + fClipRange * p;
+		float fDistance = m_fShadowCascadeSplitLambda * (fLog - fUniform) + fUniform;
+		arySplit[i] = (fDistance - fNearClip) / fClipRange;
+	}
 
-	static float fDegree = 0.f;
-	fDegree += deltaTime * 10.f;
+	ShadowCascadeUniformBufferObject uboData{};
+	std::array<float, SHADOW_CASCADE_MAX> arySplitDepth{};
+	//reversed-ZԶͶӰ޷Զƽǵ㣬ʹͬӽǵͶӰ
+	glm::mat4 invViewProj = glm::inverse(m_Camera.GetFiniteProjMatrix() * m_Camera.GetViewMatrix());
+	float fHalfShadowMapSize = static_cast<float>(m_ShadowMapExtent2D.width) * 0.5f;
 
-	auto rotate = glm::rotate(glm::mat4(1.f), glm::radians(fDegree), { 0.0, 1.0, 0.0 });
-	m_PointLight.color = { 1.0, 1.0, 1.0, 1.0 };
-	//m_PointLight.position = glm::vec3(rotate * glm::vec4(5.0, -5.0, 5.0, 1.0));
+	float fLastSplit = 0.f;
+	for (UINT i = 0; i < uiCascadeCount; ++i)
+	{
+		std::array<glm::vec3, 8> aryCorner = {
+			glm::vec3(-1.f,  1.f, 0.f), glm::vec3(1.f,  1.f, 0.f), glm::vec3(1.f, -1.f, 0.f), glm::vec3(-1.f, -1.f, 0.f),
+			glm::vec3(-1.f,  1.f, 1.f), glm::vec3(1.f,  1.f, 1.f), glm::vec3(1.f, -1.f, 1.f), glm::vec3(-1.f, -1.f, 1.f),
+		};
+		for (auto& corner : aryCorner)
+		{
+			glm::vec4 worldCorner = invViewProj * glm::vec4(corner, 1.f);
+			corner = glm::vec3(worldCorner) / worldCorner.w;
+		}
+		//ȡ[fLastSplit, arySplit[i]]֮׶
+		for (UINT j = 0; j < 4; ++j)
+		{
+			glm::vec3 edge = aryCorner[j + 4] - aryCorner[j];
+			aryCorner[j + 4] = aryCorner[j] + edge * arySplit[i];
+			aryCorner[j] = aryCorner[j] + edge * fLastSplit;
+		}
 
-	m_PointLight.position = { -20.68, -8.31, 18.88 };
+		//ʹðΧ򣬰뾶޹أתʱͶӰΧ
+		glm::vec3 center = glm::vec3(0.f);
+		for (const auto& corner : aryCorner)
+			center += corner;
+		center /= 8.f;
+
+		float fRadius = 0.f;
+		for (const auto& corner : aryCorner)
+			fRadius = std::max(fRadius, glm::length(corner - center));
+		fRadius = std::ceil(fRadius * 16.f) / 16.f;
+
+		glm::mat4 lightView = glm::lookAt(center - lightDir * fRadius, center, lightUp);
+
+		//ƽԶcasterλڹԴ׶֮ҲͶӰ
+		float fMinDepth = 0.f;
+		CullShadowCascadeCasters(i, lightView, fRadius, fMinDepth);
+		glm::mat4 lightProj = glm::ortho(-fRadius, fRadius, -fRadius, fRadius, fMinDepth, 2.f * fRadius);
+
+		//Texel Snappingԭ뵽texelϣƽʱӰԵ˸
+		glm::vec4 shadowOrigin = lightProj * lightView * glm::vec4(0.f, 0.f, 0.f, 1.f);
+		shadowOrigin *= fHalfShadowMapSize;
+		glm::vec4 roundOffset = (glm::round(shadowOrigin) - shadowOrigin) / fHalfShadowMapSize;
+		lightProj[3][0] += roundOffset.x;
+		lightProj[3][1] += roundOffset.y;
+
+		uboData.viewProj[i] = lightProj * lightView;
+		arySplitDepth[i] = fNearClip + arySplit[i] * fClipRange;
+		fLastSplit = arySplit[i];
+	}
 
-	auto model = glm::translate(glm::mat4(1.f), m_PointLight.position);
-	auto& view = m_Camera.GetViewMatrix();
-	auto& proj = m_Camera.GetProjMatrix();
+	//Դcascadeδ仯ʱҪUBOshadow mapҲԸ
+	if (m_uiShadowMapRenderedLightVersion != 0
+		&& memcmp(&uboData, &m_ShadowMapUBOData, sizeof(ShadowCascadeUniformBufferObject)) == 0
+		&& arySplitDepth == m_aryShadowCascadeSplitDepth)
+		return;
 
-	m_PointLightUBOData.mvp = proj * view * model;
+	m_ShadowMapUBOData = uboData;
+	m_aryShadowCascadeSplitDepth = arySplitDepth;
+	++m_uiShadowLightVersion;
 
 	void* uniformBufferData;
-	vkMapMemory(m_LogicalDevice, m_PointLightUniformBufferMemory, 0, sizeof(MVPUniformBufferObject), 0, &uniformBufferData);
-	memcpy(uniformBufferData, &m_PointLightUBOData, sizeof(MVPUniformBufferObject));
-	vkUnmapMemory(m_LogicalDevice, m_PointLightUniformBufferMemory);
+	vkMapMemory(m_LogicalDevice, m_ShadowMapUniformBufferMemory, 0, sizeof(ShadowCascadeUniformBufferObject), 0, &uniformBufferData);
+	memcpy(uniformBufferData, &m_ShadowMapUBOData, sizeof(ShadowCascadeUniformBufferObject));
+	vkUnmapMemory(m_LogicalDevice, m_ShadowMapUniformBufferMemory);
 }
 
-void VulkanRenderer::CreatePointLightShaderModule()
+void VulkanRenderer::CullShadowCascadeCasters(UINT uiCascadeIdx, const glm::mat4& lightView, float fRadius, float& fMinDepth)
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapShaderPath = {
-	{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/PointLight/vert.spv" },
-	{ VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/PointLight/frag.spv" },
+	auto& vecCasters = m_aryShadowCascadeCasters[uiCascadeIdx];
+	vecCasters.clear();
 
-	};
-	ASSERT(mapShaderPath.size() > 0, "Detect no shader spv file");
+	if (!m_testObjModel)
+		return;
 
-	m_mapPointLightShaderModule.clear();
+	//texel snappingƫһtexel޳Χһtexel
+	float fExtent = fRadius + 2.f * fRadius / static_cast<float>(m_ShadowMapExtent2D.width);
+	float fMaxDepth = 2.f * fRadius;
 
-	for (const auto& spvPath : mapShaderPath)
+	const auto& vecSubMeshes = m_testObjModel->m_vecSubMeshes;
+	for (UINT i = 0; i < static_cast<UINT>(vecSubMeshes.size()); ++i)
 	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
-
-		m_mapPointLightShaderModule[spvPath.first] = shaderModule;
-	}
-}
+		const auto& subMesh = vecSubMeshes[i];
 
-void VulkanRenderer::CreatePointLightDescriptorSetLayout()
-{
-	//MVP UBO Binding
-	VkDescriptorSetLayoutBinding MVPUBOLayoutBinding{};
-	MVPUBOLayoutBinding.binding = 0;
-	MVPUBOLayoutBinding.descriptorCount = 1;
-	MVPUBOLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	MVPUBOLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-	MVPUBOLayoutBinding.pImmutableSamplers = nullptr;
+		//Χе8任Դռ
+		glm::vec3 lightMin = glm::vec3(FLT_MAX);
+		glm::vec3 lightMax = glm::vec3(-FLT_MAX);
+		for (UINT uiCorner = 0; uiCorner < 8; ++uiCorner)
+		{
+			glm::vec3 corner = {
+				(uiCorner & 1) ? subMesh.boundMax.x : subMesh.boundMin.x,
+				(uiCorner & 2) ? subMesh.boundMax.y : subMesh.boundMin.y,
+				(uiCorner & 4) ? subMesh.boundMax.z : subMesh.boundMin.z,
+			};
+			glm::vec3 lightCorner = glm::vec3(lightView * glm::vec4(corner, 1.f));
+			lightMin = glm::min(lightMin, lightCorner);
+			lightMax = glm::max(lightMax, lightCorner);
+		}
 
-	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
-		MVPUBOLayoutBinding,
-	};
+		if (lightMax.x < -fExtent || lightMin.x > fExtent || lightMax.y < -fExtent || lightMin.y > fExtent)
+			continue;
 
-	VkDescriptorSetLayoutCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
-	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+		//Դռ-z۲죬depth = -zλ׶֮岻Ͷ䵽
+		if (-lightMax.z > fMaxDepth)
+			continue;
 
-	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_PointLightDescriptorSetLayout), "Create point light descriptor layout failed");
+		fMinDepth = std::min(fMinDepth, -lightMax.z);
+		vecCasters.push_back(i);
+	}
 }
 
-void VulkanRenderer::CreatePointLightDescriptorPool()
+bool VulkanRenderer::IsShadowMapDirty()
 {
-	VkDescriptorPoolSize MVPUBOPoolSize{};
-	MVPUBOPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	MVPUBOPoolSize.descriptorCount = 1;
-
-	std::vector<VkDescriptorPoolSize> vecPoolSize = {
-		MVPUBOPoolSize,
-	};
-
-	VkDescriptorPoolCreateInfo poolCreateInfo{};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
-	poolCreateInfo.pPoolSizes = vecPoolSize.data();
-	poolCreateInfo.maxSets = 1;
+	if (!m_bEnableShadowCache)
+		return true;
 
-	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_PointLightDescriptorPool), "Create point light descriptor pool failed");
+	return m_nShadowMapRenderedLightType != m_nShadowLightType
+		|| m_uiShadowMapRenderedLightVersion != m_uiShadowLightVersion
+		|| m_uiShadowMapRenderedCasterVersion != m_uiShadowCasterVersion;
 }
 
-void VulkanRenderer::CreatePointLightDescriptorSet()
+void VulkanRenderer::CreateShadowMapShaderModule()
 {
-	VkDescriptorSetAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	allocInfo.descriptorSetCount = 1;
-	allocInfo.descriptorPool = m_PointLightDescriptorPool;
-	allocInfo.pSetLayouts = &m_PointLightDescriptorSetLayout;
-
-	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, &m_PointLightDescriptorSet), "Allocate point light desctiprot sets failed");
-
-	VkDescriptorBufferInfo MVPDescriptorBufferInfo{};
-	MVPDescriptorBufferInfo.buffer = m_PointLightUniformBuffer;
-	MVPDescriptorBufferInfo.offset = 0;
-	MVPDescriptorBufferInfo.range = sizeof(MVPUniformBufferObject);
-
-	VkWriteDescriptorSet MVPUBOWrite{};
-	MVPUBOWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	MVPUBOWrite.dstSet = m_PointLightDescriptorSet;
-	MVPUBOWrite.dstBinding = 0;
-	MVPUBOWrite.dstArrayElement = 0;
-	MVPUBOWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	MVPUBOWrite.descriptorCount = 1;
-	MVPUBOWrite.pBufferInfo = &MVPDescriptorBufferInfo;
-
-	std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
-		MVPUBOWrite,
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
 	};
 
-	vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
+	m_mapShadowMapShaderModule.clear();
+
+	for (const auto& stage : vecShaderStage)
+	{
+		m_mapShadowMapShaderModule[stage] = CreateShaderModuleByName("ShadowMap", stage);
+	}
 }
 
-void VulkanRenderer::CreatePointLightPipelineLayout()
+void VulkanRenderer::CreateShadowMapPipelineLayout()
 {
+	VkPushConstantRange cascadePushConstantRange = {};
+	cascadePushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	cascadePushConstantRange.offset = 0;
+	cascadePushConstantRange.size = sizeof(UINT); //cascade index
+
 	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
 	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutCreateInfo.setLayoutCount = 1;
-	pipelineLayoutCreateInfo.pSetLayouts = &m_PointLightDescriptorSetLayout;
-	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_ShadowMapDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &cascadePushConstantRange;
 
-	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_PointLightPipelineLayout), "Create point light pipeline layout failed");
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_ShadowMapPipelineLayout), "Create shadow map pipeline layout failed");
 }
 
-void VulkanRenderer::CreatePointLightPipeline()
+void VulkanRenderer::CreateShadowMapPipeline()
 {
 	/****************************ɱ̹*******************************/
 	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
 	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageCreateInfo.module = m_mapPointLightShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
+	vertShaderStageCreateInfo.module = m_mapShadowMapShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
 	vertShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
 
-	VkPipelineShaderStageCreateInfo fragShaderStageCreateInfo{};
-	fragShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	fragShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageCreateInfo.module = m_mapPointLightShaderModule.at(VK_SHADER_STAGE_FRAGMENT_BIT); //Bytecode
-	fragShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
-
 	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
 		vertShaderStageCreateInfo,
-		fragShaderStageCreateInfo,
 	};
 
 	/*****************************̶*******************************/
 
 	//-----------------------Dynamic State--------------------------//
+	//һὫViewportScissorΪdynamicԷʱ޸
 	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
 	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+
 	std::vector<VkDynamicState> vecDynamicStates = {
 		VK_DYNAMIC_STATE_VIEWPORT,
 		VK_DYNAMIC_STATE_SCISSOR,
+		VK_DYNAMIC_STATE_DEPTH_BIAS,
 	};
 	dynamicStateCreateInfo.dynamicStateCount = static_cast<UINT>(vecDynamicStates.size());
 	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
 
+
 	//-----------------------Vertex Input State--------------------------//
 	auto bindingDescription = Vertex3D::GetBindingDescription();
 	auto attributeDescriptions = Vertex3D::GetAttributeDescriptions();
@@ -3622,9 +5715,9 @@ void VulkanRenderer::CreatePointLightPipeline()
 	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;	//󣬽ֹͼԪդ
 	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;	//ͼԪģʽFILLLINEPOINT
 	rasterizationStateCreateInfo.lineWidth = 1.f;	//ָդ߶ο
-	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
-	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //򣬿˳ʱcwʱccw
-	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE; //ƫƣһShaodw MapбӰ
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;	//޳ģʽNONEFRONTBACKFRONT_AND_BACK
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE; //򣬿˳ʱcwʱccw
+	rasterizationStateCreateInfo.depthBiasEnable = VK_TRUE; //ƫƣһShaodw MapбӰ
 	rasterizationStateCreateInfo.depthBiasConstantFactor = 0.f;
 	rasterizationStateCreateInfo.depthBiasClamp = 0.f;
 	rasterizationStateCreateInfo.depthBiasSlopeFactor = 0.f;
@@ -3632,7 +5725,7 @@ void VulkanRenderer::CreatePointLightPipeline()
 	//-----------------------Multisample State--------------------------//
 	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
 	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisamplingStateCreateInfo.sampleShadingEnable = VK_FALSE;
+	multisamplingStateCreateInfo.sampleShadingEnable = false;
 	multisamplingStateCreateInfo.minSampleShading = 0.8f;
 	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 	multisamplingStateCreateInfo.minSampleShading = 1.f;
@@ -3658,23 +5751,8 @@ void VulkanRenderer::CreatePointLightPipeline()
 	colorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 	colorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
 	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-	colorBlendStateCreateInfo.attachmentCount = 1;
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-	colorBlendAttachment.colorWriteMask =
-		VK_COLOR_COMPONENT_R_BIT
-		| VK_COLOR_COMPONENT_G_BIT
-		| VK_COLOR_COMPONENT_B_BIT
-		| VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_FALSE;
-	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-
-	colorBlendStateCreateInfo.pAttachments = &colorBlendAttachment;
+	colorBlendStateCreateInfo.attachmentCount = 0;
+	colorBlendStateCreateInfo.pAttachments = nullptr;
 	colorBlendStateCreateInfo.blendConstants[0] = 0.f;
 	colorBlendStateCreateInfo.blendConstants[1] = 0.f;
 	colorBlendStateCreateInfo.blendConstants[2] = 0.f;
@@ -3683,7 +5761,7 @@ void VulkanRenderer::CreatePointLightPipeline()
 	/***********************************************************************/
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
 	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapPointLightShaderModule.size());
+	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapShadowMapShaderModule.size());
 	pipelineCreateInfo.pStages = shaderStageCreateInfos;
 	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
 	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
@@ -3693,77 +5771,153 @@ void VulkanRenderer::CreatePointLightPipeline()
 	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
 	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
 	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-	pipelineCreateInfo.layout = m_PointLightPipelineLayout;
-	pipelineCreateInfo.renderPass = m_RenderPass;
+	pipelineCreateInfo.layout = m_ShadowMapPipelineLayout;
+	pipelineCreateInfo.renderPass = m_ShadowMapRenderPass;
 	pipelineCreateInfo.subpass = 0;
 	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineCreateInfo.basePipelineIndex = -1;
 
-	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_PointLightPipeline), "Create point light pipeline failed");
+	//ʱṩVkPipelineCacheVulkan᳢Դ
+	//ûпõݣµݻᱻӵ
+	VkPipelineCache pipelineCache = m_CommonGraphicPipelineCache;
+
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_ShadowMapPipeline), "Create shadow map pipeline failed");
 }
 
-void VulkanRenderer::CreateShadowMapResource()
+void VulkanRenderer::CreateShadowMapDescriptorSetLayout()
 {
-	CreateShadowMapImage();
-	CreateShadowMapSampler();
-	CreateShadowMapRenderPass();
-	CreateShadowMapFrameBuffer();
-	CreateShadowMapUniformBufferAndMemory();
-	CreateShadowMapShaderModule();
-	CreateShadowMapDescriptorSetLayout();
-	CreateShadowMapDescriptorPool();
-	CreateShadowMapDescriptorSet();
-	CreateShadowMapPipelineLayout();
-	CreateShadowMapPipeline();
+	//MVP UBO Binding
+	VkDescriptorSetLayoutBinding MVPUBOLayoutBinding{};
+	MVPUBOLayoutBinding.binding = 0;
+	MVPUBOLayoutBinding.descriptorCount = 1;
+	MVPUBOLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	MVPUBOLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	MVPUBOLayoutBinding.pImmutableSamplers = nullptr;
+
+	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
+		MVPUBOLayoutBinding,
+	};
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
+	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_ShadowMapDescriptorSetLayout), "Create shadow map descriptor layout failed");
 }
 
-void VulkanRenderer::CreateShadowMapImage()
+void VulkanRenderer::CreateShadowMapDescriptorPool()
+{
+	VkDescriptorPoolSize MVPUBOPoolSize{};
+	MVPUBOPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	MVPUBOPoolSize.descriptorCount = 1;
+
+	std::vector<VkDescriptorPoolSize> vecPoolSize = {
+		MVPUBOPoolSize,
+	};
+
+	VkDescriptorPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
+	poolCreateInfo.pPoolSizes = vecPoolSize.data();
+	poolCreateInfo.maxSets = 1;
+
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_ShadowMapDescriptorPool), "Create shadow map descriptor pool failed");
+}
+
+void VulkanRenderer::CreateShadowMapDescriptorSet()
+{
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.descriptorPool = m_ShadowMapDescriptorPool;
+	allocInfo.pSetLayouts = &m_ShadowMapDescriptorSetLayout;
+
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, &m_ShadowMapDescriptorSet), "Allocate shadow map desctiprot sets failed");
+
+	VkDescriptorBufferInfo MVPDescriptorBufferInfo{};
+	MVPDescriptorBufferInfo.buffer = m_ShadowMapUniformBuffer;
+	MVPDescriptorBufferInfo.offset = 0;
+	MVPDescriptorBufferInfo.range = sizeof(ShadowCascadeUniformBufferObject);
+
+	VkWriteDescriptorSet MVPUBOWrite{};
+	MVPUBOWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	MVPUBOWrite.dstSet = m_ShadowMapDescriptorSet;
+	MVPUBOWrite.dstBinding = 0;
+	MVPUBOWrite.dstArrayElement = 0;
+	MVPUBOWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	MVPUBOWrite.descriptorCount = 1;
+	MVPUBOWrite.pBufferInfo = &MVPDescriptorBufferInfo;
+
+	std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
+		MVPUBOWrite,
+	};
+
+	vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
+}
+
+void VulkanRenderer::CreateOmniShadowResource()
+{
+	CreateOmniShadowImage();
+	CreateOmniShadowRenderPass();
+	CreateOmniShadowFrameBuffer();
+	CreateOmniShadowUniformBufferAndMemory();
+	CreateOmniShadowShaderModule();
+	CreateOmniShadowDescriptorSetLayout();
+	CreateOmniShadowDescriptorPool();
+	CreateOmniShadowDescriptorSet();
+	CreateOmniShadowPipelineLayout();
+	CreateOmniShadowPipeline();
+}
+
+void VulkanRenderer::CreateOmniShadowImage()
 {
+	//洢ǹһԾ룬ȱD16ߵD32_SFLOAT
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, VK_FORMAT_D32_SFLOAT, &formatProperties);
+	VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+	m_OmniShadowFormat = ((formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures) ? VK_FORMAT_D32_SFLOAT : VK_FORMAT_D16_UNORM;
+
 	//Image, ImageView, Memory
-	CreateImageAndBindMemory(m_ShadowMapExtent2D.width, m_ShadowMapExtent2D.height,
-		1, 1, 1,
+	CreateImageAndBindMemory(m_OmniShadowExtent2D.width, m_OmniShadowExtent2D.height,
+		1, 1, 6,
 		VK_SAMPLE_COUNT_1_BIT,
-		m_ShadowMapFormat,
+		m_OmniShadowFormat,
 		VK_IMAGE_TILING_OPTIMAL,
-		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, //sampler
+		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-		m_ShadowMapDepthImage, m_ShadowMapDepthImageMemory);
+		m_OmniShadowDepthImage, m_OmniShadowDepthImageMemory);
 
-	m_ShadowMapDepthImageView = CreateImageView(m_ShadowMapDepthImage, m_ShadowMapFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1, 1);
+	m_OmniShadowCubeImageView = CreateImageView(m_OmniShadowDepthImage, m_OmniShadowFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1, 6);
 
-	ChangeImageLayout(m_ShadowMapDepthImage, m_ShadowMapFormat,
-		1, 1, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED,
-		VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
-}
+	//layered renderingҪ2D Array͵attachment
+	VkImageViewCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	createInfo.image = m_OmniShadowDepthImage;
+	createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	createInfo.format = m_OmniShadowFormat;
+	createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+	createInfo.subresourceRange.baseMipLevel = 0;
+	createInfo.subresourceRange.levelCount = 1;
+	createInfo.subresourceRange.baseArrayLayer = 0;
+	createInfo.subresourceRange.layerCount = 6;
+	VULKAN_ASSERT(vkCreateImageView(m_LogicalDevice, &createInfo, nullptr, &m_OmniShadowLayeredImageView), "Create omni shadow layered image view failed");
 
-void VulkanRenderer::CreateShadowMapSampler()
-{
-	//Sampler
-	VkSamplerCreateInfo sampler = {};
-	sampler.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-	sampler.magFilter = VK_FILTER_LINEAR;
-	sampler.minFilter = VK_FILTER_LINEAR;
-	sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-	sampler.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-	sampler.addressModeV = sampler.addressModeU;
-	sampler.addressModeW = sampler.addressModeU;
-	sampler.mipLodBias = 0.0f;
-	sampler.maxAnisotropy = 1.0f;
-	sampler.minLod = 0.0f;
-	sampler.maxLod = 1.0f;
-	sampler.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
-	VULKAN_ASSERT(vkCreateSampler(m_LogicalDevice, &sampler, nullptr, &m_ShadowMapSampler));
+	//render passfinalLayoutһ£һȾǰҲԱ
+	ChangeImageLayout(m_OmniShadowDepthImage, m_OmniShadowFormat,
+		1, 1, 6,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
 }
 
-void VulkanRenderer::CreateShadowMapRenderPass()
+void VulkanRenderer::CreateOmniShadowRenderPass()
 {
 	//Render Pass
 	VkAttachmentDescription attachmentDescription{};
-	attachmentDescription.format = m_ShadowMapFormat;
+	attachmentDescription.format = m_OmniShadowFormat;
 	attachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
 	attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE; //Ⱦ
+	attachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 	attachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	attachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	attachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -3776,7 +5930,7 @@ void VulkanRenderer::CreateShadowMapRenderPass()
 	VkSubpassDescription subpass = {};
 	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 	subpass.colorAttachmentCount = 0;
-	subpass.pDepthStencilAttachment = &depthReference; //ûcolor attachmentֻһdepth attachment
+	subpass.pDepthStencilAttachment = &depthReference;
 
 	std::array<VkSubpassDependency, 2> dependencies = {};
 
@@ -3805,109 +5959,261 @@ void VulkanRenderer::CreateShadowMapRenderPass()
 	renderPassCreateInfo.dependencyCount = static_cast<UINT>(dependencies.size());
 	renderPassCreateInfo.pDependencies = dependencies.data();
 
-	VULKAN_ASSERT(vkCreateRenderPass(m_LogicalDevice, &renderPassCreateInfo, nullptr, &m_ShadowMapRenderPass), "Create shadow map renderpass failed");
+	VULKAN_ASSERT(vkCreateRenderPass(m_LogicalDevice, &renderPassCreateInfo, nullptr, &m_OmniShadowRenderPass), "Create omni shadow renderpass failed");
+}
+
+void VulkanRenderer::CreateOmniShadowFrameBuffer()
+{
+	//FrameBufferlayersΪ6gl_Layerѡд
+	VkFramebufferCreateInfo fbufCreateInfo = {};
+	fbufCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	fbufCreateInfo.renderPass = m_OmniShadowRenderPass;
+	fbufCreateInfo.attachmentCount = 1;
+	fbufCreateInfo.pAttachments = &m_OmniShadowLayeredImageView;
+	fbufCreateInfo.width = m_OmniShadowExtent2D.width;
+	fbufCreateInfo.height = m_OmniShadowExtent2D.height;
+	fbufCreateInfo.layers = 6;
+	VULKAN_ASSERT(vkCreateFramebuffer(m_LogicalDevice, &fbufCreateInfo, nullptr, &m_OmniShadowFrameBuffer), "Create omni shadow frameBuffer failed");
+}
+
+void VulkanRenderer::CreateOmniShadowUniformBufferAndMemory()
+{
+	CreateBufferAndBindMemory(sizeof(OmniShadowUniformBufferObject),
+		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_OmniShadowUniformBuffer,
+		m_OmniShadowUniformBufferMemory
+	);
+}
+
+void VulkanRenderer::UpdateOmniShadowUniformBuffer()
+{
+	glm::vec3 lightPos = m_PointLight.position;
+
+	//ĳupҪcube mapĲԼ
+	//VulkanNDCyᳯ£cube maptһ£ͶӰҪתy
+	const std::array<std::pair<glm::vec3, glm::vec3>, 6> aryFaceDirUp = {
+		std::make_pair(glm::vec3( 1.f,  0.f,  0.f), glm::vec3(0.f, -1.f,  0.f)),
+		std::make_pair(glm::vec3(-1.f,  0.f,  0.f), glm::vec3(0.f, -1.f,  0.f)),
+		std::make_pair(glm::vec3( 0.f,  1.f,  0.f), glm::vec3(0.f,  0.f,  1.f)),
+		std::make_pair(glm::vec3( 0.f, -1.f,  0.f), glm::vec3(0.f,  0.f, -1.f)),
+		std::make_pair(glm::vec3( 0.f,  0.f,  1.f), glm::vec3(0.f, -1.f,  0.f)),
+		std::make_pair(glm::vec3( 0.f,  0.f, -1.f), glm::vec3(0.f, -1.f,  0.f)),
+	};
+
+	glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, 0.1f, m_fOmniShadowFarPlane);
+
+	OmniShadowUniformBufferObject uboData{};
+	for (UINT i = 0; i < 6; ++i)
+	{
+		uboData.faceViewProj[i] = proj * glm::lookAt(lightPos, lightPos + aryFaceDirUp[i].first, aryFaceDirUp[i].second);
+	}
+	uboData.lightPos = glm::vec4(lightPos, m_fOmniShadowFarPlane);
+
+	CullOmniShadowCasters(lightPos, uboData.faceViewProj);
+
+	//ԴδƶʱҪUBOshadow mapҲԸ
+	if (m_uiShadowMapRenderedLightVersion != 0
+		&& memcmp(&uboData, &m_OmniShadowUBOData, sizeof(OmniShadowUniformBufferObject)) == 0)
+		return;
+
+	m_OmniShadowUBOData = uboData;
+	++m_uiShadowLightVersion;
+
+	void* uniformBufferData;
+	vkMapMemory(m_LogicalDevice, m_OmniShadowUniformBufferMemory, 0, sizeof(OmniShadowUniformBufferObject), 0, &uniformBufferData);
+	memcpy(uniformBufferData, &m_OmniShadowUBOData, sizeof(OmniShadowUniformBufferObject));
+	vkUnmapMemory(m_LogicalDevice, m_OmniShadowUniformBufferMemory);
+}
+
+void VulkanRenderer::CullOmniShadowCasters(const glm::vec3& lightPos, const glm::mat4* pFaceViewProj)
+{
+	m_vecOmniShadowFaceMask.clear();
+	m_uiOmniShadowDrawnFaceCount = 0;
+
+	if (!m_testObjModel)
+		return;
+
+	const auto& vecSubMeshes = m_testObjModel->m_vecSubMeshes;
+	m_vecOmniShadowFaceMask.resize(vecSubMeshes.size(), 0);
+
+	for (UINT i = 0; i < static_cast<UINT>(vecSubMeshes.size()); ++i)
+	{
+		const auto& subMesh = vecSubMeshes[i];
+
+		//ΧԴĵ㳬far planeκһ涼
+		glm::vec3 closestPoint = glm::clamp(lightPos, subMesh.boundMin, subMesh.boundMax);
+		if (glm::length(closestPoint - lightPos) > m_fOmniShadowFarPlane)
+			continue;
+
+		std::array<glm::vec3, 8> aryCorner;
+		for (UINT uiCorner = 0; uiCorner < 8; ++uiCorner)
+		{
+			aryCorner[uiCorner] = {
+				(uiCorner & 1) ? subMesh.boundMax.x : subMesh.boundMin.x,
+				(uiCorner & 2) ? subMesh.boundMax.y : subMesh.boundMin.y,
+				(uiCorner & 4) ? subMesh.boundMax.z : subMesh.boundMin.z,
+			};
+		}
+
+		UINT uiFaceMask = 0;
+		for (UINT uiFace = 0; uiFace < 6; ++uiFace)
+		{
+			//üռеƽԣ8㶼ͬһƽʱ޳
+			UINT uiOutsideLeft = 0, uiOutsideRight = 0, uiOutsideBottom = 0, uiOutsideTop = 0, uiOutsideNear = 0;
+			for (const auto& corner : aryCorner)
+			{
+				glm::vec4 clipPos = pFaceViewProj[uiFace] * glm::vec4(corner, 1.f);
+				uiOutsideLeft += (clipPos.x < -clipPos.w) ? 1 : 0;
+				uiOutsideRight += (clipPos.x > clipPos.w) ? 1 : 0;
+				uiOutsideBottom += (clipPos.y < -clipPos.w) ? 1 : 0;
+				uiOutsideTop += (clipPos.y > clipPos.w) ? 1 : 0;
+				uiOutsideNear += (clipPos.z < 0.f) ? 1 : 0;
+			}
+
+			if (uiOutsideLeft == 8 || uiOutsideRight == 8 || uiOutsideBottom == 8 || uiOutsideTop == 8 || uiOutsideNear == 8)
+				continue;
+
+			uiFaceMask |= (1u << uiFace);
+			++m_uiOmniShadowDrawnFaceCount;
+		}
+
+		m_vecOmniShadowFaceMask[i] = uiFaceMask;
+	}
+}
+
+void VulkanRenderer::CreateOmniShadowShaderModule()
+{
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_GEOMETRY_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+	};
+
+	m_mapOmniShadowShaderModule.clear();
+
+	for (const auto& stage : vecShaderStage)
+	{
+		m_mapOmniShadowShaderModule[stage] = CreateShaderModuleByName("OmniShadow", stage);
+	}
 }
 
-void VulkanRenderer::CreateShadowMapFrameBuffer()
-{
-	//FrameBuffer
-	VkFramebufferCreateInfo fbufCreateInfo = {};
-	fbufCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-	fbufCreateInfo.renderPass = m_ShadowMapRenderPass;
-	fbufCreateInfo.attachmentCount = 1;
-	fbufCreateInfo.pAttachments = &m_ShadowMapDepthImageView;
-	fbufCreateInfo.width = m_ShadowMapExtent2D.width;
-	fbufCreateInfo.height = m_ShadowMapExtent2D.height;
-	fbufCreateInfo.layers = 1;
-	VULKAN_ASSERT(vkCreateFramebuffer(m_LogicalDevice, &fbufCreateInfo, nullptr, &m_ShadowMapFrameBuffer), "Create shadow map frameBuffer failed");
+void VulkanRenderer::CreateOmniShadowDescriptorSetLayout()
+{
+	//UBO Bindinggeometry shaderʹøVPfragment shaderʹùԴλ
+	VkDescriptorSetLayoutBinding UBOLayoutBinding{};
+	UBOLayoutBinding.binding = 0;
+	UBOLayoutBinding.descriptorCount = 1;
+	UBOLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	UBOLayoutBinding.stageFlags = VK_SHADER_STAGE_GEOMETRY_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	UBOLayoutBinding.pImmutableSamplers = nullptr;
+
+	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
+		UBOLayoutBinding,
+	};
+
+	VkDescriptorSetLayoutCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
+	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+
+	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_OmniShadowDescriptorSetLayout), "Create omni shadow descriptor layout failed");
 }
 
-void VulkanRenderer::CreateShadowMapUniformBufferAndMemory()
+void VulkanRenderer::CreateOmniShadowDescriptorPool()
 {
-	CreateBufferAndBindMemory(sizeof(MVPUniformBufferObject),
-		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		m_ShadowMapUniformBuffer,
-		m_ShadowMapUniformBufferMemory
-	);
-}
+	VkDescriptorPoolSize UBOPoolSize{};
+	UBOPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	UBOPoolSize.descriptorCount = 1;
 
-void VulkanRenderer::UpdateShadowMapUniformBuffer()
-{
-	glm::vec3 lightPos = m_PointLight.position;
-	glm::vec3 lightFocus = { -13.39, -6.80, 12.21 };
+	std::vector<VkDescriptorPoolSize> vecPoolSize = {
+		UBOPoolSize,
+	};
 
-	glm::mat4 model = glm::mat4(1.f);
-	glm::mat4 view = glm::lookAt(lightPos, lightFocus, { -0.11, 0.99, 0.10 });
-	glm::mat4 proj = glm::perspective(glm::radians(45.f), 
-		(float)m_ShadowMapExtent2D.width / (float)m_ShadowMapExtent2D.height,
-		0.1f, 1000.f);
-	m_ShadowMapUBOData.mvp = proj * view * model;
+	VkDescriptorPoolCreateInfo poolCreateInfo{};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
+	poolCreateInfo.pPoolSizes = vecPoolSize.data();
+	poolCreateInfo.maxSets = 1;
 
-	void* uniformBufferData;
-	vkMapMemory(m_LogicalDevice, m_ShadowMapUniformBufferMemory, 0, sizeof(MVPUniformBufferObject), 0, &uniformBufferData);
-	memcpy(uniformBufferData, &m_ShadowMapUBOData, sizeof(MVPUniformBufferObject));
-	vkUnmapMemory(m_LogicalDevice, m_ShadowMapUniformBufferMemory);
+	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_OmniShadowDescriptorPool), "Create omni shadow descriptor pool failed");
 }
 
-void VulkanRenderer::CreateShadowMapShaderModule()
+void VulkanRenderer::CreateOmniShadowDescriptorSet()
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapShaderPath = {
-		{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/ShadowMap/vert.spv" },
-	};
-	ASSERT(mapShaderPath.size() > 0, "Detect no shader spv file");
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.descriptorPool = m_OmniShadowDescriptorPool;
+	allocInfo.pSetLayouts = &m_OmniShadowDescriptorSetLayout;
 
-	m_mapShadowMapShaderModule.clear();
+	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, &m_OmniShadowDescriptorSet), "Allocate omni shadow desctiprot sets failed");
 
-	for (const auto& spvPath : mapShaderPath)
-	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
+	VkDescriptorBufferInfo UBODescriptorBufferInfo{};
+	UBODescriptorBufferInfo.buffer = m_OmniShadowUniformBuffer;
+	UBODescriptorBufferInfo.offset = 0;
+	UBODescriptorBufferInfo.range = sizeof(OmniShadowUniformBufferObject);
 
-		m_mapShadowMapShaderModule[spvPath.first] = shaderModule;
-	}
+	VkWriteDescriptorSet UBOWrite{};
+	UBOWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	UBOWrite.dstSet = m_OmniShadowDescriptorSet;
+	UBOWrite.dstBinding = 0;
+	UBOWrite.dstArrayElement = 0;
+	UBOWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	UBOWrite.descriptorCount = 1;
+	UBOWrite.pBufferInfo = &UBODescriptorBufferInfo;
+
+	std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
+		UBOWrite,
+	};
+
+	vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
 }
 
-void VulkanRenderer::CreateShadowMapPipelineLayout()
+void VulkanRenderer::CreateOmniShadowPipelineLayout()
 {
+	VkPushConstantRange faceMaskPushConstantRange = {};
+	faceMaskPushConstantRange.stageFlags = VK_SHADER_STAGE_GEOMETRY_BIT;
+	faceMaskPushConstantRange.offset = 0;
+	faceMaskPushConstantRange.size = sizeof(UINT); //face mask
+
 	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
 	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutCreateInfo.setLayoutCount = 1;
-	pipelineLayoutCreateInfo.pSetLayouts = &m_ShadowMapDescriptorSetLayout;
-	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
+	pipelineLayoutCreateInfo.pSetLayouts = &m_OmniShadowDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &faceMaskPushConstantRange;
 
-	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_ShadowMapPipelineLayout), "Create shadow map pipeline layout failed");
+	VULKAN_ASSERT(vkCreatePipelineLayout(m_LogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_OmniShadowPipelineLayout), "Create omni shadow pipeline layout failed");
 }
 
-void VulkanRenderer::CreateShadowMapPipeline()
+void VulkanRenderer::CreateOmniShadowPipeline()
 {
 	/****************************ɱ̹*******************************/
-	VkPipelineShaderStageCreateInfo vertShaderStageCreateInfo{};
-	vertShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	vertShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageCreateInfo.module = m_mapShadowMapShaderModule.at(VK_SHADER_STAGE_VERTEX_BIT); //Bytecode
-	vertShaderStageCreateInfo.pName = "main"; //Ҫinvokeĺ
-
-	VkPipelineShaderStageCreateInfo shaderStageCreateInfos[] = {
-		vertShaderStageCreateInfo,
-	};
+	std::vector<VkPipelineShaderStageCreateInfo> vecShaderStageCreateInfo;
+	for (const auto& stage : { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_GEOMETRY_BIT, VK_SHADER_STAGE_FRAGMENT_BIT })
+	{
+		VkPipelineShaderStageCreateInfo shaderStageCreateInfo{};
+		shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageCreateInfo.stage = stage;
+		shaderStageCreateInfo.module = m_mapOmniShadowShaderModule.at(stage);
+		shaderStageCreateInfo.pName = "main";
+		vecShaderStageCreateInfo.push_back(shaderStageCreateInfo);
+	}
 
 	/*****************************̶*******************************/
 
 	//-----------------------Dynamic State--------------------------//
-	//һὫViewportScissorΪdynamicԷʱ޸
 	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
 	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
 
 	std::vector<VkDynamicState> vecDynamicStates = {
 		VK_DYNAMIC_STATE_VIEWPORT,
 		VK_DYNAMIC_STATE_SCISSOR,
-		VK_DYNAMIC_STATE_DEPTH_BIAS,
 	};
 	dynamicStateCreateInfo.dynamicStateCount = static_cast<UINT>(vecDynamicStates.size());
 	dynamicStateCreateInfo.pDynamicStates = vecDynamicStates.data();
 
-
 	//-----------------------Vertex Input State--------------------------//
 	auto bindingDescription = Vertex3D::GetBindingDescription();
 	auto attributeDescriptions = Vertex3D::GetAttributeDescriptions();
@@ -3924,7 +6230,6 @@ void VulkanRenderer::CreateShadowMapPipeline()
 	inputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
-
 	//-----------------------Viewport State--------------------------//
 	VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
 	viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -3934,22 +6239,18 @@ void VulkanRenderer::CreateShadowMapPipeline()
 	//-----------------------Raserization State--------------------------//
 	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{};
 	rasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;	//󣬳ԶƽĲֻᱻضԶƽϣǶ
-	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;	//󣬽ֹͼԪդ
-	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;	//ͼԪģʽFILLLINEPOINT
-	rasterizationStateCreateInfo.lineWidth = 1.f;	//ָդ߶ο
-	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;	//޳ģʽNONEFRONTBACKFRONT_AND_BACK
-	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE; //򣬿˳ʱcwʱccw
-	rasterizationStateCreateInfo.depthBiasEnable = VK_TRUE; //ƫƣһShaodw MapбӰ
-	rasterizationStateCreateInfo.depthBiasConstantFactor = 0.f;
-	rasterizationStateCreateInfo.depthBiasClamp = 0.f;
-	rasterizationStateCreateInfo.depthBiasSlopeFactor = 0.f;
+	rasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
+	rasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+	rasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterizationStateCreateInfo.lineWidth = 1.f;
+	rasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	rasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+	rasterizationStateCreateInfo.depthBiasEnable = VK_FALSE; //дgl_FragDepthӲdepth biasЧbiasڲʱ
 
 	//-----------------------Multisample State--------------------------//
 	VkPipelineMultisampleStateCreateInfo multisamplingStateCreateInfo{};
 	multisamplingStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 	multisamplingStateCreateInfo.sampleShadingEnable = false;
-	multisamplingStateCreateInfo.minSampleShading = 0.8f;
 	multisamplingStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
 	multisamplingStateCreateInfo.minSampleShading = 1.f;
 	multisamplingStateCreateInfo.pSampleMask = nullptr;
@@ -3976,16 +6277,12 @@ void VulkanRenderer::CreateShadowMapPipeline()
 	colorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
 	colorBlendStateCreateInfo.attachmentCount = 0;
 	colorBlendStateCreateInfo.pAttachments = nullptr;
-	colorBlendStateCreateInfo.blendConstants[0] = 0.f;
-	colorBlendStateCreateInfo.blendConstants[1] = 0.f;
-	colorBlendStateCreateInfo.blendConstants[2] = 0.f;
-	colorBlendStateCreateInfo.blendConstants[3] = 0.f;
 
 	/***********************************************************************/
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
 	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineCreateInfo.stageCount = static_cast<UINT>(m_mapShadowMapShaderModule.size());
-	pipelineCreateInfo.pStages = shaderStageCreateInfos;
+	pipelineCreateInfo.stageCount = static_cast<UINT>(vecShaderStageCreateInfo.size());
+	pipelineCreateInfo.pStages = vecShaderStageCreateInfo.data();
 	pipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
 	pipelineCreateInfo.pVertexInputState = &vertexInputCreateInfo;
 	pipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
@@ -3994,89 +6291,197 @@ void VulkanRenderer::CreateShadowMapPipeline()
 	pipelineCreateInfo.pMultisampleState = &multisamplingStateCreateInfo;
 	pipelineCreateInfo.pDepthStencilState = &depthStencilStateCreateInfo;
 	pipelineCreateInfo.pColorBlendState = &colorBlendStateCreateInfo;
-	pipelineCreateInfo.layout = m_ShadowMapPipelineLayout;
-	pipelineCreateInfo.renderPass = m_ShadowMapRenderPass;
+	pipelineCreateInfo.layout = m_OmniShadowPipelineLayout;
+	pipelineCreateInfo.renderPass = m_OmniShadowRenderPass;
 	pipelineCreateInfo.subpass = 0;
 	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 	pipelineCreateInfo.basePipelineIndex = -1;
 
-	//ʱṩVkPipelineCacheVulkan᳢Դ
-	//ûпõݣµݻᱻӵ
-	VkPipelineCache pipelineCache = m_CommonGraphicPipelineCache;
+	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, m_CommonGraphicPipelineCache, 1, &pipelineCreateInfo, nullptr, &m_OmniShadowPipeline), "Create omni shadow pipeline failed");
+}
 
-	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_ShadowMapPipeline), "Create shadow map pipeline failed");
+VkShaderModule VulkanRenderer::CreateShaderModuleByName(const std::string& strShaderName, VkShaderStageFlagBits stage)
+{
+	auto pEmbedded = DZW_EmbeddedShader::FindEmbeddedSpirv(strShaderName, stage);
+	ASSERT(pEmbedded, std::format("No embedded spirv for shader {}", strShaderName));
+
+	//غϵspvȱǶĸ£variantstage֣δرstageǶspv
+	if (m_setHotReloadedSpirv.contains(pEmbedded))
+		return DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(pEmbedded->szSpvPath));
+
+	return DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, pEmbedded->spirv);
 }
 
-void VulkanRenderer::CreateShadowMapDescriptorSetLayout()
+void VulkanRenderer::RegisterShaderHotReloadTargets()
 {
-	//MVP UBO Binding
-	VkDescriptorSetLayoutBinding MVPUBOLayoutBinding{};
-	MVPUBOLayoutBinding.binding = 0;
-	MVPUBOLayoutBinding.descriptorCount = 1;
-	MVPUBOLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	MVPUBOLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-	MVPUBOLayoutBinding.pImmutableSamplers = nullptr;
+	//keyΪǶshaderе֣Assert/ShaderĿ¼µshaderΪ"Planet"
+	m_mapShaderHotReloadTarget.clear();
 
-	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
-		MVPUBOLayoutBinding,
-	};
+	std::vector<VkPipeline*> vecCommonPipeline;
+	for (auto& pipeline : m_aryCommonGraphicPipeline)
+	{
+		vecCommonPipeline.push_back(&pipeline);
+	}
+	m_mapShaderHotReloadTarget["Common"] = { &m_mapCommonShaderModule, vecCommonPipeline,
+		[this]() { CreateCommonShader(); }, [this]() { CreateCommonGraphicPipeline(); } };
 
-	VkDescriptorSetLayoutCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	createInfo.bindingCount = static_cast<UINT>(vecDescriptorLayoutBinding.size());
-	createInfo.pBindings = vecDescriptorLayoutBinding.data();
+	m_mapShaderHotReloadTarget["ShadowMap"] = { &m_mapShadowMapShaderModule, { &m_ShadowMapPipeline },
+		[this]() { CreateShadowMapShaderModule(); }, [this]() { CreateShadowMapPipeline(); } };
 
-	VULKAN_ASSERT(vkCreateDescriptorSetLayout(m_LogicalDevice, &createInfo, nullptr, &m_ShadowMapDescriptorSetLayout), "Create shadow map descriptor layout failed");
+	m_mapShaderHotReloadTarget["OmniShadow"] = { &m_mapOmniShadowShaderModule, { &m_OmniShadowPipeline },
+		[this]() { CreateOmniShadowShaderModule(); }, [this]() { CreateOmniShadowPipeline(); } };
+
+	m_mapShaderHotReloadTarget["PointLight"] = { &m_mapPointLightShaderModule, { &m_PointLightPipeline },
+		[this]() { CreatePointLightShaderModule(); }, [this]() { CreatePointLightPipeline(); } };
+
+	m_mapShaderHotReloadTarget["Instanced"] = { &m_mapInstancedShaderModule, { &m_InstancedPipeline },
+		[this]() { CreateInstancedShaderModule(); }, [this]() { CreateInstancedPipeline(); } };
+
+	m_mapShaderHotReloadTarget["AsteroidCompute"] = { m_AsteroidBeltCompute.GetShaderModuleMap(), { m_AsteroidBeltCompute.GetPipeline() },
+		[this]() { m_AsteroidBeltCompute.SetShaderModule(CreateShaderModuleByName("AsteroidCompute", VK_SHADER_STAGE_COMPUTE_BIT)); },
+		[this]() { m_AsteroidBeltCompute.CreatePipeline(); } };
+
+	m_mapShaderHotReloadTarget["Planet"] = { &m_mapShaderModule, { &m_GraphicPipeline },
+		[this]() { CreateShader(); }, [this]() { CreateGraphicPipeline(); } };
+
+	m_mapShaderHotReloadTarget["PlanetImpostor"] = { &m_mapPlanetImpostorShaderModule, { &m_PlanetImpostorPipeline },
+		[this]() { CreatePlanetImpostorShaderModule(); }, [this]() { CreatePlanetImpostorPipeline(); } };
+
+	m_mapShaderHotReloadTarget["PlanetTerrain"] = { &m_mapPlanetTerrainShaderModule, { &m_PlanetTerrainPipeline },
+		[this]() { CreatePlanetTerrainShaderModule(); }, [this]() { CreatePlanetTerrainPipeline(); } };
+
+	m_mapShaderHotReloadTarget["Skybox"] = { &m_mapSkyboxShaderModule, { &m_SkyboxGraphicPipeline },
+		[this]() { CreateSkyboxShader(); }, [this]() { CreateSkyboxGraphicPipeline(); } };
+
+	m_mapShaderHotReloadTarget["glTF"] = { &m_mapGLTFShaderModule, { &m_GLTFGraphicPipeline },
+		[this]() { CreateGLTFShader(); }, [this]() { CreateGLTFGraphicPipeline(); } };
+
+	//ԤɵvariantؽpipelineCreateShaderȰ豸ѡvariant
+	m_mapShaderHotReloadTarget["PlanetNoFeedback"] = m_mapShaderHotReloadTarget["Planet"];
+	m_mapShaderHotReloadTarget["PlanetTerrainNoFeedback"] = m_mapShaderHotReloadTarget["PlanetTerrain"];
 }
 
-void VulkanRenderer::CreateShadowMapDescriptorPool()
+void VulkanRenderer::ProcessShaderHotReload()
 {
-	VkDescriptorPoolSize MVPUBOPoolSize{};
-	MVPUBOPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	MVPUBOPoolSize.descriptorCount = 1;
+	if (!m_bEnableShaderHotReload)
+		return;
 
-	std::vector<VkDescriptorPoolSize> vecPoolSize = {
-		MVPUBOPoolSize,
-	};
+	//ں̨߳ɣֻؽshader modulepipeline
+	auto setReloadedShaders = m_ShaderHotReload.FetchReloadedShaders();
+	std::set<std::string> setReloadedNames;
+	for (const auto& pEmbedded : setReloadedShaders)
+	{
+		m_setHotReloadedSpirv.insert(pEmbedded);
+		setReloadedNames.insert(pEmbedded->szName);
+	}
 
-	VkDescriptorPoolCreateInfo poolCreateInfo{};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = static_cast<UINT>(vecPoolSize.size());
-	poolCreateInfo.pPoolSizes = vecPoolSize.data();
-	poolCreateInfo.maxSets = 1;
+	//ͬһԴļĶvariantһtargetֻؽһ
+	std::set<const std::unordered_map<VkShaderStageFlagBits, VkShaderModule>*> setRebuiltTargets;
+	for (const auto& strDir : setReloadedNames)
+	{
+		auto iter = m_mapShaderHotReloadTarget.find(strDir);
+		if (iter == m_mapShaderHotReloadTarget.end())
+			continue;
 
-	VULKAN_ASSERT(vkCreateDescriptorPool(m_LogicalDevice, &poolCreateInfo, nullptr, &m_ShadowMapDescriptorPool), "Create shadow map descriptor pool failed");
+		auto& target = iter->second;
+		if (!setRebuiltTargets.insert(target.pMapShaderModule).second)
+			continue;
+
+		//ɵpipelineԱin-flight֡command bufferãӳ
+		for (const auto& pPipeline : target.vecPipeline)
+		{
+			RetirePipeline(*pPipeline);
+		}
+		for (const auto& shaderModule : *target.pMapShaderModule)
+		{
+			RetireShaderModule(shaderModule.second);
+		}
+
+		target.funcCreateShader();
+		target.funcCreatePipeline();
+
+		if (strDir == "ShadowMap" || strDir == "OmniShadow")
+			MarkShadowCasterDirty();
+
+		Log::Info("Shader hot reload rebuilt {} pipeline", strDir);
+	}
 }
 
-void VulkanRenderer::CreateShadowMapDescriptorSet()
+VulkanRenderer::RetiredResource& VulkanRenderer::GetCurrentRetiredResource()
 {
-	VkDescriptorSetAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	allocInfo.descriptorSetCount = 1;
-	allocInfo.descriptorPool = m_ShadowMapDescriptorPool;
-	allocInfo.pSetLayouts = &m_ShadowMapDescriptorSetLayout;
+	//ͬһ֡۵Դͬһ
+	if (m_vecRetiredResource.empty() || m_vecRetiredResource.back().uiRetireFrame != m_uiFrameNumber)
+	{
+		RetiredResource retired;
+		retired.uiRetireFrame = m_uiFrameNumber;
+		m_vecRetiredResource.push_back(std::move(retired));
+	}
+	return m_vecRetiredResource.back();
+}
 
-	VULKAN_ASSERT(vkAllocateDescriptorSets(m_LogicalDevice, &allocInfo, &m_ShadowMapDescriptorSet), "Allocate shadow map desctiprot sets failed");
+void VulkanRenderer::RetirePipeline(VkPipeline pipeline)
+{
+	if (pipeline != VK_NULL_HANDLE)
+		GetCurrentRetiredResource().vecPipeline.push_back(pipeline);
+}
 
-	VkDescriptorBufferInfo MVPDescriptorBufferInfo{};
-	MVPDescriptorBufferInfo.buffer = m_ShadowMapUniformBuffer;
-	MVPDescriptorBufferInfo.offset = 0;
-	MVPDescriptorBufferInfo.range = sizeof(MVPUniformBufferObject);
+void VulkanRenderer::RetireShaderModule(VkShaderModule shaderModule)
+{
+	if (shaderModule != VK_NULL_HANDLE)
+		GetCurrentRetiredResource().vecShaderModules.push_back(shaderModule);
+}
 
-	VkWriteDescriptorSet MVPUBOWrite{};
-	MVPUBOWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	MVPUBOWrite.dstSet = m_ShadowMapDescriptorSet;
-	MVPUBOWrite.dstBinding = 0;
-	MVPUBOWrite.dstArrayElement = 0;
-	MVPUBOWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	MVPUBOWrite.descriptorCount = 1;
-	MVPUBOWrite.pBufferInfo = &MVPDescriptorBufferInfo;
+void VulkanRenderer::RetireImageView(VkImageView imageView)
+{
+	if (imageView != VK_NULL_HANDLE)
+		GetCurrentRetiredResource().vecImageView.push_back(imageView);
+}
 
-	std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
-		MVPUBOWrite,
-	};
+void VulkanRenderer::RetireBuffer(VkBuffer buffer, VkDeviceMemory memory)
+{
+	RetiredResource& retired = GetCurrentRetiredResource();
+	if (buffer != VK_NULL_HANDLE)
+		retired.vecBuffer.push_back(buffer);
+	if (memory != VK_NULL_HANDLE)
+		retired.vecMemory.push_back(memory);
+}
 
-	vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
+void VulkanRenderer::DestroyRetiredResources(bool bForce)
+{
+	//ÿframe slotڸǰȴfenceSwapChain Image֡Դһٱ
+	UINT64 uiFramesInFlight = static_cast<UINT64>(m_vecSwapChainImages.size());
+
+	//֡ŵһδڵļֹͣ
+	auto iter = m_vecRetiredResource.begin();
+	for (; iter != m_vecRetiredResource.end(); ++iter)
+	{
+		const RetiredResource& retired = *iter;
+		if (!bForce && m_uiFrameNumber < retired.uiRetireFrame + uiFramesInFlight)
+			break;
+
+		//ߣٱõimage view/buffermemory
+		for (const auto& pipeline : retired.vecPipeline)
+		{
+			vkDestroyPipeline(m_LogicalDevice, pipeline, nullptr);
+		}
+		for (const auto& shaderModule : retired.vecShaderModules)
+		{
+			vkDestroyShaderModule(m_LogicalDevice, shaderModule, nullptr);
+		}
+		for (const auto& imageView : retired.vecImageView)
+		{
+			vkDestroyImageView(m_LogicalDevice, imageView, nullptr);
+		}
+		for (const auto& buffer : retired.vecBuffer)
+		{
+			vkDestroyBuffer(m_LogicalDevice, buffer, nullptr);
+		}
+		for (const auto& memory : retired.vecMemory)
+		{
+			vkFreeMemory(m_LogicalDevice, memory, nullptr);
+		}
+	}
+	m_vecRetiredResource.erase(m_vecRetiredResource.begin(), iter);
 }
 
 void VulkanRenderer::LoadPlanetInfo()
@@ -4085,17 +6490,26 @@ void VulkanRenderer::LoadPlanetInfo()
 	ASSERT(std::filesystem::exists(configPath), std::format("planet config {} not exist", configPath.string()));
 	std::ifstream file(configPath);
 
-	nlohmann::json jsonFile;
+	//ordered_jsonļе˳˳ʵĶӦϵ
+	nlohmann::ordered_json jsonFile;
 	jsonFile << file;
 
 	m_vecPlanetInfo.clear();
+	m_OrbitSystem.Clear();
 
-	std::vector<std::string> vecPlanet = {"Sun", "Mercury", "Venus", "Earth", "Mars", "Juipter", "Saturn", "Uranus", "Neptune"};
+	//ÿAUӦĳλ״̬Ϊdoubleʵ1.496e8λkmҲᶶ
+	m_OrbitSystem.SetDistanceScale(jsonFile.value("DistanceScale", 100.0));
+	m_uiVirtualTextureWidth = jsonFile.value("VirtualTextureWidth", 8192u);
 
-	for (auto it = vecPlanet.begin(); it != vecPlanet.end(); ++it)
+	//ļе˳ÿ壨ֵΪobject±꼴ʵ±Ĳ㣻ͨParentָĸǣĸ֮
+	std::vector<std::string> vecPlanet;
+	for (auto& [strName, node] : jsonFile.items())
 	{
+		if (!node.is_object())
+			continue;
+
 		PlanetInfo info;
-		auto node = jsonFile[*it];
+		info.strName = strName;
 		info.strDesc = node["Desc"];
 		info.fDiameter = static_cast<float>(node["Diameter"]);
 		info.fRotationAxisDegree = node["RotationAxisDegree"];
@@ -4103,8 +6517,125 @@ void VulkanRenderer::LoadPlanetInfo()
 		info.fRevolutionPeriod = node["RevolutionPeriod"];
 		info.fOrbitRadius = node["OrbitRadius"];
 
+		info.fEccentricity = node.value("Eccentricity", 0.f);
+		info.fInclination = node.value("Inclination", 0.f);
+		info.fAscendingNode = node.value("AscendingNode", 0.f);
+		info.fArgumentOfPeriapsis = node.value("ArgumentOfPeriapsis", 0.f);
+		info.fMeanAnomaly = node.value("MeanAnomaly", 0.f);
+		info.strParent = node.value("Parent", std::string());
+
+		//θ߶ǰ뾶Ϊλ0ʾûе
+		info.fTerrainHeightScale = node.value("TerrainHeightScale", 0.f);
+		info.strTerrainDir = node.value("TerrainTileDir", "./Assert/Terrain/" + strName);
+
+		//ԴͼΪʱֻʹ
+		info.strTexture = node.value("Texture", std::string());
+
+		vecPlanet.push_back(strName);
 		m_vecPlanetInfo.push_back(info);
 	}
+	ASSERT(!m_vecPlanetInfo.empty(), std::format("planet config {} has no body", configPath.string()));
+
+	//ǵʵ±m_vecPlanetInfoһ
+	std::unordered_map<std::string, int> mapBodyIdx;
+	for (size_t i = 0; i < m_vecPlanetInfo.size(); ++i)
+	{
+		const auto& info = m_vecPlanetInfo[i];
+
+		KeplerElements elements;
+		elements.fSemiMajorAxis = info.fOrbitRadius;
+		elements.fEccentricity = info.fEccentricity;
+		elements.fInclination = info.fInclination;
+		elements.fAscendingNode = info.fAscendingNode;
+		elements.fArgumentOfPeriapsis = info.fArgumentOfPeriapsis;
+		elements.fMeanAnomalyAtEpoch = info.fMeanAnomaly;
+		elements.fPeriod = info.fRevolutionPeriod * 365.25f;
+
+		BodyRotation rotation;
+		rotation.fAxisTiltDegree = info.fRotationAxisDegree;
+		rotation.fRotationPeriod = info.fRotationPeriod;
+		rotation.fScale = info.fDiameter / 100.f;
+
+		int nParent = -1;
+		if (!info.strParent.empty())
+		{
+			auto iter = mapBodyIdx.find(info.strParent);
+			ASSERT(iter != mapBodyIdx.end(), std::format("planet {} parent {} must be listed before it", vecPlanet[i], info.strParent));
+			nParent = iter->second;
+		}
+
+		mapBodyIdx[vecPlanet[i]] = static_cast<int>(m_OrbitSystem.AddBody(elements, rotation, nParent));
+	}
+}
+
+void VulkanRenderer::CreateAsteroidBeltResource()
+{
+	m_AsteroidBelt.Generate(ASTEROID_BELT_CAPACITY, 20240501, 2.1f, 3.3f, static_cast<float>(m_OrbitSystem.GetDistanceScale()));
+
+	m_AsteroidModel = DZW_VulkanWrap::ModelFactor::CreateModel(this, "./Assert/Model/sphere_lowpoly.obj");
+	float fBoundingRadius = 0.f;
+	for (const auto& vertex : m_AsteroidModel->m_vecVertices)
+	{
+		fBoundingRadius = std::max(fBoundingRadius, glm::length(vertex.pos));
+	}
+
+	//GPU·ֻϴһΣ֮compute shaderÿ֡
+	m_AsteroidBeltCompute.Init(m_PhysicalDevice, m_LogicalDevice, m_GraphicQueue, GetGraphicQueueIdx(),
+		m_AsteroidBelt, static_cast<UINT>(m_AsteroidModel->m_vecIndices.size()), fBoundingRadius);
+	m_AsteroidBeltCompute.SetShaderModule(CreateShaderModuleByName("AsteroidCompute", VK_SHADER_STAGE_COMPUTE_BIT));
+	m_AsteroidBeltCompute.CreatePipeline();
+}
+
+void VulkanRenderer::UpdateAsteroidBelt(UINT uiIdx)
+{
+	m_nAsteroidCount = std::clamp(m_nAsteroidCount, 0, static_cast<int>(ASTEROID_BELT_CAPACITY));
+	if (!m_bEnableAsteroidBelt || m_bAsteroidBeltGPUCompute)
+		return;
+
+	//ǰѵȴǰ֡fenceGPUٶȡһ
+	m_AsteroidBelt.Update(m_OrbitSystem.GetSimulationDays(), m_pInstanceData + uiIdx * m_uiInstanceFrameCount, m_nAsteroidCount);
+}
+
+void VulkanRenderer::RecordAsteroidBeltCompute(VkCommandBuffer commandBuffer)
+{
+	if (!m_bEnableAsteroidBelt || !m_bAsteroidBeltGPUCompute)
+		return;
+
+	//render pass֮¼ƣdispatch֮barrier֤indirect draw֡Ľ
+	glm::mat4 viewProj = m_Camera.GetProjMatrix() * m_Camera.GetViewMatrix();
+	m_AsteroidBeltCompute.RecordDispatch(commandBuffer, m_OrbitSystem.GetSimulationDays(), static_cast<UINT>(m_nAsteroidCount), &viewProj);
+}
+
+void VulkanRenderer::DrawAsteroidBelt(VkCommandBuffer commandBuffer, UINT uiIdx)
+{
+	if (!m_bEnableAsteroidBelt || m_nAsteroidCount <= 0)
+		return;
+
+	InstancedPushConstant pushConstant{};
+	pushConstant.viewProj = m_Camera.GetRelativeViewProjMatrix();
+	pushConstant.color = { 0.55f, 0.5f, 0.45f, 1.f };
+	pushConstant.origin = glm::vec4(glm::vec3(m_Camera.GetWorldPosition()), 0.f);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_InstancedPipeline);
+	vkCmdPushConstants(commandBuffer, m_InstancedPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(InstancedPushConstant), &pushConstant);
+
+	//CPU·ÿswap chain imageһΣGPU·ֻcomputeдһ
+	VkBuffer instanceBuffer = m_bAsteroidBeltGPUCompute ? m_AsteroidBeltCompute.GetInstanceBuffer() : m_InstanceBuffer;
+	VkDeviceSize instanceOffset = m_bAsteroidBeltGPUCompute ? 0 : sizeof(InstanceData) * static_cast<VkDeviceSize>(m_uiInstanceFrameCount) * uiIdx;
+
+	VkBuffer asteroidVertexBuffers[] = {
+		m_AsteroidModel->m_VertexBuffer,
+		instanceBuffer,
+	};
+	VkDeviceSize asteroidOffsets[]{ 0, instanceOffset };
+	vkCmdBindVertexBuffers(commandBuffer, 0, 2, asteroidVertexBuffers, asteroidOffsets);
+	vkCmdBindIndexBuffer(commandBuffer, m_AsteroidModel->m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+	//GPU·instanceCountcompute޳д
+	if (m_bAsteroidBeltGPUCompute)
+		vkCmdDrawIndexedIndirect(commandBuffer, m_AsteroidBeltCompute.GetIndirectBuffer(), 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+	else
+		vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_AsteroidModel->m_vecIndices.size()), static_cast<UINT>(m_nAsteroidCount), 0, 0, 0);
 }
 
 void VulkanRenderer::InitBlinnPhongLightMaterialInfo()
@@ -4121,19 +6652,16 @@ void VulkanRenderer::InitBlinnPhongLightMaterialInfo()
 
 void VulkanRenderer::CreateBlinnPhongShaderModule()
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapBlinnPhongShaderPath = {
-	{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/BlinnPhong/vert.spv" },
-	{ VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/BlinnPhong/frag.spv" },
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
 	};
-	ASSERT(mapBlinnPhongShaderPath.size() > 0, "Detect no shader spv file");
 
 	m_mapBlinnPhongShaderModule.clear();
 
-	for (const auto& spvPath : mapBlinnPhongShaderPath)
+	for (const auto& stage : vecShaderStage)
 	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
-
-		m_mapBlinnPhongShaderModule[spvPath.first] = shaderModule;
+		m_mapBlinnPhongShaderModule[stage] = CreateShaderModuleByName("BlinnPhong", stage);
 	}
 }
 
@@ -4463,7 +6991,7 @@ void VulkanRenderer::CreateBlinnPhongGraphicPipeline()
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE; //ΪʼԶȼ
 	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
@@ -4533,19 +7061,16 @@ void VulkanRenderer::InitPBRLightMaterialInfo()
 
 void VulkanRenderer::CreatePBRShaderModule()
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapPBRShaderPath = {
-	{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/PBR/vert.spv" },
-	{ VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/PBR/frag.spv" },
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
 	};
-	ASSERT(mapPBRShaderPath.size() > 0, "Detect no shader spv file");
 
 	m_mapPBRShaderModule.clear();
 
-	for (const auto& spvPath : mapPBRShaderPath)
+	for (const auto& stage : vecShaderStage)
 	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
-
-		m_mapPBRShaderModule[spvPath.first] = shaderModule;
+		m_mapPBRShaderModule[stage] = CreateShaderModuleByName("PBR", stage);
 	}
 }
 
@@ -4875,7 +7400,7 @@ void VulkanRenderer::CreatePBRGraphicPipeline()
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE; //ΪʼԶȼ
 	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
@@ -4934,19 +7459,16 @@ void VulkanRenderer::CreatePBRGraphicPipeline()
 
 void VulkanRenderer::CreateCommonShader()
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapShaderPath = {
-		{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/Common/vert.spv" },
-		{ VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/Common/frag.spv" },
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
 	};
-	ASSERT(mapShaderPath.size() > 0, "Detect no shader spv file");
 
 	m_mapCommonShaderModule.clear();
 
-	for (const auto& spvPath : mapShaderPath)
+	for (const auto& stage : vecShaderStage)
 	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
-
-		m_mapCommonShaderModule[spvPath.first] = shaderModule;
+		m_mapCommonShaderModule[stage] = CreateShaderModuleByName("Common", stage);
 	}
 }
 
@@ -4969,8 +7491,15 @@ void VulkanRenderer::UpdateCommonMVPUniformBuffer(UINT uiIdx)
 	//	(float)m_ShadowMapExtent2D.width / (float)m_ShadowMapExtent2D.height,
 	//	0.1f, 1000.f);
 	m_CommonMVPUboData.mv_normal = glm::transpose(glm::inverse(m_CommonMVPUboData.view * m_CommonMVPUboData.model));
-	m_CommonMVPUboData.lightPovMVP = m_ShadowMapUBOData.mvp;
+	for (UINT i = 0; i < SHADOW_CASCADE_MAX; ++i)
+	{
+		m_CommonMVPUboData.lightPovMVP[i] = m_ShadowMapUBOData.viewProj[i];
+		m_CommonMVPUboData.cascadeSplits[i] = m_aryShadowCascadeSplitDepth[i];
+	}
 	m_CommonMVPUboData.lightPos = m_PointLight.position;
+	m_CommonMVPUboData.nCascadeCount = m_nShadowCascadeCount;
+	m_CommonMVPUboData.nShadowLightType = m_nShadowLightType;
+	m_CommonMVPUboData.fOmniShadowFarPlane = m_fOmniShadowFarPlane;
 
 	void* uniformBufferData;
 	vkMapMemory(m_LogicalDevice, m_CommonMVPUniformBufferMemory, 0, sizeof(CommonMVPUniformBufferObject), 0, &uniformBufferData);
@@ -4985,7 +7514,7 @@ void VulkanRenderer::CreateCommonDescriptorSetLayout()
 	uboLayoutBinding.binding = 0; //ӦVertex Shaderеlayout binding
 	uboLayoutBinding.descriptorCount = 1;
 	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; //ֻҪvertex stageЧ
+	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT; //fragment stageѡcascade
 	uboLayoutBinding.pImmutableSamplers = nullptr;
 
 	//shadowMap sampler binding
@@ -4996,9 +7525,18 @@ void VulkanRenderer::CreateCommonDescriptorSetLayout()
 	shadowMapSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; //ֻfragment stage
 	shadowMapSamplerLayoutBinding.pImmutableSamplers = nullptr;
 
+	//omni shadow cube sampler binding
+	VkDescriptorSetLayoutBinding omniShadowSamplerLayoutBinding{};
+	omniShadowSamplerLayoutBinding.binding = 2;
+	omniShadowSamplerLayoutBinding.descriptorCount = 1;
+	omniShadowSamplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	omniShadowSamplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	omniShadowSamplerLayoutBinding.pImmutableSamplers = nullptr;
+
 	std::vector<VkDescriptorSetLayoutBinding> vecDescriptorLayoutBinding = {
 		uboLayoutBinding,
 		shadowMapSamplerLayoutBinding,
+		omniShadowSamplerLayoutBinding,
 	};
 
 	VkDescriptorSetLayoutCreateInfo createInfo{};
@@ -5019,7 +7557,7 @@ void VulkanRenderer::CreateCommonDescriptorPool()
 	//shadowMap sampler
 	VkDescriptorPoolSize shadowMapSamplerPoolSize{};
 	shadowMapSamplerPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	shadowMapSamplerPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size());
+	shadowMapSamplerPoolSize.descriptorCount = static_cast<UINT>(m_vecSwapChainImages.size()) * 2; //cascade array + omni cube
 
 	std::vector<VkDescriptorPoolSize> vecPoolSize = {
 		uboPoolSize,
@@ -5075,9 +7613,25 @@ void VulkanRenderer::CreateCommonDescriptorSet()
 	shadowMapSamplerWrite.descriptorCount = 1;
 	shadowMapSamplerWrite.pImageInfo = &shadowMapImageInfo;
 
+	//omni shadow sampler
+	VkDescriptorImageInfo omniShadowImageInfo{};
+	omniShadowImageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+	omniShadowImageInfo.imageView = m_OmniShadowCubeImageView;
+	omniShadowImageInfo.sampler = m_ShadowMapSampler;
+
+	VkWriteDescriptorSet omniShadowSamplerWrite{};
+	omniShadowSamplerWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	omniShadowSamplerWrite.dstSet = m_CommonDescriptorSet;
+	omniShadowSamplerWrite.dstBinding = 2;
+	omniShadowSamplerWrite.dstArrayElement = 0;
+	omniShadowSamplerWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	omniShadowSamplerWrite.descriptorCount = 1;
+	omniShadowSamplerWrite.pImageInfo = &omniShadowImageInfo;
+
 	std::vector<VkWriteDescriptorSet> vecDescriptorWrite = {
 		uboWrite,
 		shadowMapSamplerWrite,
+		omniShadowSamplerWrite,
 	};
 
 	vkUpdateDescriptorSets(m_LogicalDevice, static_cast<UINT>(vecDescriptorWrite.size()), vecDescriptorWrite.data(), 0, nullptr);
@@ -5187,7 +7741,7 @@ void VulkanRenderer::CreateCommonGraphicPipeline()
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
 	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
@@ -5243,26 +7797,66 @@ void VulkanRenderer::CreateCommonGraphicPipeline()
 
 	//ʱṩVkPipelineCacheVulkan᳢Դ
 	//ûпõݣµݻᱻӵ
-	VkPipelineCache pipelineCache = m_CommonGraphicPipelineCache;
+	if (m_CommonGraphicPipelineCache == VK_NULL_HANDLE)
+	{
+		VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
+		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		VULKAN_ASSERT(vkCreatePipelineCache(m_LogicalDevice, &pipelineCacheCreateInfo, nullptr, &m_CommonGraphicPipelineCache), "Create common pipeline cache failed");
+	}
 
-	VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_CommonGraphicPipeline), "Create common graphic pipeline failed");
+	//ÿӰģʽһpipeline壬kernelСΪspecialization constantȫչѭ
+	std::array<VkSpecializationMapEntry, 3> arySpecializationMapEntry{};
+	arySpecializationMapEntry[0] = { 0, offsetof(ShadowSpecializationData, nShadowMode), sizeof(int) };
+	arySpecializationMapEntry[1] = { 1, offsetof(ShadowSpecializationData, nPCFRadius), sizeof(int) };
+	arySpecializationMapEntry[2] = { 2, offsetof(ShadowSpecializationData, nBlockerSearchRadius), sizeof(int) };
+
+	//뾶Ϊ0ʱPCSSеĲŻ0
+	m_nPCFRadius = std::clamp(m_nPCFRadius, SHADOW_FILTER_RADIUS_MIN, SHADOW_FILTER_RADIUS_MAX);
+	m_nBlockerSearchRadius = std::clamp(m_nBlockerSearchRadius, SHADOW_FILTER_RADIUS_MIN, SHADOW_FILTER_RADIUS_MAX);
+	m_nLastPCFRadius = m_nPCFRadius;
+	m_nLastBlockerSearchRadius = m_nBlockerSearchRadius;
+
+	for (int nMode = 0; nMode < SHADOW_MODE_COUNT; ++nMode)
+	{
+		ShadowSpecializationData specializationData{ nMode, m_nPCFRadius, m_nBlockerSearchRadius };
+
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = static_cast<UINT>(arySpecializationMapEntry.size());
+		specializationInfo.pMapEntries = arySpecializationMapEntry.data();
+		specializationInfo.dataSize = sizeof(ShadowSpecializationData);
+		specializationInfo.pData = &specializationData;
+
+		shaderStageCreateInfos[1].pSpecializationInfo = &specializationInfo;
+
+		VULKAN_ASSERT(vkCreateGraphicsPipelines(m_LogicalDevice, m_CommonGraphicPipelineCache, 1, &pipelineCreateInfo, nullptr, &m_aryCommonGraphicPipeline[nMode]), "Create common graphic pipeline failed");
+	}
+}
+
+void VulkanRenderer::RecreateCommonGraphicPipelineIfFilterChanged()
+{
+	if (m_nPCFRadius == m_nLastPCFRadius && m_nBlockerSearchRadius == m_nLastBlockerSearchRadius)
+		return;
+
+	//ͬpipelineԱin-flight֡
+	for (const auto& pipeline : m_aryCommonGraphicPipeline)
+	{
+		RetirePipeline(pipeline);
+	}
+	CreateCommonGraphicPipeline();
 }
 
 void VulkanRenderer::CreateGLTFShader()
 {
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> mapShaderPath = {
-	{ VK_SHADER_STAGE_VERTEX_BIT,	"./Assert/Shader/glTF/vert.spv" },
-	{ VK_SHADER_STAGE_FRAGMENT_BIT,	"./Assert/Shader/glTF/frag.spv" },
+	std::vector<VkShaderStageFlagBits> vecShaderStage = {
+		VK_SHADER_STAGE_VERTEX_BIT,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
 	};
-	ASSERT(mapShaderPath.size() > 0, "Detect no shader spv file");
 
 	m_mapGLTFShaderModule.clear();
 
-	for (const auto& spvPath : mapShaderPath)
+	for (const auto& stage : vecShaderStage)
 	{
-		auto shaderModule = DZW_VulkanUtils::CreateShaderModule(m_LogicalDevice, DZW_VulkanUtils::ReadShaderFile(spvPath.second));
-
-		m_mapGLTFShaderModule[spvPath.first] = shaderModule;
+		m_mapGLTFShaderModule[stage] = CreateShaderModuleByName("glTF", stage);
 	}
 }
 
@@ -5448,7 +8042,7 @@ void VulkanRenderer::CreateGLTFGraphicPipeline()
 	depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
 	depthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	depthStencilStateCreateInfo.depthCompareOp = GetDepthCompareOp();
 	depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilStateCreateInfo.minDepthBounds = 0.f;
 	depthStencilStateCreateInfo.maxDepthBounds = 1.f;
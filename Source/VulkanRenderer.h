@@ -11,15 +11,45 @@
 #include "Camera.h"
 
 #include "VulkanWrap.h"
+#include "ShaderHotReload.h"
+#include "OrbitSystem.h"
+#include "AsteroidBelt.h"
+#include "AsteroidBeltCompute.h"
+#include "PlanetTerrain.h"
+#include "VirtualTexture.h"
+#include "TextureCache.h"
+#include "TextureStreamer.h"
+#include "SamplerCache.h"
+
+#include <functional>
+#include <array>
+#include <bit>
+#include <chrono>
 
 struct PlanetInfo
 {
+	std::string strName; //config.jsonеļ
 	std::string strDesc;
 	float fDiameter = 0.f;	//λkm
 	float fRotationAxisDegree = 0.f; //λ
 	float fRotationPeriod = 0.f; //λ
 	float fRevolutionPeriod = 0.f; //λ
-	float fOrbitRadius = 0.f; //λAU149.6ǧ
+	float fOrbitRadius = 0.f; //λAU149.6ǧףΪ볤
+
+	//J2000ԪĿչλ
+	float fEccentricity = 0.f;
+	float fInclination = 0.f;
+	float fAscendingNode = 0.f;
+	float fArgumentOfPeriapsis = 0.f;
+	float fMeanAnomaly = 0.f;
+	std::string strParent; //Ϊʱ̫ϵԭ㹫ת
+
+	//Σ߶ȵλǰ뾶0ʾûе
+	float fTerrainHeightScale = 0.f;
+	std::string strTerrainDir;
+
+	//Դͼ״ʹʱгpage決ΪͬĿ¼.vtp
+	std::string strTexture;
 };
 
 namespace std
@@ -102,6 +132,8 @@ public:
 	friend class DZW_VulkanWrap::Texture;
 	friend class DZW_VulkanWrap::NormalTexture;
 	friend class DZW_VulkanWrap::KTXTexture;
+	friend class TextureCache;
+	friend class TextureStreamer;
 
 
 private:
@@ -157,7 +189,7 @@ private:
 
 	VkSurfaceFormatKHR ChooseUISwapChainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& vecAvailableFormats);
 
-	VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, UINT uiMipLevelCount, UINT uiLayerCount, UINT uiFaceCount);
+	VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, UINT uiMipLevelCount, UINT uiLayerCount, UINT uiFaceCount, UINT uiBaseMipLevel = 0);
 
 	void CreateDepthImage();
 	void CreateDepthImageView();
@@ -180,14 +212,23 @@ private:
 		glm::mat4 view;
 		glm::mat4 proj;
 		float lod = 0.f;
+
+		//Ӧshader.fragеͬԱ
+		UINT uiVirtualTextureEnable = 0;
+		UINT uiVirtualPageCountX = 0;
+		UINT uiVirtualMipCount = 0;
+		UINT uiVirtualLayerCount = 0;
 	};
 
-	struct DynamicUniformBufferObject
+	//impostorõpipeline layout
+	struct PlanetPushConstant
 	{
-		glm::mat4* model;
-		float* fTextureIndex;
+		UINT uiSubdivision; //ʮÿߵķֶ
 	};
 
+	//ϸּ0~6ÿֳ4^level
+	static constexpr UINT PLANET_SUBDIVISION_LEVEL_COUNT = 7;
+
 	void AllocateBufferMemory(VkMemoryPropertyFlags propertyFlags, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 	void CreateBufferAndBindMemory(VkDeviceSize deviceSize, VkBufferUsageFlags usageFlags,
 		VkMemoryPropertyFlags propertyFlags, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
@@ -201,6 +242,21 @@ private:
 	bool CheckFormatHasStencilComponent(VkFormat format);
 	void ChangeImageLayout(VkImage image, VkFormat format, UINT uiMipLevelCount, UINT uiLayerCount, UINT uiFaceCount, VkImageLayout oldLayout, VkImageLayout newLayout);
 	void TransferImageDataByStageBuffer(const void* pData, VkDeviceSize imageSize, VkImage& image, UINT uiWidth, UINT uiHeight);
+	//RGBA8ϴmip 0Уmipʱȫshader readonly
+	void TransferImageDataAndGenerateMipmaps(const void* pData, VkImage& image, VkFormat format, UINT uiWidth, UINT uiHeight, UINT uiMipLevelCount, UINT uiLayerCount);
+	//funcWriteLevel0ֱstagingдmip 0ͼ񲻱ڶƴRGBA
+	void TransferImageDataAndGenerateMipmaps(const std::function<void(UCHAR*)>& funcWriteLevel0, VkImage& image, VkFormat format, UINT uiWidth, UINT uiHeight, UINT uiMipLevelCount, UINT uiLayerCount);
+	//֣staging׼worker߳нУ¼ƽcommand bufferִstaging
+	void PrepareMipmapStaging(const std::function<void(UCHAR*)>& funcWriteLevel0, VkFormat format, UINT uiWidth, UINT uiHeight, UINT uiMipLevelCount, UINT uiLayerCount, DZW_VulkanWrap::StagingUpload& upload);
+	void RecordStagingUpload(VkCommandBuffer commandBuffer, const DZW_VulkanWrap::StagingUpload& upload, VkImage image, UINT uiMipLevelCount, UINT uiLayerCount);
+	//ֻϴ[uiBaseMip, uiEndMip)⼸תΪshader readonlyС˳𼶵ãuiEndMipΪuiMipLevelCountʱǵһ
+	void RecordStagingUploadLevels(VkCommandBuffer commandBuffer, const DZW_VulkanWrap::StagingUpload& upload, VkImage image, UINT uiBaseMip, UINT uiEndMip, UINT uiMipLevelCount, UINT uiLayerCount);
+	void DestroyStagingUpload(DZW_VulkanWrap::StagingUpload& upload);
+	bool CheckFormatSupportBlit(VkFormat format);
+	bool CheckFormatSupportSampling(VkFormat format);
+	//VK_EXT_memory_budgetdevice local heapԤ뵱ǰռ֮ͣδøչʱfalse
+	bool QueryDeviceLocalMemoryBudget(UINT64& ullBudget, UINT64& ullUsage);
+	static UINT CalculateMipLevelCount(UINT uiWidth, UINT uiHeight) { return static_cast<UINT>(std::bit_width(std::max(uiWidth, uiHeight))); }
 	
 	void CreateDescriptorSetLayout();
 	void CreateDescriptorPool();
@@ -220,6 +276,11 @@ private:
 
 	void RecordCommandBuffer(VkCommandBuffer& commandBuffer, UINT uiIdx);
 	void UpdateUniformBuffer(UINT uiIdx);
+	void DrawPlanets(VkCommandBuffer commandBuffer, UINT uiIdx);
+
+	//Planet ImpostorͶӰ뾶ֵǻıΣƬԪн
+	void CreatePlanetImpostorShaderModule();
+	void CreatePlanetImpostorPipeline();
 	void Render();
 
 	void WindowResize();
@@ -234,6 +295,15 @@ private:
 	void CreatePointLightPipelineLayout();
 	void CreatePointLightPipeline();
 
+	//Instanced Meshbinding 1ΪʵInstanceDataģ;ǰ + paramsСǹ
+	static VkVertexInputBindingDescription GetInstanceBindingDescription();
+	static std::array<VkVertexInputAttributeDescription, 4> GetInstanceAttributeDescriptions();
+	void CreateInstanceBuffer();
+	void CreateInstancedResource();
+	void CreateInstancedShaderModule();
+	void CreateInstancedPipelineLayout();
+	void CreateInstancedPipeline();
+
 
 	void CreateShadowMapResource();
 	void CreateShadowMapImage();
@@ -242,6 +312,9 @@ private:
 	void CreateShadowMapFrameBuffer();
 	void CreateShadowMapUniformBufferAndMemory();
 	void UpdateShadowMapUniformBuffer();
+	void CullShadowCascadeCasters(UINT uiCascadeIdx, const glm::mat4& lightView, float fRadius, float& fMinDepth);
+	void MarkShadowCasterDirty() { ++m_uiShadowCasterVersion; }
+	bool IsShadowMapDirty();
 	void CreateShadowMapShaderModule();
 	void CreateShadowMapDescriptorSetLayout();
 	void CreateShadowMapDescriptorPool();
@@ -249,14 +322,185 @@ private:
 	void CreateShadowMapPipelineLayout();
 	void CreateShadowMapPipeline();
 
+	void CreateOmniShadowResource();
+	void CreateOmniShadowImage();
+	void CreateOmniShadowRenderPass();
+	void CreateOmniShadowFrameBuffer();
+	void CreateOmniShadowUniformBufferAndMemory();
+	void UpdateOmniShadowUniformBuffer();
+	void CullOmniShadowCasters(const glm::vec3& lightPos, const glm::mat4* pFaceViewProj);
+	void CreateOmniShadowShaderModule();
+	void CreateOmniShadowDescriptorSetLayout();
+	void CreateOmniShadowDescriptorPool();
+	void CreateOmniShadowDescriptorSet();
+	void CreateOmniShadowPipelineLayout();
+	void CreateOmniShadowPipeline();
+
+	//Shader hot reload
+	struct ShaderHotReloadTarget
+	{
+		std::unordered_map<VkShaderStageFlagBits, VkShaderModule>* pMapShaderModule = nullptr;
+		std::vector<VkPipeline*> vecPipeline;
+		std::function<void()> funcCreateShader;
+		std::function<void()> funcCreatePipeline;
+	};
+
+	VkShaderModule CreateShaderModuleByName(const std::string& strShaderName, VkShaderStageFlagBits stage);
+	void RegisterShaderHotReloadTargets();
+	void ProcessShaderHotReload();
+
+	//ӳ٣ʱ滻ԴԱin-flight֡command buffer
+	//¼ʱ֡ţSwapChain Image֡Ӧfenceѵȴ٣֡ѭвҪvkDeviceWaitIdle
+	struct RetiredResource
+	{
+		std::vector<VkPipeline> vecPipeline;
+		std::vector<VkShaderModule> vecShaderModules;
+		std::vector<VkImageView> vecImageView;
+		std::vector<VkBuffer> vecBuffer;
+		std::vector<VkDeviceMemory> vecMemory;
+		UINT64 uiRetireFrame = 0;
+	};
+
+	RetiredResource& GetCurrentRetiredResource();
+	void RetirePipeline(VkPipeline pipeline);
+	void RetireShaderModule(VkShaderModule shaderModule);
+	void RetireImageView(VkImageView imageView);
+	void RetireBuffer(VkBuffer buffer, VkDeviceMemory memory);
+	void DestroyRetiredResources(bool bForce);
+
+	//GPU Timestamp
+	void CreateTimestampQueryPool();
+	void ReadTimestampQueryResult(UINT uiIdx);
+
 public:
 	std::vector<PlanetInfo> m_vecPlanetInfo;
 	void LoadPlanetInfo();
 
+	OrbitSystem m_OrbitSystem;
+	OrbitSystem* GetOrbitSystem() { return &m_OrbitSystem; }
+	std::chrono::high_resolution_clock::time_point m_LastOrbitTime; //Initʱãغʱģʱ
+
+	//Asteroid Belt
+	static constexpr UINT ASTEROID_BELT_CAPACITY = 200000;
+	bool m_bEnableAsteroidBelt = false;
+	int m_nAsteroidCount = 100000;
+	AsteroidBelt m_AsteroidBelt;
+	std::unique_ptr<DZW_VulkanWrap::Model> m_AsteroidModel;
+	bool m_bAsteroidBeltGPUCompute = false; //GPU·computeдinstance bufferindirectCPUӴСǵ
+	AsteroidBeltCompute m_AsteroidBeltCompute;
+	void CreateAsteroidBeltResource();
+	void UpdateAsteroidBelt(UINT uiIdx);
+	void RecordAsteroidBeltCompute(VkCommandBuffer commandBuffer);
+	void DrawAsteroidBelt(VkCommandBuffer commandBuffer, UINT uiIdx);
+
+	bool* GetAsteroidBeltEnable() { return &m_bEnableAsteroidBelt; }
+	bool* GetAsteroidBeltGPUCompute() { return &m_bAsteroidBeltGPUCompute; }
+	int* GetAsteroidCount() { return &m_nAsteroidCount; }
+	AsteroidBelt* GetAsteroidBelt() { return &m_AsteroidBelt; }
+
+	//Planet TerrainеεʱĲοǵ
+	struct PlanetTerrainPushConstant
+	{
+		glm::mat4 model;
+		float fTextureLayer;
+	};
+
+	bool m_bEnablePlanetTerrain = true;
+	float m_fPlanetTerrainActivatePixel = 256.f; //Ļϰ뾶ʱõ
+	UINT64 m_uiPlanetTerrainBudgetBytes = 64ull << 20; //פοޣͬʱشС
+	PlanetTerrain m_PlanetTerrain;
+	std::vector<int> m_vecPlanetTerrainBody; //ʵ± -> body-1ʾûе
+	int m_nPlanetTerrainInstance = -1; //֡ԵλƵʵ-1ʾû
+	glm::mat4 m_PlanetTerrainModel;
+	VkBuffer m_PlanetTerrainVertexBuffer;
+	VkDeviceMemory m_PlanetTerrainVertexBufferMemory;
+	TerrainVertex* m_pPlanetTerrainVertex = nullptr; //־ӳ䣬ο鰴slotд
+	VkBuffer m_PlanetTerrainIndexBuffer;
+	VkDeviceMemory m_PlanetTerrainIndexBufferMemory;
+	UINT m_uiPlanetTerrainIndexCount = 0;
+	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapPlanetTerrainShaderModule;
+	VkPipelineLayout m_PlanetTerrainPipelineLayout;
+	VkPipeline m_PlanetTerrainPipeline;
+	void CreatePlanetTerrainResource();
+	void CreatePlanetTerrainShaderModule();
+	void CreatePlanetTerrainPipelineLayout();
+	void CreatePlanetTerrainPipeline();
+	void DrawPlanetTerrain(VkCommandBuffer commandBuffer, UINT uiIdx);
+
+	bool* GetPlanetTerrainEnable() { return &m_bEnablePlanetTerrain; }
+	float* GetPlanetTerrainActivatePixel() { return &m_fPlanetTerrainActivatePixel; }
+	PlanetTerrain* GetPlanetTerrain() { return &m_PlanetTerrain; }
+	const char* GetPlanetTerrainBodyDesc() const { return m_nPlanetTerrainInstance < 0 ? "None" : m_vecPlanetInfo[m_nPlanetTerrainInstance].strDesc.c_str(); }
+
+	//Virtual Textureͼpageʽصatlasfragment shaderҪpageдfeedback
+	bool m_bEnableVirtualTexture = true;
+	bool m_bVirtualTextureSupported = false; //feedbackҪfragmentStoresAndAtomics
+	UINT m_uiVirtualTextureWidth = 8192;
+	UINT64 m_uiVirtualTextureBudgetBytes = 64ull << 20; //atlasС
+	VirtualTexture m_VirtualTexture;
+	VkImage m_VirtualAtlasImage;
+	VkDeviceMemory m_VirtualAtlasImageMemory;
+	VkImageView m_VirtualAtlasImageView;
+	VkSampler m_VirtualAtlasSampler;
+	std::vector<VkImage> m_vecVirtualPageTableImage; //ÿ֡һݣ⸲Ƿе֡ڶȡpage table
+	std::vector<VkDeviceMemory> m_vecVirtualPageTableImageMemory;
+	std::vector<VkImageView> m_vecVirtualPageTableImageView;
+	std::vector<UINT64> m_vecVirtualPageTableVersion;
+	VkSampler m_VirtualPageTableSampler;
+	VkBuffer m_VirtualFeedbackBuffer; //device localshaderͨatomicOrд
+	VkDeviceMemory m_VirtualFeedbackBufferMemory;
+	VkBuffer m_VirtualFeedbackReadbackBuffer;
+	VkDeviceMemory m_VirtualFeedbackReadbackBufferMemory;
+	UCHAR* m_pVirtualFeedbackReadback = nullptr;
+	VkDeviceSize m_VirtualFeedbackFrameSize = 0;
+	VkBuffer m_VirtualStagingBuffer;
+	VkDeviceMemory m_VirtualStagingBufferMemory;
+	UCHAR* m_pVirtualStaging = nullptr;
+	VkDeviceSize m_VirtualStagingFrameSize = 0;
+	std::vector<UINT> m_vecVirtualUploadSlot; //֡ϴpageڵatlas slot
+	bool m_bVirtualPageTableUpload = false;
+	void CreateVirtualTextureResource();
+	void CheckPlanetTextureLayers();
+	void UpdateVirtualTexture(UINT uiIdx);
+	void RecordVirtualTextureUpload(VkCommandBuffer commandBuffer, UINT uiIdx);
+	void RecordVirtualTextureReadback(VkCommandBuffer commandBuffer, UINT uiIdx);
+
+	bool* GetVirtualTextureEnable() { return &m_bEnableVirtualTexture; }
+	bool IsVirtualTextureSupported() const { return m_bVirtualTextureSupported; }
+	VirtualTexture* GetVirtualTexture() { return &m_VirtualTexture; }
+
+	//TextureFactorǰ決ΪBCѹKTX<source>.bc.ktx豸֧BCʱRGBA8
+	bool m_bEnableTextureCompression = true;
+	bool IsTextureCompressionEnabled() const { return m_bEnableTextureCompression; }
+
+	//·ԤʱLRṶٱõ
+	UINT64 m_ullTextureCacheBudgetBytes = 512ull << 20;
+	TextureCache m_TextureCache;
+	TextureCache* GetTextureCache() { return &m_TextureCache; }
+
+	//ģ͹õsamplerͬ״ֻ̬һΣԱ豸޽ض
+	bool m_bSamplerAnisotropyEnabled = false;
+	float m_fSamplerAnisotropy = 16.f;
+	SamplerCache m_SamplerCache;
+	SamplerCache* GetSamplerCache() { return &m_SamplerCache; }
+
+	//ں̨أϴǰplaceholderÿ֡descriptor set¼дʱ汾ͬʱд
+	TextureStreamer m_TextureStreamer;
+	TextureStreamer* GetTextureStreamer() { return &m_TextureStreamer; }
+	std::vector<UINT> m_vecPlanetTextureVersion;
+	std::vector<UINT> m_vecSkyboxTextureVersion;
+	void UpdateStreamedTextureDescriptorSets(UINT uiIdx);
+
 public:
 	Camera m_Camera;
 	void SetupCamera();
 
+	//reversed-ZԶͶӰpasspipelineȱȽdepth clearɴ˾ڴpipeline֮ǰȷ
+	//shadow passʹùԴԼı׼ͶӰӰ
+	bool m_bReversedZ = true;
+	VkCompareOp GetDepthCompareOp() const { return m_bReversedZ ? VK_COMPARE_OP_GREATER_OR_EQUAL : VK_COMPARE_OP_LESS_OR_EQUAL; }
+	float GetDepthClearValue() const { return m_bReversedZ ? 0.f : 1.f; }
+
 	UINT m_uiFPS;
 	UINT m_uiFrameCounter;
 	UINT GetFPS() { return m_uiFPS; }
@@ -289,12 +533,33 @@ public:
 
 
 	void SetTextureLod(float fLod) { m_UboData.lod = fLod; }
+	bool* GetPlanetEnable() { return &m_bEnablePlanet; }
+	bool* GetPlanetImpostorEnable() { return &m_bEnablePlanetImpostor; }
+	float* GetPlanetImpostorPixelThreshold() { return &m_fPlanetImpostorPixelThreshold; }
+	float* GetPlanetTessellationError() { return &m_fPlanetTessellationErrorPixel; }
+	const std::array<UINT, PLANET_SUBDIVISION_LEVEL_COUNT>& GetPlanetLevelInstanceCount() const { return m_aryPlanetLevelInstanceCount; }
+	UINT GetPlanetMeshCount() const { return m_uiPlanetMeshCount; }
+	UINT GetPlanetImpostorCount() const { return m_uiPlanetImpostorCount; }
 	//UINT GetTextureMaxLod() { return m_Texture.m_uiMipLevelNum; }
 
 	VkCommandBuffer& GetCommandBuffer(UINT uiIdx) { return m_vecCommandBuffers[uiIdx]; }
 
 	glm::vec3 GetCameraPosition() { return m_Camera.GetPosition(); }
 
+	int* GetShadowMode() { return &m_nShadowMode; }
+	int* GetShadowPCFRadius() { return &m_nPCFRadius; }
+	int* GetShadowBlockerSearchRadius() { return &m_nBlockerSearchRadius; }
+	bool* GetShadowCacheEnable() { return &m_bEnableShadowCache; }
+	bool IsShadowMapRenderedLastFrame() { return m_bShadowMapRenderedLastFrame; }
+	int* GetShadowLightType() { return &m_nShadowLightType; }
+	float* GetOmniShadowFarPlane() { return &m_fOmniShadowFarPlane; }
+	UINT GetOmniShadowDrawnFaceCount() { return m_uiOmniShadowDrawnFaceCount; }
+	int* GetShadowCascadeCount() { return &m_nShadowCascadeCount; }
+	float* GetShadowCascadeSplitLambda() { return &m_fShadowCascadeSplitLambda; }
+	float GetShadowCascadeSplitDepth(UINT uiIdx) { return m_aryShadowCascadeSplitDepth[uiIdx]; }
+	UINT GetShadowCascadeCasterCount(UINT uiIdx) { return static_cast<UINT>(m_aryShadowCascadeCasters[uiIdx].size()); }
+	float GetCommonPassGPUTime() { return m_fCommonPassGPUTime; }
+
 	bool* GetSkyboxEnable() { return &m_bEnableSkybox; }
 	float* GetSkyboxRotateSpeed() { return &m_fSkyboxRotateSpeed; }
 
@@ -310,17 +575,61 @@ public:
 	DZW_MaterialWrap::PBRMaterial* GetPBRMaterial() { return &m_PBRMaterial; }
 
 public:
+	//Common/shader.fragShadowMap/shader.vertеSHADOW_CASCADE_MAXһ
+	static constexpr UINT SHADOW_CASCADE_MAX = 4;
+	//PCF/Blocker Searchkernel뾶Χkernel = (2 * radius + 1)^2
+	static constexpr int SHADOW_FILTER_RADIUS_MIN = 1;
+	static constexpr int SHADOW_FILTER_RADIUS_MAX = 6;
+
+	struct ShadowCascadeUniformBufferObject
+	{
+		glm::mat4 viewProj[SHADOW_CASCADE_MAX];
+	};
+
+	enum ShadowLightType
+	{
+		SHADOW_LIGHT_DIRECTIONAL = 0, //Cascaded Shadow Map
+		SHADOW_LIGHT_POINT, //Cube Shadow Map
+	};
+
+	struct OmniShadowUniformBufferObject
+	{
+		glm::mat4 faceViewProj[6]; //cube map6
+		glm::vec4 lightPos; //wΪfar planeڰѾһ[0, 1]
+	};
+
 	struct CommonMVPUniformBufferObject
 	{
 		glm::mat4 model;
 		glm::mat4 view;
 		glm::mat4 proj;
 		glm::mat4 mv_normal; //ڽnormalתͼռ
-		glm::mat4 lightPovMVP; //ԴλõMVP
+		glm::mat4 lightPovMVP[SHADOW_CASCADE_MAX]; //ÿcascadeĹԴVP
+		glm::vec4 cascadeSplits; //ÿcascadeͼռԶ˾
 		glm::vec3 lightPos;
+		int nCascadeCount; //ռlightPospaddingstd140һ
+		int nShadowLightType;
+		float fOmniShadowFarPlane;
+	};
+
+	enum ShadowMode
+	{
+		SHADOW_MODE_HARD = 0,
+		SHADOW_MODE_PCF,
+		SHADOW_MODE_PCSS,
+		SHADOW_MODE_COUNT,
+	};
+
+	//ӦCommon/shader.fragеconstant_id
+	struct ShadowSpecializationData
+	{
+		int nShadowMode;
+		int nPCFRadius;
+		int nBlockerSearchRadius;
 	};
 
 	void CreateCommonShader();
+	void RecreateCommonGraphicPipelineIfFilterChanged();
 
 	void CreateCommonMVPUniformBufferAndMemory();
 	void UpdateCommonMVPUniformBuffer(UINT uiIdx);
@@ -539,6 +848,9 @@ private:
 	const std::vector<const char*> m_vecDeviceExtensions = {
 		VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 	};
+	//ѡչ֧ʱ
+	bool m_bPhysicalDeviceProperties2Enabled = false;
+	bool m_bMemoryBudgetEnabled = false;
 	VkQueue m_GraphicQueue;
 	VkQueue m_PresentQueue;
 
@@ -570,9 +882,23 @@ private:
 	std::vector<VkFence> m_vecInFlightFences;
 
 	UINT m_uiCurFrameIdx;
+	UINT64 m_uiFrameNumber = 0; //ۼ֡FPSͳ
 
 	bool m_bNeedResize = false;
 
+	//Shader Hot Reload
+	bool m_bEnableShaderHotReload;
+	ShaderHotReload m_ShaderHotReload;
+	std::unordered_map<std::string, ShaderHotReloadTarget> m_mapShaderHotReloadTarget;
+	std::set<const DZW_EmbeddedShader::EmbeddedSpirv*> m_setHotReloadedSpirv; //عshaderΪӴ̶ȡspv
+
+	//GPU Timestamp
+	VkQueryPool m_TimestampQueryPool = VK_NULL_HANDLE;
+	float m_fTimestampPeriod = 1.f; //ÿtick
+	std::vector<bool> m_vecTimestampWritten;
+	float m_fCommonPassGPUTime = 0.f; //ms
+	std::vector<RetiredResource> m_vecRetiredResource; //֡ŵ
+
 	//Point Light
 	DZW_LightWrap::BlinnPhongPointLight m_PointLight;
 	std::unique_ptr<DZW_VulkanWrap::Model> m_PointLightModel;
@@ -586,18 +912,36 @@ private:
 	VkDescriptorSetLayout m_PointLightDescriptorSetLayout;
 	VkDescriptorSet m_PointLightDescriptorSet;
 
+	//Instanced Mesh
+	struct InstancedPushConstant
+	{
+		glm::mat4 viewProj;		//ƽ
+		glm::vec4 color;
+		glm::vec4 origin;		//꣬shaderдʵλϼȥ
+	};
+	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapInstancedShaderModule;
+	VkPipeline m_InstancedPipeline;
+	VkPipelineLayout m_InstancedPipelineLayout;
+
+	//ÿswap chain imageһΣǰASTEROID_BELT_CAPACITYΪСǣ֮Ϊ
+	VkBuffer m_InstanceBuffer;
+	VkDeviceMemory m_InstanceBufferMemory;
+	InstanceData* m_pInstanceData = nullptr; //־ӳ
+	UINT m_uiInstanceFrameCount = 0; //ÿεʵ
+
 	//Shadow
 	VkExtent2D m_ShadowMapExtent2D = { 2048, 2048 };
 	VkFormat m_ShadowMapFormat = VK_FORMAT_D16_UNORM;
 	VkRenderPass m_ShadowMapRenderPass;
 	VkImage m_ShadowMapDepthImage;
-	VkImageView m_ShadowMapDepthImageView;
+	VkImageView m_ShadowMapDepthImageView; //2D Arrayڲ
 	VkDeviceMemory m_ShadowMapDepthImageMemory;
 	VkSampler m_ShadowMapSampler; //ShadowMapв
-	VkFramebuffer m_ShadowMapFrameBuffer; //ֻҪһ
+	std::array<VkImageView, SHADOW_CASCADE_MAX> m_aryShadowMapCascadeImageView; //ÿһattachment
+	std::array<VkFramebuffer, SHADOW_CASCADE_MAX> m_aryShadowMapFrameBuffer;
 	VkBuffer m_ShadowMapUniformBuffer;
 	VkDeviceMemory m_ShadowMapUniformBufferMemory;
-	MVPUniformBufferObject m_ShadowMapUBOData;
+	ShadowCascadeUniformBufferObject m_ShadowMapUBOData;
 	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapShadowMapShaderModule;
 	VkPipeline m_ShadowMapPipeline;
 	VkPipelineLayout m_ShadowMapPipelineLayout;
@@ -605,6 +949,45 @@ private:
 	VkDescriptorSetLayout m_ShadowMapDescriptorSetLayout;
 	VkDescriptorSet m_ShadowMapDescriptorSet;
 
+	//Shadow Cache
+	//ԴͶӰ仯ʱ汾ţ汾ϴȾʱһshadow pass
+	bool m_bEnableShadowCache = true;
+	bool m_bShadowMapRenderedLastFrame = false;
+	UINT64 m_uiShadowLightVersion = 1;
+	UINT64 m_uiShadowCasterVersion = 1;
+	UINT64 m_uiShadowMapRenderedLightVersion = 0;
+	UINT64 m_uiShadowMapRenderedCasterVersion = 0;
+
+	//Cascaded Shadow Map
+	int m_nShadowCascadeCount = SHADOW_CASCADE_MAX;
+	float m_fShadowCascadeSplitLambda = 0.95f; //0Ϊз֣1Ϊз
+	std::array<float, SHADOW_CASCADE_MAX> m_aryShadowCascadeSplitDepth{};
+	std::array<std::vector<UINT>, SHADOW_CASCADE_MAX> m_aryShadowCascadeCasters; //ÿcascadeɼSubMesh
+
+	//Omni Shadow
+	//Դʹcube shadow mapgeometry shaderͨgl_Layerһpassд6
+	int m_nShadowLightType = SHADOW_LIGHT_POINT;
+	int m_nShadowMapRenderedLightType = -1;
+	VkExtent2D m_OmniShadowExtent2D = { 1024, 1024 };
+	VkFormat m_OmniShadowFormat = VK_FORMAT_D16_UNORM; //洢Ծ룬֧ʱʹD32_SFLOAT
+	float m_fOmniShadowFarPlane = 1000.f;
+	VkRenderPass m_OmniShadowRenderPass;
+	VkImage m_OmniShadowDepthImage;
+	VkDeviceMemory m_OmniShadowDepthImageMemory;
+	VkImageView m_OmniShadowCubeImageView; //Cubeڲ
+	VkImageView m_OmniShadowLayeredImageView; //62D Arraylayered attachment
+	VkFramebuffer m_OmniShadowFrameBuffer;
+	VkBuffer m_OmniShadowUniformBuffer;
+	VkDeviceMemory m_OmniShadowUniformBufferMemory;
+	OmniShadowUniformBufferObject m_OmniShadowUBOData;
+	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapOmniShadowShaderModule;
+	VkPipeline m_OmniShadowPipeline;
+	VkPipelineLayout m_OmniShadowPipelineLayout;
+	VkDescriptorPool m_OmniShadowDescriptorPool;
+	VkDescriptorSetLayout m_OmniShadowDescriptorSetLayout;
+	VkDescriptorSet m_OmniShadowDescriptorSet;
+	std::vector<UINT> m_vecOmniShadowFaceMask; //ÿSubMeshɼ棬bit iӦcubeĵi
+	UINT m_uiOmniShadowDrawnFaceCount = 0;
 
 	/********************Դ**********************/
 
@@ -621,9 +1004,15 @@ private:
 	VkDescriptorSet m_CommonDescriptorSet;
 
 	VkPipelineLayout m_CommonGraphicPipelineLayout;
-	VkPipeline m_CommonGraphicPipeline;
+	std::array<VkPipeline, SHADOW_MODE_COUNT> m_aryCommonGraphicPipeline; //ÿӰģʽһpipeline
 	VkPipelineCache m_CommonGraphicPipelineCache = VK_NULL_HANDLE;
 
+	int m_nShadowMode = SHADOW_MODE_PCSS;
+	int m_nPCFRadius = 3;
+	int m_nBlockerSearchRadius = 2;
+	int m_nLastPCFRadius = m_nPCFRadius; //kernel뾶specialization constantıؽpipeline
+	int m_nLastBlockerSearchRadius = m_nBlockerSearchRadius;
+
 	std::unique_ptr<DZW_VulkanWrap::Model> m_testObjModel;
 
 
@@ -641,7 +1030,6 @@ private:
 	std::unique_ptr<DZW_VulkanWrap::Model> m_testGLTFModel;
 
 	//Planets
-	std::unordered_map<VkShaderStageFlagBits, std::filesystem::path> m_mapShaderPath;
 	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapShaderModule;
 
 	std::vector<VkBuffer> m_vecUniformBuffers;
@@ -649,24 +1037,36 @@ private:
 	UniformBufferObject m_UboData;
 	size_t m_UboBufferSize;
 
-	//DZW_VulkanWrap::Texture m_Texture;
+	bool m_bEnablePlanet = false;
+	std::shared_ptr<DZW_VulkanWrap::Texture> m_PlanetTexture;
 
 	VkDescriptorSetLayout m_DescriptorSetLayout;
 	VkDescriptorPool m_DescriptorPool;
 	std::vector<VkDescriptorSet> m_vecDescriptorSets;
 
-	//Dynamic Uniform
-	std::vector<VkBuffer> m_vecDynamicUniformBuffers;
-	std::vector<VkDeviceMemory> m_vecDynamicUniformBufferMemories;
-	size_t m_DynamicAlignment;
-	DynamicUniformBufferObject m_DynamicUboData;
-	size_t m_DynamicUboBufferSize;
+	VkPipelineLayout m_GraphicPipelineLayout;
+	VkPipeline m_GraphicPipeline;
+
+	//Instancingģ;Ϊʵԣдm_InstanceBufferС֮Ĳ
+	//ɶɫgl_VertexIndexɣÿϸּһDraw
+
+	//ÿʵϸּӵ͵Уimpostorʵ
+	float m_fPlanetTessellationErrorPixel = 0.5f; //ʵƫأ
+	std::array<UINT, PLANET_SUBDIVISION_LEVEL_COUNT> m_aryPlanetLevelInstanceCount{};
+
+	//Impostor
+	bool m_bEnablePlanetImpostor = true;
+	float m_fPlanetImpostorPixelThreshold = 8.f; //Ļϰ뾶Сڸʱimpostor
+	UINT m_uiPlanetMeshCount = 0;
+	UINT m_uiPlanetImpostorCount = 0;
+	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapPlanetImpostorShaderModule;
+	VkPipeline m_PlanetImpostorPipeline;
 
 	//Skybox
 	bool m_bEnableSkybox = true;
 	float m_fSkyboxRotateSpeed = 1.f;
 	std::unique_ptr<DZW_VulkanWrap::Model> m_SkyboxModel;
-	std::unique_ptr<DZW_VulkanWrap::Texture> m_SkyboxTexture;
+	std::shared_ptr<DZW_VulkanWrap::Texture> m_SkyboxTexture;
 	std::unordered_map<VkShaderStageFlagBits, VkShaderModule> m_mapSkyboxShaderModule;
 	SkyboxUniformBufferObject m_SkyboxUboData;
 	std::vector<VkBuffer> m_vecSkyboxUniformBuffers;
@@ -692,8 +1092,8 @@ private:
 	std::vector<VkDeviceMemory> m_vecMeshGridUniformBufferMemories;
 	VkBuffer m_MeshGridVertexBuffer = VK_NULL_HANDLE;
 	VkDeviceMemory m_MeshGridVertexBufferMemory = VK_NULL_HANDLE;
-	VkBuffer m_MeshGridIndexBuffer;
-	VkDeviceMemory m_MeshGridIndexBufferMemory;
+	VkBuffer m_MeshGridIndexBuffer = VK_NULL_HANDLE;
+	VkDeviceMemory m_MeshGridIndexBufferMemory = VK_NULL_HANDLE;
 	VkDescriptorSetLayout m_MeshGridDescriptorSetLayout;
 	VkDescriptorPool m_MeshGridDescriptorPool;
 	std::vector<VkDescriptorSet> m_vecMeshGridDescriptorSets;
@@ -42,10 +42,17 @@ namespace DZW_VulkanUtils
 	}
 	VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& vecBytecode)
 	{
+		ASSERT(vecBytecode.size() % sizeof(UINT) == 0, "Shader bytecode size is not a multiple of 4");
+		return CreateShaderModule(device, std::span<const UINT>(reinterpret_cast<const UINT*>(vecBytecode.data()), vecBytecode.size() / sizeof(UINT)));
+	}
+	VkShaderModule CreateShaderModule(VkDevice device, std::span<const UINT> spirv)
+	{
+		ASSERT(!spirv.empty(), "Shader bytecode is empty");
+
 		VkShaderModuleCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = vecBytecode.size();
-		createInfo.pCode = reinterpret_cast<const UINT*>(vecBytecode.data());
+		createInfo.codeSize = spirv.size_bytes();
+		createInfo.pCode = spirv.data();
 
 		VkShaderModule shaderModule;
 		VULKAN_ASSERT(vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule), "Create shader module failed");
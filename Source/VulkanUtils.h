@@ -2,6 +2,7 @@
 #include "vulkan/vulkan.h"
 #include <unordered_map>
 #include <filesystem>
+#include <span>
 
 #include "tiny_gltf.h"
 
@@ -72,6 +73,7 @@ namespace DZW_VulkanUtils
 
 	std::vector<char> ReadShaderFile(const std::filesystem::path& filepath);
 	VkShaderModule CreateShaderModule(VkDevice device, const std::vector<char>& vecBytecode);
+	VkShaderModule CreateShaderModule(VkDevice device, std::span<const uint32_t> spirv);
 
 	std::tuple<VkFilter, VkFilter, VkSamplerMipmapMode> TinyGltfFilterToVulkan(int tinygltfMinFilter, int tinygltfMagFilter);
 	VkSamplerAddressMode TinyGltfWrapModeToVulkan(int tinygltfWrapMode);
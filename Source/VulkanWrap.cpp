@@ -3,6 +3,9 @@
 
 #include "Log.h"
 #include "VulkanUtils.h"
+#include "TextureBaker.h"
+#include "MappedFile.h"
+#include "ImageDecoder.h"
 
 #include <random>
 
@@ -21,31 +24,57 @@
 
 #define VULKAN_FLIP_Y true
 
+//tinygltfֻݣImageDecoder̳߳
+static bool StoreEncodedGLTFImage(tinygltf::Image* pImage, const int nImageIdx, std::string* pError, std::string* pWarning,
+	int nRequestWidth, int nRequestHeight, const unsigned char* pBytes, int nSize, void* pUserData)
+{
+	pImage->image.assign(pBytes, pBytes + nSize);
+	return true;
+}
+
 namespace DZW_VulkanWrap
 {
-	std::unique_ptr<Texture> TextureFactor::CreateTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath)
+	std::shared_ptr<Texture> TextureFactor::CreateTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath)
 	{
-		if (filepath.extension() == ".ktx")
-			return std::make_unique<KTXTexture>(pRenderer, filepath);
+		std::shared_ptr<Texture> pTexture;
+
+		//ȼغ決õBCѹKTX決ʧʱԼԴļ
+		std::filesystem::path bakedPath = filepath;
+		if (pRenderer->IsTextureCompressionEnabled())
+			bakedPath = TextureBaker::Bake(filepath);
+
+		if (bakedPath != filepath)
+			pTexture = std::make_shared<KTXTexture>(pRenderer, bakedPath);
+		else if (filepath.extension() == ".ktx")
+			pTexture = std::make_shared<KTXTexture>(pRenderer, filepath);
 		else if (filepath.extension() == ".jpg"
 			|| filepath.extension() == ".png"
 			|| filepath.extension() == ".tga"
 			|| filepath.extension() == ".bmp"
 			|| filepath.extension() == ".gif")
-			return std::make_unique<NormalTexture>(pRenderer, filepath);
+			pTexture = std::make_shared<NormalTexture>(pRenderer, filepath);
 		else
 		{
 			Log::Error("Unsupport texture format");
 			return nullptr;
 		}
+
+		pRenderer->GetTextureStreamer()->Enqueue(pTexture);
+		return pTexture;
 	}
 
 	Texture::~Texture()
 	{
+		ReleaseStaging();
+
+		if (m_ImageView != m_PlaceholderImageView)
+			vkDestroyImageView(m_pRenderer->m_LogicalDevice, m_ImageView, nullptr);
 		vkDestroyImage(m_pRenderer->m_LogicalDevice, m_Image, nullptr);
-		vkDestroyImageView(m_pRenderer->m_LogicalDevice, m_ImageView, nullptr);
 		vkFreeMemory(m_pRenderer->m_LogicalDevice, m_Memory, nullptr);
-		vkDestroySampler(m_pRenderer->m_LogicalDevice, m_Sampler, nullptr);
+
+		vkDestroyImageView(m_pRenderer->m_LogicalDevice, m_PlaceholderImageView, nullptr);
+		vkDestroyImage(m_pRenderer->m_LogicalDevice, m_PlaceholderImage, nullptr);
+		vkFreeMemory(m_pRenderer->m_LogicalDevice, m_PlaceholderMemory, nullptr);
 	}
 
 	void Texture::CreateImage()
@@ -53,21 +82,27 @@ namespace DZW_VulkanWrap
 		m_pRenderer->CreateImageAndBindMemory(m_uiWidth, m_uiHeight,
 			m_uiMipLevelNum, m_uiLayerNum, m_uiFaceNum,
 			VK_SAMPLE_COUNT_1_BIT,
-			VK_FORMAT_R8G8B8A8_SRGB,
+			m_Format,
 			VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			m_Image, m_Memory);
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(m_pRenderer->m_LogicalDevice, m_Image, &memoryRequirements);
+		m_MemorySize = memoryRequirements.size;
+		m_uiResidentMipLevel = m_uiMipLevelNum;
 	}
 
-	void Texture::CreateImageView()
+	void Texture::CreateImageView(UINT uiBaseMipLevel)
 	{
 		m_ImageView = m_pRenderer->CreateImageView(m_Image,
-			VK_FORMAT_R8G8B8A8_SRGB,
+			m_Format,
 			VK_IMAGE_ASPECT_COLOR_BIT,
-			m_uiMipLevelNum,
+			m_uiMipLevelNum - uiBaseMipLevel,
 			m_uiLayerNum,
-			m_uiFaceNum
+			m_uiFaceNum,
+			uiBaseMipLevel
 		);
 	}
 
@@ -84,13 +119,9 @@ namespace DZW_VulkanWrap
 		createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 		createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 
-		//ǷԹˣӲһ֧AnisotropyҪȷӲָ֧preperty
-		createInfo.anisotropyEnable = VK_FALSE;
-		if (createInfo.anisotropyEnable == VK_TRUE)
-		{
-			auto& physicalDeviceProperties = m_pRenderer->m_mapPhysicalDeviceInfo.at(m_pRenderer->m_PhysicalDevice).properties;
-			createInfo.maxAnisotropy = physicalDeviceProperties.limits.maxSamplerAnisotropy;
-		}
+		//ǷԹˣӲһ֧AnisotropySamplerCache豸Ƿּ֧޽ض
+		createInfo.anisotropyEnable = VK_TRUE;
+		createInfo.maxAnisotropy = m_pRenderer->m_fSamplerAnisotropy;
 
 		//ѰַģʽΪclamp to borderʱɫ
 		createInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
@@ -107,80 +138,129 @@ namespace DZW_VulkanWrap
 		createInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		createInfo.mipLodBias = 0.f;
 		createInfo.minLod = 0.f;
-		createInfo.maxLod = static_cast<float>(m_uiMipLevelNum);
+		createInfo.maxLod = VK_LOD_CLAMP_NONE; //mipimage view޶Թͬһsampler
+
+		//samplerSamplerCacheУʱ
+		m_Sampler = m_pRenderer->GetSamplerCache()->Acquire(createInfo);
+	}
+
+	void Texture::CreatePlaceholder()
+	{
+		//ֻ1texelͬϴĿԺ
+		UINT uiLayerCount = m_uiLayerNum * m_uiFaceNum;
+		m_pRenderer->CreateImageAndBindMemory(1, 1,
+			1, m_uiLayerNum, m_uiFaceNum,
+			VK_SAMPLE_COUNT_1_BIT,
+			VK_FORMAT_R8G8B8A8_SRGB,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_PlaceholderImage, m_PlaceholderMemory);
+
+		std::vector<UCHAR> vecTexel;
+		for (UINT i = 0; i < uiLayerCount; ++i)
+		{
+			vecTexel.insert(vecTexel.end(), { 0x80, 0x80, 0x80, 0xFF });
+		}
+		m_pRenderer->TransferImageDataAndGenerateMipmaps(vecTexel.data(), m_PlaceholderImage, VK_FORMAT_R8G8B8A8_SRGB, 1, 1, 1, uiLayerCount);
+
+		m_PlaceholderImageView = m_pRenderer->CreateImageView(m_PlaceholderImage,
+			VK_FORMAT_R8G8B8A8_SRGB,
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			1,
+			m_uiLayerNum,
+			m_uiFaceNum
+		);
+		m_ImageView = m_PlaceholderImageView;
+	}
 
-		VULKAN_ASSERT(vkCreateSampler(m_pRenderer->m_LogicalDevice, &createInfo, nullptr, &m_Sampler), "Create texture sampler failed");
+	void Texture::RecordUpload(VkCommandBuffer commandBuffer, UINT uiBaseMipLevel, VkImageView& retiredView)
+	{
+		if (!IsProgressive())
+			uiBaseMipLevel = 0;
+		ASSERT(uiBaseMipLevel < m_uiResidentMipLevel, "Texture {} mip {} is already resident", m_Filepath.string(), uiBaseMipLevel);
+
+		if (m_StagingUpload.bBlitMipmaps)
+			m_pRenderer->RecordStagingUpload(commandBuffer, m_StagingUpload, m_Image, m_uiMipLevelNum, m_uiLayerNum * m_uiFaceNum);
+		else
+			m_pRenderer->RecordStagingUploadLevels(commandBuffer, m_StagingUpload, m_Image, uiBaseMipLevel, m_uiResidentMipLevel, m_uiMipLevelNum, m_uiLayerNum * m_uiFaceNum);
+		m_uiResidentMipLevel = uiBaseMipLevel;
+
+		//֮¼Ƶϴִ֮Улµimage viewviewֻϴmip
+		retiredView = (m_ImageView != m_PlaceholderImageView) ? m_ImageView : VK_NULL_HANDLE;
+		CreateImageView(uiBaseMipLevel);
+		++m_uiVersion;
+		m_LoadState = (uiBaseMipLevel == 0) ? LoadState::LOAD_STATE_RESIDENT : LoadState::LOAD_STATE_PARTIAL;
+	}
+
+	void Texture::ReleaseStaging()
+	{
+		if (m_StagingUpload.buffer != VK_NULL_HANDLE)
+			m_pRenderer->DestroyStagingUpload(m_StagingUpload);
 	}
 
 	NormalTexture::NormalTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath)
 		: Texture(pRenderer, filepath)
 	{
-		//stbһͼ⣬޷ֱӶȡͼƬmipmap㼶
-
-		//ImageMemory
+		//stbһͼ⣬޷ֱӶȡͼƬmipmap㼶mipϴʱGPU
+		//ֻȡߴ磬PrepareStagingн
 		int nTexWidth = 0;
 		int nTexHeight = 0;
 		int nTexChannel = 0;
-		stbi_uc* pixels = stbi_load(m_Filepath.string().c_str(), &nTexWidth, &nTexHeight, &nTexChannel, STBI_rgb_alpha);
-		ASSERT(pixels, std::format("stb load image {} failed", m_Filepath.string()));
-
-		ASSERT(nTexChannel == 4);
+		int res = stbi_info(m_Filepath.string().c_str(), &nTexWidth, &nTexHeight, &nTexChannel);
+		ASSERT(res, std::format("stb read image info {} failed", m_Filepath.string()));
 
 		m_uiWidth = static_cast<UINT>(nTexWidth);
 		m_uiHeight = static_cast<UINT>(nTexHeight);
-		m_uiMipLevelNum = 1;
+		m_uiMipLevelNum = VulkanRenderer::CalculateMipLevelCount(m_uiWidth, m_uiHeight);
 		m_uiLayerNum = 1;
 		m_uiFaceNum = 1;
 
-		m_Size = m_uiWidth * m_uiHeight * static_cast<UINT>(nTexChannel);
+		m_Size = static_cast<size_t>(m_uiWidth) * m_uiHeight * 4;
 
 		CreateImage();
+		CreatePlaceholder();
+		CreateSampler();
+	}
 
-		//copy֮ǰlayoutӳʼundefinedתΪtransfer dst
-		m_pRenderer->ChangeImageLayout(m_Image,
-			VK_FORMAT_R8G8B8A8_SRGB,
-			m_uiMipLevelNum,
-			m_uiLayerNum,
-			m_uiFaceNum,
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	void NormalTexture::PrepareStaging()
+	{
+		int nTexWidth = 0;
+		int nTexHeight = 0;
+		int nTexChannel = 0;
+		stbi_uc* pixels = stbi_load(m_Filepath.string().c_str(), &nTexWidth, &nTexHeight, &nTexChannel, STBI_rgb_alpha);
+		ASSERT(pixels, std::format("stb load image {} failed", m_Filepath.string()));
+		ASSERT(static_cast<UINT>(nTexWidth) == m_uiWidth && static_cast<UINT>(nTexHeight) == m_uiHeight, "Image {} changed while loading", m_Filepath.string());
 
-		m_pRenderer->TransferImageDataByStageBuffer(pixels, m_Size, m_Image, m_uiWidth, m_uiHeight);
+		//mip 0дstagingmipϴʱ
+		m_pRenderer->PrepareMipmapStaging([&](UCHAR* pDst) { memcpy(pDst, pixels, m_Size); },
+			VK_FORMAT_R8G8B8A8_SRGB, m_uiWidth, m_uiHeight, m_uiMipLevelNum, m_uiLayerNum * m_uiFaceNum, m_StagingUpload);
 
 		stbi_image_free(pixels);
-		
-		//copy֮󣬽layoutתΪshader readonly
-		m_pRenderer->ChangeImageLayout(m_Image,
-			VK_FORMAT_R8G8B8A8_SRGB,
-			m_uiMipLevelNum,
-			m_uiLayerNum,
-			m_uiFaceNum,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-		CreateImageView();
-		CreateSampler();
 	}
 
 	KTXTexture::KTXTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath)
 		: Texture(pRenderer, filepath)
 	{
+		//ӳļlibktxֻheaderimagePrepareStagingдӳֱӿstaging bufferڴ
+		m_MappedFile.Open(m_Filepath);
+		ASSERT(m_MappedFile.IsOpen(), "ktx map file {} failed", m_Filepath.string());
+
 		ktxResult result;
-		ktxTexture* pKtxTexture;
-		result = ktxTexture_CreateFromNamedFile(m_Filepath.string().c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &pKtxTexture);
+		result = ktxTexture_CreateFromMemory(m_MappedFile.GetData(), m_MappedFile.GetSize(), KTX_TEXTURE_CREATE_SKIP_KVDATA_BIT, &m_pKtxTexture);
 		ASSERT(result == KTX_SUCCESS, "ktx load image {} failed", m_Filepath.string());
 
-		ASSERT(pKtxTexture->glFormat == GL_RGBA);
-		ASSERT(pKtxTexture->numDimensions == 2);
+		ASSERT(m_pKtxTexture->glFormat == GL_RGBA || TextureBaker::GetVulkanFormat(m_pKtxTexture->glInternalformat) != VK_FORMAT_UNDEFINED,
+			"Unsupport ktx format {} in {}", m_pKtxTexture->glInternalformat, m_Filepath.string());
+		ASSERT(m_pKtxTexture->numDimensions == 2);
 
-		ktx_uint8_t* ktxTextureData = ktxTexture_GetData(pKtxTexture);
-		m_Size = ktxTexture_GetSize(pKtxTexture);
+		m_Size = ktxTexture_GetSize(m_pKtxTexture);
 
-		m_uiWidth = pKtxTexture->baseWidth;
-		m_uiHeight = pKtxTexture->baseHeight;
-		m_uiMipLevelNum = pKtxTexture->numLevels;
-		m_uiLayerNum = pKtxTexture->numLayers;
-		m_uiFaceNum = pKtxTexture->numFaces;
+		m_uiWidth = m_pKtxTexture->baseWidth;
+		m_uiHeight = m_pKtxTexture->baseHeight;
+		m_uiMipLevelNum = m_pKtxTexture->numLevels;
+		m_uiLayerNum = m_pKtxTexture->numLayers;
+		m_uiFaceNum = m_pKtxTexture->numFaces;
 
 		if (IsTextureArray())
 		{
@@ -189,83 +269,195 @@ namespace DZW_VulkanWrap
 			ASSERT(m_uiLayerNum <= uiMaxLayerNum, "TextureArray {} layout count {} exceed max limit {}", m_Filepath.string(), m_uiLayerNum, uiMaxLayerNum);
 		}
 
+		//BCѹ豸֧ʱֱϴ𼶽ΪRGBA8
+		if (m_pKtxTexture->isCompressed)
+		{
+			VkFormat blockFormat = TextureBaker::GetVulkanFormat(m_pKtxTexture->glInternalformat);
+			if (m_pRenderer->CheckFormatSupportSampling(blockFormat))
+			{
+				m_Format = blockFormat;
+			}
+			else
+			{
+				m_bDecode = true;
+				Log::Warn("Block format {} not supported, {} is decoded to RGBA8", static_cast<int>(blockFormat), m_Filepath.string());
+			}
+		}
+
+		//ļֻһʱϴʱmipKTXиlayerfaceݽ
+		m_bGenerateMipmaps = (m_uiMipLevelNum == 1) && !m_pKtxTexture->isCompressed;
+		if (m_bGenerateMipmaps)
+			m_uiMipLevelNum = VulkanRenderer::CalculateMipLevelCount(m_uiWidth, m_uiHeight);
+
 		CreateImage();
+		CreatePlaceholder();
+		CreateSampler();
+	}
 
-		//copy֮ǰlayoutӳʼundefinedתΪtransfer dst
-		m_pRenderer->ChangeImageLayout(m_Image,
-			VK_FORMAT_R8G8B8A8_SRGB,
-			m_uiMipLevelNum,
-			m_uiLayerNum,
-			m_uiFaceNum,
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	KTXTexture::~KTXTexture()
+	{
+		if (m_pKtxTexture)
+			ktxTexture_Destroy(m_pKtxTexture);
+	}
 
-		TransferImageDataByStageBuffer(ktxTextureData, m_Size, m_Image, m_uiWidth, m_uiHeight, pKtxTexture);
+	void KTXTexture::PrepareStaging()
+	{
+		std::vector<ImageSource> vecImage;
+		LocateMappedImages(m_pKtxTexture, m_MappedFile.GetData(), m_MappedFile.GetSize(), vecImage);
 
-		ktxTexture_Destroy(pKtxTexture);
+		if (m_bGenerateMipmaps)
+		{
+			size_t levelSize = static_cast<size_t>(m_uiWidth) * m_uiHeight * 4 * m_uiLayerNum * m_uiFaceNum;
+			m_pRenderer->PrepareMipmapStaging([&](UCHAR* pDst) { memcpy(pDst, vecImage[0].pData, levelSize); },
+				VK_FORMAT_R8G8B8A8_SRGB, m_uiWidth, m_uiHeight, m_uiMipLevelNum, m_uiLayerNum * m_uiFaceNum, m_StagingUpload);
+		}
+		else
+		{
+			std::vector<UCHAR> vecDecoded;
+			if (m_bDecode)
+			{
+				std::vector<size_t> vecDecodedOffset;
+				size_t decodedSize = 0;
+				for (UINT face = 0; face < m_uiFaceNum; ++face)
+				{
+					for (UINT layer = 0; layer < m_uiLayerNum; ++layer)
+					{
+						for (UINT mipLevel = 0; mipLevel < m_uiMipLevelNum; ++mipLevel)
+						{
+							vecDecodedOffset.push_back(decodedSize);
+							decodedSize += static_cast<size_t>(std::max(m_uiWidth >> mipLevel, 1u)) * std::max(m_uiHeight >> mipLevel, 1u) * 4;
+						}
+					}
+				}
 
-		m_pRenderer->ChangeImageLayout(m_Image,
-			VK_FORMAT_R8G8B8A8_SRGB,
-			m_uiMipLevelNum,
-			m_uiLayerNum,
-			m_uiFaceNum,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				vecDecoded.resize(decodedSize);
+				for (size_t i = 0; i < vecImage.size(); ++i)
+				{
+					UINT mipLevel = static_cast<UINT>(i % m_uiMipLevelNum);
+					TextureBaker::DecodeImage(m_pKtxTexture->glInternalformat, vecImage[i].pData,
+						std::max(m_uiWidth >> mipLevel, 1u), std::max(m_uiHeight >> mipLevel, 1u), vecDecoded.data() + vecDecodedOffset[i]);
 
-		CreateImageView();
-		CreateSampler();
+					size_t nextOffset = (i + 1 < vecImage.size()) ? vecDecodedOffset[i + 1] : decodedSize;
+					vecImage[i].pData = vecDecoded.data() + vecDecodedOffset[i];
+					vecImage[i].size = nextOffset - vecDecodedOffset[i];
+				}
+			}
+
+			WriteStagingBuffer(vecImage, m_uiWidth, m_uiHeight);
+		}
+
+		//stagingУͷheaderļӳ
+		ktxTexture_Destroy(m_pKtxTexture);
+		m_pKtxTexture = nullptr;
+		m_MappedFile.Close();
 	}
 
-	void KTXTexture::TransferImageDataByStageBuffer(const void* pData, VkDeviceSize imageSize, VkImage& image, UINT uiWidth, UINT uiHeight, ktxTexture* pKtxTexture)
+	void KTXTexture::LocateMappedImages(ktxTexture* pKtxTexture, const UCHAR* pFileData, size_t fileSize, std::vector<ImageSource>& vecImage)
 	{
-		ASSERT(pKtxTexture != nullptr, "Ktx imgae data is empty");
+		//KTX1ÿmip level֮ǰ4ֽڵimageSizeRGBA8BCʽݶ4ֽڶ룬ûpadding
+		//imageļеλ =  + (level + 1) * 4 + ʱƫ
+		//header̶64ֽڣ4ֽΪbytesOfKeyValueDatakey/value֮ΪһlevelimageSize
+		constexpr size_t KTX_HEADER_SIZE = 64;
+		ASSERT(fileSize >= KTX_HEADER_SIZE, "ktx {} is truncated", m_Filepath.string());
+
+		UINT uiEndianness = 0;
+		memcpy(&uiEndianness, pFileData + 12, sizeof(UINT));
+		ASSERT(uiEndianness == 0x04030201, "ktx {} is not little endian", m_Filepath.string());
+
+		UINT uiKeyValueBytes = 0;
+		memcpy(&uiKeyValueBytes, pFileData + 60, sizeof(UINT));
+		size_t dataStart = KTX_HEADER_SIZE + uiKeyValueBytes;
+		ASSERT(dataStart <= fileSize, "ktx {} is truncated", m_Filepath.string());
+
+		bool bCubemapFace = pKtxTexture->isCubemap && !pKtxTexture->isArray; //cubemapimageSizeΪfaceĴС
+		for (UINT mipLevel = 0; mipLevel < pKtxTexture->numLevels; ++mipLevel)
+		{
+			size_t levelOffset;
+			KTX_error_code ret = ktxTexture_GetImageOffset(pKtxTexture, mipLevel, 0, 0, &levelOffset);
+			ASSERT(ret == KTX_SUCCESS);
 
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
+			//ȼimageSizelevelļڣٶȡ
+			size_t imageSizePos = dataStart + levelOffset + mipLevel * sizeof(UINT);
+			ASSERT(imageSizePos + sizeof(UINT) <= fileSize, "ktx {} is truncated at level {}", m_Filepath.string(), mipLevel);
 
-		m_pRenderer->CreateBufferAndBindMemory(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			stagingBuffer, stagingBufferMemory);
+			UINT uiImageSize = 0;
+			memcpy(&uiImageSize, pFileData + imageSizePos, sizeof(UINT));
+			size_t expectedSize = ktxTexture_GetImageSize(pKtxTexture, mipLevel) * (bCubemapFace ? 1 : pKtxTexture->numLayers * pKtxTexture->numFaces);
+			ASSERT(uiImageSize == expectedSize, "ktx {} level {} size {} mismatch, expect {}", m_Filepath.string(), mipLevel, uiImageSize, expectedSize);
+
+			size_t levelSize = bCubemapFace ? expectedSize * pKtxTexture->numFaces : expectedSize;
+			ASSERT(imageSizePos + sizeof(UINT) + levelSize <= fileSize, "ktx {} is truncated at level {}", m_Filepath.string(), mipLevel);
+		}
+
+		//˳copy regionһ
+		vecImage.clear();
+		for (UINT face = 0; face < pKtxTexture->numFaces; ++face)
+		{
+			for (UINT layer = 0; layer < pKtxTexture->numLayers; ++layer)
+			{
+				for (UINT mipLevel = 0; mipLevel < pKtxTexture->numLevels; ++mipLevel)
+				{
+					size_t offset;
+					KTX_error_code ret = ktxTexture_GetImageOffset(pKtxTexture, mipLevel, layer, face, &offset);
+					ASSERT(ret == KTX_SUCCESS);
+
+					ImageSource imageSource;
+					imageSource.pData = pFileData + dataStart + (mipLevel + 1) * sizeof(UINT) + offset;
+					imageSource.size = ktxTexture_GetImageSize(pKtxTexture, mipLevel);
+					ASSERT(imageSource.pData + imageSource.size <= pFileData + fileSize, "ktx {} is truncated", m_Filepath.string());
+					vecImage.push_back(imageSource);
+				}
+			}
+		}
+	}
+
+	void KTXTexture::WriteStagingBuffer(const std::vector<ImageSource>& vecImage, UINT uiWidth, UINT uiHeight)
+	{
+		ASSERT(vecImage.size() == static_cast<size_t>(m_uiFaceNum) * m_uiLayerNum * m_uiMipLevelNum, "Ktx imgae count mismatch");
 
-		void* imageData;
-		vkMapMemory(m_pRenderer->m_LogicalDevice, stagingBufferMemory, 0, imageSize, 0, (void**)&imageData);
-		memcpy(imageData, pData, static_cast<size_t>(imageSize));
-		vkUnmapMemory(m_pRenderer->m_LogicalDevice, stagingBufferMemory);
+		//ÿimagestagingе㰴16ֽڶ룬bufferOffsettexelBC blockСҪ
+		std::vector<VkDeviceSize> vecStagingOffset;
+		VkDeviceSize stagingSize = 0;
+		for (const auto& imageSource : vecImage)
+		{
+			stagingSize = (stagingSize + 15) & ~static_cast<VkDeviceSize>(15);
+			vecStagingOffset.push_back(stagingSize);
+			stagingSize += imageSource.size;
+		}
+
+		m_pRenderer->CreateBufferAndBindMemory(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			m_StagingUpload.buffer, m_StagingUpload.memory);
 
-		VkCommandBuffer singleTimeCommandBuffer = m_pRenderer->BeginSingleTimeCommand();
+		UCHAR* pStaging;
+		vkMapMemory(m_pRenderer->m_LogicalDevice, m_StagingUpload.memory, 0, stagingSize, 0, (void**)&pStaging);
+		for (size_t i = 0; i < vecImage.size(); ++i)
+			memcpy(pStaging + vecStagingOffset[i], vecImage[i].pData, vecImage[i].size);
+		vkUnmapMemory(m_pRenderer->m_LogicalDevice, m_StagingUpload.memory);
 
-		std::vector<VkBufferImageCopy> vecBufferCopyRegions;
+		m_StagingUpload.vecRegion.clear();
 		for (UINT face = 0; face < m_uiFaceNum; ++face)
 		{
 			for (UINT layer = 0; layer < m_uiLayerNum; ++layer)
 			{
 				for (UINT mipLevel = 0; mipLevel < m_uiMipLevelNum; ++mipLevel)
 				{
-					size_t offset;
-					KTX_error_code ret = ktxTexture_GetImageOffset(pKtxTexture, mipLevel, layer, face, &offset);
-					ASSERT(ret == KTX_SUCCESS);
 					VkBufferImageCopy bufferCopyRegion = {};
 					bufferCopyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 					bufferCopyRegion.imageSubresource.mipLevel = mipLevel;
 					bufferCopyRegion.imageSubresource.baseArrayLayer = (m_uiFaceNum > 1) ? (face + layer * 6) : (layer);
 					bufferCopyRegion.imageSubresource.layerCount = 1;
-					bufferCopyRegion.imageExtent.width = uiWidth >> mipLevel;
-					bufferCopyRegion.imageExtent.height = uiHeight >> mipLevel;
+					bufferCopyRegion.imageExtent.width = std::max(uiWidth >> mipLevel, 1u);
+					bufferCopyRegion.imageExtent.height = std::max(uiHeight >> mipLevel, 1u);
 					bufferCopyRegion.imageExtent.depth = 1;
-					bufferCopyRegion.bufferOffset = offset;
-					vecBufferCopyRegions.push_back(bufferCopyRegion);
+					bufferCopyRegion.bufferOffset = vecStagingOffset[m_StagingUpload.vecRegion.size()];
+					m_StagingUpload.vecRegion.push_back(bufferCopyRegion);
 				}
 			}
 		}
-
-		vkCmdCopyBufferToImage(singleTimeCommandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			static_cast<UINT>(vecBufferCopyRegions.size()), vecBufferCopyRegions.data());
-
-
-		m_pRenderer->EndSingleTimeCommand(singleTimeCommandBuffer);
-
-		vkDestroyBuffer(m_pRenderer->m_LogicalDevice, stagingBuffer, nullptr);
-		vkFreeMemory(m_pRenderer->m_LogicalDevice, stagingBufferMemory, nullptr);
+		m_StagingUpload.uiWidth = uiWidth;
+		m_StagingUpload.uiHeight = uiHeight;
+		m_StagingUpload.bBlitMipmaps = false;
 	}
 
 
@@ -306,6 +498,9 @@ namespace DZW_VulkanWrap
 		{
 			size_t index_offset = 0;
 
+			SubMesh subMesh;
+			subMesh.uiFirstIndex = static_cast<UINT>(m_vecIndices.size());
+
 			// 
 			for (size_t f = 0; f < vecShapes[s].mesh.num_face_vertices.size(); f++)
 			{
@@ -359,12 +554,19 @@ namespace DZW_VulkanWrap
 						vert.normal.y *= -1.f;
 					}
 
+					subMesh.boundMin = glm::min(subMesh.boundMin, vert.pos);
+					subMesh.boundMax = glm::max(subMesh.boundMax, vert.pos);
+
 					m_vecVertices.push_back(vert);
 					m_vecIndices.push_back(static_cast<UINT>(m_vecIndices.size()));
 				}
 
 				index_offset += fv;
 			}
+
+			subMesh.uiIndexCount = static_cast<UINT>(m_vecIndices.size()) - subMesh.uiFirstIndex;
+			if (subMesh.uiIndexCount > 0)
+				m_vecSubMeshes.push_back(subMesh);
 		}
 
 		ASSERT(m_vecVertices.size() > 0, "Vertex data empty");
@@ -422,11 +624,41 @@ namespace DZW_VulkanWrap
 		vkCmdDrawIndexed(commandBuffer, static_cast<UINT>(m_vecIndices.size()), 1, 0, 0, 0);
 	}
 
+	void Model::DrawSubMeshes(VkCommandBuffer& commandBuffer, VkPipeline& pipeline, VkPipelineLayout& pipelineLayout, VkDescriptorSet* pDescriptorSet, const std::vector<UINT>& vecSubMeshIdx,
+		const std::function<void(UINT)>& funcPreDraw)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		VkBuffer VertexBuffers[] = {
+			m_VertexBuffer,
+		};
+		VkDeviceSize Offsets[]{ 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, VertexBuffers, Offsets);
+		vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+		if (pDescriptorSet)
+		{
+			vkCmdBindDescriptorSets(commandBuffer,
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				pipelineLayout,
+				0, 1,
+				pDescriptorSet,
+				0, NULL);
+		}
+
+		for (const auto& uiIdx : vecSubMeshIdx)
+		{
+			const auto& subMesh = m_vecSubMeshes[uiIdx];
+			if (funcPreDraw)
+				funcPreDraw(uiIdx);
+			vkCmdDrawIndexed(commandBuffer, subMesh.uiIndexCount, 1, subMesh.uiFirstIndex, 0, 0);
+		}
+	}
+
 	GLTFModel::GLTFModel(VulkanRenderer* pRenderer, const std::filesystem::path& filepath)
 		: Model(pRenderer, filepath)
 	{
 		tinygltf::Model gltfModel;
 		tinygltf::TinyGLTF loader;
+		loader.SetImageLoader(StoreEncodedGLTFImage, nullptr);
 		std::string strError;
 		std::string strWarn;
 
@@ -457,15 +689,15 @@ namespace DZW_VulkanWrap
 
 		for (auto& image : m_vecImages)
 		{
+			if (image.m_pTexture)
+				continue;
+
 			vkDestroyImage(m_pRenderer->m_LogicalDevice, image.m_Image, nullptr);
 			vkDestroyImageView(m_pRenderer->m_LogicalDevice, image.m_ImageView, nullptr);
 			vkFreeMemory(m_pRenderer->m_LogicalDevice, image.m_Memory, nullptr);
 		}
 
-		for (auto& sampler : m_vecSamplers)
-		{
-			vkDestroySampler(m_pRenderer->m_LogicalDevice, sampler.m_Sampler, nullptr);
-		}
+		//samplerSamplerCache
 
 		vkDestroyBuffer(m_pRenderer->m_LogicalDevice, m_VertexBuffer, nullptr);
 		vkFreeMemory(m_pRenderer->m_LogicalDevice, m_VertexBufferMemory, nullptr);
@@ -533,50 +765,55 @@ namespace DZW_VulkanWrap
 	void GLTFModel::LoadImages(const tinygltf::Model& gltfModel)
 	{
 		m_vecImages.resize(gltfModel.images.size());
+
+		//tinygltfֻ˱ݣTextureCacheͼƬ̳߳вн
+		std::vector<size_t> vecDecodeIdx;
+		std::vector<std::span<const UCHAR>> vecEncoded;
 		for (size_t i = 0; i < gltfModel.images.size(); ++i)
 		{
 			const tinygltf::Image& gltfImage = gltfModel.images[i];
-			const UCHAR* imageBuffer = nullptr;
-			UCHAR* allocImageBuffer = nullptr;
-			size_t imageBufferSize = 0;
-			bool bDeleteBuffer = false;
-			if (gltfImage.component == 3) //RGB ҪתΪRGBA
+			auto& image = m_vecImages[i];
+			image.m_strName = gltfImage.uri;
+
+			//ⲿͼƬļTextureCacheͬģͬһļʱֻϴһ
+			if (!gltfImage.uri.empty() && gltfImage.uri.rfind("data:", 0) != 0)
 			{
-				imageBufferSize = gltfImage.width * gltfImage.height * 4;
-				allocImageBuffer = new UCHAR[imageBufferSize];
-				UCHAR* rgbaPtr = allocImageBuffer;
-				const UCHAR* rgbPtr = &gltfImage.image[0];
-				for (size_t p = 0; p < gltfImage.width * gltfImage.height; ++p)
+				std::filesystem::path imagePath = m_Filepath.parent_path() / gltfImage.uri;
+				if (std::filesystem::exists(imagePath))
 				{
-					rgbaPtr[0] = rgbPtr[0]; // R
-					rgbaPtr[1] = rgbPtr[1]; // G
-					rgbaPtr[2] = rgbPtr[2]; // B
-					rgbaPtr[3] = 255;       // A
-
-					rgbaPtr += 4;
-					rgbPtr += 3;
+					image.m_pTexture = m_pRenderer->GetTextureCache()->Acquire(imagePath);
+					if (image.m_pTexture)
+					{
+						//ʵdescriptor setֻдһΣȴʵϴʹplaceholder
+						m_pRenderer->GetTextureStreamer()->Finish(image.m_pTexture);
+						image.m_uiWidth = image.m_pTexture->m_uiWidth;
+						image.m_uiHeight = image.m_pTexture->m_uiHeight;
+						image.m_uiMipLevelNum = image.m_pTexture->m_uiMipLevelNum;
+						image.m_Image = image.m_pTexture->m_Image;
+						image.m_ImageView = image.m_pTexture->m_ImageView;
+						image.m_Memory = image.m_pTexture->m_Memory;
+						continue;
+					}
 				}
-				imageBuffer = allocImageBuffer;
-				bDeleteBuffer = true;
-			}
-			else if (gltfImage.component == 4) //RGBA
-			{
-				imageBuffer = &gltfImage.image[0];
-				imageBufferSize = gltfImage.image.size();
-				bDeleteBuffer = false;
-			}
-			else
-			{
-				ASSERT(false, "Unsupport gltf image type");
 			}
 
-			auto& image = m_vecImages[i];
-			image.m_uiWidth = static_cast<UINT>(gltfImage.width);
-			image.m_uiHeight = static_cast<UINT>(gltfImage.height);
-			image.m_strName = gltfImage.uri;
+			vecDecodeIdx.push_back(i);
+			vecEncoded.emplace_back(gltfImage.image.data(), gltfImage.image.size());
+		}
+
+		std::vector<ImageDecoder::DecodedImage> vecDecoded = ImageDecoder::DecodeBatch(vecEncoded);
+		for (size_t n = 0; n < vecDecodeIdx.size(); ++n)
+		{
+			auto& decoded = vecDecoded[n];
+			ASSERT(decoded.IsValid(), "Decode gltf image {} failed", gltfModel.images[vecDecodeIdx[n]].uri);
+
+			auto& image = m_vecImages[vecDecodeIdx[n]];
+			image.m_uiWidth = decoded.uiWidth;
+			image.m_uiHeight = decoded.uiHeight;
+			image.m_uiMipLevelNum = VulkanRenderer::CalculateMipLevelCount(image.m_uiWidth, image.m_uiHeight);
 
 			m_pRenderer->CreateImageAndBindMemory(image.m_uiWidth, image.m_uiHeight,
-				1, 1, 1,
+				image.m_uiMipLevelNum, 1, 1,
 				VK_SAMPLE_COUNT_1_BIT,
 				VK_FORMAT_R8G8B8A8_SRGB,
 				VK_IMAGE_TILING_OPTIMAL,
@@ -584,32 +821,15 @@ namespace DZW_VulkanWrap
 				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 				image.m_Image, image.m_Memory);
 
-			//copy֮ǰlayoutӳʼundefinedתΪtransfer dst
-			m_pRenderer->ChangeImageLayout(image.m_Image,
-				VK_FORMAT_R8G8B8A8_SRGB,				//image format
-				1,										//mipmap levels
-				1,										//layers
-				1,										//faces
-				VK_IMAGE_LAYOUT_UNDEFINED,				//src layout
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);	//dst layout
-
-			m_pRenderer->TransferImageDataByStageBuffer(imageBuffer, imageBufferSize, image.m_Image, image.m_uiWidth, image.m_uiHeight);
-			
-			if (bDeleteBuffer)
-				delete[] imageBuffer;
-
-			m_pRenderer->ChangeImageLayout(image.m_Image,
-				VK_FORMAT_R8G8B8A8_SRGB,
-				1,
-				1,
-				1,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			//RGBдstagingʱչΪRGBAϴmip 0mipʱlayoutΪshader readonly
+			m_pRenderer->TransferImageDataAndGenerateMipmaps([&](UCHAR* pDst) { ImageDecoder::WriteRGBA(decoded, pDst); },
+				image.m_Image, VK_FORMAT_R8G8B8A8_SRGB, image.m_uiWidth, image.m_uiHeight, image.m_uiMipLevelNum, 1);
+			decoded.pPixels.reset();
 
 			image.m_ImageView = m_pRenderer->CreateImageView(image.m_Image,
 				VK_FORMAT_R8G8B8A8_SRGB,	//ʽΪsRGB
 				VK_IMAGE_ASPECT_COLOR_BIT,	//aspectFlagsΪCOLOR_BIT
-				1,
+				image.m_uiMipLevelNum,
 				1,
 				1);
 		}
@@ -649,12 +869,9 @@ namespace DZW_VulkanWrap
 			createInfo.addressModeV = addressModeV;
 			createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 
-			createInfo.anisotropyEnable = VK_FALSE;
-			if (createInfo.anisotropyEnable == VK_TRUE)
-			{
-				auto& physicalDeviceProperties = m_pRenderer->m_mapPhysicalDeviceInfo.at(m_pRenderer->m_PhysicalDevice).properties;
-				createInfo.maxAnisotropy = physicalDeviceProperties.limits.maxSamplerAnisotropy;
-			}
+			//nearest˲Ҫ
+			createInfo.anisotropyEnable = (minFilter == VK_FILTER_LINEAR) ? VK_TRUE : VK_FALSE;
+			createInfo.maxAnisotropy = m_pRenderer->m_fSamplerAnisotropy;
 
 			createInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 			createInfo.unnormalizedCoordinates = VK_FALSE;
@@ -665,9 +882,9 @@ namespace DZW_VulkanWrap
 			createInfo.mipmapMode = mipmapMode;
 			createInfo.mipLodBias = 0.f;
 			createInfo.minLod = 0.f;
-			createInfo.maxLod = 0.f;
+			createInfo.maxLod = VK_LOD_CLAMP_NONE; //samplerɶimageãmipɸԵimage view޶
 
-			VULKAN_ASSERT(vkCreateSampler(m_pRenderer->m_LogicalDevice, &createInfo, nullptr, &sampler.m_Sampler), "Create sampler failed");
+			sampler.m_Sampler = m_pRenderer->GetSamplerCache()->Acquire(createInfo);
 		}
 	}
 
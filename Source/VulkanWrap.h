@@ -2,8 +2,12 @@
 
 #include "vulkan/vulkan.h"
 #include "Core.h"
+#include "MappedFile.h"
 
 #include <filesystem>
+#include <cfloat>
+#include <functional>
+#include <atomic>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -166,12 +170,23 @@ namespace DZW_MathWrap
 
 namespace DZW_VulkanWrap
 {
+	//дstagingimagecopy regionworker߳׼֮¼ƽcommand buffer
+	struct StagingUpload
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		std::vector<VkBufferImageCopy> vecRegion;
+		UINT uiWidth = 0;
+		UINT uiHeight = 0;
+		bool bBlitMipmaps = false; //trueʱֻmip 0mipcopy֮blit
+	};
+
 	class Texture
 	{
 	public:
 		Texture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath)
 			: m_pRenderer(pRenderer), m_Filepath(filepath) {}
-		~Texture();
+		virtual ~Texture();
 
 		enum class TextureType : UCHAR
 		{
@@ -179,31 +194,65 @@ namespace DZW_VulkanWrap
 			TEXTURE_TYPE_NORMAL,
 		};
 
+		//첽أʱֻȡļͷ1x1placeholderstagingTextureStreamerworker׼
+		enum class LoadState : UCHAR
+		{
+			LOAD_STATE_QUEUED,
+			LOAD_STATE_PREPARING,
+			LOAD_STATE_STAGED,
+			LOAD_STATE_PARTIAL, //ֻϴ˵ͷֱʵmipimage viewm_uiResidentMipLevelʼ
+			LOAD_STATE_RESIDENT,
+		};
+
 		virtual TextureType GetType() = 0;
 
 		bool IsTextureArray() { return m_uiLayerNum > 1; }
 		bool IsCubemapTexture() { return m_uiFaceNum == 6; }
+		bool IsResident() const { return m_LoadState == LoadState::LOAD_STATE_RESIDENT; }
+		//stagingÿmipcopy regionʱϴblitɵmipֻһ
+		bool IsProgressive() const { return !m_StagingUpload.bBlitMipmaps && m_uiMipLevelNum > 1; }
 
 		void CreateImage();
-		void CreateImageView();
+		void CreateImageView(UINT uiBaseMipLevel = 0);
 		void CreateSampler();
+		void CreatePlaceholder();
+
+		//workeṛ߳ȡ벢дstaging
+		virtual void PrepareStaging() = 0;
+		//Ⱦ̣߳¼[uiBaseMipLevel, m_uiResidentMipLevel)⼸ϴm_ImageViewлΪuiBaseMipLevelʼviewm_uiVersionһ
+		//滻viewretiredViewأplaceholder⣩÷ʹ֡
+		void RecordUpload(VkCommandBuffer commandBuffer, UINT uiBaseMipLevel, VkImageView& retiredView);
+		//¼ϴcommand bufferִ
+		void ReleaseStaging();
 
 	public:
 		std::filesystem::path m_Filepath;
 		VulkanRenderer* m_pRenderer = nullptr;
 
 		size_t m_Size = 0;
+		VkDeviceSize m_MemorySize = 0; //ԴʵռãTextureCacheͳ
 		UINT m_uiWidth = 0;
 		UINT m_uiHeight = 0;
 		UINT m_uiMipLevelNum = 0;
 		UINT m_uiLayerNum = 0;
 		UINT m_uiFaceNum = 0;
+		VkFormat m_Format = VK_FORMAT_R8G8B8A8_SRGB; //決KTXΪBC1/BC3
+
+		std::atomic<LoadState> m_LoadState = LoadState::LOAD_STATE_QUEUED;
+		UINT m_uiVersion = 0; //m_ImageViewÿлһμһdescriptor setһݴд
+		UINT m_uiResidentMipLevel = 0; //ϴ߷ֱʵmipϴ֮ǰm_uiMipLevelNum
+		StagingUpload m_StagingUpload;
 	public:
 		//vulkan resource
 		VkImage m_Image = VK_NULL_HANDLE;
-		VkImageView m_ImageView = VK_NULL_HANDLE;
+		VkImageView m_ImageView = VK_NULL_HANDLE; //ϴǰָplaceholder
 		VkDeviceMemory m_Memory = VK_NULL_HANDLE;
 		VkSampler m_Sampler = VK_NULL_HANDLE;
+
+		//ʵlayerfaceͬ1x1ɫviewһ£ֱ
+		VkImage m_PlaceholderImage = VK_NULL_HANDLE;
+		VkImageView m_PlaceholderImageView = VK_NULL_HANDLE;
+		VkDeviceMemory m_PlaceholderMemory = VK_NULL_HANDLE;
 	};
 
 	class NormalTexture : public Texture
@@ -212,23 +261,43 @@ namespace DZW_VulkanWrap
 		NormalTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath);
 
 		virtual TextureType GetType() { return TextureType::TEXTURE_TYPE_KTX; }
+
+		virtual void PrepareStaging();
 	};
 
 	class KTXTexture : public Texture
 	{
 	public:
 		KTXTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath);
+		virtual ~KTXTexture();
 
 		virtual TextureType GetType() { return TextureType::TEXTURE_TYPE_KTX; }
+
+		virtual void PrepareStaging();
 	
 	private:
-		void TransferImageDataByStageBuffer(const void* pData, VkDeviceSize imageSize, VkImage& image, UINT uiWidth, UINT uiHeight, ktxTexture* pKtxTextue);
+		//һface/layer/mipݣfacelayermip˳Уcopy regionһ
+		struct ImageSource
+		{
+			const UCHAR* pData = nullptr;
+			size_t size = 0;
+		};
+
+		void LocateMappedImages(ktxTexture* pKtxTexture, const UCHAR* pFileData, size_t fileSize, std::vector<ImageSource>& vecImage);
+		void WriteStagingBuffer(const std::vector<ImageSource>& vecImage, UINT uiWidth, UINT uiHeight);
+
+		//ʱheaderļӳ䱣PrepareStaging
+		MappedFile m_MappedFile;
+		ktxTexture* m_pKtxTexture = nullptr;
+		bool m_bDecode = false;
+		bool m_bGenerateMipmaps = false;
 	};
 
 	class TextureFactor
 	{
 	public:
-		static std::unique_ptr<Texture> CreateTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath);
+		//ذplaceholderrendererTextureStreamerں̨
+		static std::shared_ptr<Texture> CreateTexture(VulkanRenderer* pRenderer, const std::filesystem::path& filepath);
 	};
 
 
@@ -258,6 +327,21 @@ namespace DZW_VulkanWrap
 		std::vector<UINT> m_vecIndices;
 		VkBuffer m_IndexBuffer = VK_NULL_HANDLE;
 		VkDeviceMemory m_IndexBufferMemory = VK_NULL_HANDLE;
+
+		//shapeֵ估ģͿռΧУshadow cascadecaster޳
+		struct SubMesh
+		{
+			UINT uiFirstIndex = 0;
+			UINT uiIndexCount = 0;
+			glm::vec3 boundMin = glm::vec3(FLT_MAX);
+			glm::vec3 boundMax = glm::vec3(-FLT_MAX);
+		};
+		std::vector<SubMesh> m_vecSubMeshes;
+
+		//ֻvecSubMeshIdxеSubMeshDrawvertex/index buffer
+		//funcPreDrawÿSubMeshdraw֮ǰãڸpush constant
+		void DrawSubMeshes(VkCommandBuffer& commandBuffer, VkPipeline& pipeline, VkPipelineLayout& pipelineLayout, VkDescriptorSet* pDescriptorSet, const std::vector<UINT>& vecSubMeshIdx,
+			const std::function<void(UINT)>& funcPreDraw = nullptr);
 	};
 
 	class OBJModel : public Model
@@ -311,9 +395,13 @@ namespace DZW_VulkanWrap
 			std::string m_strName;
 			UINT m_uiWidth;
 			UINT m_uiHeight;
+			UINT m_uiMipLevelNum = 1;
 			VkImage m_Image;
 			VkImageView m_ImageView;
 			VkDeviceMemory m_Memory;
+
+			//ⲿļʱTextureCacheУģ͹ͬһݣʱԴ
+			std::shared_ptr<DZW_VulkanWrap::Texture> m_pTexture;
 		};
 
 		struct Sampler
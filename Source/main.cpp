@@ -1,9 +1,17 @@
 #include "VulkanRenderer.h"
 #include <windows.h>
 
-int main()
+int main(int argc, char** argv)
 {
     SetCurrentDirectory(L"D:\\dev\\SolarSystem");
+
+    //--bench-asteroid-gpu: headless compute benchmark, needs no window or surface (runs on lavapipe / SwiftShader too)
+    if (argc > 1 && std::string(argv[1]) == "--bench-asteroid-gpu")
+    {
+        AsteroidBeltCompute::RunHeadlessBenchmark({ 100000, 1000000 });
+        return 0;
+    }
+
     VulkanRenderer renderer;
 
     renderer.Init();
@@ -27,6 +27,11 @@ project "SolarSystem"
         "glfw3.lib",
     }
 
+    prebuildcommands --将GLSL编译为.u32，由EmbeddedShader.cpp嵌入
+    {
+        "call \"%{prj.location}/Assert/Shader/GenerateEmbeddedSpv.bat\"",
+    }
+
     includedirs --外部包含目录
     {
         "D:/VulkanSDK/Include",
@@ -44,7 +49,14 @@ project "SolarSystem"
     filter "configurations:Debug"
         defines "DEBUG"
         symbols "On"
+        links "shaderc_shared.lib" --Shader热重载运行时编译GLSL，仅Debug开启
 
     filter "configurations:Release"
         defines "NDEBUG"
-        optimize "On"
\ No newline at end of file
+        optimize "On"
+
+    filter "files:Source/AsteroidBeltAVX2.cpp" --仅该文件使用AVX2指令集，运行时检测CPU支持后才会调用
+        buildoptions "/arch:AVX2"
+
+    filter "files:Source/ImageDecoderAVX2.cpp" --RGB转RGBA的AVX2 kernel，运行时检测CPU支持后才会调用
+        buildoptions "/arch:AVX2"